@@ -13,28 +13,36 @@ in vec3 tangent;
 in vec3 bitangent;
 in vec3 normal;
 
-struct Material
+// material constants, see MaterialBlock in render_material.h; one range of the model's buffer per material
+layout(std140) uniform MaterialBlock
 {
-    bool useTextureAlbedo;
-    bool useTextureMetallicRoughness;
-    bool useTextureNormal;
-    bool useTextureAmbientOcclusion;
-    bool useTextureEmissive;
-
-    vec3  albedo;
+    vec4  albedo;   // rgb
+    vec4  emissive; // rgb
     float metallic;
     float roughness;
     float ambientOcclusion;
-    vec3  emissive;
+    uint  textureFlags; // MATERIAL_TEXTURE_* bits
+} material;
+
+const uint MATERIAL_TEXTURE_ALBEDO             = 1u;
+const uint MATERIAL_TEXTURE_METALLIC_ROUGHNESS = 2u;
+const uint MATERIAL_TEXTURE_NORMAL             = 4u;
+const uint MATERIAL_TEXTURE_AMBIENT_OCCLUSION  = 8u;
+const uint MATERIAL_TEXTURE_EMISSIVE           = 16u;
 
-    sampler2D textureAlbedo;
-    sampler2D textureMetallicRoughness;
-    sampler2D textureNormal;
-    sampler2D textureAmbientOcclusion;
-    sampler2D textureEmissive;
+// samplers can't live in a block; their units are fixed, the material's textures are bound to them
+struct MaterialTextures
+{
+    sampler2D albedo;
+    sampler2D metallicRoughness;
+    sampler2D normal;
+    sampler2D ambientOcclusion;
+    sampler2D emissive;
 };
 
-uniform Material material;
+uniform MaterialTextures materialTextures;
+
+bool hasTexture(uint flag) { return (material.textureFlags & flag) != 0u; }
 
 uniform vec3 cameraPosition;
 
@@ -117,10 +125,11 @@ float geometrySmith(vec3 n, vec3 v, vec3 l, float roughness)
     return geometrySchlickGGX(n, v, k) * geometrySchlickGGX(n, l, k);
 }
 
-// Tangent space to world
-vec3 calculateNormal(vec3 tangentNormal)
+// Tangent space to world, z is rebuilt since BC5 normal maps only store xy
+vec3 calculateNormal(vec2 tangentNormal)
 {
-    vec3 norm = normalize(tangentNormal * 2.0 - 1.0);
+    vec2 xy   = tangentNormal * 2.0 - 1.0;
+    vec3 norm = normalize(vec3(xy, sqrt(max(1.0 - dot(xy, xy), 0.0))));
     mat3 TBN  = mat3(tangent, bitangent, normal);
     return normalize(TBN * norm); // tangent --> world
 }
@@ -130,41 +139,41 @@ void main()
     // retrieve all the material properties
 
     // albedo
-    vec3 albedo = material.albedo;
-    if (material.useTextureAlbedo)
+    vec3 albedo = material.albedo.rgb;
+    if (hasTexture(MATERIAL_TEXTURE_ALBEDO))
     {
-        albedo = texture(material.textureAlbedo, textureCoordinates).rgb;
+        albedo = texture(materialTextures.albedo, textureCoordinates).rgb;
     }
 
     // metallic/roughness
     float metallic  = material.metallic;
     float roughness = material.roughness;
-    if (material.useTextureMetallicRoughness)
+    if (hasTexture(MATERIAL_TEXTURE_METALLIC_ROUGHNESS))
     {
-        vec3 metallicRoughness = texture(material.textureMetallicRoughness, textureCoordinates).rgb;
+        vec3 metallicRoughness = texture(materialTextures.metallicRoughness, textureCoordinates).rgb;
         metallic               = metallicRoughness.b;
         roughness              = metallicRoughness.g;
     }
 
     // normal
     vec3 n = normal; // interpolated vertex normal
-    if (material.useTextureNormal)
+    if (hasTexture(MATERIAL_TEXTURE_NORMAL))
     {
-        n = calculateNormal(texture(material.textureNormal, textureCoordinates).rgb);
+        n = calculateNormal(texture(materialTextures.normal, textureCoordinates).rg);
     }
 
     // ambient occlusion
     float ao = material.ambientOcclusion;
-    if (material.useTextureAmbientOcclusion)
+    if (hasTexture(MATERIAL_TEXTURE_AMBIENT_OCCLUSION))
     {
-        ao = texture(material.textureAmbientOcclusion, textureCoordinates).r;
+        ao = texture(materialTextures.ambientOcclusion, textureCoordinates).r;
     }
 
     // emissive
-    vec3 emissive = material.emissive;
-    if (material.useTextureEmissive)
+    vec3 emissive = material.emissive.rgb;
+    if (hasTexture(MATERIAL_TEXTURE_EMISSIVE))
     {
-        emissive = texture(material.textureEmissive, textureCoordinates).rgb;
+        emissive = texture(materialTextures.emissive, textureCoordinates).rgb;
     }
 
     vec3 v = normalize(cameraPosition - worldCoordinates); // view vector pointing at camera
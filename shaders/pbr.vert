@@ -1,10 +1,17 @@
 #version 330 core
 
-layout(location = 0) in vec3 aPos;
-layout(location = 1) in vec3 aNormal;
-layout(location = 2) in vec2 aTextureCoordinates;
-layout(location = 3) in vec3 aTangent;
-layout(location = 4) in vec3 aBitangent;
+// packed vertex layout, see VertexEncoder
+layout(location = 0) in vec3 aPos;                // fp32, or unorm16 inside the mesh bounds
+layout(location = 1) in vec2 aNormal;             // octahedral, snorm16
+layout(location = 2) in vec2 aTextureCoordinates; // half float
+layout(location = 3) in vec4 aTangent;            // octahedral snorm8 in xy, bitangent sign in z
+layout(location = 4) in vec4 aColor;              // unorm8
+layout(location = 5) in uvec4 aJoints;            // skinned meshes, uint16
+layout(location = 6) in vec4 aWeights;            // skinned meshes, unorm8 summing to 1
+
+// CPU skinned stream, replaces aPos with posed fp32 positions, see MeshBuffers::createCpuSkinnedArray
+layout(location = 7) in vec3 aSkinnedNormal;
+layout(location = 8) in vec4 aSkinnedTangent; // bitangent sign in w
 
 out vec2 textureCoordinates;
 out vec3 worldCoordinates;
@@ -16,15 +23,59 @@ uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
+
+// 0: static, 1: skinned here with the joint palette, 2: skinned on the CPU
+uniform int skinningMode;
+
+// see Animator::computeJointMatrices, MAX_MESH_BONES entries
+layout(std140) uniform JointMatrices
+{
+    mat4 joints[128];
+};
+
+vec3 decodeOctahedral(vec2 e)
+{
+    vec3  n = vec3(e, 1.0f - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return normalize(n);
+}
+
 void main()
 {
-    worldCoordinates   = (model * vec4(aPos, 1.0f)).xyz;
-    gl_Position        = projection * view * model * vec4(aPos, 1.0f);
+    vec3  position      = aPos * positionScale + positionOffset;
+    vec3  objectNormal  = decodeOctahedral(aNormal);
+    vec3  objectTangent = decodeOctahedral(aTangent.xy);
+    float tangentSign   = aTangent.z < 0.0f ? -1.0f : 1.0f;
+
+    if (skinningMode == 1)
+    {
+        mat4 skin = joints[aJoints.x] * aWeights.x + joints[aJoints.y] * aWeights.y +
+                    joints[aJoints.z] * aWeights.z + joints[aJoints.w] * aWeights.w;
+        position      = (skin * vec4(position, 1.0f)).xyz;
+        objectNormal  = normalize(mat3(skin) * objectNormal);
+        objectTangent = normalize(mat3(skin) * objectTangent);
+    }
+    else if (skinningMode == 2)
+    {
+        position      = aPos;
+        objectNormal  = normalize(aSkinnedNormal);
+        objectTangent = normalize(aSkinnedTangent.xyz);
+        tangentSign   = aSkinnedTangent.w < 0.0f ? -1.0f : 1.0f;
+    }
+
+    vec3 objectBitangent = cross(objectNormal, objectTangent) * tangentSign;
+
+    worldCoordinates   = (model * vec4(position, 1.0f)).xyz;
+    gl_Position        = projection * view * model * vec4(position, 1.0f);
     textureCoordinates = aTextureCoordinates;
 
     mat3 normalMatrix = transpose(inverse(mat3(model)));
 
-    tangent   = normalize(normalMatrix * aTangent);
-    bitangent = normalize(normalMatrix * aBitangent);
-    normal    = normalize(normalMatrix * aNormal);
+    tangent   = normalize(normalMatrix * objectTangent);
+    bitangent = normalize(normalMatrix * objectBitangent);
+    normal    = normalize(normalMatrix * objectNormal);
 }
@@ -0,0 +1,120 @@
+#include "animation_sampler.h"
+#include <algorithm>
+#include <cmath>
+#include "glm/common.hpp"
+#include "glm/geometric.hpp"
+#include "glm/gtc/quaternion.hpp"
+#include "resource/datatype/model/node_hierarchy.h"
+
+namespace RealmEngine
+{
+    namespace
+    {
+        constexpr float MIN_SCALE = 1e-8f; // below this a column can't be normalized back into a rotation
+
+        // The keys around time and how far time is between them; a single key or a time outside the
+        // track returns the same key twice.
+        template<typename T>
+        void findKeys(const AnimationTrack<T>& track, float time, size_t& first, size_t& second, float& alpha)
+        {
+            const std::vector<float>& times = track.times;
+            alpha                           = 0.0f;
+            if (time <= times.front())
+            {
+                first = second = 0;
+                return;
+            }
+            if (time >= times.back())
+            {
+                first = second = times.size() - 1;
+                return;
+            }
+
+            second            = static_cast<size_t>(std::upper_bound(times.begin(), times.end(), time) - times.begin());
+            first             = second - 1;
+            const float range = times[second] - times[first];
+            alpha             = range > 0.0f ? (time - times[first]) / range : 0.0f;
+        }
+    } // namespace
+
+    glm::mat4 NodeTransform::toMatrix() const
+    {
+        glm::mat4 matrix = glm::mat4_cast(rotation);
+        matrix[0]        = matrix[0] * scale.x;
+        matrix[1]        = matrix[1] * scale.y;
+        matrix[2]        = matrix[2] * scale.z;
+        matrix[3]        = glm::vec4(translation, 1.0f);
+        return matrix;
+    }
+
+    NodeTransform NodeTransform::fromMatrix(const glm::mat4& matrix)
+    {
+        NodeTransform transform;
+        transform.translation = glm::vec3(matrix[3]);
+
+        glm::vec3 axes[3] = {glm::vec3(matrix[0]), glm::vec3(matrix[1]), glm::vec3(matrix[2])};
+        for (int i = 0; i < 3; ++i)
+            transform.scale[i] = std::max(glm::length(axes[i]), MIN_SCALE);
+        if (glm::dot(glm::cross(axes[0], axes[1]), axes[2]) < 0.0f)
+            transform.scale.x = -transform.scale.x;
+
+        const glm::mat3 rotation(axes[0] / transform.scale.x, axes[1] / transform.scale.y, axes[2] / transform.scale.z);
+        transform.rotation = glm::normalize(glm::quat_cast(rotation));
+        return transform;
+    }
+
+    std::vector<NodeTransform> AnimationSampler::decomposeRestPose(const NodeHierarchy& hierarchy)
+    {
+        std::vector<NodeTransform> rest(hierarchy.getNodeCount());
+        for (size_t i = 0; i < rest.size(); ++i)
+            rest[i] = NodeTransform::fromMatrix(hierarchy.getLocalTransform(i));
+        return rest;
+    }
+
+    void AnimationSampler::sample(const Animation&                  animation,
+                                  float                             time,
+                                  const std::vector<NodeTransform>& rest,
+                                  NodeHierarchy&                    pose)
+    {
+        for (const auto& channel : animation.getChannels())
+        {
+            if (channel.node >= pose.getNodeCount() || channel.node >= rest.size())
+                continue;
+
+            const NodeTransform& fallback = rest[channel.node];
+            NodeTransform        transform;
+            transform.translation = sampleTrack(channel.translations, time, fallback.translation);
+            transform.rotation    = sampleTrack(channel.rotations, time, fallback.rotation);
+            transform.scale       = sampleTrack(channel.scales, time, fallback.scale);
+            pose.setLocalTransform(channel.node, transform.toMatrix());
+        }
+    }
+
+    glm::vec3 AnimationSampler::sampleTrack(const AnimationTrack<glm::vec3>& track,
+                                            float                            time,
+                                            const glm::vec3&                 fallback)
+    {
+        if (track.empty())
+            return fallback;
+
+        size_t first, second;
+        float  alpha;
+        findKeys(track, time, first, second, alpha);
+        return glm::mix(track.values[first], track.values[second], alpha);
+    }
+
+    glm::quat AnimationSampler::sampleTrack(const AnimationTrack<glm::quat>& track,
+                                            float                            time,
+                                            const glm::quat&                 fallback)
+    {
+        if (track.empty())
+            return fallback;
+
+        size_t first, second;
+        float  alpha;
+        findKeys(track, time, first, second, alpha);
+        if (first == second)
+            return track.values[first];
+        return glm::normalize(glm::slerp(track.values[first], track.values[second], alpha));
+    }
+} // namespace RealmEngine
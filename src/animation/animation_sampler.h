@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include "glm/ext/matrix_float4x4.hpp"
+#include "glm/ext/quaternion_float.hpp"
+#include "glm/ext/vector_float3.hpp"
+#include "resource/datatype/model/animation.h"
+
+namespace RealmEngine
+{
+    class NodeHierarchy;
+
+    // A node's local transform split into the parts animation channels drive.
+    struct NodeTransform
+    {
+        glm::vec3 translation {0.0f};
+        glm::quat rotation {1.0f, 0.0f, 0.0f, 0.0f};
+        glm::vec3 scale {1.0f};
+
+        // T * R * S
+        glm::mat4 toMatrix() const;
+        // Assumes no shear; a mirroring matrix ends up with a negative x scale.
+        static NodeTransform fromMatrix(const glm::mat4& matrix);
+    };
+
+    /**
+     * Evaluates animation clips into local node transforms.
+     *
+     * Keys are found by binary search, translations and scales are interpolated linearly and rotations along the
+     * shortest arc. Times outside a track hold its first or last key, and a node without a track for a part
+     * keeps that part of its rest transform, so partial clips don't collapse the nodes they leave out.
+     */
+    class AnimationSampler
+    {
+    public:
+        // The decomposed local transform of every node in hierarchy, the fallback for missing tracks.
+        static std::vector<NodeTransform> decomposeRestPose(const NodeHierarchy& hierarchy);
+
+        // Writes the local transform at time (seconds) of every node animation drives into pose.
+        // World transforms are left for pose.updateWorldTransforms().
+        static void sample(const Animation&                  animation,
+                           float                             time,
+                           const std::vector<NodeTransform>& rest,
+                           NodeHierarchy&                    pose);
+
+        static glm::vec3 sampleTrack(const AnimationTrack<glm::vec3>& track, float time, const glm::vec3& fallback);
+        static glm::quat sampleTrack(const AnimationTrack<glm::quat>& track, float time, const glm::quat& fallback);
+    };
+} // namespace RealmEngine
@@ -0,0 +1,100 @@
+#include "animator.h"
+#include <cmath>
+#include "glm/matrix.hpp"
+#include "resource/datatype/model/mesh.h"
+#include "resource/datatype/model/model.h"
+
+namespace RealmEngine
+{
+    Animator::Animator(const Model& model) :
+        m_model(&model), m_pose(model.getHierarchy()), m_rest(AnimationSampler::decomposeRestPose(m_pose))
+    {}
+
+    bool Animator::play(const std::string& name, bool loop)
+    {
+        if (name.empty())
+            return play(static_cast<size_t>(0), loop);
+
+        for (size_t i = 0; i < m_model->getAnimationCount(); ++i)
+        {
+            if (m_model->getAnimation(i).getName() == name)
+                return play(i, loop);
+        }
+        return false;
+    }
+
+    bool Animator::play(size_t clip, bool loop)
+    {
+        if (clip >= m_model->getAnimationCount())
+            return false;
+
+        m_clip    = clip;
+        m_loop    = loop;
+        m_playing = true;
+        setTime(0.0f);
+        return true;
+    }
+
+    const std::string& Animator::getClipName() const
+    {
+        static const std::string none;
+        return m_clip < m_model->getAnimationCount() ? m_model->getAnimation(m_clip).getName() : none;
+    }
+
+    void Animator::setTime(float time)
+    {
+        m_time  = time;
+        m_posed = false;
+    }
+
+    bool Animator::update(float delta_time)
+    {
+        const bool has_clip = m_clip < m_model->getAnimationCount();
+        if (!has_clip || (!m_playing && m_posed))
+        {
+            // nothing to sample, the rest or held pose is already in the hierarchy
+            const bool first = !m_posed;
+            m_posed          = true;
+            return first;
+        }
+
+        const Animation& animation = m_model->getAnimation(m_clip);
+        const float      duration  = animation.getDuration();
+        if (m_playing && m_posed)
+        {
+            m_time += delta_time * m_speed;
+            if (duration <= 0.0f)
+            {
+                m_time = 0.0f;
+            }
+            else if (m_loop)
+            {
+                m_time = std::fmod(m_time, duration);
+                if (m_time < 0.0f)
+                    m_time += duration;
+            }
+            else if (m_time >= duration || m_time <= 0.0f)
+            {
+                // a one shot clip holds its last (or, played backwards, first) frame
+                m_time    = m_time >= duration ? duration : 0.0f;
+                m_playing = false;
+            }
+        }
+
+        AnimationSampler::sample(animation, m_time, m_rest, m_pose);
+        m_pose.updateWorldTransforms();
+        m_posed = true;
+        return true;
+    }
+
+    void Animator::computeJointMatrices(const Mesh& mesh, std::vector<glm::mat4>& joints) const
+    {
+        const std::vector<Bone>& bones = mesh.getBones();
+        joints.resize(bones.size());
+
+        // bones are posed in model space; the renderer places the node the mesh hangs from on top
+        const glm::mat4 to_mesh = glm::inverse(m_pose.getWorldTransform(mesh.getSkinNode()));
+        for (size_t i = 0; i < bones.size(); ++i)
+            joints[i] = to_mesh * m_pose.getWorldTransform(bones[i].node) * bones[i].inverse_bind;
+    }
+} // namespace RealmEngine
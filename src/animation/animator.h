@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+#include "animation/animation_sampler.h"
+#include "glm/ext/matrix_float4x4.hpp"
+#include "resource/datatype/model/node_hierarchy.h"
+
+namespace RealmEngine
+{
+    class Mesh;
+    class Model;
+
+    /**
+     * Plays the animation clips of one Model on a private copy of its NodeHierarchy, so instances of the same
+     * model animate independently. update() and computeJointMatrices() only touch the animator's own state and
+     * the read-only Model, so many animators can run on worker threads at once.
+     * The Model must outlive the animator.
+     */
+    class Animator
+    {
+    public:
+        explicit Animator(const Model& model);
+        ~Animator() noexcept = default;
+
+        Animator(const Animator& that)            = delete;
+        Animator(Animator&& that)                 = delete;
+        Animator& operator=(const Animator& that) = delete;
+        Animator& operator=(Animator&& that)      = delete;
+
+        // An empty name plays the first clip. Returns false, and keeps the current clip, if there is no such clip.
+        bool play(const std::string& name, bool loop = true);
+        bool play(size_t clip, bool loop = true);
+        // Freezes the pose where it is.
+        void stop() { m_playing = false; }
+
+        bool               isPlaying() const { return m_playing; }
+        // empty before the first play()
+        const std::string& getClipName() const;
+        bool               isLooping() const { return m_loop; }
+
+        // seconds into the current clip
+        float getTime() const { return m_time; }
+        void  setTime(float time);
+        float getSpeed() const { return m_speed; }
+        void  setSpeed(float speed) { m_speed = speed; }
+
+        // Advances the clip by delta_time seconds and poses the hierarchy. Returns true when the pose changed.
+        bool update(float delta_time);
+
+        /**
+         * The skinning palette of mesh in the pose of the last update(): for each bone, the transform from the
+         * mesh's bind space to its current position, relative to the node the mesh hangs from, so that node's
+         * posed world transform and the entity's model matrix still apply on top. Resizes joints to the mesh's
+         * bone count.
+         */
+        void computeJointMatrices(const Mesh& mesh, std::vector<glm::mat4>& joints) const;
+
+        const NodeHierarchy& getPose() const { return m_pose; }
+
+    private:
+        const Model*               m_model;
+        NodeHierarchy              m_pose;
+        std::vector<NodeTransform> m_rest;
+        size_t                     m_clip {std::numeric_limits<size_t>::max()}; // none until play()
+        float                      m_time {0.0f};
+        float                      m_speed {1.0f};
+        bool                       m_loop {true};
+        bool                       m_playing {false};
+        bool                       m_posed {false}; // false until the first update, or after a seek
+    };
+} // namespace RealmEngine
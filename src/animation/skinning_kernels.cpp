@@ -0,0 +1,232 @@
+#include "skinning_kernels.h"
+#include <functional>
+#include "glm/geometric.hpp"
+#include "resource/datatype/model/mesh.h"
+#include "resource/processor/mesh_kernels.h"
+#include "resource/processor/simd_target.h"
+#include "thread_pool.h"
+
+namespace RealmEngine
+{
+    namespace
+    {
+        using SimdLevel = MeshKernels::SimdLevel;
+
+        constexpr size_t VERTEX_GRAIN = 4096;
+
+        // ===== Scalar reference =====
+        // Sums run left to right, the order the SIMD paths use.
+
+        void skinScalar(const SkinnedVertex* bind,
+                        const SkinInfluence* influences,
+                        const glm::mat4*     joints,
+                        SkinnedVertex*       out,
+                        size_t               begin,
+                        size_t               end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const SkinInfluence& influence = influences[i];
+                const float*         j[4];
+                for (int k = 0; k < 4; ++k)
+                    j[k] = &joints[influence.joints[k]][0][0];
+
+                float m[16];
+                for (int e = 0; e < 16; ++e)
+                    m[e] = j[0][e] * influence.weights[0] + j[1][e] * influence.weights[1] +
+                           j[2][e] * influence.weights[2] + j[3][e] * influence.weights[3];
+
+                const glm::vec4& p = bind[i].position;
+                const glm::vec4& n = bind[i].normal;
+                const glm::vec4& t = bind[i].tangent;
+                for (int r = 0; r < 4; ++r)
+                {
+                    out[i].position[r] = m[r] * p.x + m[4 + r] * p.y + m[8 + r] * p.z + m[12 + r];
+                    out[i].normal[r]   = m[r] * n.x + m[4 + r] * n.y + m[8 + r] * n.z;
+                    out[i].tangent[r]  = m[r] * t.x + m[4 + r] * t.y + m[8 + r] * t.z;
+                }
+                out[i].tangent.w = t.w;
+            }
+        }
+
+#if defined(REALM_KERNELS_X86)
+        // ===== SSE2 (x86-64 baseline), one vertex, one matrix column per register =====
+
+        // c[0] * v.x + c[1] * v.y + c[2] * v.z
+        inline __m128 transform(const __m128* c, __m128 v)
+        {
+            __m128 r = _mm_mul_ps(c[0], _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+            r        = _mm_add_ps(r, _mm_mul_ps(c[1], _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+            r        = _mm_add_ps(r, _mm_mul_ps(c[2], _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+            return r;
+        }
+
+        void skinSse2(const SkinnedVertex* bind,
+                      const SkinInfluence* influences,
+                      const glm::mat4*     joints,
+                      SkinnedVertex*       out,
+                      size_t               begin,
+                      size_t               end)
+        {
+            const __m128 xyz_mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+
+            for (size_t i = begin; i < end; ++i)
+            {
+                const SkinInfluence& influence = influences[i];
+                const __m128         weights   = _mm_loadu_ps(influence.weights);
+                const __m128         w[4]      = {_mm_shuffle_ps(weights, weights, _MM_SHUFFLE(0, 0, 0, 0)),
+                                                  _mm_shuffle_ps(weights, weights, _MM_SHUFFLE(1, 1, 1, 1)),
+                                                  _mm_shuffle_ps(weights, weights, _MM_SHUFFLE(2, 2, 2, 2)),
+                                                  _mm_shuffle_ps(weights, weights, _MM_SHUFFLE(3, 3, 3, 3))};
+
+                __m128 c[4];
+                for (int col = 0; col < 4; ++col)
+                {
+                    c[col] = _mm_mul_ps(_mm_loadu_ps(&joints[influence.joints[0]][col][0]), w[0]);
+                    for (int k = 1; k < 4; ++k)
+                    {
+                        const __m128 column = _mm_loadu_ps(&joints[influence.joints[k]][col][0]);
+                        c[col]              = _mm_add_ps(c[col], _mm_mul_ps(column, w[k]));
+                    }
+                }
+
+                const __m128 t        = _mm_loadu_ps(&bind[i].tangent.x);
+                const __m128 position = _mm_add_ps(transform(c, _mm_loadu_ps(&bind[i].position.x)), c[3]);
+                const __m128 normal   = transform(c, _mm_loadu_ps(&bind[i].normal.x));
+                const __m128 tangent  = _mm_or_ps(_mm_and_ps(transform(c, t), xyz_mask), _mm_andnot_ps(xyz_mask, t));
+
+                _mm_storeu_ps(&out[i].position.x, position);
+                _mm_storeu_ps(&out[i].normal.x, normal);
+                _mm_storeu_ps(&out[i].tangent.x, tangent);
+            }
+        }
+
+        // ===== AVX2, two vertices, one per 128-bit half =====
+
+        REALM_TARGET_AVX2 inline __m256 loadPair(const float* low, const float* high)
+        {
+            return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(low)), _mm_loadu_ps(high), 1);
+        }
+
+        REALM_TARGET_AVX2 inline void storePair(float* low, float* high, __m256 v)
+        {
+            _mm_storeu_ps(low, _mm256_castps256_ps128(v));
+            _mm_storeu_ps(high, _mm256_extractf128_ps(v, 1));
+        }
+
+        REALM_TARGET_AVX2 inline __m256 transformPair(const __m256* c, __m256 v)
+        {
+            __m256 r = _mm256_mul_ps(c[0], _mm256_permute_ps(v, _MM_SHUFFLE(0, 0, 0, 0)));
+            r        = _mm256_add_ps(r, _mm256_mul_ps(c[1], _mm256_permute_ps(v, _MM_SHUFFLE(1, 1, 1, 1))));
+            r        = _mm256_add_ps(r, _mm256_mul_ps(c[2], _mm256_permute_ps(v, _MM_SHUFFLE(2, 2, 2, 2))));
+            return r;
+        }
+
+        REALM_TARGET_AVX2 void skinAvx2(const SkinnedVertex* bind,
+                                        const SkinInfluence* influences,
+                                        const glm::mat4*     joints,
+                                        SkinnedVertex*       out,
+                                        size_t               begin,
+                                        size_t               end)
+        {
+            const __m256 xyz_mask = _mm256_castsi256_ps(_mm256_setr_epi32(-1, -1, -1, 0, -1, -1, -1, 0));
+
+            size_t i = begin;
+            for (; i + 2 <= end; i += 2)
+            {
+                const SkinInfluence& a       = influences[i];
+                const SkinInfluence& b       = influences[i + 1];
+                const __m256         weights = loadPair(a.weights, b.weights);
+                const __m256         w[4]    = {_mm256_permute_ps(weights, _MM_SHUFFLE(0, 0, 0, 0)),
+                                                _mm256_permute_ps(weights, _MM_SHUFFLE(1, 1, 1, 1)),
+                                                _mm256_permute_ps(weights, _MM_SHUFFLE(2, 2, 2, 2)),
+                                                _mm256_permute_ps(weights, _MM_SHUFFLE(3, 3, 3, 3))};
+
+                __m256 c[4];
+                for (int col = 0; col < 4; ++col)
+                {
+                    c[col] = _mm256_mul_ps(loadPair(&joints[a.joints[0]][col][0], &joints[b.joints[0]][col][0]), w[0]);
+                    for (int k = 1; k < 4; ++k)
+                    {
+                        const __m256 column = loadPair(&joints[a.joints[k]][col][0], &joints[b.joints[k]][col][0]);
+                        c[col]              = _mm256_add_ps(c[col], _mm256_mul_ps(column, w[k]));
+                    }
+                }
+
+                const __m256 t        = loadPair(&bind[i].tangent.x, &bind[i + 1].tangent.x);
+                const __m256 position = _mm256_add_ps(
+                    transformPair(c, loadPair(&bind[i].position.x, &bind[i + 1].position.x)), c[3]);
+                const __m256 normal  = transformPair(c, loadPair(&bind[i].normal.x, &bind[i + 1].normal.x));
+                const __m256 tangent = _mm256_or_ps(_mm256_and_ps(transformPair(c, t), xyz_mask),
+                                                    _mm256_andnot_ps(xyz_mask, t));
+
+                storePair(&out[i].position.x, &out[i + 1].position.x, position);
+                storePair(&out[i].normal.x, &out[i + 1].normal.x, normal);
+                storePair(&out[i].tangent.x, &out[i + 1].tangent.x, tangent);
+            }
+            skinSse2(bind, influences, joints, out, i, end);
+        }
+#endif
+
+        void skinRange(SimdLevel            level,
+                       const SkinnedVertex* bind,
+                       const SkinInfluence* influences,
+                       const glm::mat4*     joints,
+                       SkinnedVertex*       out,
+                       size_t               begin,
+                       size_t               end)
+        {
+#if defined(REALM_KERNELS_X86)
+            if (level == SimdLevel::AVX2)
+                return skinAvx2(bind, influences, joints, out, begin, end);
+            if (level == SimdLevel::SSE2)
+                return skinSse2(bind, influences, joints, out, begin, end);
+#endif
+            skinScalar(bind, influences, joints, out, begin, end);
+        }
+    } // namespace
+
+    void SkinningKernels::extractBindPose(const Mesh&                 mesh,
+                                          std::vector<SkinnedVertex>& vertices,
+                                          std::vector<SkinInfluence>& influences)
+    {
+        const std::vector<Vertex>& source     = mesh.getVertices();
+        const size_t               bone_count = mesh.getBones().size();
+        vertices.resize(source.size());
+        influences.resize(source.size());
+
+        for (size_t i = 0; i < source.size(); ++i)
+        {
+            const Vertex& vert = source[i];
+            const float   sign = glm::dot(glm::cross(vert.normal, vert.tangent), vert.bitangent) < 0.0f ? -1.0f : 1.0f;
+            vertices[i].position = glm::vec4(vert.position, 1.0f);
+            vertices[i].normal   = glm::vec4(vert.normal, 0.0f);
+            vertices[i].tangent  = glm::vec4(vert.tangent, sign);
+
+            for (int k = 0; k < 4; ++k)
+            {
+                const bool valid         = vert.joints[k] < bone_count;
+                influences[i].joints[k]  = valid ? vert.joints[k] : 0;
+                influences[i].weights[k] = valid ? vert.weights[k] : 0.0f;
+            }
+        }
+    }
+
+    void SkinningKernels::skin(const SkinnedVertex* bind,
+                               const SkinInfluence* influences,
+                               size_t               count,
+                               const glm::mat4*     joints,
+                               SkinnedVertex*       out,
+                               ThreadPool*          pool)
+    {
+        const SimdLevel level = MeshKernels::getSimdLevel();
+        auto            body  = [&](size_t begin, size_t end) {
+            skinRange(level, bind, influences, joints, out, begin, end);
+        };
+
+        if (pool && count > VERTEX_GRAIN)
+            pool->parallelFor(0, count, VERTEX_GRAIN, body);
+        else if (count > 0)
+            body(0, count);
+    }
+} // namespace RealmEngine
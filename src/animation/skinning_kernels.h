@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "glm/ext/matrix_float4x4.hpp"
+#include "glm/ext/vector_float4.hpp"
+
+namespace RealmEngine
+{
+    class Mesh;
+    class ThreadPool;
+
+    // Vertex the skinning kernels read (bind pose) and write (posed), also the layout of the CPU skinned stream.
+    struct SkinnedVertex
+    {
+        glm::vec4 position; // w is 1
+        glm::vec4 normal;   // w is 0
+        glm::vec4 tangent;  // w is the bitangent sign, copied through
+    };
+    static_assert(sizeof(SkinnedVertex) == 48, "SkinnedVertex must stay tightly packed");
+
+    struct SkinInfluence
+    {
+        uint32_t joints[4];
+        float    weights[4];
+    };
+
+    /**
+     * CPU linear blend skinning.
+     *
+     * Each vertex blends its 4 joint matrices by weight and transforms its position, normal and tangent with the
+     * blended matrix. SSE2 does one vertex per iteration with a matrix column per register, AVX2 (when the CPU
+     * supports it) two, one per 128-bit half. The arithmetic is done in the same order on every path, so all of
+     * them give the same result bit for bit. The SIMD level is the one selected through MeshKernels.
+     */
+    class SkinningKernels
+    {
+    public:
+        // The bind pose of a skinned mesh in kernel layout. Joints past the mesh's bones get no weight.
+        static void extractBindPose(const Mesh&                 mesh,
+                                    std::vector<SkinnedVertex>& vertices,
+                                    std::vector<SkinInfluence>& influences);
+
+        // out[i] = bind[i] transformed by the weighted sum of its joint matrices. Ranges of vertices are split
+        // over the pool when one is given.
+        static void skin(const SkinnedVertex* bind,
+                         const SkinInfluence* influences,
+                         size_t               count,
+                         const glm::mat4*     joints,
+                         SkinnedVertex*       out,
+                         ThreadPool*          pool = nullptr);
+    };
+} // namespace RealmEngine
@@ -1,9 +1,13 @@
 #include "config_manager.h"
 
 #include "plateform/plateform.h"
+#include "resource/cache/asset_cache.h"
 #include "utils.h"
 
+#include <cstdlib>
 #include <filesystem>
+#include <stdexcept>
+#include <string>
 
 namespace RealmEngine
 {
@@ -14,12 +18,33 @@ namespace RealmEngine
 
         m_asset_folder  = m_root_folder / "assets";
         m_shader_folder = m_root_folder / "shaders";
+        m_cache_folder  = m_root_folder / "cache";
+
+        m_cache_size_limit = AssetCache::DEFAULT_SIZE_LIMIT;
+        if (const char* cache_dir = std::getenv("REALM_CACHE_DIR"); cache_dir && *cache_dir)
+            m_cache_folder = cache_dir;
+        if (const char* cache_size = std::getenv("REALM_CACHE_SIZE_MB"); cache_size && *cache_size)
+        {
+            try
+            {
+                m_cache_size_limit = std::stoull(cache_size) << 20;
+            }
+            catch (const std::exception&)
+            {
+                warn("Ignoring invalid REALM_CACHE_SIZE_MB: " + std::string(cache_size));
+            }
+        }
 
         if (!std::filesystem::exists(m_asset_folder))
             fatal("Assets folder not found: " + m_asset_folder.string());
         if (!std::filesystem::exists(m_shader_folder))
             fatal("Shaders folder not found: " + m_shader_folder.string());
 
+        std::error_code ec;
+        std::filesystem::create_directories(m_cache_folder, ec);
+        if (ec)
+            warn("Failed to create cache folder: " + m_cache_folder.string() + " - " + ec.message());
+
         info("Config manager initialized.");
     }
 
@@ -31,4 +56,8 @@ namespace RealmEngine
 
     const std::filesystem::path& ConfigManager::getShaderFolder() const { return m_shader_folder; }
 
+    const std::filesystem::path& ConfigManager::getCacheFolder() const { return m_cache_folder; }
+
+    uint64_t ConfigManager::getCacheSizeLimit() const { return m_cache_size_limit; }
+
 } // namespace RealmEngine
\ No newline at end of file
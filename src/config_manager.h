@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
 
 namespace RealmEngine
@@ -21,10 +22,16 @@ namespace RealmEngine
         const std::filesystem::path& getRootFolder() const;
         const std::filesystem::path& getAssetFolder() const;
         const std::filesystem::path& getShaderFolder() const;
+        // REALM_CACHE_DIR points every checkout (and build farm machine) at one shared cache, <root>/cache otherwise
+        const std::filesystem::path& getCacheFolder() const;
+        // REALM_CACHE_SIZE_MB overrides the default limit, 0 for none
+        uint64_t                     getCacheSizeLimit() const;
 
     private:
         std::filesystem::path m_root_folder;
         std::filesystem::path m_asset_folder;
         std::filesystem::path m_shader_folder;
+        std::filesystem::path m_cache_folder;
+        uint64_t              m_cache_size_limit {0};
     };
 } // namespace RealmEngine
\ No newline at end of file
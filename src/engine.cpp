@@ -5,14 +5,17 @@
 #include <glm/glm.hpp>
 #include <memory>
 #include <string>
+#include <utility>
 #include "config_manager.h"
 #include "gameplay/scene.h"
 #include "global_context.h"
+#include "hot_reloader.h"
 #include "input.h"
 #include "render/render_entity.h"
 #include "render/render_object.h"
 #include "render/render_scene.h"
 #include "render/renderer.h"
+#include "resource/asset_manager.h"
 #include "utils.h"
 #include "window.h"
 
@@ -39,17 +42,25 @@ namespace RealmEngine
         m_render_scene = render_scene;
 
         std::string model_path = g_context.m_config->getAssetFolder().generic_string() + "/helmet/DamagedHelmet.gltf";
+        std::shared_ptr<ModelStream> helmet_stream;
         try
         {
+            // streamed, so the first meshes show up while the rest is still importing
+            ModelStreamCallbacks callbacks;
+            callbacks.on_complete = [model_path](const ModelHandle& model) {
+                if (model)
+                    info("Helmet model streamed in: " + model_path);
+            };
+            helmet_stream = g_context.m_assets->loadModelProgressive(model_path, {}, std::move(callbacks));
+
             // Don't flip textures for glTF
-            auto model  = std::make_shared<RenderObject>(model_path, false);
+            auto model  = std::make_shared<RenderObject>(helmet_stream, false);
             auto entity = RenderEntity(model);
             entity.setPosition(glm::vec3(0.0f, 0.0f, 0.0f));
             entity.setScale(glm::vec3(1.0f, 1.0f, 1.0f));
-
-            entity.setOrientation(glm::angleAxis(1.5708f, glm::vec3(1.0f, 0.0f, 0.0f)));
+            // the helmet's node already stands it upright
             render_scene->m_entities.push_back(entity);
-            info("Successfully loaded helmet model: " + model_path);
+            info("Streaming helmet model: " + model_path);
         }
         catch (const std::exception& e)
         {
@@ -70,13 +81,37 @@ namespace RealmEngine
 
         info("Starting render loop for helmet model...");
 
+        bool textures_reported = false;
         while (!g_context.m_window->shouldClose())
         {
             tick();
             frame_count++;
 
+            // per texture memory once the helmet is in and the textures its materials requested have loaded; the
+            // loader is also idle before the first request
+            if (!textures_reported && helmet_stream && helmet_stream->isComplete() &&
+                g_context.m_renderer->getTextureRegistry().getStats().textures > 0 &&
+                g_context.m_renderer->getTextureLoader().isIdle())
+            {
+                g_context.m_renderer->getTextureRegistry().logMemoryUsage();
+                textures_reported = true;
+            }
+
             if (frame_count % 60 == 0)
-                debug("Rendered " + std::to_string(frame_count) + " frames");
+            {
+                const RenderStats&    stats     = g_context.m_renderer->getStats();
+                const AnimationStats& animation = g_context.m_renderer->getAnimationStats();
+                TextureRegistryStats  textures  = g_context.m_renderer->getTextureRegistry().getStats();
+                debug("Rendered " + std::to_string(frame_count) + " frames - Entities visible/culled: " +
+                      std::to_string(stats.visible_entities) + "/" + std::to_string(stats.culled_entities) +
+                      ", Meshes visible/culled: " + std::to_string(stats.visible_meshes) + "/" +
+                      std::to_string(stats.culled_meshes) + ", LOD meshes: " + std::to_string(stats.lod_meshes) +
+                      ", Triangles: " + std::to_string(stats.triangles) + ", Textures: " +
+                      std::to_string(textures.resident) + "/" + std::to_string(textures.textures) + " resident, " +
+                      std::to_string(textures.gpu_bytes >> 10) + " KB, Animated objects: " +
+                      std::to_string(animation.animated_objects) + " (" + std::to_string(animation.skinned_meshes) +
+                      " skinned meshes) in " + std::to_string(animation.update_ms) + " ms");
+            }
         }
 
         debug("Render loop completed. Total frames: " + std::to_string(frame_count));
@@ -106,7 +141,14 @@ namespace RealmEngine
             m_delta_time = 0.1f;
 
         logicalTick(m_scene);
+
+        // edited shaders, textures and models, swapped in before this frame is drawn
+        g_context.m_hot_reloader->tick();
+
         renderTick(m_render_scene);
+
+        // reclaim models released during this frame if we are over budget
+        g_context.m_assets->trimModelMemory();
     }
 
     void Engine::logicalTick(std::shared_ptr<Scene> scene) const
@@ -130,6 +172,8 @@ namespace RealmEngine
             return;
         }
 
+        // poses and skins are computed on the thread pool, then uploaded before the frame draws them
+        g_context.m_renderer->updateAnimations(scene, static_cast<float>(m_delta_time));
         g_context.m_renderer->render(scene);
         g_context.m_window->swapBuffer();
     }
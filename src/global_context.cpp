@@ -1,10 +1,12 @@
 #include "global_context.h"
 
 #include "config_manager.h"
+#include "hot_reloader.h"
 #include "input.h"
 #include "logger.h"
 #include "render/renderer.h"
 #include "resource/asset_manager.h"
+#include "thread_pool.h"
 #include "window.h"
 
 #include <memory>
@@ -21,6 +23,9 @@ namespace RealmEngine
         m_config = std::make_shared<ConfigManager>();
         m_config->initialize();
 
+        m_thread_pool = std::make_shared<ThreadPool>();
+        m_thread_pool->initialize();
+
         m_assets = std::make_shared<AssetManager>();
         m_assets->initialize();
 
@@ -32,10 +37,16 @@ namespace RealmEngine
 
         m_input = std::make_shared<Input>();
         m_input->initialize();
+
+        m_hot_reloader = std::make_shared<HotReloader>();
+        m_hot_reloader->initialize();
     }
 
     void GlobalContext::destroy()
     {
+        m_hot_reloader->disposal();
+        m_hot_reloader.reset();
+
         m_input->disposal();
         m_input.reset();
 
@@ -48,6 +59,9 @@ namespace RealmEngine
         m_assets->disposal();
         m_assets.reset();
 
+        m_thread_pool->disposal();
+        m_thread_pool.reset();
+
         m_config->disposal();
         m_config.reset();
 
@@ -6,10 +6,12 @@ namespace RealmEngine
 {
     class Logger;
     class ConfigManager;
+    class ThreadPool;
     class AssetManager;
     class Window;
     class Renderer;
     class Input;
+    class HotReloader;
 
     class GlobalContext
     {
@@ -27,10 +29,12 @@ namespace RealmEngine
 
         std::shared_ptr<Logger>        m_logger;
         std::shared_ptr<ConfigManager> m_config;
+        std::shared_ptr<ThreadPool>    m_thread_pool;
         std::shared_ptr<AssetManager>  m_assets;
         std::shared_ptr<Window>        m_window;
         std::shared_ptr<Renderer>      m_renderer;
         std::shared_ptr<Input>         m_input;
+        std::shared_ptr<HotReloader>   m_hot_reloader;
     };
 
     extern GlobalContext g_context;
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace RealmEngine
+{
+    // 64-bit xxHash (XXH64). Fast enough to hash whole source assets when keying cooked data.
+    namespace Hash
+    {
+        namespace detail
+        {
+            constexpr uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+            constexpr uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+            constexpr uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+            constexpr uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+            constexpr uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+            constexpr uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+            inline uint64_t read64(const uint8_t* p)
+            {
+                uint64_t v;
+                std::memcpy(&v, p, sizeof(v));
+                return v;
+            }
+
+            inline uint32_t read32(const uint8_t* p)
+            {
+                uint32_t v;
+                std::memcpy(&v, p, sizeof(v));
+                return v;
+            }
+
+            constexpr uint64_t round(uint64_t acc, uint64_t input)
+            {
+                acc += input * PRIME64_2;
+                acc = rotl(acc, 31);
+                acc *= PRIME64_1;
+                return acc;
+            }
+
+            constexpr uint64_t mergeRound(uint64_t acc, uint64_t val)
+            {
+                val = round(0, val);
+                acc ^= val;
+                acc = acc * PRIME64_1 + PRIME64_4;
+                return acc;
+            }
+        } // namespace detail
+
+        inline uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0)
+        {
+            using namespace detail;
+
+            const uint8_t* p   = static_cast<const uint8_t*>(data);
+            const uint8_t* end = p + size;
+            uint64_t       h64;
+
+            if (size >= 32)
+            {
+                const uint8_t* limit = end - 32;
+                uint64_t       v1    = seed + PRIME64_1 + PRIME64_2;
+                uint64_t       v2    = seed + PRIME64_2;
+                uint64_t       v3    = seed;
+                uint64_t       v4    = seed - PRIME64_1;
+
+                do
+                {
+                    v1 = round(v1, read64(p));
+                    v2 = round(v2, read64(p + 8));
+                    v3 = round(v3, read64(p + 16));
+                    v4 = round(v4, read64(p + 24));
+                    p += 32;
+                } while (p <= limit);
+
+                h64 = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+                h64 = mergeRound(h64, v1);
+                h64 = mergeRound(h64, v2);
+                h64 = mergeRound(h64, v3);
+                h64 = mergeRound(h64, v4);
+            }
+            else
+            {
+                h64 = seed + PRIME64_5;
+            }
+
+            h64 += static_cast<uint64_t>(size);
+
+            while (p + 8 <= end)
+            {
+                h64 ^= round(0, read64(p));
+                h64 = rotl(h64, 27) * PRIME64_1 + PRIME64_4;
+                p += 8;
+            }
+
+            if (p + 4 <= end)
+            {
+                h64 ^= static_cast<uint64_t>(read32(p)) * PRIME64_1;
+                h64 = rotl(h64, 23) * PRIME64_2 + PRIME64_3;
+                p += 4;
+            }
+
+            while (p < end)
+            {
+                h64 ^= (*p) * PRIME64_5;
+                h64 = rotl(h64, 11) * PRIME64_1;
+                p++;
+            }
+
+            h64 ^= h64 >> 33;
+            h64 *= PRIME64_2;
+            h64 ^= h64 >> 29;
+            h64 *= PRIME64_3;
+            h64 ^= h64 >> 32;
+
+            return h64;
+        }
+
+        inline uint64_t hashString(const std::string& str, uint64_t seed = 0)
+        {
+            return hashBytes(str.data(), str.size(), seed);
+        }
+
+        // Order-dependent combination of two hashes.
+        constexpr uint64_t combine(uint64_t seed, uint64_t value)
+        {
+            return seed ^ (value + 0x9E3779B97F4A7C15ULL + (seed << 12) + (seed >> 4));
+        }
+
+        template<typename T>
+        inline uint64_t hashValue(const T& value, uint64_t seed = 0)
+        {
+            return hashBytes(&value, sizeof(T), seed);
+        }
+    } // namespace Hash
+} // namespace RealmEngine
@@ -0,0 +1,181 @@
+#include "hot_reloader.h"
+
+#include <algorithm>
+#include <cctype>
+#include <system_error>
+#include <utility>
+#include "config_manager.h"
+#include "global_context.h"
+#include "render/renderer.h"
+#include "resource/asset_manager.h"
+#include "utils.h"
+
+namespace RealmEngine
+{
+    namespace
+    {
+        std::string getLowerExtension(const std::filesystem::path& path)
+        {
+            std::string extension = path.extension().string();
+            std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) {
+                return static_cast<char>(std::tolower(c));
+            });
+            return extension;
+        }
+
+        bool isShaderFile(const std::string& extension)
+        {
+            return extension == ".vert" || extension == ".frag" || extension == ".glsl";
+        }
+
+        bool isTextureFile(const std::string& extension)
+        {
+            return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" ||
+                   extension == ".bmp" || extension == ".psd" || extension == ".gif";
+        }
+
+        bool isModelFile(const std::string& extension)
+        {
+            return extension == ".gltf" || extension == ".glb" || extension == ".obj" || extension == ".fbx" ||
+                   extension == ".dae" || extension == ".3ds" || extension == ".blend" || extension == ".ply";
+        }
+
+        bool isInsideFolder(const std::filesystem::path& path, const std::filesystem::path& folder)
+        {
+            if (folder.empty())
+                return false;
+            auto mismatch = std::mismatch(folder.begin(), folder.end(), path.begin(), path.end());
+            return mismatch.first == folder.end();
+        }
+
+        double millisecondsSince(std::chrono::steady_clock::time_point start)
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+    } // namespace
+
+    void HotReloader::initialize()
+    {
+        if (!m_watcher.initialize())
+            return;
+
+        const std::filesystem::path& asset_folder  = g_context.m_config->getAssetFolder();
+        const std::filesystem::path& shader_folder = g_context.m_config->getShaderFolder();
+
+        std::error_code ec;
+        m_shader_folder = std::filesystem::weakly_canonical(shader_folder, ec);
+
+        m_watcher.addDirectory(asset_folder);
+        m_watcher.addDirectory(shader_folder);
+
+        info("Hot reload watching " + asset_folder.generic_string() + " and " + shader_folder.generic_string());
+    }
+
+    void HotReloader::disposal()
+    {
+        // running imports are waited for by the asset manager
+        m_pending_models.clear();
+        m_watcher.disposal();
+    }
+
+    void HotReloader::tick()
+    {
+        swapReloadedModels();
+
+        if (!m_enabled || !m_watcher.isActive())
+            return;
+
+        for (const auto& path : m_watcher.poll())
+        {
+            const Clock::time_point changed   = Clock::now();
+            const std::string       extension = getLowerExtension(path);
+
+            if (isShaderFile(extension) && isInsideFolder(path, m_shader_folder))
+                reloadShader(path);
+            else if (isTextureFile(extension))
+                reloadTexture(path);
+            else
+                reloadModels(path, changed);
+        }
+    }
+
+    void HotReloader::reloadShader(const std::filesystem::path& path)
+    {
+        const Clock::time_point start    = Clock::now();
+        const size_t            reloaded = g_context.m_renderer->reloadShaders(path);
+        if (reloaded > 0)
+            info("Reloaded " + std::to_string(reloaded) + " shader program(s) using " + path.generic_string() +
+                 " in " + std::to_string(millisecondsSince(start)) + " ms");
+    }
+
+    void HotReloader::reloadTexture(const std::filesystem::path& path)
+    {
+        // uploaded by the loader within its per frame budget, like any other texture
+        const size_t reloaded = g_context.m_renderer->getTextureRegistry().reload(path.generic_string());
+        if (reloaded > 0)
+            info("Reloading " + std::to_string(reloaded) + " texture(s) from " + path.generic_string());
+    }
+
+    void HotReloader::reloadModels(const std::filesystem::path& path, Clock::time_point changed)
+    {
+        const std::string extension = getLowerExtension(path);
+        const bool        is_model  = isModelFile(extension);
+        // glTF geometry lives next to the .gltf in .bin buffers
+        const bool is_buffer = extension == ".bin";
+        if (!is_model && !is_buffer)
+            return;
+
+        for (const std::string& loaded : g_context.m_assets->getLoadedModelPaths())
+        {
+            std::error_code             ec;
+            const std::filesystem::path source = std::filesystem::weakly_canonical(loaded, ec);
+
+            const bool affected = is_model ? source == path :
+                                             source.parent_path() == path.parent_path() &&
+                                                 getLowerExtension(source) == ".gltf";
+            if (!affected)
+                continue;
+
+            // already re-importing; a save made during the import needs another save to be picked up
+            auto pending = std::find_if(m_pending_models.begin(), m_pending_models.end(), [&](const PendingModel& p) {
+                return p.path == loaded;
+            });
+            if (pending != m_pending_models.end())
+                continue;
+
+            PendingModel reload;
+            reload.path     = loaded;
+            reload.previous = g_context.m_assets->getModel(loaded);
+            reload.future   = g_context.m_assets->reloadModel(loaded);
+            reload.changed  = changed;
+            m_pending_models.push_back(std::move(reload));
+
+            debug("Re-importing model " + loaded);
+        }
+    }
+
+    void HotReloader::swapReloadedModels()
+    {
+        for (auto it = m_pending_models.begin(); it != m_pending_models.end();)
+        {
+            if (it->future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                ++it;
+                continue;
+            }
+
+            ModelHandle model = it->future.get();
+            if (!model)
+            {
+                warn("Re-import of " + it->path + " failed, keeping the previous model.");
+            }
+            else
+            {
+                const size_t replaced = g_context.m_renderer->replaceModel(it->previous.get(), model);
+                info("Reloaded model " + it->path + " in " + std::to_string(millisecondsSince(it->changed)) +
+                     " ms, " + std::to_string(replaced) + " render model(s) swapped");
+            }
+            it = m_pending_models.erase(it);
+        }
+    }
+} // namespace RealmEngine
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <string>
+#include <vector>
+#include "plateform/file_watcher.h"
+#include "resource/model_stream.h"
+
+namespace RealmEngine
+{
+    /**
+     * Applies edits to the asset and shader folders while the engine runs, without a restart.
+     *
+     * Shaders are recompiled into new programs right away. Textures are decoded again by the TextureLoader and
+     * swapped in place once uploaded. Models are re-imported on the thread pool by the AssetManager and swapped
+     * into their RenderModels between two frames, so a model is never drawn half replaced.
+     * Only Linux has a watcher; elsewhere tick() does nothing.
+     */
+    class HotReloader
+    {
+    public:
+        HotReloader()           = default;
+        ~HotReloader() noexcept = default;
+
+        HotReloader(const HotReloader& that)            = delete;
+        HotReloader(HotReloader&& that)                 = delete;
+        HotReloader& operator=(const HotReloader& that) = delete;
+        HotReloader& operator=(HotReloader&& that)      = delete;
+
+        void initialize();
+        void disposal();
+
+        // GL thread, once per frame before rendering.
+        void tick();
+
+        void setEnabled(bool enabled) { m_enabled = enabled; }
+        bool isEnabled() const { return m_enabled; }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct PendingModel
+        {
+            std::string                     path;
+            ModelHandle                     previous;
+            std::shared_future<ModelHandle> future;
+            Clock::time_point               changed;
+        };
+
+        void reloadShader(const std::filesystem::path& path);
+        void reloadTexture(const std::filesystem::path& path);
+        void reloadModels(const std::filesystem::path& path, Clock::time_point changed);
+        void swapReloadedModels();
+
+        FileWatcher               m_watcher;
+        std::filesystem::path     m_shader_folder;
+        std::vector<PendingModel> m_pending_models;
+        bool                      m_enabled {true};
+    };
+} // namespace RealmEngine
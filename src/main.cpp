@@ -1,7 +1,12 @@
 #include "engine.h"
+#include "tools/import_report.h"
 
-int main(int /*argc*/, char** /*argv*/)
+int main(int argc, char** argv)
 {
+    // command line tools run without a window
+    if (RealmEngine::ImportReport::isRequested(argc, argv))
+        return RealmEngine::ImportReport::run(argc, argv);
+
     RealmEngine::Engine engine;
 
     engine.boot();
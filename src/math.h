@@ -1,6 +1,9 @@
 #pragma once
 
+#include "glm/common.hpp"
+#include "glm/ext/matrix_float4x4.hpp"
 #include "glm/ext/vector_float3.hpp"
+#include "glm/ext/vector_float4.hpp"
 
 namespace RealmEngine
 {
@@ -11,6 +14,38 @@ namespace RealmEngine
 
         constexpr glm::vec3 center() const { return (min + max) * 0.5f; }
         constexpr glm::vec3 extent() const { return max - min; }
+
+        void merge(const AABB& other)
+        {
+            min = glm::min(min, other.min);
+            max = glm::max(max, other.max);
+        }
+
+        // Box enclosing this one after an affine transform (Arvo's method, no corner expansion).
+        AABB transform(const glm::mat4& mat) const
+        {
+            const glm::vec3 world_center = glm::vec3(mat * glm::vec4(center(), 1.0f));
+            const glm::vec3 half         = extent() * 0.5f;
+            const glm::vec3 world_half   = glm::abs(glm::vec3(mat[0])) * half.x +
+                                         glm::abs(glm::vec3(mat[1])) * half.y + glm::abs(glm::vec3(mat[2])) * half.z;
+
+            return AABB {world_center - world_half, world_center + world_half};
+        }
+    };
+
+    // A half-line; direction needn't be normalized, hit distances are then in multiples of it.
+    struct Ray
+    {
+        glm::vec3 origin;
+        glm::vec3 direction;
+
+        constexpr glm::vec3 at(float t) const { return origin + direction * t; }
+
+        // Same line in the space mat maps into, keeping the parameterisation (direction is not renormalized).
+        Ray transform(const glm::mat4& mat) const
+        {
+            return Ray {glm::vec3(mat * glm::vec4(origin, 1.0f)), glm::vec3(mat * glm::vec4(direction, 0.0f))};
+        }
     };
 
-} // namespace RealmEngine
\ No newline at end of file
+} // namespace RealmEngine
@@ -0,0 +1,153 @@
+#include "file_watcher.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <system_error>
+#include "utils.h"
+
+namespace RealmEngine
+{
+    FileWatcher::~FileWatcher() noexcept { disposal(); }
+
+    bool FileWatcher::initialize()
+    {
+#ifdef __linux__
+        if (m_fd >= 0)
+            return true;
+
+        m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_fd < 0)
+        {
+            warn("File watcher unavailable: inotify_init1 failed with errno " + std::to_string(errno));
+            return false;
+        }
+        return true;
+#else
+        warn("File watcher unavailable: only supported on Linux.");
+        return false;
+#endif
+    }
+
+    void FileWatcher::disposal()
+    {
+#ifdef __linux__
+        if (m_fd >= 0)
+            ::close(m_fd);
+#endif
+        m_fd = -1;
+        m_watches.clear();
+        m_changed.clear();
+    }
+
+    bool FileWatcher::addDirectory(const std::filesystem::path& directory)
+    {
+        if (m_fd < 0)
+            return false;
+
+        std::error_code       ec;
+        std::filesystem::path root = std::filesystem::canonical(directory, ec);
+        if (ec || !std::filesystem::is_directory(root, ec))
+        {
+            warn("File watcher: not a directory: " + directory.generic_string());
+            return false;
+        }
+
+        bool added = addWatch(root);
+        for (auto it = std::filesystem::recursive_directory_iterator(root, ec);
+             !ec && it != std::filesystem::recursive_directory_iterator();
+             it.increment(ec))
+        {
+            if (it->is_directory(ec))
+                added &= addWatch(it->path());
+        }
+        return added;
+    }
+
+    std::vector<std::filesystem::path> FileWatcher::poll()
+    {
+        std::vector<std::filesystem::path> changed;
+        if (m_fd < 0)
+            return changed;
+
+        readEvents();
+
+        const Clock::time_point now = Clock::now();
+        for (auto it = m_changed.begin(); it != m_changed.end();)
+        {
+            if (std::chrono::duration<double, std::milli>(now - it->second).count() < m_debounce_ms)
+            {
+                ++it;
+                continue;
+            }
+            changed.emplace_back(it->first);
+            it = m_changed.erase(it);
+        }
+        return changed;
+    }
+
+    bool FileWatcher::addWatch(const std::filesystem::path& directory)
+    {
+#ifdef __linux__
+        // editors either rewrite the file or rename a temporary over it
+        const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR;
+        const int      wd   = inotify_add_watch(m_fd, directory.c_str(), mask);
+        if (wd < 0)
+        {
+            warn("File watcher: cannot watch " + directory.generic_string() + ", errno " + std::to_string(errno));
+            return false;
+        }
+        m_watches[wd] = directory;
+        return true;
+#else
+        (void)directory;
+        return false;
+#endif
+    }
+
+    void FileWatcher::readEvents()
+    {
+#ifdef __linux__
+        alignas(inotify_event) char buffer[4096];
+        for (;;)
+        {
+            const ssize_t length = ::read(m_fd, buffer, sizeof(buffer));
+            if (length <= 0)
+                break;
+
+            for (ssize_t offset = 0; offset < length;)
+            {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+                // the directory was removed or unmounted
+                if (event->mask & IN_IGNORED)
+                {
+                    m_watches.erase(event->wd);
+                    continue;
+                }
+
+                auto watch = m_watches.find(event->wd);
+                if (watch == m_watches.end() || event->len == 0)
+                    continue;
+
+                std::filesystem::path path = watch->second / event->name;
+                if (event->mask & IN_ISDIR)
+                {
+                    // new folders are watched too, along with any folders already inside them
+                    if (event->mask & (IN_CREATE | IN_MOVED_TO))
+                        addDirectory(path);
+                    continue;
+                }
+
+                // a created file is reported by the IN_CLOSE_WRITE that follows
+                if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+                    m_changed[path.generic_string()] = Clock::now();
+            }
+        }
+#endif
+    }
+} // namespace RealmEngine
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace RealmEngine
+{
+    /**
+     * Reports files written under a set of directories, recursively, without blocking.
+     *
+     * Backed by inotify on Linux; elsewhere initialize() fails and nothing is ever reported. A file is reported
+     * once it has been quiet for the debounce delay, so an editor saving in several writes triggers one reload.
+     */
+    class FileWatcher
+    {
+    public:
+        FileWatcher() = default;
+        ~FileWatcher() noexcept;
+
+        FileWatcher(const FileWatcher& that)            = delete;
+        FileWatcher(FileWatcher&& that)                 = delete;
+        FileWatcher& operator=(const FileWatcher& that) = delete;
+        FileWatcher& operator=(FileWatcher&& that)      = delete;
+
+        bool initialize();
+        void disposal();
+        bool isActive() const { return m_fd >= 0; }
+
+        // Watches directory and every directory below it, including ones created later.
+        bool addDirectory(const std::filesystem::path& directory);
+
+        // Canonical paths of the files changed and quiet since the previous call.
+        std::vector<std::filesystem::path> poll();
+
+        void   setDebounce(double milliseconds) { m_debounce_ms = milliseconds; }
+        double getDebounce() const { return m_debounce_ms; }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        bool addWatch(const std::filesystem::path& directory);
+        void readEvents();
+
+        int                                                m_fd {-1};
+        std::unordered_map<int, std::filesystem::path>     m_watches;
+        std::unordered_map<std::string, Clock::time_point> m_changed; // path -> last write
+        double                                             m_debounce_ms {50.0};
+    };
+} // namespace RealmEngine
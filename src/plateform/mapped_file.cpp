@@ -0,0 +1,112 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <utility>
+
+namespace RealmEngine
+{
+    MappedFile::~MappedFile() noexcept { close(); }
+
+    MappedFile::MappedFile(MappedFile&& that) noexcept { *this = std::move(that); }
+
+    MappedFile& MappedFile::operator=(MappedFile&& that) noexcept
+    {
+        if (this != &that)
+        {
+            close();
+            std::swap(m_data, that.m_data);
+            std::swap(m_size, that.m_size);
+#ifdef _WIN32
+            std::swap(m_file_handle, that.m_file_handle);
+            std::swap(m_mapping_handle, that.m_mapping_handle);
+#endif
+        }
+        return *this;
+    }
+
+    bool MappedFile::open(const std::filesystem::path& path)
+    {
+        close();
+
+#ifdef _WIN32
+        HANDLE file = CreateFileW(
+            path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!view)
+        {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        m_file_handle    = file;
+        m_mapping_handle = mapping;
+        m_data           = static_cast<const uint8_t*>(view);
+        m_size           = static_cast<size_t>(file_size.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            ::close(fd);
+            return false;
+        }
+
+        void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        // the mapping keeps its own reference to the file
+        ::close(fd);
+        if (view == MAP_FAILED)
+            return false;
+
+        m_data = static_cast<const uint8_t*>(view);
+        m_size = static_cast<size_t>(st.st_size);
+#endif
+        return true;
+    }
+
+    void MappedFile::close() noexcept
+    {
+        if (!m_data)
+            return;
+
+#ifdef _WIN32
+        UnmapViewOfFile(m_data);
+        CloseHandle(static_cast<HANDLE>(m_mapping_handle));
+        CloseHandle(static_cast<HANDLE>(m_file_handle));
+        m_mapping_handle = nullptr;
+        m_file_handle    = nullptr;
+#else
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+} // namespace RealmEngine
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace RealmEngine
+{
+    // Read-only memory mapping of a whole file.
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile() noexcept;
+
+        MappedFile(const MappedFile&)            = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& that) noexcept;
+        MappedFile& operator=(MappedFile&& that) noexcept;
+
+        bool open(const std::filesystem::path& path);
+        void close() noexcept;
+
+        const uint8_t* data() const { return m_data; }
+        size_t         size() const { return m_size; }
+        bool           isOpen() const { return m_data != nullptr; }
+
+    private:
+        const uint8_t* m_data {nullptr};
+        size_t         m_size {0};
+
+#ifdef _WIN32
+        void* m_file_handle {nullptr};
+        void* m_mapping_handle {nullptr};
+#endif
+    };
+} // namespace RealmEngine
@@ -1,6 +1,15 @@
 #include "plateform.h"
 #include <filesystem>
 
+#ifdef __linux__
+#include <fstream>
+#include <string>
+#elif _WIN32
+#include <psapi.h>
+#elif __APPLE__
+#include <mach/mach.h>
+#endif
+
 namespace RealmEngine
 {
     std::filesystem::path Plateform::getExecutablePath() noexcept
@@ -27,4 +36,101 @@ namespace RealmEngine
 #endif
         return std::filesystem::current_path() / "RealmEngine";
     }
-} // namespace RealmEngine
\ No newline at end of file
+
+    uint32_t Plateform::getProcessId() noexcept
+    {
+#ifdef _WIN32
+        return static_cast<uint32_t>(GetCurrentProcessId());
+#else
+        return static_cast<uint32_t>(getpid());
+#endif
+    }
+
+#ifdef __linux__
+    namespace
+    {
+        // a "Vm...:   1234 kB" line of /proc/self/status
+        size_t readProcStatus(const char* field)
+        {
+            std::ifstream status("/proc/self/status");
+            std::string   line;
+            const size_t  length = std::char_traits<char>::length(field);
+            while (std::getline(status, line))
+            {
+                if (line.compare(0, length, field) == 0 && line.size() > length && line[length] == ':')
+                    return std::stoull(line.substr(length + 1)) * 1024;
+            }
+            return 0;
+        }
+    } // namespace
+#endif
+
+    size_t Plateform::getResidentMemory() noexcept
+    {
+#ifdef __linux__
+        try
+        {
+            return readProcStatus("VmRSS");
+        }
+        catch (...)
+        {
+            return 0;
+        }
+#elif _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return counters.WorkingSetSize;
+        return 0;
+#elif __APPLE__
+        mach_task_basic_info_data_t info;
+        mach_msg_type_number_t      count = MACH_TASK_BASIC_INFO_COUNT;
+        if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) ==
+            KERN_SUCCESS)
+            return info.resident_size;
+        return 0;
+#else
+        return 0;
+#endif
+    }
+
+    size_t Plateform::getPeakResidentMemory() noexcept
+    {
+#ifdef __linux__
+        try
+        {
+            return readProcStatus("VmHWM");
+        }
+        catch (...)
+        {
+            return 0;
+        }
+#elif _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return counters.PeakWorkingSetSize;
+        return 0;
+#elif __APPLE__
+        mach_task_basic_info_data_t info;
+        mach_msg_type_number_t      count = MACH_TASK_BASIC_INFO_COUNT;
+        if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) ==
+            KERN_SUCCESS)
+            return info.resident_size_max;
+        return 0;
+#else
+        return 0;
+#endif
+    }
+
+    bool Plateform::resetPeakResidentMemory() noexcept
+    {
+#ifdef __linux__
+        // "5" resets VmHWM to the current resident set size (Linux 4.0+)
+        std::ofstream clear_refs("/proc/self/clear_refs");
+        clear_refs << "5";
+        clear_refs.flush();
+        return clear_refs.good();
+#else
+        return false;
+#endif
+    }
+} // namespace RealmEngine
@@ -7,8 +7,11 @@
 #include <windows.h>
 #elif __APPLE__
 #include <mach-o/dyld.h>
+#include <unistd.h>
 #endif
 
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
 
 namespace RealmEngine
@@ -17,5 +20,13 @@ namespace RealmEngine
     {
     public:
         static std::filesystem::path getExecutablePath() noexcept;
+        static uint32_t              getProcessId() noexcept;
+
+        // Resident set size of the process in bytes, 0 where the OS doesn't say.
+        static size_t getResidentMemory() noexcept;
+        // Highest resident set size since the start or the last resetPeakResidentMemory(), 0 where unknown.
+        static size_t getPeakResidentMemory() noexcept;
+        // Restarts the peak; false where the OS can't, the peak then covers the whole run.
+        static bool resetPeakResidentMemory() noexcept;
     };
 } // namespace RealmEngine
\ No newline at end of file
@@ -1,5 +1,9 @@
 #include "render/render_entity.h"
 
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/quaternion.hpp>
+
 namespace RealmEngine
 {
     RenderEntity::RenderEntity(std::shared_ptr<RenderObject> object) : m_render_object(object) {}
@@ -17,4 +21,13 @@ namespace RealmEngine
     glm::quat RenderEntity::getOrientation() const { return m_orientation; }
 
     std::shared_ptr<RenderObject> RenderEntity::getObject() const { return m_render_object; }
+
+    glm::mat4 RenderEntity::getModelMatrix() const
+    {
+        // Match reference implementation transformation order
+        glm::mat4 model = glm::toMat4(m_orientation);
+        model           = glm::translate(model, m_position);
+        model           = glm::scale(model, m_scale);
+        return model;
+    }
 } // namespace RealmEngine
@@ -29,6 +29,8 @@ namespace RealmEngine
 
         std::shared_ptr<RenderObject> getObject() const;
 
+        glm::mat4 getModelMatrix() const;
+
     private:
         glm::vec3                     m_position {glm::vec3(0.0)};
         glm::vec3                     m_scale {glm::vec3(1.0, 1.0, 1.0)};
@@ -0,0 +1,89 @@
+#include "render/render_material.h"
+
+#include <glad/gl.h>
+#include <cstring>
+#include <initializer_list>
+#include "hash.h"
+
+namespace RealmEngine
+{
+    bool RenderMaterial::drawsLike(const RenderMaterial& other) const
+    {
+        const MaterialBlock a = MaterialBlock::fromMaterial(*this);
+        const MaterialBlock b = MaterialBlock::fromMaterial(other);
+        return std::memcmp(&a, &b, sizeof(MaterialBlock)) == 0 && texture_albedo == other.texture_albedo &&
+               texture_metallic_roughness == other.texture_metallic_roughness &&
+               texture_normal == other.texture_normal &&
+               texture_ambient_occlusion == other.texture_ambient_occlusion &&
+               texture_emissive == other.texture_emissive;
+    }
+
+    uint64_t RenderMaterial::drawHash() const
+    {
+        const MaterialBlock block = MaterialBlock::fromMaterial(*this);
+
+        uint64_t hash = Hash::hashBytes(&block, sizeof(MaterialBlock));
+        for (const Texture* texture : {texture_albedo.get(),
+                                       texture_metallic_roughness.get(),
+                                       texture_normal.get(),
+                                       texture_ambient_occlusion.get(),
+                                       texture_emissive.get()})
+            hash = Hash::combine(hash, Hash::hashValue(texture));
+        return hash == 0 ? 1 : hash;
+    }
+
+    MaterialBlock MaterialBlock::fromMaterial(const RenderMaterial& material)
+    {
+        MaterialBlock block {};
+        block.albedo            = glm::vec4(material.albedo, 1.0f);
+        block.emissive          = glm::vec4(material.emissive, 1.0f);
+        block.metallic          = material.metallic;
+        block.roughness         = material.roughness;
+        block.ambient_occlusion = material.ambient_occlusion;
+        block.texture_flags     = 0;
+
+        // a flag without its texture would sample whatever the unit holds, so both must be there
+        if (material.use_texture_albedo && material.texture_albedo)
+            block.texture_flags |= MATERIAL_TEXTURE_ALBEDO;
+        if (material.use_texture_metallic_roughness && material.texture_metallic_roughness)
+            block.texture_flags |= MATERIAL_TEXTURE_METALLIC_ROUGHNESS;
+        if (material.use_texture_normal && material.texture_normal)
+            block.texture_flags |= MATERIAL_TEXTURE_NORMAL;
+        if (material.use_texture_ambient_occlusion && material.texture_ambient_occlusion)
+            block.texture_flags |= MATERIAL_TEXTURE_AMBIENT_OCCLUSION;
+        if (material.use_texture_emissive && material.texture_emissive)
+            block.texture_flags |= MATERIAL_TEXTURE_EMISSIVE;
+        return block;
+    }
+
+    void MaterialBuffer::upload(const std::vector<MaterialBlock>& blocks, size_t alignment)
+    {
+        m_stride = (sizeof(MaterialBlock) + alignment - 1) / alignment * alignment;
+        m_count  = blocks.size();
+
+        std::vector<uint8_t> staging(m_count * m_stride, 0);
+        for (size_t i = 0; i < m_count; ++i)
+            std::memcpy(staging.data() + i * m_stride, &blocks[i], sizeof(MaterialBlock));
+
+        if (m_buffer == 0)
+            glGenBuffers(1, &m_buffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+        glBufferData(GL_UNIFORM_BUFFER, staging.size(), staging.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void MaterialBuffer::release()
+    {
+        if (m_buffer == 0)
+            return;
+        glDeleteBuffers(1, &m_buffer);
+        m_buffer = 0;
+        m_count  = 0;
+    }
+
+    void MaterialBuffer::bind(uint32_t block) const
+    {
+        glBindBufferRange(
+            GL_UNIFORM_BUFFER, UNIFORM_BINDING_MATERIAL, m_buffer, block * m_stride, sizeof(MaterialBlock));
+    }
+} // namespace RealmEngine
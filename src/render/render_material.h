@@ -1,11 +1,24 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <memory>
+#include <vector>
 #include "render/texture.h"
 
 namespace RealmEngine
 {
+    // uniform buffer binding point of pbr.frag's MaterialBlock, next to the renderer's UNIFORM_BINDING_JOINTS
+    static const unsigned int UNIFORM_BINDING_MATERIAL = 1;
+
+    // MaterialBlock::texture_flags, one bit per texture the material samples
+    static const uint32_t MATERIAL_TEXTURE_ALBEDO             = 1u << 0;
+    static const uint32_t MATERIAL_TEXTURE_METALLIC_ROUGHNESS = 1u << 1;
+    static const uint32_t MATERIAL_TEXTURE_NORMAL             = 1u << 2;
+    static const uint32_t MATERIAL_TEXTURE_AMBIENT_OCCLUSION  = 1u << 3;
+    static const uint32_t MATERIAL_TEXTURE_EMISSIVE           = 1u << 4;
+
     struct RenderMaterial
     {
         bool use_texture_albedo             = false;
@@ -25,5 +38,49 @@ namespace RealmEngine
         std::shared_ptr<Texture> texture_normal;
         std::shared_ptr<Texture> texture_ambient_occlusion;
         std::shared_ptr<Texture> texture_emissive;
+
+        // same constants and same textures, so one MaterialBlock and one set of bindings draws both
+        bool drawsLike(const RenderMaterial& other) const;
+        // equal for materials that drawsLike() each other, never 0
+        uint64_t drawHash() const;
+    };
+
+    // std140 layout of pbr.frag's MaterialBlock: the constants of a RenderMaterial, textures stay bound to units
+    struct MaterialBlock
+    {
+        glm::vec4 albedo;   // rgb, a unused
+        glm::vec4 emissive; // rgb, a unused
+        float     metallic;
+        float     roughness;
+        float     ambient_occlusion;
+        uint32_t  texture_flags; // MATERIAL_TEXTURE_* bits
+
+        static MaterialBlock fromMaterial(const RenderMaterial& material);
+    };
+    static_assert(sizeof(MaterialBlock) == 48, "MaterialBlock must match the std140 block in pbr.frag");
+
+    /**
+     * Uniform buffer of MaterialBlocks, each at the uniform buffer offset alignment so any one of them can be
+     * bound as a range. Switching materials between draws is then one glBindBufferRange instead of a string
+     * lookup and upload per constant.
+     */
+    class MaterialBuffer
+    {
+    public:
+        // Creates the buffer on first use, then replaces its contents. GL thread only.
+        void upload(const std::vector<MaterialBlock>& blocks, size_t alignment);
+        // Deletes the buffer. GL thread only.
+        void release();
+
+        // Binds block to UNIFORM_BINDING_MATERIAL. GL thread only.
+        void bind(uint32_t block) const;
+
+        size_t getBlockCount() const { return m_count; }
+        size_t getGpuBytes() const { return m_count * m_stride; }
+
+    private:
+        unsigned int m_buffer {0};
+        size_t       m_stride {0};
+        size_t       m_count {0};
     };
 } // namespace RealmEngine
@@ -1,117 +1,232 @@
 #include "render/render_mesh.h"
 
 #include <glad/gl.h>
+#include <algorithm>
+#include <cstddef>
+#include "animation/skinning_kernels.h"
+#include "resource/processor/vertex_encoder.h"
 
 namespace RealmEngine
 {
-    RenderMesh::RenderMesh(std::vector<RenderVertex> vertices,
-                           std::vector<unsigned int> indices,
-                           RenderMaterial material) : m_vertices(vertices), m_indices(indices), m_material(material)
+    namespace
     {
-        init();
+        void bindTexture(int unit, bool used, const std::shared_ptr<Texture>& texture)
+        {
+            if (!used || !texture)
+                return;
+            glActiveTexture(GL_TEXTURE0 + unit);
+            glBindTexture(GL_TEXTURE_2D, texture->m_id);
+        }
+    } // namespace
+
+    RenderMesh::RenderMesh(const MeshBuffers&    buffers,
+                           uint32_t              submesh,
+                           const RenderMaterial& material,
+                           const MaterialBuffer& material_buffer,
+                           uint32_t              material_block,
+                           uint32_t              node,
+                           int32_t               skin) :
+        m_buffers(&buffers), m_submesh(submesh), m_material(&material), m_material_buffer(&material_buffer),
+        m_material_block(material_block), m_node(node), m_skin(skin)
+    {}
+
+    size_t RenderMesh::getLodCount() const { return 1 + m_buffers->submeshes[m_submesh].lod_count; }
+
+    MeshLod RenderMesh::getLod(size_t lod) const
+    {
+        const SubMesh& submesh = m_buffers->submeshes[m_submesh];
+        if (lod == 0)
+            return MeshLod {submesh.base_index, submesh.index_count, 0.0f};
+        return m_buffers->lods[submesh.lod_offset + lod - 1];
     }
 
-    void RenderMesh::draw(Shader& shader)
+    void RenderMesh::draw(Shader& shader, DrawState& state, size_t lod, unsigned int vao) const
     {
-        shader.setBool("material.useTextureAlbedo", m_material.use_texture_albedo);
-        shader.setVec3("material.albedo", m_material.albedo);
-        if (m_material.use_texture_albedo)
+        if (state.material_buffer != m_material_buffer || state.material_block != m_material_block)
         {
-            glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_ALBEDO);
-            shader.setInt("material.textureAlbedo", TEXTURE_UNIT_ALBEDO);
-            glBindTexture(GL_TEXTURE_2D, m_material.texture_albedo->m_id);
+            // the constants come from the block, the sampler units are set once per frame by the renderer;
+            // texture ids are read here as they go from placeholder to resident
+            m_material_buffer->bind(m_material_block);
+            bindTexture(TEXTURE_UNIT_ALBEDO, m_material->use_texture_albedo, m_material->texture_albedo);
+            bindTexture(TEXTURE_UNIT_METALLIC_ROUGHNESS,
+                        m_material->use_texture_metallic_roughness,
+                        m_material->texture_metallic_roughness);
+            bindTexture(TEXTURE_UNIT_NORMAL, m_material->use_texture_normal, m_material->texture_normal);
+            bindTexture(TEXTURE_UNIT_AMBIENT_OCCLUSION,
+                        m_material->use_texture_ambient_occlusion,
+                        m_material->texture_ambient_occlusion);
+            bindTexture(TEXTURE_UNIT_EMISSIVE, m_material->use_texture_emissive, m_material->texture_emissive);
+            glActiveTexture(GL_TEXTURE0);
+
+            state.material_buffer = m_material_buffer;
+            state.material_block  = m_material_block;
         }
 
-        shader.setBool("material.useTextureMetallicRoughness", m_material.use_texture_metallic_roughness);
-        shader.setFloat("material.metallic", m_material.metallic);
-        shader.setFloat("material.roughness", m_material.roughness);
-        if (m_material.use_texture_metallic_roughness)
+        if (state.buffers != m_buffers)
         {
-            glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_METALLIC_ROUGHNESS);
-            shader.setInt("material.textureMetallicRoughness", TEXTURE_UNIT_METALLIC_ROUGHNESS);
-            glBindTexture(GL_TEXTURE_2D, m_material.texture_metallic_roughness->m_id);
+            shader.setVec3("positionOffset", m_buffers->encoding.position_offset);
+            shader.setVec3("positionScale", m_buffers->encoding.position_scale);
+            state.buffers = m_buffers;
         }
 
-        shader.setBool("material.useTextureNormal", m_material.use_texture_normal);
-        if (m_material.use_texture_normal)
+        const unsigned int array = vao != 0 ? vao : m_buffers->vao;
+        if (state.vao != array)
         {
-            glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_NORMAL);
-            shader.setInt("material.textureNormal", TEXTURE_UNIT_NORMAL);
-            glBindTexture(GL_TEXTURE_2D, m_material.texture_normal->m_id);
+            glBindVertexArray(array);
+            state.vao = array;
         }
 
-        shader.setBool("material.useTextureAmbientOcclusion", m_material.use_texture_ambient_occlusion);
-        shader.setFloat("material.ambientOcclusion", m_material.ambient_occlusion);
-        if (m_material.use_texture_ambient_occlusion)
-        {
-            glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_AMBIENT_OCCLUSION);
-            shader.setInt("material.textureAmbientOcclusion", TEXTURE_UNIT_AMBIENT_OCCLUSION);
-            glBindTexture(GL_TEXTURE_2D, m_material.texture_ambient_occlusion->m_id);
-        }
+        const MeshLod range = getLod(std::min(lod, getLodCount() - 1));
+        glDrawElements(GL_TRIANGLES,
+                       range.index_count,
+                       m_buffers->index_type == IndexType::UInt16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
+                       reinterpret_cast<void*>(range.base_index * IndexBuffer::getIndexSize(m_buffers->index_type)));
+    }
 
-        shader.setBool("material.useTextureEmissive", m_material.use_texture_emissive);
-        shader.setVec3("material.emissive", m_material.emissive);
-        if (m_material.use_texture_emissive)
+    void MeshBuffers::upload(const Mesh& mesh)
+    {
+        const bool      encoded = mesh.hasEncodedVertices();
+        EncodedVertices local;
+        if (!encoded)
+            local = VertexEncoder::encode(mesh.getVertices(), mesh.getBounds(), true, mesh.isSkinned());
+        const EncodedVertices& vertices = encoded ? mesh.getEncodedVertices() : local;
+        const IndexBuffer      indices  = mesh.packIndices();
+
+        encoding     = vertices.encoding;
+        index_type   = indices.type;
+        bounds       = mesh.getBounds();
+        submeshes    = mesh.getSubMeshes();
+        lods         = mesh.getLods();
+        vertex_bytes = vertices.data.size();
+        index_bytes  = indices.data.size();
+        data_version = mesh.getGpuDataVersion();
+
+        if (vao == 0)
         {
-            glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_EMISSIVE);
-            shader.setInt("material.textureEmissive", TEXTURE_UNIT_EMISSIVE);
-            glBindTexture(GL_TEXTURE_2D, m_material.texture_emissive->m_id);
+            glGenVertexArrays(1, &vao);
+            glGenBuffers(1, &vbo);
+            glGenBuffers(1, &ebo);
         }
 
-        glActiveTexture(GL_TEXTURE0);
+        glBindVertexArray(vao);
+
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER,
+                     vertices.data.size(),
+                     vertices.data.data(),
+                     GL_STATIC_DRAW); // copy over the vertex data
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                     indices.data.size(),
+                     indices.data.data(),
+                     GL_STATIC_DRAW); // copy over the index data
+
+        setupAttributes(false);
 
-        glBindVertexArray(m_vao);
-        glDrawElements(GL_TRIANGLES, m_indices.size(), GL_UNSIGNED_INT, nullptr);
         glBindVertexArray(0);
     }
 
-    void RenderMesh::init()
+    void MeshBuffers::release()
     {
-        glGenVertexArrays(1, &m_vao);
-        glGenBuffers(1, &m_vbo);
-        glGenBuffers(1, &m_ebo);
-
-        glBindVertexArray(m_vao);
+        if (vao == 0)
+            return;
+        glDeleteVertexArrays(1, &vao);
+        glDeleteBuffers(1, &vbo);
+        glDeleteBuffers(1, &ebo);
+        vao = vbo = ebo = 0;
+        data_version = 0;
+    }
 
-        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-        glBufferData(GL_ARRAY_BUFFER,
-                     m_vertices.size() * sizeof(RenderVertex),
-                     &m_vertices[0],
-                     GL_STATIC_DRAW); // copy over the vertex data
+    unsigned int MeshBuffers::createCpuSkinnedArray(unsigned int skinned_vbo) const
+    {
+        unsigned int skinned_vao = 0;
+        glGenVertexArrays(1, &skinned_vao);
+        glBindVertexArray(skinned_vao);
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                     m_indices.size() * sizeof(unsigned int),
-                     &m_indices[0],
-                     GL_STATIC_DRAW); // copy over the index data
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+        setupAttributes(true);
 
+        // posed in object space by the CPU, so positions are plain floats the shader doesn't decode
+        const GLsizei stride = static_cast<GLsizei>(sizeof(SkinnedVertex));
+        glBindBuffer(GL_ARRAY_BUFFER, skinned_vbo);
         glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(RenderVertex), reinterpret_cast<void*>(0));
+        glVertexAttribPointer(
+            0, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(SkinnedVertex, position)));
+        glEnableVertexAttribArray(7);
+        glVertexAttribPointer(
+            7, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(SkinnedVertex, normal)));
+        glEnableVertexAttribArray(8);
+        glVertexAttribPointer(
+            8, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(SkinnedVertex, tangent)));
+
+        glBindVertexArray(0);
+        return skinned_vao;
+    }
+
+    void MeshBuffers::setupAttributes(bool cpu_skinned) const
+    {
+        // every attribute is expanded to float by the vertex fetch, pbr.vert finishes the decode
+        const GLsizei stride     = static_cast<GLsizei>(encoding.stride);
+        const size_t  attributes = encoding.getAttributeOffset();
+
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+        if (!cpu_skinned)
+        {
+            glEnableVertexAttribArray(0);
+            if (encoding.quantized_positions)
+                glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, reinterpret_cast<void*>(0));
+            else
+                glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(0));
+        }
 
         glEnableVertexAttribArray(1);
-        glVertexAttribPointer(
-            1, 3, GL_FLOAT, GL_FALSE, sizeof(RenderVertex), reinterpret_cast<void*>(offsetof(RenderVertex, m_normal)));
+        glVertexAttribPointer(1,
+                              2,
+                              GL_SHORT,
+                              GL_TRUE,
+                              stride,
+                              reinterpret_cast<void*>(attributes + offsetof(PackedVertexAttributes, normal)));
 
         glEnableVertexAttribArray(2);
         glVertexAttribPointer(2,
                               2,
-                              GL_FLOAT,
+                              GL_HALF_FLOAT,
                               GL_FALSE,
-                              sizeof(RenderVertex),
-                              reinterpret_cast<void*>(offsetof(RenderVertex, m_texture_coordinates)));
+                              stride,
+                              reinterpret_cast<void*>(attributes + offsetof(PackedVertexAttributes, tex_coord)));
 
         glEnableVertexAttribArray(3);
-        glVertexAttribPointer(
-            3, 3, GL_FLOAT, GL_FALSE, sizeof(RenderVertex), reinterpret_cast<void*>(offsetof(RenderVertex, m_tangent)));
+        glVertexAttribPointer(3,
+                              4,
+                              GL_BYTE,
+                              GL_TRUE,
+                              stride,
+                              reinterpret_cast<void*>(attributes + offsetof(PackedVertexAttributes, tangent)));
 
         glEnableVertexAttribArray(4);
         glVertexAttribPointer(4,
-                              3,
-                              GL_FLOAT,
-                              GL_FALSE,
-                              sizeof(RenderVertex),
-                              reinterpret_cast<void*>(offsetof(RenderVertex, m_bitangent)));
+                              4,
+                              GL_UNSIGNED_BYTE,
+                              GL_TRUE,
+                              stride,
+                              reinterpret_cast<void*>(attributes + offsetof(PackedVertexAttributes, color)));
+
+        // a re-upload can turn a skinned mesh static, so the skin attributes are switched off explicitly
+        if (cpu_skinned || !encoding.skinned)
+        {
+            glDisableVertexAttribArray(5);
+            glDisableVertexAttribArray(6);
+            return;
+        }
 
-        glBindVertexArray(0);
+        const size_t skin = encoding.getSkinOffset();
+        glEnableVertexAttribArray(5);
+        glVertexAttribIPointer(
+            5, 4, GL_UNSIGNED_SHORT, stride, reinterpret_cast<void*>(skin + offsetof(PackedSkin, joints)));
+        glEnableVertexAttribArray(6);
+        glVertexAttribPointer(
+            6, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, reinterpret_cast<void*>(skin + offsetof(PackedSkin, weights)));
     }
 } // namespace RealmEngine
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <vector>
+#include "math.h"
 #include "render/render_material.h"
 #include "render/shader.h"
-#include "render/vertex.h"
+#include "resource/datatype/model/index_buffer.h"
+#include "resource/datatype/model/mesh.h"
+#include "resource/datatype/model/packed_vertex.h"
 
 namespace RealmEngine
 {
@@ -14,20 +19,92 @@ namespace RealmEngine
     const int TEXTURE_UNIT_AMBIENT_OCCLUSION  = 3;
     const int TEXTURE_UNIT_EMISSIVE           = 4;
 
+    /**
+     * GPU copy of one Mesh: the compact vertex stream (see VertexEncoder) and indices narrowed to 16 bits when
+     * the vertex count allows it, plus the ranges needed to draw its submeshes and their LODs.
+     * Meshes imported without encoded vertices are encoded here, with quantized positions.
+     * Skinned meshes also carry joints and weights (attributes 5 and 6) for skinning in pbr.vert.
+     */
+    struct MeshBuffers
+    {
+        unsigned int         vao {0};
+        unsigned int         vbo {0};
+        unsigned int         ebo {0};
+        VertexEncoding       encoding;
+        IndexType            index_type {IndexType::UInt32};
+        AABB                 bounds {glm::vec3(0.0f), glm::vec3(0.0f)};
+        std::vector<SubMesh> submeshes;
+        std::vector<MeshLod> lods;
+        size_t               vertex_bytes {0};
+        size_t               index_bytes {0};
+        uint64_t             data_version {0}; // Mesh::getGpuDataVersion() uploaded, 0 before the first upload
+
+        // Creates the GL objects on first use, then replaces their contents. GL thread only.
+        void upload(const Mesh& mesh);
+        // Deletes the GL objects. GL thread only.
+        void release();
+
+        // A vertex array drawing these indices and attributes, but with position, normal and tangent read from
+        // skinned_vbo, a stream of SkinnedVertex written by CPU skinning. The caller owns it. GL thread only.
+        unsigned int createCpuSkinnedArray(unsigned int skinned_vbo) const;
+
+    private:
+        // For the bound vertex array; the static position and skin attributes only when not CPU skinned.
+        void setupAttributes(bool cpu_skinned) const;
+    };
+
+    /**
+     * What the previous draw left bound, so a run of draws sharing a material only binds its range of the material
+     * buffer and its textures once, and a run sharing a mesh only sets the position decode once. Start from a
+     * fresh one whenever other code may have changed those bindings.
+     */
+    struct DrawState
+    {
+        const MaterialBuffer* material_buffer {nullptr};
+        uint32_t              material_block {0};
+        const MeshBuffers*    buffers {nullptr};
+        unsigned int          vao {0};
+    };
+
+    // One submesh of an uploaded mesh, drawn with its material at the node it hangs from.
     class RenderMesh
     {
     public:
-        RenderMesh(std::vector<RenderVertex> vertices, std::vector<unsigned int> indices, RenderMaterial material);
+        // Buffers, material and the material buffer must outlive the RenderMesh; the RenderModel owns them, or
+        // the RenderObject for an override material. material_block is the material's block in material_buffer,
+        // node the index in the model's NodeHierarchy.
+        RenderMesh(const MeshBuffers&    buffers,
+                   uint32_t              submesh,
+                   const RenderMaterial& material,
+                   const MaterialBuffer& material_buffer,
+                   uint32_t              material_block,
+                   uint32_t              node,
+                   int32_t               skin = -1);
 
-        void draw(Shader& shader);
+        // vao replaces the mesh's own vertex array when not 0, see MeshBuffers::createCpuSkinnedArray()
+        void draw(Shader& shader, DrawState& state, size_t lod = 0, unsigned int vao = 0) const;
 
-        std::vector<RenderVertex> m_vertices;
-        std::vector<unsigned int> m_indices;
-        RenderMaterial            m_material;
+        // in mesh space, the node's world transform places it in the model
+        const AABB&           getBounds() const { return m_buffers->bounds; }
+        const MeshBuffers&    getMeshBuffers() const { return *m_buffers; }
+        const RenderMaterial& getMaterial() const { return *m_material; }
+        const MaterialBuffer& getMaterialBuffer() const { return *m_material_buffer; }
+        uint32_t              getMaterialBlock() const { return m_material_block; }
+        uint32_t              getNode() const { return m_node; }
+        // index into the owning RenderObject's skins, -1 for static meshes
+        int32_t getSkin() const { return m_skin; }
 
-    private:
-        void init();
+        // LOD 0 included
+        size_t  getLodCount() const;
+        MeshLod getLod(size_t lod) const;
 
-        unsigned int m_vao, m_vbo, m_ebo;
+    private:
+        const MeshBuffers*    m_buffers;
+        uint32_t              m_submesh;
+        const RenderMaterial* m_material;
+        const MaterialBuffer* m_material_buffer;
+        uint32_t              m_material_block;
+        uint32_t              m_node;
+        int32_t               m_skin;
     };
 } // namespace RealmEngine
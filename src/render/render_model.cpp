@@ -0,0 +1,175 @@
+#include "render/render_model.h"
+
+#include <chrono>
+#include <utility>
+#include "global_context.h"
+#include "render/renderer.h"
+#include "resource/datatype/model/model.h"
+#include "resource/processor/model_deduplicator.h"
+#include "utils.h"
+
+namespace RealmEngine
+{
+    RenderModel::RenderModel(ModelHandle model, bool flip_textures, std::shared_ptr<ModelStream> stream) :
+        m_model(std::move(model)), m_flip_textures(flip_textures), m_stream(std::move(stream))
+    {
+        m_buffers.resize(m_model->getMeshCount());
+        m_bind_poses.resize(m_buffers.size());
+        m_mesh_ready.assign(m_buffers.size(), m_stream ? 0 : 1);
+        createMaterials();
+
+        // streamed meshes go through the per frame budget instead
+        if (!m_stream)
+            sync();
+    }
+
+    size_t RenderModel::sync(double& budget_ms)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        if (m_stream)
+        {
+            size_t ready = 0;
+            for (size_t i = 0; i < m_mesh_ready.size(); ++i)
+            {
+                if (!m_mesh_ready[i] && m_stream->isMeshReady(i))
+                    m_mesh_ready[i] = 1;
+                ready += m_mesh_ready[i];
+            }
+            if (ready == m_mesh_ready.size() || m_stream->isFailed())
+                m_stream.reset();
+        }
+
+        size_t uploaded = 0;
+        for (size_t i = 0; i < m_buffers.size() && budget_ms > 0.0; ++i)
+        {
+            // a mesh that isn't ready may still be written by a worker
+            if (!m_mesh_ready[i])
+                continue;
+
+            // the Mesh is shared with other RenderModels of the model, so the uploaded version is kept here
+            const Mesh& mesh = m_model->getMesh(i);
+            if (m_buffers[i].data_version == mesh.getGpuDataVersion())
+                continue;
+
+            const Clock::time_point start = Clock::now();
+            m_buffers[i].upload(mesh);
+            m_bind_poses[i] = SkinBindPose {}; // extracted again from the new vertices
+            budget_ms -= std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            ++uploaded;
+        }
+
+        m_generation += uploaded;
+        return uploaded;
+    }
+
+    void RenderModel::replace(ModelHandle model)
+    {
+        for (auto& buffers : m_buffers)
+            buffers.release();
+        m_buffers.clear();
+        m_materials.clear();
+        m_material_blocks.clear();
+        m_material_buffer.release();
+        m_bind_poses.clear();
+        m_texture_count = 0;
+        m_stream.reset();
+
+        // textures shared with the previous materials stay registered, the others are collected next frame
+        m_model = std::move(model);
+        m_buffers.resize(m_model->getMeshCount());
+        m_bind_poses.resize(m_buffers.size());
+        m_mesh_ready.assign(m_buffers.size(), 1);
+        createMaterials();
+        sync();
+        ++m_generation;
+    }
+
+    const RenderMaterial& RenderModel::getMaterial(size_t material) const
+    {
+        return material < m_materials.size() - 1 ? m_materials[material] : m_materials.back();
+    }
+
+    uint32_t RenderModel::getMaterialBlock(size_t material) const
+    {
+        return material < m_material_blocks.size() - 1 ? m_material_blocks[material] : m_material_blocks.back();
+    }
+
+    void RenderModel::prepareBindPoses()
+    {
+        for (size_t i = 0; i < m_bind_poses.size(); ++i)
+        {
+            const Mesh& mesh = m_model->getMesh(i);
+            if (!m_mesh_ready[i] || !mesh.isSkinned() || !m_bind_poses[i].vertices.empty())
+                continue;
+            SkinningKernels::extractBindPose(mesh, m_bind_poses[i].vertices, m_bind_poses[i].influences);
+        }
+    }
+
+    const SkinBindPose* RenderModel::getBindPose(size_t mesh) const
+    {
+        if (mesh >= m_bind_poses.size() || m_bind_poses[mesh].vertices.empty())
+            return nullptr;
+        return &m_bind_poses[mesh];
+    }
+
+    size_t RenderModel::getGpuBytes() const
+    {
+        size_t bytes = 0;
+        for (const auto& buffers : m_buffers)
+            bytes += buffers.vertex_bytes + buffers.index_bytes;
+        return bytes;
+    }
+
+    void RenderModel::createMaterials()
+    {
+        TextureRegistry& registry = g_context.m_renderer->getTextureRegistry();
+
+        // slots follow TextureUsage, see Material
+        auto acquire = [&](const std::optional<TextureRef>& ref, bool& use, std::shared_ptr<Texture>& texture) {
+            if (!ref || ref->path.empty())
+                return;
+            use     = true;
+            texture = registry.acquire(ref->path, static_cast<TextureUsage>(ref->slot), ref->srgb, m_flip_textures);
+            ++m_texture_count;
+        };
+
+        m_materials.resize(m_model->getMaterialCount() + 1);
+        for (size_t i = 0; i < m_model->getMaterialCount(); ++i)
+        {
+            const Material& source   = m_model->getMaterial(i);
+            RenderMaterial& material = m_materials[i];
+
+            material.albedo    = glm::vec3(source.getBaseColorFactor());
+            material.metallic  = source.getMetallicFactor();
+            material.roughness = source.getRoughnessFactor();
+            material.emissive  = source.getEmissiveFactor();
+
+            acquire(source.getBaseColorTexture(), material.use_texture_albedo, material.texture_albedo);
+            acquire(source.getMetallicRoughnessTexture(),
+                    material.use_texture_metallic_roughness,
+                    material.texture_metallic_roughness);
+            acquire(source.getNormalTexture(), material.use_texture_normal, material.texture_normal);
+            acquire(source.getOcclusionTexture(),
+                    material.use_texture_ambient_occlusion,
+                    material.texture_ambient_occlusion);
+            acquire(source.getEmissiveTexture(), material.use_texture_emissive, material.texture_emissive);
+        }
+
+        // The importer already merges identical materials, but those differing only in what the renderer ignores
+        // (alpha, names, ...) still come out alike here; they share a block so sorted draws skip the rebinding.
+        std::vector<uint64_t> hashes(m_materials.size());
+        for (size_t i = 0; i < m_materials.size(); ++i)
+            hashes[i] = m_materials[i].drawHash();
+
+        const ModelDeduplicator::Remap groups = ModelDeduplicator::group(
+            hashes, [&](uint32_t kept, uint32_t other) { return m_materials[kept].drawsLike(m_materials[other]); });
+
+        std::vector<MaterialBlock> blocks;
+        blocks.reserve(groups.sources.size());
+        for (uint32_t material : groups.sources)
+            blocks.push_back(MaterialBlock::fromMaterial(m_materials[material]));
+        m_material_blocks = groups.remap;
+        m_material_buffer.upload(blocks, g_context.m_renderer->getUniformAlignment());
+    }
+} // namespace RealmEngine
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "animation/skinning_kernels.h"
+#include "render/render_material.h"
+#include "render/render_mesh.h"
+#include "resource/asset_manager.h"
+
+namespace RealmEngine
+{
+    // CPU skinning input of one skinned mesh, see SkinningKernels.
+    struct SkinBindPose
+    {
+        std::vector<SkinnedVertex> vertices;
+        std::vector<SkinInfluence> influences;
+    };
+
+    /**
+     * GPU side of one AssetManager Model, shared by every RenderObject built from it.
+     *
+     * Keeps the model resident through its handle, owns one MeshBuffers per mesh and one RenderMaterial per
+     * material, with the textures acquired from the renderer's TextureRegistry. Materials the renderer would
+     * draw the same way share one block of the model's MaterialBuffer. sync() uploads every mesh once, then
+     * only re-uploads those whose CPU data changed since (Mesh::getGpuDataVersion()).
+     *
+     * A model that is still streaming in (see AssetManager::loadModelProgressive) only has its ready meshes
+     * uploaded, a few per frame within the renderer's mesh upload budget.
+     */
+    class RenderModel
+    {
+    public:
+        RenderModel(ModelHandle model, bool flip_textures, std::shared_ptr<ModelStream> stream = nullptr);
+        ~RenderModel() noexcept = default;
+
+        RenderModel(const RenderModel& that)            = delete;
+        RenderModel(RenderModel&& that)                 = delete;
+        RenderModel& operator=(const RenderModel& that) = delete;
+        RenderModel& operator=(RenderModel&& that)      = delete;
+
+        // GL thread only. Uploads while budget_ms lasts, at least one mesh, and takes the time spent off it.
+        // Returns the number of meshes uploaded.
+        size_t sync(double& budget_ms);
+        size_t sync()
+        {
+            double unlimited = std::numeric_limits<double>::infinity();
+            return sync(unlimited);
+        }
+
+        /**
+         * Swaps in model, typically a re-import of the same file, and uploads it right away: the old buffers are
+         * deleted and the materials acquired again, so draw lists built before must be rebuilt before the next
+         * draw, which RenderObject::update() does as the generation changes. GL thread only.
+         */
+        void replace(ModelHandle model);
+
+        // bumped by every upload, so RenderObjects know when to rebuild their draw lists
+        uint64_t getGeneration() const { return m_generation; }
+        bool     isStreaming() const { return m_stream != nullptr; }
+
+        const ModelHandle&    getModel() const { return m_model; }
+        bool                  isFlippingTextures() const { return m_flip_textures; }
+        const MeshBuffers&    getMeshBuffers(size_t mesh) const { return m_buffers[mesh]; }
+        const RenderMaterial& getMaterial(size_t material) const;
+        // block of getMaterialBuffer() drawing material, equal for materials that draw alike
+        uint32_t              getMaterialBlock(size_t material) const;
+        const MaterialBuffer& getMaterialBuffer() const { return m_material_buffer; }
+
+        // Extracts the bind pose of every skinned mesh uploaded so far that doesn't have one yet. GL thread only,
+        // before objects skin on the CPU; getBindPose() is then safe to call from any thread.
+        void                prepareBindPoses();
+        const SkinBindPose* getBindPose(size_t mesh) const;
+
+        size_t getGpuBytes() const;
+        size_t getTextureCount() const { return m_texture_count; }
+
+    private:
+        void createMaterials();
+
+        ModelHandle                  m_model;
+        bool                         m_flip_textures {false};
+        std::vector<MeshBuffers>     m_buffers;   // sized once, RenderMeshes point into it
+        std::vector<RenderMaterial>  m_materials; // the last one is the default for out of range indices
+        std::vector<uint32_t>        m_material_blocks; // per material
+        MaterialBuffer               m_material_buffer;
+        std::vector<SkinBindPose>    m_bind_poses; // empty for static meshes and until prepareBindPoses()
+        size_t                       m_texture_count {0};
+        uint64_t                     m_generation {0};
+        std::shared_ptr<ModelStream> m_stream;     // dropped once every mesh is ready
+        std::vector<uint8_t>         m_mesh_ready; // meshes the stream has handed over
+    };
+} // namespace RealmEngine
@@ -1,8 +1,13 @@
 #include "render/render_object.h"
 
-#include <assimp/GltfMaterial.h>
 #include <glad/gl.h>
-#include <stb/stb_image.h>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include "global_context.h"
+#include "render/renderer.h"
+#include "resource/asset_manager.h"
+#include "resource/datatype/model/model.h"
 #include "utils.h"
 
 namespace RealmEngine
@@ -21,321 +26,221 @@ namespace RealmEngine
         loadModel(path, flipTexturesVertically);
     }
 
-    void RenderObject::draw(Shader& shader)
+    RenderObject::RenderObject(ModelHandle model, bool flipTexturesVertically) :
+        m_flip_textures(flipTexturesVertically)
     {
-        for (auto& mesh : m_meshes)
-            mesh.draw(shader);
-    }
-
-    void RenderObject::loadModel(std::string path, bool flipTexturesVertically)
-    {
-        Assimp::Importer importer;
-        stbi_set_flip_vertically_on_load(flipTexturesVertically);
-        const aiScene* scene =
-            importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
-
-        if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+        if (!model)
         {
-            err("Error loading model: " + std::string(importer.GetErrorString()));
+            err("Cannot create a render object without a model");
             return;
         }
-
-        size_t last_slash = path.find_last_of("/\\");
-        if (last_slash != std::string::npos)
-        {
-            m_directory = path.substr(0, last_slash);
-        }
-        else
-        {
-            m_directory = ".";
-        }
-
-        info("Loading model from: " + path);
-        info("Model directory: " + m_directory);
-        info("Scene has " + std::to_string(scene->mNumMeshes) + " meshes, " + std::to_string(scene->mNumMaterials) +
-             " materials");
-
-        processNode(scene->mRootNode, scene);
-
-        info("Loaded " + std::to_string(m_meshes.size()) + " meshes from model");
-
-        stbi_set_flip_vertically_on_load(true);
+        m_render_model = g_context.m_renderer->getRenderModel(model, m_flip_textures);
+        buildMeshes();
     }
 
-    void RenderObject::processNode(aiNode* node, const aiScene* scene)
-    {
-        for (unsigned int i = 0; i < node->mNumMeshes; i++)
-        {
-            aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-            m_meshes.push_back(processMesh(mesh, scene));
-        }
-
-        for (unsigned int i = 0; i < node->mNumChildren; i++)
-        {
-            processNode(node->mChildren[i], scene);
-        }
-    }
+    RenderObject::RenderObject(std::shared_ptr<ModelStream> stream, bool flipTexturesVertically) :
+        m_stream(std::move(stream)), m_flip_textures(flipTexturesVertically)
+    {}
 
-    RenderMesh RenderObject::processMesh(aiMesh* mesh, const aiScene* scene)
+    void RenderObject::update(double& upload_budget_ms)
     {
-        std::vector<RenderVertex> vertices;
-        std::vector<unsigned int> indices;
-        RenderMaterial            material;
-
-        if (m_material_override)
+        if (!m_render_model && m_stream)
         {
-            material = *m_material_override;
-        }
-
-        // vertices
-        for (unsigned int i = 0; i < mesh->mNumVertices; i++)
-        {
-            RenderVertex vertex;
-
-            // position
-            glm::vec3 position;
-            position.x = mesh->mVertices[i].x;
-            position.y = mesh->mVertices[i].y;
-            position.z = mesh->mVertices[i].z;
-
-            vertex.m_position = position;
-
-            // normal
-            glm::vec3 normal;
-            normal.x = mesh->mNormals[i].x;
-            normal.y = mesh->mNormals[i].y;
-            normal.z = mesh->mNormals[i].z;
-
-            vertex.m_normal = normal;
-
-            // texture coordinates
-            if (mesh->mTextureCoords[0])
-            {
-                glm::vec2 texture_coordinates;
-                texture_coordinates.x        = mesh->mTextureCoords[0][i].x;
-                texture_coordinates.y        = mesh->mTextureCoords[0][i].y;
-                vertex.m_texture_coordinates = texture_coordinates;
-            }
-            else
+            ModelHandle model = m_stream->getModel();
+            if (!model)
             {
-                vertex.m_texture_coordinates = glm::vec2(0.0f, 0.0f);
+                if (m_stream->isFailed())
+                    m_stream.reset();
+                return;
             }
 
-            // tangents
-            if (mesh->mTangents && mesh->mNumVertices > 0)
-            {
-                glm::vec3 tangent;
-                tangent.x        = mesh->mTangents[i].x;
-                tangent.y        = mesh->mTangents[i].y;
-                tangent.z        = mesh->mTangents[i].z;
-                vertex.m_tangent = tangent;
-            }
-            else
-            {
-                vertex.m_tangent = glm::vec3(0.0f);
-            }
+            // a stream that is already complete needs no per mesh tracking
+            m_render_model = g_context.m_renderer->getRenderModel(
+                model, m_flip_textures, m_stream->isComplete() ? nullptr : m_stream);
+            m_stream.reset();
+        }
+        if (!m_render_model)
+            return;
 
-            // bitangents
-            if (mesh->mBitangents && mesh->mNumVertices > 0)
-            {
-                glm::vec3 bitangent;
-                bitangent.x        = mesh->mBitangents[i].x;
-                bitangent.y        = mesh->mBitangents[i].y;
-                bitangent.z        = mesh->mBitangents[i].z;
-                vertex.m_bitangent = bitangent;
-            }
-            else
-            {
-                vertex.m_bitangent = glm::vec3(0.0f);
-            }
+        m_render_model->sync(upload_budget_ms);
+        if (m_generation != m_render_model->getGeneration())
+            buildMeshes();
+    }
 
-            vertices.push_back(vertex);
-        }
+    bool RenderObject::playAnimation(const std::string& name, bool loop)
+    {
+        m_clip           = name;
+        m_clip_loop      = loop;
+        m_clip_requested = true;
+        if (!m_animator)
+            return !m_render_model;
+        return m_animator->play(name, loop);
+    }
 
-        // indices
-        for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+    bool RenderObject::updateAnimation(float delta_time, bool cpu_skinning, ThreadPool* pool)
+    {
+        // a replaced model frees the one the animator reads, until update() builds it again
+        if (!m_animator || m_generation != m_render_model->getGeneration())
+            return false;
+
+        const bool posed = m_animator->update(delta_time);
+        if (!posed && !m_skins_dirty && cpu_skinning == m_cpu_skinned)
+            return false;
+        m_skins_dirty = false;
+        m_cpu_skinned = cpu_skinning;
+
+        const Model& model = *m_render_model->getModel();
+        for (Skin& skin : m_skins)
         {
-            aiFace face = mesh->mFaces[i];
+            m_animator->computeJointMatrices(model.getMesh(skin.mesh), skin.joints);
 
-            for (unsigned int j = 0; j < face.mNumIndices; j++)
+            // no bind pose yet means the renderer hasn't prepared it, the mesh is drawn unskinned meanwhile
+            const SkinBindPose* bind = cpu_skinning ? m_render_model->getBindPose(skin.mesh) : nullptr;
+            if (!bind)
             {
-                indices.push_back(face.mIndices[j]);
+                skin.vertices.clear();
+                continue;
             }
+            skin.vertices.resize(bind->vertices.size());
+            SkinningKernels::skin(bind->vertices.data(),
+                                  bind->influences.data(),
+                                  bind->vertices.size(),
+                                  skin.joints.data(),
+                                  skin.vertices.data(),
+                                  pool);
         }
 
-        // material
-        if (!m_material_override)
-        {
-            if (mesh->mMaterialIndex >= 0)
-            {
-                aiMaterial* ai_material = scene->mMaterials[mesh->mMaterialIndex];
-
-                // albedo - try glTF base color first, then fallback to diffuse
-                if (ai_material->GetTextureCount(aiTextureType_BASE_COLOR))
-                {
-                    // glTF 2.0 base color
-                    material.use_texture_albedo = true;
-                    material.texture_albedo     = loadMaterialTexture(ai_material, aiTextureType_BASE_COLOR);
-                }
-                else if (ai_material->GetTextureCount(aiTextureType_DIFFUSE))
-                {
-                    // FBX/OBJ diffuse fallback
-                    material.use_texture_albedo = true;
-                    material.texture_albedo     = loadMaterialTexture(ai_material, aiTextureType_DIFFUSE);
-                }
-
-                // metallicRoughness (in gltf 2.0 they are combined in one texture)
-                // Try glTF-specific texture type first
-                if (ai_material->GetTextureCount(aiTextureType_GLTF_METALLIC_ROUGHNESS))
-                {
-                    // glTF combined metallic-roughness texture
-                    material.use_texture_metallic_roughness = true;
-                    material.texture_metallic_roughness =
-                        loadMaterialTexture(ai_material, aiTextureType_GLTF_METALLIC_ROUGHNESS);
-                }
-                else if (ai_material->GetTextureCount(aiTextureType_UNKNOWN))
-                {
-                    // Fallback to UNKNOWN type (defined in assimp pbrmaterial.h)
-                    // https://github.com/assimp/assimp/blob/master/include/assimp/pbrmaterial.h#L57
-                    material.use_texture_metallic_roughness = true;
-                    material.texture_metallic_roughness     = loadMaterialTexture(ai_material, aiTextureType_UNKNOWN);
-                }
-
-                // normal
-                if (ai_material->GetTextureCount(aiTextureType_NORMALS))
-                {
-                    material.use_texture_normal = true;
-                    material.texture_normal     = loadMaterialTexture(ai_material, aiTextureType_NORMALS);
-                }
-
-                // ambient occlusion - try glTF AO first, then lightmap
-                if (ai_material->GetTextureCount(aiTextureType_AMBIENT_OCCLUSION))
-                {
-                    // glTF AO map
-                    material.use_texture_ambient_occlusion = true;
-                    material.texture_ambient_occlusion =
-                        loadMaterialTexture(ai_material, aiTextureType_AMBIENT_OCCLUSION);
-                }
-                else if (ai_material->GetTextureCount(aiTextureType_LIGHTMAP))
-                {
-                    // FBX lightmap fallback
-                    material.use_texture_ambient_occlusion = true;
-                    material.texture_ambient_occlusion     = loadMaterialTexture(ai_material, aiTextureType_LIGHTMAP);
-                }
-
-                // emissive
-                if (ai_material->GetTextureCount(aiTextureType_EMISSIVE))
-                {
-                    material.use_texture_emissive = true;
-                    material.texture_emissive     = loadMaterialTexture(ai_material, aiTextureType_EMISSIVE);
-                }
-            }
-        }
+        ++m_pose_version;
+        return true;
+    }
 
-        return RenderMesh(vertices, indices, material);
+    const glm::mat4& RenderObject::getNodeTransform(uint32_t node) const
+    {
+        // the animator poses its own copy of the hierarchy, static models stay in the imported pose
+        if (m_animator)
+            return m_animator->getPose().getWorldTransform(node);
+        return m_render_model->getModel()->getHierarchy().getWorldTransform(node);
     }
 
-    // loads the first texture of given type
-    std::shared_ptr<Texture> RenderObject::loadMaterialTexture(aiMaterial* material, aiTextureType type)
+    void RenderObject::draw(Shader& shader)
     {
-        aiString path;
-        material->GetTexture(type, 0, &path);
+        DrawState state;
+        for (auto& mesh : m_meshes)
+            mesh.draw(shader, state);
+        glBindVertexArray(0);
+    }
 
-        // check if we already have it loaded and use that if so
-        auto iterator = m_textures_loaded.find(std::string(path.C_Str()));
-        if (iterator != m_textures_loaded.end())
+    void RenderObject::loadModel(const std::string& path, bool flipTexturesVertically)
+    {
+        m_flip_textures   = flipTexturesVertically;
+        ModelHandle model = g_context.m_assets->loadModel(path);
+        if (!model)
         {
-            return iterator->second;
+            err("Error loading model: " + path);
+            return;
         }
 
-        auto texture = std::make_shared<Texture>();
+        m_render_model = g_context.m_renderer->getRenderModel(model, m_flip_textures);
+        buildMeshes();
 
-        texture->m_id   = textureFromFile(path.C_Str(), m_directory, type);
-        texture->m_path = path.C_Str();
-
-        m_textures_loaded.insert(std::pair<std::string, std::shared_ptr<Texture>>(path.C_Str(), texture));
-
-        return texture;
+        info("Loaded " + std::to_string(m_meshes.size()) + " meshes from model " + path + ", " +
+             std::to_string(m_render_model->getTextureCount()) + " texture references, " +
+             std::to_string(m_render_model->getGpuBytes() >> 10) + " KB of vertex and index data");
     }
 
-    unsigned int RenderObject::textureFromFile(const char* file_name, std::string directory, aiTextureType type)
+    void RenderObject::buildMeshes()
     {
-        int width, height, num_channels;
+        m_meshes.clear();
+        m_skins.clear();
+        m_generation = m_render_model->getGeneration();
 
-        std::string relative_path = file_name;
-        std::string path;
-        if (relative_path[0] == '/' || (relative_path.length() > 1 && relative_path[1] == ':'))
-        {
-            path = relative_path;
-        }
-        else
+        if (m_material_override)
+            m_override_buffer.upload({MaterialBlock::fromMaterial(*m_material_override)},
+                                     g_context.m_renderer->getUniformAlignment());
+
+        const NodeHierarchy& hierarchy = m_render_model->getModel()->getHierarchy();
+        for (size_t i = 0; i < hierarchy.getNodeCount(); ++i)
+            addNodeMeshes(*hierarchy.getNode(i));
+
+        // object bounds in model space, used by the renderer for culling
+        for (size_t i = 0; i < m_meshes.size(); ++i)
         {
-            path = directory + '/' + relative_path;
+            const AABB bounds = m_meshes[i].getBounds().transform(hierarchy.getWorldTransform(m_meshes[i].getNode()));
+            if (i == 0)
+                m_bounds = bounds;
+            else
+                m_bounds.merge(bounds);
         }
 
-        debug("Loading texture: " + path);
+        createAnimator();
+        m_skins_dirty = true;
+        ++m_skin_generation;
+    }
 
-        unsigned char* data = stbi_load(path.c_str(), &width, &height, &num_channels, 0);
+    void RenderObject::createAnimator()
+    {
+        // a re-imported model needs a new animator, the clip being played carries over
+        const Model& model = *m_render_model->getModel();
+        if (m_animator && m_animated_model == &model)
+            return;
 
-        if (!data)
-        {
-            err("Failed to load texture data: " + path);
-            return 0;
-        }
+        m_animator.reset();
+        m_animated_model = nullptr;
+        if (m_skins.empty() && model.getAnimationCount() == 0)
+            return;
 
-        GLenum format;
+        m_animator       = std::make_unique<Animator>(model);
+        m_animated_model = &model;
+        if (m_clip_requested && !m_animator->play(m_clip, m_clip_loop))
+            warn("Model has no animation named \"" + m_clip + "\", showing its rest pose");
+    }
 
-        switch (num_channels)
+    void RenderObject::addNodeMeshes(const Node& node)
+    {
+        const Model& model = *m_render_model->getModel();
+        for (uint32_t mesh_index : node.getMeshIndices())
         {
-            case 1:
-                format = GL_RED;
-                break;
-            case 3:
-                format = GL_RGB;
-                break;
-            case 4:
-                format = GL_RGBA;
-                break;
-            default:
-                err("Unsupported texture format with " + std::to_string(num_channels) + " channels");
-                stbi_image_free(data);
-                return 0;
-        }
+            if (mesh_index >= model.getMeshCount())
+                continue;
 
-        GLenum internal_format = format;
+            // submeshes are filled in by the upload, so meshes still streaming in are skipped
+            const MeshBuffers& buffers = m_render_model->getMeshBuffers(mesh_index);
+            if (buffers.submeshes.empty())
+                continue;
 
-        // account for sRGB textures here
-        //
-        // diffuse textures are in sRGB space (non-linear)
-        // metallic/roughness/normals are usually in linear
-        // AO depends
-        if (type == aiTextureType_DIFFUSE)
-        {
-            if (internal_format == GL_RGB)
+            // the encoding, not the Mesh, which a worker may still be writing
+            int32_t skin = -1;
+            if (buffers.encoding.skinned)
             {
-                internal_format = GL_SRGB;
+                auto it = std::find_if(m_skins.begin(), m_skins.end(), [&](const Skin& s) {
+                    return s.mesh == mesh_index;
+                });
+                if (it == m_skins.end())
+                {
+                    m_skins.emplace_back();
+                    m_skins.back().mesh = mesh_index;
+                    it                  = std::prev(m_skins.end());
+                }
+                skin = static_cast<int32_t>(it - m_skins.begin());
             }
-            else if (internal_format == GL_RGBA)
+
+            for (uint32_t i = 0; i < buffers.submeshes.size(); ++i)
             {
-                internal_format = GL_SRGB_ALPHA;
+                if (m_material_override)
+                {
+                    m_meshes.emplace_back(
+                        buffers, i, *m_material_override, m_override_buffer, 0, node.getIndex(), skin);
+                    continue;
+                }
+                const uint32_t material = buffers.submeshes[i].material_idx;
+                m_meshes.emplace_back(buffers,
+                                      i,
+                                      m_render_model->getMaterial(material),
+                                      m_render_model->getMaterialBuffer(),
+                                      m_render_model->getMaterialBlock(material),
+                                      node.getIndex(),
+                                      skin);
             }
         }
-
-        unsigned int texture_id;
-        glGenTextures(1, &texture_id);
-        glBindTexture(GL_TEXTURE_2D, texture_id);
-
-        // generate the texture mipmap
-        glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR); // image is resized using bilinear filtering
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // image is enlarged using bilinear filtering
-
-        stbi_image_free(data);
-
-        return texture_id;
     }
 } // namespace RealmEngine
@@ -1,38 +1,109 @@
 #pragma once
 
-#include <assimp/pbrmaterial.h>
-#include <assimp/postprocess.h>
-#include <assimp/scene.h>
-#include <assimp/Importer.hpp>
-
-#include <map>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
+#include "animation/animator.h"
+#include "animation/skinning_kernels.h"
+#include "math.h"
 #include "render/render_mesh.h"
+#include "render/render_model.h"
 
 namespace RealmEngine
 {
+    class Node;
+    class ThreadPool;
+
+    /**
+     * A drawable instance of a Model loaded through the AssetManager, so each file is parsed once and shares the
+     * model cache. GPU buffers and textures live in the RenderModel, shared with other objects of the same model.
+     *
+     * Built from a ModelStream, the object starts out empty and picks up meshes as they stream in; update(),
+     * called by the renderer every frame, uploads them and refreshes the draw list and bounds.
+     *
+     * Objects of skinned or animated models get their own Animator. Each skinned mesh has a Skin holding its
+     * joint palette, and with CPU skinning its posed vertices; the renderer uploads either after
+     * updateAnimation(). Culling keeps using the bind pose bounds.
+     */
     class RenderObject
     {
     public:
         explicit RenderObject(std::string path);
         RenderObject(std::string path, bool flipTexturesVertically);
         RenderObject(std::string path, std::shared_ptr<RenderMaterial> material, bool flipTexturesVertically);
+        RenderObject(ModelHandle model, bool flipTexturesVertically);
+        RenderObject(std::shared_ptr<ModelStream> stream, bool flipTexturesVertically);
 
+        // GL thread, once per frame. Mesh uploads spend upload_budget_ms, see RenderModel::sync().
+        void update(double& upload_budget_ms);
         void draw(Shader& shader);
 
+        // false while the model is still streaming in
+        bool isComplete() const { return m_render_model && !m_render_model->isStreaming() && !m_stream; }
+
+        // Skinned mesh of the model, in node order of first use. RenderMesh::getSkin() indexes these.
+        struct Skin
+        {
+            uint32_t                   mesh {0};
+            std::vector<glm::mat4>     joints;   // see Animator::computeJointMatrices()
+            std::vector<SkinnedVertex> vertices; // CPU skinning output, empty otherwise
+        };
+
+        // An empty name plays the first clip. Before the model is loaded the request is kept and applied once it
+        // is. Returns false if the model is loaded and has no such clip.
+        bool playAnimation(const std::string& name = "", bool loop = true);
+        // nullptr until the model is loaded, and for models with neither bones nor clips
+        Animator*       getAnimator() { return m_animator.get(); }
+        const Animator* getAnimator() const { return m_animator.get(); }
+
+        /**
+         * Advances the animator by delta_time seconds and refreshes the skins: joint palettes, and posed vertices
+         * when cpu_skinning (their ranges are split over pool). Only touches this object and its read-only model,
+         * so objects can update on worker threads, but not during update(). Returns true when the skins changed.
+         */
+        bool updateAnimation(float delta_time, bool cpu_skinning, ThreadPool* pool = nullptr);
+
+        const std::vector<Skin>& getSkins() const { return m_skins; }
+        // bumped whenever the skins are rebuilt, so GL objects made for them must be made again
+        uint64_t getSkinGeneration() const { return m_skin_generation; }
+        // bumped by every updateAnimation() that changed the skins
+        uint64_t getPoseVersion() const { return m_pose_version; }
+
+        // World transform of a node of the model, in the animator's pose when there is one. RenderMesh::getNode()
+        // indexes the nodes; the entity's model matrix applies on top.
+        const glm::mat4& getNodeTransform(uint32_t node) const;
+
+        // in node order; the renderer sorts the visible ones of all objects by material block, then mesh
+        std::vector<RenderMesh>&            getMeshes() { return m_meshes; }
+        const AABB&                         getBounds() const { return m_bounds; }
+        const std::shared_ptr<RenderModel>& getRenderModel() const { return m_render_model; }
+
     private:
-        void loadModel(std::string path, bool flipTexturesVertically);
+        void loadModel(const std::string& path, bool flipTexturesVertically);
+        void buildMeshes();
+        void addNodeMeshes(const Node& node);
+        void createAnimator();
 
-        void                     processNode(aiNode* node, const aiScene* scene);
-        RenderMesh               processMesh(aiMesh* mesh, const aiScene* scene);
-        std::shared_ptr<Texture> loadMaterialTexture(aiMaterial* material, aiTextureType type);
-        unsigned int             textureFromFile(const char* file_name, std::string directory, aiTextureType type);
+        std::vector<RenderMesh>         m_meshes;
+        std::shared_ptr<RenderModel>    m_render_model;
+        std::shared_ptr<ModelStream>    m_stream; // until the render model exists
+        std::shared_ptr<RenderMaterial> m_material_override;
+        MaterialBuffer                  m_override_buffer; // the override's block, uploaded by buildMeshes()
+        bool                            m_flip_textures {true};
+        uint64_t                        m_generation {0}; // of the render model when the meshes were built
+        AABB                            m_bounds {glm::vec3(0.0f), glm::vec3(0.0f)};
 
-        std::vector<RenderMesh>                         m_meshes;
-        std::string                                     m_directory;
-        std::map<std::string, std::shared_ptr<Texture>> m_textures_loaded;
-        std::shared_ptr<RenderMaterial>                 m_material_override;
+        std::unique_ptr<Animator> m_animator;
+        const Model*              m_animated_model {nullptr}; // the model m_animator was made for
+        std::string               m_clip;                     // requested or playing clip
+        bool                      m_clip_requested {false};
+        bool                      m_clip_loop {true};
+        std::vector<Skin>         m_skins;
+        bool                      m_skins_dirty {false}; // rebuilt, or skinned on the other side, since the last pose
+        bool                      m_cpu_skinned {false};
+        uint64_t                  m_skin_generation {0};
+        uint64_t                  m_pose_version {0};
     };
 } // namespace RealmEngine
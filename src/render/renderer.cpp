@@ -2,17 +2,39 @@
 
 #include "config_manager.h"
 #include "global_context.h"
+#include "thread_pool.h"
 #include "utils.h"
 #include "window.h"
 
 #define GLM_ENABLE_EXPERIMENTAL
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
 #include <glad/gl.h>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/quaternion.hpp>
+#include <system_error>
+#include <unordered_set>
 
 namespace RealmEngine
 {
+    namespace
+    {
+        // the JointMatrices block of pbr.vert
+        constexpr size_t JOINT_BLOCK_SIZE = MAX_MESH_BONES * sizeof(glm::mat4);
+        constexpr size_t NO_PALETTE       = std::numeric_limits<size_t>::max();
+
+        // skinningMode of pbr.vert
+        constexpr int SKINNING_NONE = 0;
+        constexpr int SKINNING_GPU  = 1;
+        constexpr int SKINNING_CPU  = 2;
+    } // namespace
+
     void Renderer::initialize(std::shared_ptr<Window> window)
     {
         m_window = window;
@@ -31,6 +53,16 @@ namespace RealmEngine
         m_camera->setPosition(glm::vec3(0.0f, 0.0f, 5.0f));
         m_camera->lookAt(glm::vec3(0.0f, 0.0f, 0.0f));
 
+        m_texture_loader = std::make_unique<TextureLoader>();
+        m_texture_loader->initialize();
+        m_texture_registry = std::make_unique<TextureRegistry>(*m_texture_loader);
+
+        GLint uniform_alignment = 0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniform_alignment);
+        if (uniform_alignment > 0)
+            m_uniform_alignment = static_cast<size_t>(uniform_alignment);
+        glGenBuffers(1, &m_joint_buffer);
+
         setupShaders();
         setupFramebuffers();
         setupIBL();
@@ -44,6 +76,17 @@ namespace RealmEngine
 
     void Renderer::disposal()
     {
+        for (auto& [object, state] : m_skinned_objects)
+            releaseCpuSkins(state);
+        m_skinned_objects.clear();
+        glDeleteBuffers(1, &m_joint_buffer);
+        m_joint_buffer = 0;
+
+        m_render_models.clear();
+        m_texture_registry->disposal();
+        m_texture_registry.reset();
+        m_texture_loader->disposal();
+        m_texture_loader.reset();
         m_pbr_shader.reset();
         m_bloom_shader.reset();
         m_post_shader.reset();
@@ -64,6 +107,9 @@ namespace RealmEngine
 
     void Renderer::render(std::shared_ptr<RenderScene> scene)
     {
+        m_texture_loader->processUploads(m_texture_upload_budget_ms);
+        m_texture_registry->collectUnused();
+
         if (!scene)
             return;
 
@@ -119,27 +165,7 @@ namespace RealmEngine
         // post stuff for main shader
         m_pbr_shader->setFloat("bloomBrightnessCutoff", m_bloom_brightness_cutoff);
 
-        // Render entities
-        for (auto& entity : scene->m_entities)
-        {
-            glm::mat4 model = glm::mat4(1.0f);
-
-            // Match reference implementation transformation order
-            auto rotation_matrix = glm::toMat4(entity.getOrientation());
-            model                = rotation_matrix * model;
-
-            model = glm::translate(model, entity.getPosition());
-            model = glm::scale(model, entity.getScale());
-
-            m_pbr_shader->setModelViewProjectionMatrices(model, view, projection);
-
-            if (auto model_ptr = entity.getObject())
-            {
-                // Ensure depth writing is enabled for models
-                glDepthMask(GL_TRUE);
-                model_ptr->draw(*m_pbr_shader);
-            }
-        }
+        renderEntities(scene, view, projection);
 
         renderSkybox();
 
@@ -153,6 +179,8 @@ namespace RealmEngine
         std::string vertex_path   = m_shader_root_path + "/pbr.vert";
         std::string fragment_path = m_shader_root_path + "/pbr.frag";
         m_pbr_shader              = std::make_unique<Shader>(vertex_path, fragment_path);
+        m_pbr_shader->bindUniformBlock("JointMatrices", UNIFORM_BINDING_JOINTS);
+        m_pbr_shader->bindUniformBlock("MaterialBlock", UNIFORM_BINDING_MATERIAL);
 
         vertex_path    = m_shader_root_path + "/bloom.vert";
         fragment_path  = m_shader_root_path + "/bloom.frag";
@@ -197,6 +225,453 @@ namespace RealmEngine
         m_skybox = std::make_unique<Skybox>(m_ibl_equirectangular_cubemap->getCubemapId());
     }
 
+    std::shared_ptr<RenderModel>
+    Renderer::getRenderModel(const ModelHandle& model, bool flip_textures, std::shared_ptr<ModelStream> stream)
+    {
+        const auto key = std::make_pair(static_cast<const Model*>(model.get()), flip_textures);
+
+        // a live RenderModel holds its Model, so the address can't have been reused
+        auto iterator = m_render_models.find(key);
+        if (iterator != m_render_models.end())
+        {
+            if (std::shared_ptr<RenderModel> render_model = iterator->second.lock())
+                return render_model;
+        }
+
+        for (auto it = m_render_models.begin(); it != m_render_models.end();)
+            it = it->second.expired() ? m_render_models.erase(it) : std::next(it);
+
+        auto render_model    = std::make_shared<RenderModel>(model, flip_textures, std::move(stream));
+        m_render_models[key] = render_model;
+        return render_model;
+    }
+
+    size_t Renderer::reloadShaders(const std::filesystem::path& path)
+    {
+        std::error_code             ec;
+        const std::filesystem::path changed = std::filesystem::weakly_canonical(path, ec);
+
+        auto usesFile = [&](const std::string& source) {
+            std::error_code error;
+            return std::filesystem::weakly_canonical(source, error) == changed;
+        };
+
+        // IBL programs only run once at startup and are not reloaded
+        size_t reloaded = 0;
+        for (std::unique_ptr<Shader>* shader : {&m_pbr_shader, &m_bloom_shader, &m_post_shader, &m_skybox_shader})
+        {
+            if (!*shader || (!usesFile((*shader)->getVertexPath()) && !usesFile((*shader)->getFragmentPath())))
+                continue;
+
+            auto rebuilt = std::make_unique<Shader>((*shader)->getVertexPath(), (*shader)->getFragmentPath());
+            if (rebuilt->getId() == 0)
+            {
+                warn("Keeping the previous program of " + (*shader)->getFragmentPath() + " until it compiles again.");
+                continue;
+            }
+
+            // uniforms are all set every frame, only the block bindings are kept by the program
+            rebuilt->bindUniformBlock("JointMatrices", UNIFORM_BINDING_JOINTS);
+            rebuilt->bindUniformBlock("MaterialBlock", UNIFORM_BINDING_MATERIAL);
+            *shader = std::move(rebuilt);
+            ++reloaded;
+        }
+        return reloaded;
+    }
+
+    size_t Renderer::replaceModel(const Model* previous, const ModelHandle& model)
+    {
+        if (!previous || !model || previous == model.get())
+            return 0;
+
+        size_t replaced = 0;
+        for (auto it = m_render_models.begin(); it != m_render_models.end();)
+        {
+            if (it->first.first != previous)
+            {
+                ++it;
+                continue;
+            }
+
+            const bool                   flip_textures = it->first.second;
+            std::shared_ptr<RenderModel> render_model  = it->second.lock();
+            it                                         = m_render_models.erase(it);
+            if (!render_model)
+                continue;
+
+            render_model->replace(model);
+            m_render_models[std::make_pair(static_cast<const Model*>(model.get()), flip_textures)] = render_model;
+            ++replaced;
+        }
+        return replaced;
+    }
+
+    void Renderer::renderEntities(const std::shared_ptr<RenderScene>& scene,
+                                  const glm::mat4&                    view,
+                                  const glm::mat4&                    projection)
+    {
+        m_stats = RenderStats {};
+
+        const Frustum& frustum = m_camera->getFrustum();
+
+        // shared by every object this frame, so streaming models can't stall it
+        double mesh_upload_budget = m_mesh_upload_budget_ms;
+
+        // streamed in or edited meshes since the last frame; all uploads first, so they don't disturb the
+        // bindings the draws below carry over from one to the next
+        for (auto& entity : scene->m_entities)
+        {
+            if (auto model_ptr = entity.getObject())
+                model_ptr->update(mesh_upload_budget);
+        }
+
+        // material samplers always read the same units, the blocks and textures are bound per material run
+        m_pbr_shader->setInt("materialTextures.albedo", TEXTURE_UNIT_ALBEDO);
+        m_pbr_shader->setInt("materialTextures.metallicRoughness", TEXTURE_UNIT_METALLIC_ROUGHNESS);
+        m_pbr_shader->setInt("materialTextures.normal", TEXTURE_UNIT_NORMAL);
+        m_pbr_shader->setInt("materialTextures.ambientOcclusion", TEXTURE_UNIT_AMBIENT_OCCLUSION);
+        m_pbr_shader->setInt("materialTextures.emissive", TEXTURE_UNIT_EMISSIVE);
+
+        m_draw_list.clear();
+        m_draw_transforms.clear();
+
+        for (auto& entity : scene->m_entities)
+        {
+            auto model_ptr = entity.getObject();
+            if (!model_ptr)
+                continue;
+
+            glm::mat4 model = entity.getModelMatrix();
+
+            // reject the whole entity first, then test its meshes one by one
+            if (m_frustum_culling_enabled && !frustum.containsAABB(model_ptr->getBounds().transform(model)))
+            {
+                m_stats.culled_entities++;
+                m_stats.culled_meshes += static_cast<uint32_t>(model_ptr->getMeshes().size());
+                continue;
+            }
+            m_stats.visible_entities++;
+
+            // skins uploaded for the draw list the object has now, if any
+            const SkinnedObject* skinned = nullptr;
+            if (model_ptr->getAnimator())
+            {
+                auto state = m_skinned_objects.find(model_ptr.get());
+                if (state != m_skinned_objects.end() &&
+                    state->second.skin_generation == model_ptr->getSkinGeneration())
+                    skinned = &state->second;
+            }
+
+            const size_t first_transform = m_draw_transforms.size();
+            uint32_t     node            = 0;
+            float        world_scale     = 1.0f;
+            for (auto& mesh : model_ptr->getMeshes())
+            {
+                // the meshes of a node come in one run, its transform is worked out at the first of them
+                if (m_draw_transforms.size() == first_transform || mesh.getNode() != node)
+                {
+                    node = mesh.getNode();
+                    m_draw_transforms.push_back(model * model_ptr->getNodeTransform(node));
+
+                    // largest axis scale, turns mesh-space LOD errors into world units
+                    const glm::mat4& node_model = m_draw_transforms.back();
+                    world_scale                 = std::max({glm::length(glm::vec3(node_model[0])),
+                                                            glm::length(glm::vec3(node_model[1])),
+                                                            glm::length(glm::vec3(node_model[2]))});
+                }
+
+                const AABB world_bounds = mesh.getBounds().transform(m_draw_transforms.back());
+                if (m_frustum_culling_enabled && !frustum.containsAABB(world_bounds))
+                {
+                    m_stats.culled_meshes++;
+                    continue;
+                }
+
+                const size_t lod = selectLod(mesh, world_bounds, world_scale);
+                m_stats.visible_meshes++;
+                m_stats.lod_meshes += lod > 0 ? 1 : 0;
+                m_stats.triangles += mesh.getLod(lod).index_count / 3;
+                m_draw_list.push_back({&mesh, skinned, m_draw_transforms.size() - 1, lod});
+            }
+        }
+
+        // across all objects, draws sharing a material block then a mesh come in one run, so only the first of a
+        // run binds them and nodes or entities reusing a mesh only change the model matrix; stable, so an
+        // object's meshes keep their node order within a run
+        std::stable_sort(m_draw_list.begin(), m_draw_list.end(), [](const DrawRecord& a, const DrawRecord& b) {
+            const RenderMesh& x = *a.mesh;
+            const RenderMesh& y = *b.mesh;
+            if (&x.getMaterialBuffer() != &y.getMaterialBuffer())
+                return std::less<const MaterialBuffer*>()(&x.getMaterialBuffer(), &y.getMaterialBuffer());
+            if (x.getMaterialBlock() != y.getMaterialBlock())
+                return x.getMaterialBlock() < y.getMaterialBlock();
+            if (&x.getMeshBuffers() != &y.getMeshBuffers())
+                return std::less<const MeshBuffers*>()(&x.getMeshBuffers(), &y.getMeshBuffers());
+            return a.transform < b.transform;
+        });
+
+        // Ensure depth writing is enabled for models
+        glDepthMask(GL_TRUE);
+
+        DrawState draw_state;
+        size_t    transform = m_draw_transforms.size(); // none set yet
+        m_skinning_uniform  = -1;
+
+        for (const DrawRecord& record : m_draw_list)
+        {
+            if (record.transform != transform)
+            {
+                transform = record.transform;
+                m_pbr_shader->setModelViewProjectionMatrices(m_draw_transforms[transform], view, projection);
+            }
+            record.mesh->draw(*m_pbr_shader, draw_state, record.lod, bindSkin(record.skinned, *record.mesh));
+        }
+        glBindVertexArray(0);
+    }
+
+    void Renderer::updateAnimations(const std::shared_ptr<RenderScene>& scene, float delta_time)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        const Clock::time_point start = Clock::now();
+        m_animation_stats             = AnimationStats {};
+
+        for (auto it = m_skinned_objects.begin(); it != m_skinned_objects.end();)
+        {
+            if (!it->second.object.expired())
+            {
+                ++it;
+                continue;
+            }
+            releaseCpuSkins(it->second);
+            it = m_skinned_objects.erase(it);
+        }
+        if (!scene)
+            return;
+
+        const bool cpu_skinning = m_skinning_mode == SkinningMode::CPU;
+
+        std::vector<std::shared_ptr<RenderObject>> objects;
+        std::unordered_set<const RenderObject*>    seen;
+        for (auto& entity : scene->m_entities)
+        {
+            std::shared_ptr<RenderObject> object = entity.getObject();
+            if (!object || !object->getAnimator() || !seen.insert(object.get()).second)
+                continue;
+            // bind poses are extracted here, workers only read them
+            if (cpu_skinning)
+                object->getRenderModel()->prepareBindPoses();
+            objects.push_back(std::move(object));
+        }
+
+        // one object per task, the vertices of large skins are split again by the kernels
+        ThreadPool*          pool = g_context.m_thread_pool.get();
+        std::vector<uint8_t> posed(objects.size(), 0);
+        auto                 animate = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                posed[i] = objects[i]->updateAnimation(delta_time, cpu_skinning, pool) ? 1 : 0;
+        };
+        if (pool)
+            pool->parallelFor(0, objects.size(), 1, animate);
+        else
+            animate(0, objects.size());
+
+        bool layout_changed = false;
+        for (size_t i = 0; i < objects.size(); ++i)
+        {
+            const RenderObject& object = *objects[i];
+            SkinnedObject&      state  = m_skinned_objects[&object];
+
+            // expired entries were dropped above, so this one is new
+            if (state.object.expired())
+            {
+                state        = SkinnedObject {};
+                state.object = objects[i];
+            }
+            if (state.skin_generation != object.getSkinGeneration())
+            {
+                releaseCpuSkins(state);
+                state.skin_generation = object.getSkinGeneration();
+                layout_changed        = true;
+            }
+
+            m_animation_stats.animated_objects++;
+            m_animation_stats.posed_objects += posed[i];
+            m_animation_stats.skinned_meshes += static_cast<uint32_t>(object.getSkins().size());
+
+            if (cpu_skinning)
+                uploadCpuSkins(state, object);
+            else if (!state.cpu_vaos.empty())
+                releaseCpuSkins(state);
+        }
+
+        if (!cpu_skinning && (layout_changed || m_animation_stats.posed_objects > 0))
+            uploadJointPalettes(objects);
+
+        m_animation_stats.update_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    void Renderer::uploadJointPalettes(const std::vector<std::shared_ptr<RenderObject>>& objects)
+    {
+        // palettes are packed at the uniform offset alignment; the range bound for one spans a whole block and
+        // may run into the next palettes, which the shader never indexes
+        size_t size = 0;
+        for (const auto& object : objects)
+        {
+            SkinnedObject& state = m_skinned_objects[object.get()];
+            const auto&    skins = object->getSkins();
+            state.joint_offsets.assign(skins.size(), NO_PALETTE);
+            for (size_t i = 0; i < skins.size(); ++i)
+            {
+                const size_t bytes = skins[i].joints.size() * sizeof(glm::mat4);
+                if (bytes == 0 || bytes > JOINT_BLOCK_SIZE)
+                    continue;
+                state.joint_offsets[i] = size;
+                size += (bytes + m_uniform_alignment - 1) / m_uniform_alignment * m_uniform_alignment;
+            }
+        }
+        if (size == 0)
+            return;
+
+        size += JOINT_BLOCK_SIZE;
+        m_joint_staging.resize(size);
+        for (const auto& object : objects)
+        {
+            const SkinnedObject& state = m_skinned_objects[object.get()];
+            const auto&          skins = object->getSkins();
+            for (size_t i = 0; i < skins.size(); ++i)
+            {
+                if (state.joint_offsets[i] != NO_PALETTE)
+                    std::memcpy(m_joint_staging.data() + state.joint_offsets[i],
+                                skins[i].joints.data(),
+                                skins[i].joints.size() * sizeof(glm::mat4));
+            }
+        }
+
+        // one upload for every palette, orphaning the buffer the previous frame may still be reading
+        glBindBuffer(GL_UNIFORM_BUFFER, m_joint_buffer);
+        glBufferData(GL_UNIFORM_BUFFER, size, m_joint_staging.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        m_animation_stats.upload_bytes += size;
+    }
+
+    void Renderer::uploadCpuSkins(SkinnedObject& state, const RenderObject& object)
+    {
+        const auto& skins = object.getSkins();
+        if (state.cpu_vaos.size() != skins.size())
+        {
+            releaseCpuSkins(state);
+            state.cpu_vaos.resize(skins.size());
+            state.cpu_vbos.resize(skins.size());
+            state.cpu_vertex_counts.assign(skins.size(), 0);
+            glGenBuffers(static_cast<GLsizei>(skins.size()), state.cpu_vbos.data());
+            for (size_t i = 0; i < skins.size(); ++i)
+                state.cpu_vaos[i] =
+                    object.getRenderModel()->getMeshBuffers(skins[i].mesh).createCpuSkinnedArray(state.cpu_vbos[i]);
+        }
+
+        if (state.pose_version == object.getPoseVersion())
+            return;
+        state.pose_version = object.getPoseVersion();
+
+        for (size_t i = 0; i < skins.size(); ++i)
+        {
+            const std::vector<SkinnedVertex>& vertices = skins[i].vertices;
+            state.cpu_vertex_counts[i]                 = vertices.size();
+            if (vertices.empty())
+                continue;
+
+            const size_t bytes = vertices.size() * sizeof(SkinnedVertex);
+            glBindBuffer(GL_ARRAY_BUFFER, state.cpu_vbos[i]);
+            glBufferData(GL_ARRAY_BUFFER, bytes, vertices.data(), GL_STREAM_DRAW);
+            m_animation_stats.skinned_vertices += vertices.size();
+            m_animation_stats.upload_bytes += bytes;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void Renderer::releaseCpuSkins(SkinnedObject& state)
+    {
+        if (!state.cpu_vaos.empty())
+        {
+            glDeleteVertexArrays(static_cast<GLsizei>(state.cpu_vaos.size()), state.cpu_vaos.data());
+            glDeleteBuffers(static_cast<GLsizei>(state.cpu_vbos.size()), state.cpu_vbos.data());
+        }
+        state.cpu_vaos.clear();
+        state.cpu_vbos.clear();
+        state.cpu_vertex_counts.clear();
+        state.pose_version = 0;
+    }
+
+    unsigned int Renderer::bindSkin(const SkinnedObject* state, const RenderMesh& mesh)
+    {
+        // meshes whose skin isn't uploaded yet are drawn in their bind pose
+        const int32_t skin = mesh.getSkin();
+        if (!state || skin < 0)
+        {
+            setSkinningUniform(SKINNING_NONE);
+            return 0;
+        }
+
+        const size_t index = static_cast<size_t>(skin);
+        if (m_skinning_mode == SkinningMode::GPU && index < state->joint_offsets.size() &&
+            state->joint_offsets[index] != NO_PALETTE)
+        {
+            glBindBufferRange(GL_UNIFORM_BUFFER,
+                              UNIFORM_BINDING_JOINTS,
+                              m_joint_buffer,
+                              state->joint_offsets[index],
+                              JOINT_BLOCK_SIZE);
+            setSkinningUniform(SKINNING_GPU);
+            return 0;
+        }
+        if (m_skinning_mode == SkinningMode::CPU && index < state->cpu_vertex_counts.size() &&
+            state->cpu_vertex_counts[index] > 0)
+        {
+            setSkinningUniform(SKINNING_CPU);
+            return state->cpu_vaos[index];
+        }
+
+        setSkinningUniform(SKINNING_NONE);
+        return 0;
+    }
+
+    void Renderer::setSkinningUniform(int mode)
+    {
+        if (mode == m_skinning_uniform)
+            return;
+        m_pbr_shader->setInt("skinningMode", mode);
+        m_skinning_uniform = mode;
+    }
+
+    size_t Renderer::selectLod(const RenderMesh& mesh, const AABB& world_bounds, float world_scale) const
+    {
+        if (!m_lod_enabled || mesh.getLodCount() <= 1)
+            return 0;
+
+        // world units -> pixels: proj[1][1] is 1 / tan(fov / 2) in perspective, 2 / height in orthographic
+        const glm::mat4& projection      = m_camera->getProjMatrix();
+        float            pixels_per_unit = projection[1][1] * 0.5f * static_cast<float>(m_window->getHeight());
+        if (m_camera->getProjectionType() == ProjectionType::Perspective)
+        {
+            // distance to the closest point of the bounds, so large meshes aren't coarsened right next to the camera
+            const glm::vec3& eye      = m_camera->getPosition();
+            const float      distance = glm::length(glm::clamp(eye, world_bounds.min, world_bounds.max) - eye);
+            if (distance <= m_camera->getNearPlane())
+                return 0;
+            pixels_per_unit /= distance;
+        }
+
+        size_t lod = 0;
+        for (size_t i = 1; i < mesh.getLodCount(); ++i)
+        {
+            if (mesh.getLod(i).error * world_scale * pixels_per_unit > m_lod_error_threshold)
+                break;
+            lod = i;
+        }
+        return lod;
+    }
+
     void Renderer::renderSkybox()
     {
         // Skybox pass
@@ -1,8 +1,14 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <filesystem>
+#include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include "render/bloom_framebuffer.h"
 #include "render/framebuffer.h"
 #include "render/fullscreen_quad.h"
@@ -10,9 +16,14 @@
 #include "render/ibl/equirectangular_cubemap.h"
 #include "render/ibl/specular_map.h"
 #include "render/render_camera.h"
+#include "render/render_mesh.h"
+#include "render/render_model.h"
+#include "render/render_object.h"
 #include "render/render_scene.h"
 #include "render/shader.h"
 #include "render/skybox.h"
+#include "render/texture_loader.h"
+#include "render/texture_registry.h"
 
 namespace RealmEngine
 {
@@ -25,11 +36,42 @@ namespace RealmEngine
         VERTICAL   = 2
     };
 
+    // Per-frame visibility counters, reset at the start of every render().
+    struct RenderStats
+    {
+        uint32_t visible_entities {0};
+        uint32_t culled_entities {0};
+        uint32_t visible_meshes {0};
+        uint32_t culled_meshes {0};
+        uint32_t lod_meshes {0}; // visible meshes drawn below LOD 0
+        uint64_t triangles {0};
+    };
+
+    enum class SkinningMode : uint8_t
+    {
+        GPU = 0, // joint palettes in a uniform buffer, vertices skinned by pbr.vert
+        CPU = 1  // vertices skinned by SkinningKernels on the thread pool and streamed to the GPU
+    };
+
+    // Per-frame animation counters, reset by every updateAnimations().
+    struct AnimationStats
+    {
+        uint32_t animated_objects {0};
+        uint32_t posed_objects {0}; // whose pose changed this frame
+        uint32_t skinned_meshes {0};
+        uint64_t skinned_vertices {0}; // CPU skinning only
+        size_t   upload_bytes {0};     // joint palettes or skinned vertices sent to the GPU
+        double   update_ms {0.0};
+    };
+
     // IBL texture units
     static const int TEXTURE_UNIT_DIFFUSE_IRRADIANCE_MAP = 10;
     static const int TEXTURE_UNIT_PREFILTERED_ENV_MAP    = 11;
     static const int TEXTURE_UNIT_BRDF_CONVOLUTION_MAP   = 12;
 
+    // uniform buffer binding points, UNIFORM_BINDING_MATERIAL is with the MaterialBlock in render_material.h
+    static const unsigned int UNIFORM_BINDING_JOINTS = 0;
+
     class Renderer
     {
     public:
@@ -45,13 +87,90 @@ namespace RealmEngine
         void disposal();
         void render(std::shared_ptr<RenderScene> scene);
 
+        /**
+         * Advances the animated objects of scene by delta_time seconds, once per object however many entities
+         * show it, and uploads their skins for the next render(). Objects are posed, and with CPU skinning
+         * skinned, in parallel on the thread pool; only the uploads run on the calling GL thread.
+         */
+        void updateAnimations(const std::shared_ptr<RenderScene>& scene, float delta_time);
+
         std::shared_ptr<RenderCamera> getCamera() const { return m_camera; }
+        const RenderStats&            getStats() const { return m_stats; }
+        const AnimationStats&         getAnimationStats() const { return m_animation_stats; }
+        TextureLoader&                getTextureLoader() { return *m_texture_loader; }
+        TextureRegistry&              getTextureRegistry() { return *m_texture_registry; }
+        // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, what ranges bound from uniform buffers must start at
+        size_t getUniformAlignment() const { return m_uniform_alignment; }
+
+        // The GPU copy of model shared by every RenderObject built from it, created and uploaded on first use.
+        // With a stream, the model is still importing and its meshes are uploaded as they become ready.
+        std::shared_ptr<RenderModel> getRenderModel(const ModelHandle&           model,
+                                                    bool                         flip_textures,
+                                                    std::shared_ptr<ModelStream> stream = nullptr);
+
+        // Hot reload, GL thread only. Recompiles every program built from the file; one that fails to compile keeps
+        // its previous program. Returns the number of programs replaced.
+        size_t reloadShaders(const std::filesystem::path& path);
+        // Moves the GPU copies of previous over to model, a re-import of the same file, between two frames.
+        size_t replaceModel(const Model* previous, const ModelHandle& model);
+
+        // GL time per frame spent uploading textures decoded in the background
+        void  setTextureUploadBudget(float milliseconds) { m_texture_upload_budget_ms = milliseconds; }
+        float getTextureUploadBudget() const { return m_texture_upload_budget_ms; }
+        // GL time per frame spent uploading meshes of models streaming in
+        void  setMeshUploadBudget(float milliseconds) { m_mesh_upload_budget_ms = milliseconds; }
+        float getMeshUploadBudget() const { return m_mesh_upload_budget_ms; }
+
+        void         setSkinningMode(SkinningMode mode) { m_skinning_mode = mode; }
+        SkinningMode getSkinningMode() const { return m_skinning_mode; }
+
+        void setFrustumCullingEnabled(bool enabled) { m_frustum_culling_enabled = enabled; }
+        bool isFrustumCullingEnabled() const { return m_frustum_culling_enabled; }
+
+        // The coarsest LOD whose simplification error projects to at most this many pixels is drawn.
+        void  setLodEnabled(bool enabled) { m_lod_enabled = enabled; }
+        bool  isLodEnabled() const { return m_lod_enabled; }
+        void  setLodErrorThreshold(float pixels) { m_lod_error_threshold = pixels; }
+        float getLodErrorThreshold() const { return m_lod_error_threshold; }
 
     private:
+        // GL side of the skins of one animated RenderObject, indexed like RenderObject::getSkins()
+        struct SkinnedObject
+        {
+            std::weak_ptr<RenderObject> object;
+            uint64_t                    skin_generation {0};
+            uint64_t                    pose_version {0}; // last pose uploaded by CPU skinning
+            std::vector<unsigned int>   cpu_vaos;
+            std::vector<unsigned int>   cpu_vbos;
+            std::vector<size_t>         cpu_vertex_counts; // 0 until a skinned pose was uploaded
+            std::vector<size_t>         joint_offsets;     // into m_joint_buffer, SIZE_MAX for no palette
+        };
+
+        // one visible mesh of the frame, at the LOD it is drawn with
+        struct DrawRecord
+        {
+            const RenderMesh*    mesh;
+            const SkinnedObject* skinned;
+            size_t               transform; // into m_draw_transforms, entity matrix times node world transform
+            size_t               lod;
+        };
+
         void setupShaders();
         void setupFramebuffers();
         void setupIBL();
 
+        void   renderEntities(const std::shared_ptr<RenderScene>& scene,
+                              const glm::mat4&                    view,
+                              const glm::mat4&                    projection);
+        size_t selectLod(const RenderMesh& mesh, const AABB& world_bounds, float world_scale) const;
+
+        void uploadJointPalettes(const std::vector<std::shared_ptr<RenderObject>>& objects);
+        void uploadCpuSkins(SkinnedObject& state, const RenderObject& object);
+        void releaseCpuSkins(SkinnedObject& state);
+        // Sets skinningMode and binds the skin of mesh, if any. Returns the vertex array to draw it with.
+        unsigned int bindSkin(const SkinnedObject* state, const RenderMesh& mesh);
+        // skinningMode, only when it differs from what the previous draw set
+        void setSkinningUniform(int mode);
         void renderSkybox();
         void renderBloom();
         void renderPostprocess();
@@ -66,6 +185,30 @@ namespace RealmEngine
         std::shared_ptr<RenderScene>  m_scene;
         std::shared_ptr<RenderCamera> m_camera;
 
+        RenderStats m_stats;
+        bool        m_frustum_culling_enabled {true};
+        bool        m_lod_enabled {true};
+        float       m_lod_error_threshold {1.0f};
+
+        std::unique_ptr<TextureLoader>   m_texture_loader;
+        std::unique_ptr<TextureRegistry> m_texture_registry;
+        float                            m_texture_upload_budget_ms {2.0f};
+        float                            m_mesh_upload_budget_ms {2.0f};
+
+        std::map<std::pair<const Model*, bool>, std::weak_ptr<RenderModel>> m_render_models;
+
+        SkinningMode                                           m_skinning_mode {SkinningMode::GPU};
+        AnimationStats                                         m_animation_stats;
+        std::unordered_map<const RenderObject*, SkinnedObject> m_skinned_objects;
+        unsigned int                                           m_joint_buffer {0};
+        size_t                                                 m_uniform_alignment {256};
+        std::vector<uint8_t>                                   m_joint_staging;
+        int                                                    m_skinning_uniform {-1}; // -1: unknown
+
+        // kept between frames so building the draw list doesn't allocate
+        std::vector<DrawRecord> m_draw_list;
+        std::vector<glm::mat4>  m_draw_transforms;
+
         std::string m_shader_root_path;
         std::string m_engine_root_path;
         std::string m_hdri_path;
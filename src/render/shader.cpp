@@ -9,7 +9,8 @@
 
 namespace RealmEngine
 {
-    Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath)
+    Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath) :
+        m_vertex_path(vertexPath), m_fragment_path(fragmentPath)
     {
         // load shaders
         std::string   vertex_code;
@@ -99,6 +100,7 @@ namespace RealmEngine
             err(std::string(info_log));
             glDeleteShader(vertex);
             glDeleteShader(fragment);
+            glDeleteProgram(m_id);
             m_id = 0;
             return;
         }
@@ -150,6 +152,13 @@ namespace RealmEngine
         glUniformMatrix4fv(glGetUniformLocation(m_id, name.c_str()), 1, GL_FALSE, &value[0][0]);
     }
 
+    void Shader::bindUniformBlock(const std::string& name, unsigned int binding) const
+    {
+        const unsigned int index = glGetUniformBlockIndex(m_id, name.c_str());
+        if (index != GL_INVALID_INDEX)
+            glUniformBlockBinding(m_id, index, binding);
+    }
+
     void Shader::setModelViewProjectionMatrices(const glm::mat4& model,
                                                 const glm::mat4& view,
                                                 const glm::mat4& projection) const
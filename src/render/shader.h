@@ -26,13 +26,20 @@ namespace RealmEngine
         void setVec3(const std::string& name, const glm::vec3& value) const;
         void setVec3Array(const std::string& name, const std::vector<glm::vec3>& values) const;
         void setMat4(const std::string& name, const glm::mat4& value) const;
+        // Points the uniform block at a buffer binding point; blocks the program doesn't use are ignored.
+        void bindUniformBlock(const std::string& name, unsigned int binding) const;
         void setModelViewProjectionMatrices(const glm::mat4& model,
                                             const glm::mat4& view,
                                             const glm::mat4& projection) const;
 
-        unsigned int getId() const { return m_id; }
+        // 0 if the sources failed to load, compile or link
+        unsigned int       getId() const { return m_id; }
+        const std::string& getVertexPath() const { return m_vertex_path; }
+        const std::string& getFragmentPath() const { return m_fragment_path; }
 
     private:
         unsigned int m_id;
+        std::string  m_vertex_path;
+        std::string  m_fragment_path;
     };
 } // namespace RealmEngine
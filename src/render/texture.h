@@ -1,12 +1,17 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 
 namespace RealmEngine
 {
     struct Texture
     {
-        unsigned int m_id;
-        std::string  m_path; // used to de-dupe textures loaded
+        unsigned int m_id {0};        // a placeholder until the image is resident
+        std::string  m_path;          // normalized source path, the registry key
+        bool         m_resident {false};
+        int          m_width {0};
+        int          m_height {0};
+        size_t       m_gpu_bytes {0}; // mip chain included, 0 until resident
     };
 } // namespace RealmEngine
@@ -0,0 +1,487 @@
+#include "render/texture_loader.h"
+
+#include <cstring>
+#include <glad/gl.h>
+#include <stb/stb_image.h>
+#include <utility>
+#include "global_context.h"
+#include "hash.h"
+#include "resource/asset_manager.h"
+#include "thread_pool.h"
+#include "utils.h"
+
+namespace RealmEngine
+{
+    namespace
+    {
+        double millisecondsBetween(std::chrono::steady_clock::time_point begin,
+                                   std::chrono::steady_clock::time_point end)
+        {
+            return std::chrono::duration<double, std::milli>(end - begin).count();
+        }
+
+        std::string formatMilliseconds(double ms) { return std::to_string(static_cast<int64_t>(ms + 0.5)) + " ms"; }
+
+        // extension formats, not in the GL 3.3 core header
+        constexpr GLenum COMPRESSED_RGB_S3TC_DXT1         = 0x83F0;
+        constexpr GLenum COMPRESSED_RGBA_S3TC_DXT5        = 0x83F3;
+        constexpr GLenum COMPRESSED_SRGB_S3TC_DXT1        = 0x8C4C;
+        constexpr GLenum COMPRESSED_SRGB_ALPHA_S3TC_DXT5  = 0x8C4F;
+        constexpr GLenum COMPRESSED_RGBA_BPTC_UNORM       = 0x8E8C;
+        constexpr GLenum COMPRESSED_SRGB_ALPHA_BPTC_UNORM = 0x8E8D;
+
+        GLenum getCompressedFormat(TextureFormat format, bool srgb)
+        {
+            switch (format)
+            {
+                case TextureFormat::BC1:
+                    return srgb ? COMPRESSED_SRGB_S3TC_DXT1 : COMPRESSED_RGB_S3TC_DXT1;
+                case TextureFormat::BC3:
+                    return srgb ? COMPRESSED_SRGB_ALPHA_S3TC_DXT5 : COMPRESSED_RGBA_S3TC_DXT5;
+                case TextureFormat::BC4:
+                    return GL_COMPRESSED_RED_RGTC1;
+                case TextureFormat::BC5:
+                    return GL_COMPRESSED_RG_RGTC2;
+                case TextureFormat::BC7:
+                    return srgb ? COMPRESSED_SRGB_ALPHA_BPTC_UNORM : COMPRESSED_RGBA_BPTC_UNORM;
+                case TextureFormat::RGBA8:
+                    break;
+            }
+            return 0;
+        }
+
+        bool hasTransparentTexels(const unsigned char* rgba, size_t texel_count)
+        {
+            for (size_t i = 0; i < texel_count; ++i)
+                if (rgba[i * 4 + 3] != 255)
+                    return true;
+            return false;
+        }
+    } // namespace
+
+    void TextureLoader::PixelDeleter::operator()(unsigned char* pixels) const { stbi_image_free(pixels); }
+
+    void TextureLoader::initialize()
+    {
+        GLint extension_count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &extension_count);
+        for (GLint i = 0; i < extension_count; ++i)
+        {
+            const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+            if (!name)
+                continue;
+            if (std::strcmp(name, "GL_EXT_texture_compression_s3tc") == 0)
+                m_supports_s3tc = true;
+            else if (std::strcmp(name, "GL_EXT_texture_sRGB") == 0 ||
+                     std::strcmp(name, "GL_EXT_texture_compression_s3tc_srgb") == 0)
+                m_supports_s3tc_srgb = true;
+            else if (std::strcmp(name, "GL_ARB_texture_compression_bptc") == 0)
+                m_supports_bptc = true;
+        }
+        m_supports_s3tc_srgb = m_supports_s3tc && m_supports_s3tc_srgb;
+
+        info(std::string("Texture compression: S3TC ") + (m_supports_s3tc ? "yes" : "no") + ", BPTC " +
+             (m_supports_bptc ? "yes" : "no") + ", RGTC yes");
+
+        // neutral values, so an untextured frame looks like a plain matte material
+        const unsigned char colors[static_cast<size_t>(TextureUsage::Count)][4] = {
+            {128, 128, 128, 255}, // albedo
+            {0, 255, 0, 255},     // metallic (b) 0, roughness (g) 1
+            {128, 128, 255, 255}, // flat tangent space normal
+            {255, 255, 255, 255}, // no occlusion
+            {0, 0, 0, 255},       // no emission
+        };
+
+        glGenTextures(static_cast<GLsizei>(m_placeholders.size()), m_placeholders.data());
+        for (size_t i = 0; i < m_placeholders.size(); ++i)
+        {
+            glBindTexture(GL_TEXTURE_2D, m_placeholders[i]);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, colors[i]);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    void TextureLoader::disposal()
+    {
+        {
+            // decode tasks hold a pointer to us
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_decode_done.wait(lock, [this]() { return m_decoding == 0; });
+            m_decoded.clear();
+        }
+
+        glDeleteTextures(static_cast<GLsizei>(m_placeholders.size()), m_placeholders.data());
+        m_placeholders = {};
+    }
+
+    std::shared_ptr<Texture>
+    TextureLoader::load(const std::string& path, TextureUsage usage, bool srgb, bool flip_vertically)
+    {
+        auto texture    = std::make_shared<Texture>();
+        texture->m_id   = m_placeholders[static_cast<size_t>(usage)];
+        texture->m_path = path;
+
+        reload(texture, path, usage, srgb, flip_vertically);
+        return texture;
+    }
+
+    void TextureLoader::reload(const std::shared_ptr<Texture>& texture,
+                               const std::string&              path,
+                               TextureUsage                    usage,
+                               bool                            srgb,
+                               bool                            flip_vertically)
+    {
+        DecodedImage image;
+        image.texture   = texture;
+        image.usage     = usage;
+        image.srgb      = srgb;
+        image.requested = Clock::now();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_batch_open)
+            {
+                m_batch_open  = true;
+                m_batch_start = image.requested;
+                m_batch_base  = m_stats;
+            }
+            ++m_decoding;
+            ++m_stats.requested;
+        }
+
+        ThreadPool* pool = g_context.m_thread_pool.get();
+        if (pool)
+            pool->submit([this, path, image = std::move(image), flip_vertically]() mutable {
+                decode(path, std::move(image), flip_vertically);
+            });
+        else
+            decode(path, std::move(image), flip_vertically);
+    }
+
+    TextureFormat TextureLoader::pickFormat(TextureUsage usage, bool srgb, bool has_alpha) const
+    {
+        const bool s3tc = srgb ? m_supports_s3tc_srgb : m_supports_s3tc;
+        const bool bptc = m_supports_bptc;
+
+        switch (usage)
+        {
+            case TextureUsage::Albedo:
+            case TextureUsage::MetallicRoughness:
+                if (bptc && (m_high_quality_compression || !s3tc))
+                    return TextureFormat::BC7;
+                if (s3tc)
+                    return has_alpha && usage == TextureUsage::Albedo ? TextureFormat::BC3 : TextureFormat::BC1;
+                break;
+            case TextureUsage::Normal:
+                return TextureFormat::BC5; // z is rebuilt in the shader
+            case TextureUsage::AmbientOcclusion:
+                return TextureFormat::BC4;
+            case TextureUsage::Emissive:
+                if (s3tc)
+                    return TextureFormat::BC1;
+                if (bptc)
+                    return TextureFormat::BC7;
+                break;
+            case TextureUsage::Count:
+                break;
+        }
+        return TextureFormat::RGBA8;
+    }
+
+    void TextureLoader::decode(const std::string& path, DecodedImage image, bool flip_vertically)
+    {
+        if (m_compression_enabled)
+        {
+            decodeCompressed(path, image, flip_vertically);
+        }
+        else
+        {
+            const Clock::time_point start = Clock::now();
+
+            // the global flag is shared with loads on other threads
+            stbi_set_flip_vertically_on_load_thread(flip_vertically ? 1 : 0);
+            image.pixels.reset(stbi_load(path.c_str(), &image.width, &image.height, &image.channels, 0));
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.decode_ms += millisecondsBetween(start, Clock::now());
+        }
+
+        if (!image.pixels && !image.compressed)
+        {
+            const char* reason = stbi_failure_reason();
+            err("Failed to load texture data: " + path + (reason ? " (" + std::string(reason) + ")" : ""));
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (image.pixels || image.compressed)
+            m_decoded.push_back(std::move(image));
+        else
+            ++m_stats.failed;
+        --m_decoding;
+        m_decode_done.notify_all();
+    }
+
+    void TextureLoader::decodeCompressed(const std::string& path, DecodedImage& image, bool flip_vertically)
+    {
+        TextureCache& cache = g_context.m_assets->getTextureCache();
+
+        // everything the cooked result depends on besides the source bytes
+        uint64_t options = Hash::combine(static_cast<uint64_t>(image.usage), image.srgb ? 1 : 0);
+        options          = Hash::combine(options, flip_vertically ? 1 : 0);
+        options          = Hash::combine(options, m_high_quality_compression ? 1 : 0);
+        options          = Hash::combine(options, (m_supports_s3tc ? 1 : 0) | (m_supports_s3tc_srgb ? 2 : 0) |
+                                             (m_supports_bptc ? 4 : 0));
+        const uint64_t key = cache.isEnabled() ? cache.computeKey(path, options) : 0;
+
+        if (std::unique_ptr<CompressedTexture> cooked = cache.load(key))
+        {
+            debug("Loaded cooked texture: " + path);
+            image.width      = static_cast<int>(cooked->levels[0].width);
+            image.height     = static_cast<int>(cooked->levels[0].height);
+            image.compressed = std::move(cooked);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_stats.cache_hits;
+            return;
+        }
+
+        const Clock::time_point decode_start = Clock::now();
+
+        // the global flag is shared with loads on other threads
+        stbi_set_flip_vertically_on_load_thread(flip_vertically ? 1 : 0);
+        image.pixels.reset(stbi_load(path.c_str(), &image.width, &image.height, &image.channels, 4));
+        image.channels = 4;
+
+        const Clock::time_point encode_start = Clock::now();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.decode_ms += millisecondsBetween(decode_start, encode_start);
+        }
+        if (!image.pixels)
+            return;
+
+        const size_t        texel_count = static_cast<size_t>(image.width) * image.height;
+        const TextureFormat format =
+            pickFormat(image.usage, image.srgb, hasTransparentTexels(image.pixels.get(), texel_count));
+        if (format == TextureFormat::RGBA8)
+            return;
+
+        TextureEncoder::Settings settings;
+        settings.format     = format;
+        settings.srgb       = image.srgb;
+        settings.normal_map = image.usage == TextureUsage::Normal;
+
+        CompressedTexture encoded = TextureEncoder::encode(image.pixels.get(),
+                                                           static_cast<uint32_t>(image.width),
+                                                           static_cast<uint32_t>(image.height),
+                                                           settings,
+                                                           g_context.m_thread_pool.get());
+        image.compressed          = std::make_unique<CompressedTexture>(std::move(encoded));
+        image.pixels.reset();
+
+        const double encode_ms = millisecondsBetween(encode_start, Clock::now());
+        debug("Encoded texture: " + path + " (" + std::to_string(image.width) + "x" + std::to_string(image.height) +
+              ", " + formatMilliseconds(encode_ms) + ")");
+        cache.store(key, *image.compressed);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.encoded;
+        m_stats.encode_ms += encode_ms;
+    }
+
+    void TextureLoader::processUploads(double budget_ms)
+    {
+        const Clock::time_point start = Clock::now();
+
+        for (;;)
+        {
+            DecodedImage image;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_decoded.empty())
+                    break;
+                image = std::move(m_decoded.front());
+                m_decoded.pop_front();
+            }
+
+            const Clock::time_point upload_start = Clock::now();
+            const bool              uploaded     = image.compressed ? uploadCompressed(image) : upload(image);
+            const Clock::time_point now          = Clock::now();
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (uploaded)
+                {
+                    ++m_stats.uploaded;
+                    m_stats.upload_ms += millisecondsBetween(upload_start, now);
+                    m_stats.latency_ms += millisecondsBetween(image.requested, now);
+                    m_stats.uploaded_bytes += image.compressed ?
+                                                  image.compressed->getDataSize() :
+                                                  static_cast<size_t>(image.width) * image.height * image.channels;
+                }
+                else
+                {
+                    ++m_stats.failed;
+                }
+            }
+
+            if (millisecondsBetween(start, now) >= budget_ms)
+                break;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        closeBatchIfIdle();
+    }
+
+    void TextureLoader::closeBatchIfIdle()
+    {
+        if (!m_batch_open || m_decoding != 0 || !m_decoded.empty())
+            return;
+        m_batch_open = false;
+
+        const uint32_t uploaded   = m_stats.uploaded - m_batch_base.uploaded;
+        const uint32_t failed     = m_stats.failed - m_batch_base.failed;
+        const uint32_t cache_hits = m_stats.cache_hits - m_batch_base.cache_hits;
+        const uint32_t encoded    = m_stats.encoded - m_batch_base.encoded;
+        info("Loaded " + std::to_string(uploaded) + " textures" +
+             (failed ? " (" + std::to_string(failed) + " failed)" : "") + " in " +
+             formatMilliseconds(millisecondsBetween(m_batch_start, Clock::now())) + ": decode " +
+             formatMilliseconds(m_stats.decode_ms - m_batch_base.decode_ms) + " and encode " +
+             formatMilliseconds(m_stats.encode_ms - m_batch_base.encode_ms) + " on workers (" +
+             std::to_string(encoded) + " encoded, " + std::to_string(cache_hits) + " cached), upload " +
+             formatMilliseconds(m_stats.upload_ms - m_batch_base.upload_ms) + " on the GL thread, " +
+             std::to_string((m_stats.uploaded_bytes - m_batch_base.uploaded_bytes) >> 10) + " KB");
+    }
+
+    bool TextureLoader::upload(DecodedImage& image)
+    {
+        GLenum format;
+
+        switch (image.channels)
+        {
+            case 1:
+                format = GL_RED;
+                break;
+            case 3:
+                format = GL_RGB;
+                break;
+            case 4:
+                format = GL_RGBA;
+                break;
+            default:
+                err("Unsupported texture format with " + std::to_string(image.channels) + " channels: " +
+                    image.texture->m_path);
+                return false;
+        }
+
+        GLenum internal_format = format;
+
+        // account for sRGB textures here
+        //
+        // diffuse textures are in sRGB space (non-linear)
+        // metallic/roughness/normals are usually in linear
+        // AO depends
+        if (image.srgb)
+        {
+            if (internal_format == GL_RGB)
+            {
+                internal_format = GL_SRGB;
+            }
+            else if (internal_format == GL_RGBA)
+            {
+                internal_format = GL_SRGB_ALPHA;
+            }
+        }
+
+        unsigned int texture_id;
+        glGenTextures(1, &texture_id);
+        glBindTexture(GL_TEXTURE_2D, texture_id);
+
+        // generate the texture mipmap
+        glTexImage2D(GL_TEXTURE_2D,
+                     0,
+                     internal_format,
+                     image.width,
+                     image.height,
+                     0,
+                     format,
+                     GL_UNSIGNED_BYTE,
+                     image.pixels.get());
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR); // image is resized using bilinear filtering
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // image is enlarged using bilinear filtering
+
+        // drivers pad RGB to four bytes, and the generated mips add a third
+        const size_t texel_bytes = image.channels == 3 ? 4 : static_cast<size_t>(image.channels);
+        const size_t level_bytes = static_cast<size_t>(image.width) * image.height * texel_bytes;
+
+        // a reload replaces the image in place, its users bind the new id on their next draw
+        if (image.texture->m_resident)
+            glDeleteTextures(1, &image.texture->m_id);
+
+        image.texture->m_id        = texture_id;
+        image.texture->m_width     = image.width;
+        image.texture->m_height    = image.height;
+        image.texture->m_gpu_bytes = level_bytes + level_bytes / 3;
+        image.texture->m_resident  = true;
+        return true;
+    }
+
+    bool TextureLoader::uploadCompressed(DecodedImage& image)
+    {
+        const CompressedTexture& compressed      = *image.compressed;
+        const GLenum             internal_format = getCompressedFormat(compressed.format, compressed.srgb);
+
+        unsigned int texture_id;
+        glGenTextures(1, &texture_id);
+        glBindTexture(GL_TEXTURE_2D, texture_id);
+
+        // the whole chain is cooked, nothing to generate
+        for (size_t i = 0; i < compressed.levels.size(); ++i)
+        {
+            const TextureLevel& level = compressed.levels[i];
+            glCompressedTexImage2D(GL_TEXTURE_2D,
+                                   static_cast<GLint>(i),
+                                   internal_format,
+                                   static_cast<GLsizei>(level.width),
+                                   static_cast<GLsizei>(level.height),
+                                   0,
+                                   static_cast<GLsizei>(level.data.size()),
+                                   level.data.data());
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(compressed.levels.size() - 1));
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        // a reload replaces the image in place, its users bind the new id on their next draw
+        if (image.texture->m_resident)
+            glDeleteTextures(1, &image.texture->m_id);
+
+        image.texture->m_id        = texture_id;
+        image.texture->m_width     = image.width;
+        image.texture->m_height    = image.height;
+        image.texture->m_gpu_bytes = compressed.getDataSize();
+        image.texture->m_resident  = true;
+        return true;
+    }
+
+    size_t TextureLoader::getPendingCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_decoding + m_decoded.size();
+    }
+
+    TextureLoadStats TextureLoader::getStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+} // namespace RealmEngine
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "render/texture.h"
+#include "resource/processor/texture_encoder.h"
+
+namespace RealmEngine
+{
+    // Selects the placeholder shown until the image is resident.
+    enum class TextureUsage : uint8_t
+    {
+        Albedo,
+        MetallicRoughness,
+        Normal,
+        AmbientOcclusion,
+        Emissive,
+        Count
+    };
+
+    // Totals since the loader was initialized; times in milliseconds.
+    struct TextureLoadStats
+    {
+        uint32_t requested {0};
+        uint32_t uploaded {0};
+        uint32_t failed {0};
+        uint32_t cache_hits {0};   // compressed textures read back from the texture cache
+        uint32_t encoded {0};      // compressed textures encoded from their source
+        double   decode_ms {0.0};  // summed over workers
+        double   encode_ms {0.0};  // summed over workers
+        double   upload_ms {0.0};  // spent on the GL thread
+        double   latency_ms {0.0}; // summed request to resident
+        size_t   uploaded_bytes {0};
+    };
+
+    /**
+     * Decodes texture files on the thread pool and uploads them on the GL thread.
+     *
+     * load() returns at once with a texture that points at a 1x1 placeholder for its usage, so meshes can be
+     * drawn right away. Decoded images wait in a queue until processUploads(), called by the renderer at the
+     * start of every frame, creates the GL texture and swaps its id into the shared Texture.
+     *
+     * With compression enabled, images are block compressed by usage (see pickFormat) with their whole mip chain
+     * and cooked into the TextureCache, so later runs skip both decoding and encoding until the source changes.
+     * Formats the driver lacks fall back to uncompressed uploads.
+     */
+    class TextureLoader
+    {
+    public:
+        TextureLoader()           = default;
+        ~TextureLoader() noexcept = default;
+
+        TextureLoader(const TextureLoader& that)            = delete;
+        TextureLoader(TextureLoader&& that)                 = delete;
+        TextureLoader& operator=(const TextureLoader& that) = delete;
+        TextureLoader& operator=(TextureLoader&& that)      = delete;
+
+        // both on the GL thread
+        void initialize();
+        void disposal();
+
+        std::shared_ptr<Texture> load(const std::string& path, TextureUsage usage, bool srgb, bool flip_vertically);
+        // Decodes path again into texture, which keeps showing its current image until the new one is uploaded.
+        void reload(const std::shared_ptr<Texture>& texture,
+                    const std::string&              path,
+                    TextureUsage                    usage,
+                    bool                            srgb,
+                    bool                            flip_vertically);
+
+        // Uploads queued images until budget_ms is spent, at least one per call so loading always progresses.
+        void processUploads(double budget_ms);
+
+        void setCompressionEnabled(bool enabled) { m_compression_enabled = enabled; }
+        bool isCompressionEnabled() const { return m_compression_enabled; }
+        // BC7 for albedo and metallic-roughness instead of BC1/BC3, slower to encode
+        void setHighQualityCompression(bool enabled) { m_high_quality_compression = enabled; }
+        bool isHighQualityCompression() const { return m_high_quality_compression; }
+
+        // Block format for a texture of this usage, RGBA8 if nothing suitable is supported.
+        TextureFormat pickFormat(TextureUsage usage, bool srgb, bool has_alpha) const;
+
+        // decoding or waiting for upload
+        size_t getPendingCount() const;
+        bool   isIdle() const { return getPendingCount() == 0; }
+
+        TextureLoadStats getStats() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct PixelDeleter
+        {
+            void operator()(unsigned char* pixels) const;
+        };
+
+        struct DecodedImage
+        {
+            std::shared_ptr<Texture>                      texture;
+            std::unique_ptr<unsigned char[], PixelDeleter> pixels;
+            std::unique_ptr<CompressedTexture>             compressed; // replaces pixels when set
+            int                                           width {0};
+            int                                           height {0};
+            int                                           channels {0};
+            TextureUsage                                  usage {TextureUsage::Albedo};
+            bool                                          srgb {false};
+            Clock::time_point                             requested;
+        };
+
+        void decode(const std::string& path, DecodedImage image, bool flip_vertically);
+        // Compressed image from the cache, or decoded and encoded (and cooked) from the source.
+        void decodeCompressed(const std::string& path, DecodedImage& image, bool flip_vertically);
+        // Expects m_mutex to be held.
+        void closeBatchIfIdle();
+        bool upload(DecodedImage& image);
+        bool uploadCompressed(DecodedImage& image);
+
+        std::array<unsigned int, static_cast<size_t>(TextureUsage::Count)> m_placeholders {};
+
+        // set by initialize() from the GL extensions, read by workers afterwards
+        bool              m_supports_s3tc {false};
+        bool              m_supports_s3tc_srgb {false};
+        bool              m_supports_bptc {false};
+        std::atomic<bool> m_compression_enabled {true};
+        std::atomic<bool> m_high_quality_compression {true};
+
+        mutable std::mutex       m_mutex;
+        std::condition_variable  m_decode_done;
+        std::deque<DecodedImage> m_decoded;
+        size_t                   m_decoding {0};
+        TextureLoadStats         m_stats;
+
+        // a batch runs from the first request while idle to the last upload, for the summary log
+        bool              m_batch_open {false};
+        Clock::time_point m_batch_start;
+        TextureLoadStats  m_batch_base;
+    };
+} // namespace RealmEngine
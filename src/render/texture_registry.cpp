@@ -0,0 +1,187 @@
+#include "render/texture_registry.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <glad/gl.h>
+#include <utility>
+#include <vector>
+#include "utils.h"
+
+namespace RealmEngine
+{
+    namespace
+    {
+        const char* getUsageName(TextureUsage usage)
+        {
+            switch (usage)
+            {
+                case TextureUsage::Albedo:
+                    return "albedo";
+                case TextureUsage::MetallicRoughness:
+                    return "metallic-roughness";
+                case TextureUsage::Normal:
+                    return "normal";
+                case TextureUsage::AmbientOcclusion:
+                    return "ao";
+                case TextureUsage::Emissive:
+                    return "emissive";
+                case TextureUsage::Count:
+                    break;
+            }
+            return "unknown";
+        }
+    } // namespace
+
+    void TextureRegistry::disposal()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& [key, entry] : m_entries)
+        {
+            if (!entry.texture->m_resident)
+                continue;
+            glDeleteTextures(1, &entry.texture->m_id);
+            entry.texture->m_id        = 0;
+            entry.texture->m_resident  = false;
+            entry.texture->m_gpu_bytes = 0;
+        }
+        m_entries.clear();
+    }
+
+    std::shared_ptr<Texture>
+    TextureRegistry::acquire(const std::string& path, TextureUsage usage, bool srgb, bool flip_vertically)
+    {
+        const std::string normalized = normalizePath(path);
+        std::string       key        = normalized;
+        key += '|';
+        key += static_cast<char>('0' + static_cast<int>(usage));
+        key += srgb ? 's' : 'l';
+        key += flip_vertically ? 'f' : 'n';
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_requests;
+
+        auto iterator = m_entries.find(key);
+        if (iterator != m_entries.end())
+        {
+            ++m_shared_hits;
+            return iterator->second.texture;
+        }
+
+        debug("Loading texture: " + normalized);
+        Entry entry;
+        entry.texture         = m_loader.load(normalized, usage, srgb, flip_vertically);
+        entry.texture->m_path = normalized;
+        entry.usage           = usage;
+        entry.srgb            = srgb;
+        entry.flip_vertically = flip_vertically;
+
+        std::shared_ptr<Texture> texture = entry.texture;
+        m_entries.emplace(std::move(key), std::move(entry));
+        return texture;
+    }
+
+    size_t TextureRegistry::reload(const std::string& path)
+    {
+        const std::string normalized = normalizePath(path);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // one file may back several entries, e.g. used as albedo with and without flipping
+        size_t reloaded = 0;
+        for (auto& [key, entry] : m_entries)
+        {
+            if (entry.texture->m_path != normalized)
+                continue;
+            m_loader.reload(entry.texture, normalized, entry.usage, entry.srgb, entry.flip_vertically);
+            ++reloaded;
+        }
+        return reloaded;
+    }
+
+    size_t TextureRegistry::collectUnused()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        size_t released = 0;
+        for (auto iterator = m_entries.begin(); iterator != m_entries.end();)
+        {
+            // the loader holds a reference until the upload, so pending textures are never collected here
+            Texture& texture = *iterator->second.texture;
+            if (iterator->second.texture.use_count() > 1)
+            {
+                ++iterator;
+                continue;
+            }
+
+            if (texture.m_resident)
+            {
+                glDeleteTextures(1, &texture.m_id);
+                texture.m_resident  = false;
+                texture.m_gpu_bytes = 0;
+                ++released;
+            }
+            iterator = m_entries.erase(iterator);
+        }
+
+        m_released += released;
+        return released;
+    }
+
+    TextureRegistryStats TextureRegistry::getStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        TextureRegistryStats stats;
+        stats.textures    = m_entries.size();
+        stats.requests    = m_requests;
+        stats.shared_hits = m_shared_hits;
+        stats.released    = m_released;
+        for (const auto& [key, entry] : m_entries)
+        {
+            if (!entry.texture->m_resident)
+                continue;
+            ++stats.resident;
+            stats.gpu_bytes += entry.texture->m_gpu_bytes;
+        }
+        return stats;
+    }
+
+    void TextureRegistry::logMemoryUsage() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        std::vector<const Entry*> entries;
+        entries.reserve(m_entries.size());
+        size_t total_bytes = 0;
+        for (const auto& [key, entry] : m_entries)
+        {
+            entries.push_back(&entry);
+            total_bytes += entry.texture->m_gpu_bytes;
+        }
+        std::sort(entries.begin(), entries.end(), [](const Entry* a, const Entry* b) {
+            return a->texture->m_gpu_bytes > b->texture->m_gpu_bytes;
+        });
+
+        info("Texture memory: " + std::to_string(entries.size()) + " textures, " + formatKilobytes(total_bytes));
+        for (const Entry* entry : entries)
+        {
+            const Texture& texture = *entry->texture;
+            // the registry's own reference is not a user
+            const long users = entry->texture.use_count() - 1;
+            info("  " + formatKilobytes(texture.m_gpu_bytes) + "  " + std::to_string(texture.m_width) + "x" +
+                 std::to_string(texture.m_height) + " " + getUsageName(entry->usage) + (entry->srgb ? " srgb" : "") +
+                 (texture.m_resident ? "" : " (pending)") + ", " + std::to_string(users) + " user(s): " +
+                 texture.m_path);
+        }
+    }
+
+    std::string TextureRegistry::normalizePath(const std::string& path)
+    {
+        // resolves "..", "." and symlinks, so two spellings of one file share a texture
+        std::error_code       ec;
+        std::filesystem::path normalized = std::filesystem::weakly_canonical(std::filesystem::path(path), ec);
+        if (ec)
+            normalized = std::filesystem::path(path).lexically_normal();
+        return normalized.generic_string();
+    }
+} // namespace RealmEngine
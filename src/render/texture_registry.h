@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "render/texture.h"
+#include "render/texture_loader.h"
+
+namespace RealmEngine
+{
+    struct TextureRegistryStats
+    {
+        size_t textures {0};     // registered, resident or not
+        size_t resident {0};
+        size_t gpu_bytes {0};    // summed over resident textures
+        size_t requests {0};     // acquire() calls
+        size_t shared_hits {0};  // acquire() calls answered by a registered texture
+        size_t released {0};     // textures deleted after their last user went away
+    };
+
+    /**
+     * Engine-wide owner of the material textures, so a file referenced by several models or RenderObjects is
+     * decoded and uploaded once.
+     *
+     * Textures are keyed by their normalized path and by everything that changes the GL texture built from it:
+     * color space, usage (placeholder and compression format) and vertical flip. acquire() hands out shared
+     * Texture handles; the registry keeps one reference itself, and collectUnused() deletes the GL textures
+     * nobody else holds any more. GL work only happens on the GL thread, in collectUnused() and disposal().
+     */
+    class TextureRegistry
+    {
+    public:
+        explicit TextureRegistry(TextureLoader& loader) : m_loader(loader) {}
+        ~TextureRegistry() noexcept = default;
+
+        TextureRegistry(const TextureRegistry& that)            = delete;
+        TextureRegistry(TextureRegistry&& that)                 = delete;
+        TextureRegistry& operator=(const TextureRegistry& that) = delete;
+        TextureRegistry& operator=(TextureRegistry&& that)      = delete;
+
+        // Deletes every registered texture, on the GL thread before the loader is disposed.
+        void disposal();
+
+        // The registered texture for this source, or a new one queued on the loader.
+        std::shared_ptr<Texture> acquire(const std::string& path, TextureUsage usage, bool srgb, bool flip_vertically);
+
+        // Decodes every registered texture of this file again, in place. Returns how many were queued.
+        size_t reload(const std::string& path);
+
+        // Deletes resident textures only the registry still references. Returns how many were released.
+        size_t collectUnused();
+
+        TextureRegistryStats getStats() const;
+        // One line per texture with its size, users and GPU memory, largest first.
+        void logMemoryUsage() const;
+
+        static std::string normalizePath(const std::string& path);
+
+    private:
+        struct Entry
+        {
+            std::shared_ptr<Texture> texture;
+            TextureUsage             usage {TextureUsage::Albedo};
+            bool                     srgb {false};
+            bool                     flip_vertically {false};
+        };
+
+        TextureLoader& m_loader;
+
+        mutable std::mutex                     m_mutex;
+        std::unordered_map<std::string, Entry> m_entries;
+        size_t                                 m_requests {0};
+        size_t                                 m_shared_hits {0};
+        size_t                                 m_released {0};
+    };
+} // namespace RealmEngine
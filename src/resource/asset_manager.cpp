@@ -1,68 +1,428 @@
 #include "asset_manager.h"
+#include <algorithm>
+#include <chrono>
+#include <exception>
 #include <future>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <utility>
+#include <vector>
+#include "config_manager.h"
+#include "global_context.h"
 #include "resource/datatype/model/model.h"
+#include "thread_pool.h"
 #include "utils.h"
 
 namespace RealmEngine
 {
-    void AssetManager::initialize() { info("Asset manager initialized."); }
+    void AssetManager::initialize()
+    {
+        m_asset_cache.initialize(g_context.m_config->getCacheFolder(), g_context.m_config->getCacheSizeLimit());
+        m_model_cache.initialize(m_asset_cache);
+        m_texture_cache.initialize(m_asset_cache);
+
+        info("Asset manager initialized.");
+    }
 
     void AssetManager::disposal()
     {
+        waitPendingLoads();
         unloadAllModels();
         info("Asset manager disposed all resource.");
     }
 
-    Model* AssetManager::loadModel(const std::string& path, const ModelImporter::LoadOptions& options)
+    ModelHandle AssetManager::loadModel(const std::string& path, const ModelImporter::LoadOptions& options)
     {
-        auto it = m_models.find(path);
-        if (it != m_models.end())
-            return it->second.get();
+        ModelPromise                    promise;
+        std::shared_future<ModelHandle> future = acquireLoad(path, options, promise);
+
+        // nobody is importing this path yet: do it right here on the calling thread
+        if (promise)
+            completeLoad(path, options, promise);
+        else if (ThreadPool* pool = g_context.m_thread_pool.get())
+            pool->wait(future); // the import may still be queued behind the task calling us
+
+        return future.get();
+    }
 
-        std::unique_ptr<Model> loaded = m_model_importer.loadModel(path, options);
-        if (!loaded)
+    std::shared_future<ModelHandle> AssetManager::loadModelAsync(const std::string&                path,
+                                                                 const ModelImporter::LoadOptions& options)
+    {
+        ModelPromise                    promise;
+        std::shared_future<ModelHandle> future = acquireLoad(path, options, promise);
+        if (!promise)
+            return future;
+
+        if (ThreadPool* pool = g_context.m_thread_pool.get())
+            pool->submit([this, path, options, promise]() { completeLoad(path, options, promise); });
+        else
+            completeLoad(path, options, promise);
+
+        return future;
+    }
+
+    std::shared_ptr<ModelStream> AssetManager::loadModelProgressive(const std::string&                path,
+                                                                    const ModelImporter::LoadOptions& options,
+                                                                    ModelStreamCallbacks              callbacks)
+    {
+        auto stream = std::make_shared<ModelStream>(path, std::move(callbacks));
+
+        ModelPromise                    promise;
+        std::shared_future<ModelHandle> future = acquireLoad(path, options, promise, stream);
+        if (!promise)
         {
-            err("Failed to load model from :" + path);
-            return nullptr;
+            // resident already; otherwise the running import completes the stream
+            if (future.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+                stream->complete(future.get());
+            return stream;
         }
 
-        Model* model_ptr = loaded.get();
-        m_models[path]   = std::move(loaded);
+        if (ThreadPool* pool = g_context.m_thread_pool.get())
+            pool->submit([this, path, options, promise, stream]() { streamLoad(path, options, promise, stream); });
+        else
+            streamLoad(path, options, promise, stream);
 
-        return model_ptr;
+        return stream;
     }
-    std::future<Model*> AssetManager::loadModelAsync(const std::string& /*path*/)
+
+    std::shared_future<ModelHandle> AssetManager::reloadModel(const std::string& path)
     {
-        warn("NOT IMPLEMENTED YET");
-        return std::future<Model*>();
+        ModelPromise                    promise;
+        ModelImporter::LoadOptions      options;
+        std::shared_future<ModelHandle> future;
+        {
+            std::unique_lock<std::shared_mutex> lock(m_models_mutex);
+
+            auto pending = m_pending_models.find(path);
+            if (pending != m_pending_models.end())
+                return pending->second.future;
+
+            auto loaded = m_models.find(path);
+            if (loaded != m_models.end())
+                options = loaded->second.options;
+
+            // the resident entry keeps serving loads until the new model replaces it
+            promise                = std::make_shared<std::promise<ModelHandle>>();
+            future                 = promise->get_future().share();
+            m_pending_models[path] = PendingLoad {future, options.hash()};
+        }
+
+        if (ThreadPool* pool = g_context.m_thread_pool.get())
+            pool->submit([this, path, options, promise]() { completeLoad(path, options, promise); });
+        else
+            completeLoad(path, options, promise);
+
+        return future;
     }
 
-    Model* AssetManager::getModel(const std::string& path)
+    ModelHandle AssetManager::getModel(const std::string& path)
     {
+        std::shared_lock<std::shared_mutex> lock(m_models_mutex);
+
         auto it = m_models.find(path);
         if (it != m_models.end())
-            return it->second.get();
+        {
+            touch(it->second);
+            return it->second.model;
+        }
 
         err("Trying to get an unload model by :" + path);
         return nullptr;
     }
-    bool AssetManager::isModelLoaded(const std::string& path) const { return m_models.count(path); }
+    bool AssetManager::isModelLoaded(const std::string& path) const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_models_mutex);
+        return m_models.count(path);
+    }
+    bool AssetManager::isModelLoading(const std::string& path) const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_models_mutex);
+        return m_pending_models.count(path);
+    }
+
+    std::vector<std::string> AssetManager::getLoadedModelPaths() const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_models_mutex);
+
+        std::vector<std::string> paths;
+        paths.reserve(m_models.size());
+        for (const auto& [path, entry] : m_models)
+            paths.push_back(path);
+        return paths;
+    }
 
     void AssetManager::unloadModel(const std::string& path)
     {
+        std::unique_lock<std::shared_mutex> lock(m_models_mutex);
+
         auto it = m_models.find(path);
         if (it == m_models.end())
             return;
 
-        it->second.reset();
+        m_resident_bytes -= it->second.memory.total();
         m_models.erase(it);
     }
     void AssetManager::unloadAllModels()
     {
-        for (auto it = m_models.begin(); it != m_models.end();)
-            it = m_models.erase(it);
+        std::unique_lock<std::shared_mutex> lock(m_models_mutex);
+
+        m_models.clear();
+        m_resident_bytes = 0;
+    }
+
+    void AssetManager::setModelMemoryBudget(size_t bytes)
+    {
+        m_memory_budget = bytes;
+        trimModelMemory();
+    }
+    size_t AssetManager::getModelMemoryUsage() const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_models_mutex);
+        return m_resident_bytes;
+    }
+    ModelMemoryUsage AssetManager::getModelMemoryUsage(const std::string& path) const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_models_mutex);
+
+        auto it = m_models.find(path);
+        return it != m_models.end() ? it->second.memory : ModelMemoryUsage {};
+    }
+    void AssetManager::trimModelMemory()
+    {
+        std::unique_lock<std::shared_mutex> lock(m_models_mutex);
+        evictUnusedModels();
+    }
+
+    void AssetManager::evictUnusedModels()
+    {
+        const size_t budget = m_memory_budget.load();
+        if (budget == 0 || m_resident_bytes <= budget)
+            return;
+
+        // Only the registry holds an unreferenced model. New handles are only created under this lock,
+        // so a use_count of 1 can't change while we look at it.
+        std::vector<std::pair<uint64_t, std::string>> candidates;
+        for (const auto& [path, entry] : m_models)
+            if (entry.model.use_count() == 1)
+                candidates.emplace_back(entry.last_used.load(), path);
+        std::sort(candidates.begin(), candidates.end());
+
+        for (const auto& [last_used, path] : candidates)
+        {
+            if (m_resident_bytes <= budget)
+                break;
+
+            auto it = m_models.find(path);
+            m_resident_bytes -= it->second.memory.total();
+            debug("Evicted model " + path + " (" + std::to_string(it->second.memory.total()) + " bytes)");
+            m_models.erase(it);
+        }
+
+        if (m_resident_bytes > budget)
+            warn("Model memory " + std::to_string(m_resident_bytes) + " bytes exceeds budget of " +
+                 std::to_string(budget) + " bytes, remaining models are still referenced.");
+    }
+
+    std::shared_future<ModelHandle> AssetManager::acquireLoad(const std::string&                  path,
+                                                              const ModelImporter::LoadOptions&   options,
+                                                              ModelPromise&                       out_promise,
+                                                              const std::shared_ptr<ModelStream>& waiter)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_models_mutex);
+
+        auto loaded = m_models.find(path);
+        if (loaded != m_models.end())
+        {
+            if (loaded->second.options.hash() != options.hash())
+                warn("Model " + path + " is resident with other import options, those are ignored");
+            touch(loaded->second);
+
+            std::promise<ModelHandle> ready;
+            ready.set_value(loaded->second.model);
+            return ready.get_future().share();
+        }
+
+        auto pending = m_pending_models.find(path);
+        if (pending != m_pending_models.end())
+        {
+            if (pending->second.options_hash != options.hash())
+                warn("Model " + path + " is already importing with other import options, those are ignored");
+            if (waiter)
+                m_waiting_streams[path].push_back(waiter);
+            return pending->second.future;
+        }
+
+        out_promise = std::make_shared<std::promise<ModelHandle>>();
+
+        std::shared_future<ModelHandle> future = out_promise->get_future().share();
+        m_pending_models[path]                 = PendingLoad {future, options.hash()};
+        return future;
+    }
+
+    void AssetManager::completeLoad(const std::string&                path,
+                                    const ModelImporter::LoadOptions& options,
+                                    ModelPromise                      promise)
+    {
+        ModelHandle model;
+        try
+        {
+            model = importModel(path, options);
+        }
+        catch (const std::exception& e)
+        {
+            err("Exception while loading model from :" + path + " - " + e.what());
+        }
+        catch (...)
+        {
+            err("Unknown exception while loading model from :" + path);
+        }
+
+        finishLoad(path, options, std::move(model), std::move(promise));
+    }
+
+    void AssetManager::streamLoad(const std::string&                  path,
+                                  const ModelImporter::LoadOptions&   options,
+                                  ModelPromise                        promise,
+                                  const std::shared_ptr<ModelStream>& stream)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        ModelHandle model;
+        try
+        {
+            auto     start = Clock::now();
+            uint64_t key   = m_model_cache.isEnabled() ? m_model_cache.computeKey(path, options) : 0;
+
+            // a cooked model loads faster than the first mesh would stream in
+            if (std::unique_ptr<Model> cooked = m_model_cache.load(key, path))
+            {
+                model = std::move(cooked);
+            }
+            else
+            {
+                model = std::make_shared<Model>();
+
+                ModelImporter::ImportCallbacks callbacks;
+                callbacks.on_skeleton = [&](Model&) {
+                    double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+                    debug("Streaming " + path + ": " + std::to_string(model->getMeshCount()) +
+                          " mesh(es), first visible after " + std::to_string(ms) + " ms");
+                    stream->publishModel(model);
+                };
+                callbacks.on_mesh = [&](Model&, size_t mesh) { stream->publishMesh(mesh); };
+
+                if (ModelImporter::importModel(*model, path, options, callbacks))
+                {
+                    double import_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+                    debug("Streamed " + path + " in " + std::to_string(import_ms) + " ms (cold)");
+
+                    if (key != 0 && !m_model_cache.store(key, *model, path))
+                        warn("Failed to cook model: " + path);
+                }
+                else
+                {
+                    model.reset();
+                }
+            }
+        }
+        catch (const std::exception& e)
+        {
+            err("Exception while streaming model from :" + path + " - " + e.what());
+            model.reset();
+        }
+        catch (...)
+        {
+            err("Unknown exception while streaming model from :" + path);
+            model.reset();
+        }
+
+        finishLoad(path, options, model, std::move(promise));
+        stream->complete(model);
+    }
+
+    void AssetManager::finishLoad(const std::string&                path,
+                                  const ModelImporter::LoadOptions& options,
+                                  ModelHandle                       model,
+                                  ModelPromise                      promise)
+    {
+        StreamList waiting;
+        {
+            std::unique_lock<std::shared_mutex> lock(m_models_mutex);
+            if (model)
+            {
+                // a reload replaces the previous entry, handles to the old model stay valid
+                auto [it, inserted] = m_models.try_emplace(path);
+                if (!inserted)
+                    m_resident_bytes -= it->second.memory.total();
+
+                it->second.model   = model;
+                it->second.options = options;
+                it->second.memory  = model->calculateMemoryUsage();
+                touch(it->second);
+                m_resident_bytes += it->second.memory.total();
+
+                // the loader still holds model, so the new entry itself can't be evicted here
+                evictUnusedModels();
+            }
+            m_pending_models.erase(path);
+
+            auto streams = m_waiting_streams.find(path);
+            if (streams != m_waiting_streams.end())
+            {
+                waiting = std::move(streams->second);
+                m_waiting_streams.erase(streams);
+            }
+        }
+
+        if (!model)
+            err("Failed to load model from :" + path);
+
+        promise->set_value(model);
+        for (const auto& stream : waiting)
+            stream->complete(model);
+    }
+
+    void AssetManager::waitPendingLoads()
+    {
+        std::vector<std::shared_future<ModelHandle>> pending;
+        {
+            std::shared_lock<std::shared_mutex> lock(m_models_mutex);
+            for (const auto& [path, load] : m_pending_models)
+                pending.push_back(load.future);
+        }
+
+        for (auto& future : pending)
+            future.wait();
+    }
+
+    std::unique_ptr<Model> AssetManager::importModel(const std::string& path, const ModelImporter::LoadOptions& options)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        auto     start = Clock::now();
+        uint64_t key   = m_model_cache.isEnabled() ? m_model_cache.computeKey(path, options) : 0;
+
+        // warm path: cooked model, no Assimp involved
+        if (std::unique_ptr<Model> cooked = m_model_cache.load(key, path))
+        {
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            debug("Loaded cooked model for " + path + " in " + std::to_string(ms) + " ms (warm)");
+            return cooked;
+        }
+
+        // cold path: full import, then cook for next time
+        std::unique_ptr<Model> model = m_model_importer.loadModel(path, options);
+        if (!model)
+            return nullptr;
+
+        double import_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        debug("Imported " + path + " in " + std::to_string(import_ms) + " ms (cold)");
+
+        if (key != 0 && !m_model_cache.store(key, *model, path))
+            warn("Failed to cook model: " + path);
+
+        return model;
     }
 
 } // namespace RealmEngine
\ No newline at end of file
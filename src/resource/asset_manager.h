@@ -1,16 +1,28 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <future>
 #include <memory>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
+#include "resource/cache/asset_cache.h"
+#include "resource/cache/model_cache.h"
+#include "resource/cache/texture_cache.h"
 #include "resource/importer/model_importer.h"
+#include "resource/model_stream.h"
 
 namespace RealmEngine
 {
     class AssetManager
     {
     public:
+        // 0 disables the budget
+        static constexpr size_t DEFAULT_MODEL_MEMORY_BUDGET = size_t(1) << 30;
+
         AssetManager()           = default;
         ~AssetManager() noexcept = default;
 
@@ -22,18 +34,110 @@ namespace RealmEngine
         void initialize();
         void disposal();
 
-        Model*              loadModel(const std::string& path, const ModelImporter::LoadOptions& options = {});
-        std::future<Model*> loadModelAsync(const std::string& path);
+        /**
+         * Both loaders share in-flight imports: concurrent requests for one path import the file once. Entries are
+         * keyed by path alone, a request with other options than the running or resident import gets that model
+         * and a warning. loadModel() on a pool worker runs queued pool tasks while another thread imports.
+         */
+        ModelHandle                     loadModel(const std::string&                path,
+                                                  const ModelImporter::LoadOptions& options = {});
+        std::shared_future<ModelHandle> loadModelAsync(const std::string&                path,
+                                                       const ModelImporter::LoadOptions& options = {});
+        /**
+         * Like loadModelAsync, but the model is published on the returned stream as soon as its node tree and
+         * materials exist, and each mesh as soon as a worker has finished it, so it can be drawn while the rest
+         * is still importing. Cooked, resident or already importing models complete the stream in one go.
+         */
+        std::shared_ptr<ModelStream> loadModelProgressive(const std::string&                path,
+                                                          const ModelImporter::LoadOptions& options   = {},
+                                                          ModelStreamCallbacks              callbacks = {});
+
+        /**
+         * Imports path again in the background, with the options it was loaded with, bypassing the resident entry.
+         * Once done the new model replaces the entry; handles to the previous one stay valid until released.
+         * An import already running for path is returned instead. A failed re-import keeps the previous model.
+         */
+        std::shared_future<ModelHandle> reloadModel(const std::string& path);
 
-        Model* getModel(const std::string& path);
-        bool   isModelLoaded(const std::string& path) const;
+        ModelHandle getModel(const std::string& path);
+        bool        isModelLoaded(const std::string& path) const;
+        bool        isModelLoading(const std::string& path) const;
+        // paths of the resident models, as they were passed to the loaders
+        std::vector<std::string> getLoadedModelPaths() const;
 
+        // Drops the registry entry; outstanding handles keep the model alive until released.
         void unloadModel(const std::string& path);
         void unloadAllModels();
 
+        /**
+         * Resident model memory is kept under the budget by evicting the least recently used models that
+         * nobody holds a handle to. Eviction runs after every load and on trimModelMemory(), which the
+         * engine calls once per frame so models released by gameplay are reclaimed too.
+         */
+        void             setModelMemoryBudget(size_t bytes);
+        size_t           getModelMemoryBudget() const { return m_memory_budget.load(); }
+        size_t           getModelMemoryUsage() const;
+        ModelMemoryUsage getModelMemoryUsage(const std::string& path) const;
+        void             trimModelMemory();
+
+        AssetCache&   getAssetCache() { return m_asset_cache; }
+        ModelCache&   getModelCache() { return m_model_cache; }
+        TextureCache& getTextureCache() { return m_texture_cache; }
+
     private:
+        using ModelPromise = std::shared_ptr<std::promise<ModelHandle>>;
+
+        struct ModelEntry
+        {
+            ModelHandle                model;
+            ModelImporter::LoadOptions options; // reused by reloadModel()
+            ModelMemoryUsage           memory;
+            std::atomic<uint64_t>      last_used {0};
+        };
+
+        struct PendingLoad
+        {
+            std::shared_future<ModelHandle> future;
+            uint64_t                        options_hash {0}; // LoadOptions::hash() of the running import
+        };
+
+        // Returns the future for path; out_promise is set only if the caller has to perform the import.
+        // A waiter is completed when an import already running for path finishes.
+        std::shared_future<ModelHandle> acquireLoad(const std::string&                  path,
+                                                    const ModelImporter::LoadOptions&   options,
+                                                    ModelPromise&                       out_promise,
+                                                    const std::shared_ptr<ModelStream>& waiter = nullptr);
+        void completeLoad(const std::string& path, const ModelImporter::LoadOptions& options, ModelPromise promise);
+        void streamLoad(const std::string&                  path,
+                        const ModelImporter::LoadOptions&   options,
+                        ModelPromise                        promise,
+                        const std::shared_ptr<ModelStream>& stream);
+        // Registers the imported model (null on failure) and wakes everyone waiting for path.
+        void finishLoad(const std::string&                path,
+                        const ModelImporter::LoadOptions& options,
+                        ModelHandle                       model,
+                        ModelPromise                      promise);
+        void waitPendingLoads();
+
+        void touch(ModelEntry& entry) { entry.last_used.store(m_use_clock.fetch_add(1) + 1); }
+        // Expects m_models_mutex to be held exclusively.
+        void evictUnusedModels();
+
+        std::unique_ptr<Model> importModel(const std::string& path, const ModelImporter::LoadOptions& options);
+
         ModelImporter m_model_importer;
+        AssetCache    m_asset_cache;
+        ModelCache    m_model_cache;
+        TextureCache  m_texture_cache;
+
+        using StreamList = std::vector<std::shared_ptr<ModelStream>>;
 
-        std::unordered_map<std::string, std::unique_ptr<Model>> m_models;
+        mutable std::shared_mutex                    m_models_mutex;
+        std::unordered_map<std::string, ModelEntry>  m_models;
+        std::unordered_map<std::string, PendingLoad> m_pending_models;
+        std::unordered_map<std::string, StreamList>  m_waiting_streams;
+        size_t                                       m_resident_bytes {0};
+        std::atomic<size_t>                          m_memory_budget {DEFAULT_MODEL_MEMORY_BUDGET};
+        std::atomic<uint64_t>                        m_use_clock {0};
     };
-} // namespace RealmEngine
\ No newline at end of file
+} // namespace RealmEngine
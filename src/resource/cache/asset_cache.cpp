@@ -0,0 +1,212 @@
+#include "asset_cache.h"
+#include "plateform/plateform.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace RealmEngine
+{
+    namespace
+    {
+        using FileTime = std::filesystem::file_time_type;
+
+        constexpr const char* TEMP_EXTENSION = ".tmp";
+        // a writer takes milliseconds, older temp files belong to a process that died mid-write
+        constexpr auto STALE_TEMP_AGE = std::chrono::hours(1);
+
+        // unique over every process and thread writing to the store
+        std::string makeTempSuffix()
+        {
+            static std::atomic<uint32_t> counter {0};
+
+            std::ostringstream suffix;
+            suffix << '.' << Plateform::getProcessId() << '-' << std::hex
+                   << std::hash<std::thread::id> {}(std::this_thread::get_id()) << '-' << counter.fetch_add(1)
+                   << TEMP_EXTENSION;
+            return suffix.str();
+        }
+    } // namespace
+
+    void AssetCache::initialize(const std::filesystem::path& cache_folder, uint64_t size_limit)
+    {
+        m_folder = cache_folder;
+        m_size_limit.store(size_limit);
+
+        std::error_code ec;
+        std::filesystem::create_directories(m_folder, ec);
+        if (ec)
+        {
+            warn("Asset cache disabled, failed to create folder: " + m_folder.string() + " - " + ec.message());
+            m_enabled = false;
+            return;
+        }
+        m_enabled = true;
+
+        // sizes the store, and trims it if the limit went down or other instances grew it past the limit
+        prune();
+        info("Asset cache: " + m_folder.string() + ", " + formatMegabytes(m_size.load()) + " of " +
+             (size_limit != 0 ? formatMegabytes(size_limit) : std::string("unlimited")));
+    }
+
+    void AssetCache::setSizeLimit(uint64_t bytes)
+    {
+        m_size_limit.store(bytes);
+        if (m_enabled && bytes != 0 && m_size.load() > bytes)
+            prune();
+    }
+
+    std::filesystem::path AssetCache::getEntryPath(uint64_t key, const char* extension) const
+    {
+        // sharded by the top byte, so no folder grows to tens of thousands of entries
+        std::ostringstream shard, name;
+        shard << std::hex << std::setw(2) << std::setfill('0') << (key >> 56);
+        name << std::hex << std::setw(16) << std::setfill('0') << key << extension;
+        return m_folder / shard.str() / name.str();
+    }
+
+    bool AssetCache::publish(const std::filesystem::path& path, const void* data, size_t size)
+    {
+        if (!m_enabled)
+            return false;
+
+        std::error_code ec;
+        std::filesystem::create_directories(path.parent_path(), ec);
+        if (!writeAtomically(path, data, size))
+            return false;
+
+        const uint64_t limit = m_size_limit.load();
+        if (m_size.fetch_add(size) + size > limit && limit != 0)
+            prune();
+        return true;
+    }
+
+    void AssetCache::touch(const std::filesystem::path& path) const
+    {
+        // best effort: a read-only shared store still serves hits, it just can't track them
+        std::error_code ec;
+        std::filesystem::last_write_time(path, FileTime::clock::now(), ec);
+    }
+
+    void AssetCache::prune()
+    {
+        std::unique_lock<std::mutex> lock(m_prune_mutex, std::try_to_lock);
+        if (!lock || !m_enabled)
+            return;
+
+        struct Entry
+        {
+            std::filesystem::path path;
+            FileTime              last_used;
+            uint64_t              size;
+        };
+
+        const FileTime     now = FileTime::clock::now();
+        std::vector<Entry> entries;
+        uint64_t           total = 0;
+        std::error_code    ec;
+        for (auto it = std::filesystem::recursive_directory_iterator(m_folder, ec);
+             !ec && it != std::filesystem::recursive_directory_iterator();
+             it.increment(ec))
+        {
+            std::error_code entry_ec;
+            if (!it->is_regular_file(entry_ec))
+                continue;
+
+            const uint64_t size      = it->file_size(entry_ec);
+            const FileTime last_used = it->last_write_time(entry_ec);
+            if (entry_ec)
+                continue;
+
+            if (it->path().extension() == TEMP_EXTENSION)
+            {
+                if (now - last_used > STALE_TEMP_AGE)
+                    std::filesystem::remove(it->path(), entry_ec);
+                continue;
+            }
+
+            entries.push_back(Entry {it->path(), last_used, size});
+            total += size;
+        }
+
+        const uint64_t limit = m_size_limit.load();
+        if (limit == 0 || total <= limit)
+        {
+            m_size.store(total);
+            return;
+        }
+
+        // down to 90%, so the next few publishes don't prune again right away
+        const uint64_t target = limit / 10 * 9;
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+            return a.last_used < b.last_used;
+        });
+
+        const uint64_t before  = total;
+        size_t         removed = 0;
+        for (const Entry& entry : entries)
+        {
+            if (total <= target)
+                break;
+
+            // fails for entries another instance has mapped on Windows; POSIX readers keep their mapping
+            std::error_code remove_ec;
+            if (std::filesystem::remove(entry.path, remove_ec) || !std::filesystem::exists(entry.path, remove_ec))
+            {
+                total -= entry.size;
+                ++removed;
+            }
+        }
+        m_size.store(total);
+
+        info("Asset cache pruned " + std::to_string(removed) + " least recently used entries, " +
+             formatMegabytes(before) + " -> " + formatMegabytes(total));
+    }
+
+    bool AssetCache::writeAtomically(const std::filesystem::path& path, const void* data, size_t size)
+    {
+        std::filesystem::path temp_path = path;
+        temp_path += makeTempSuffix();
+        {
+            std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+            if (!out)
+            {
+                warn("Failed to open cache entry for writing: " + temp_path.string());
+                return false;
+            }
+            out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            out.close();
+            if (!out)
+            {
+                warn("Failed to write cache entry: " + temp_path.string());
+                std::error_code ec;
+                std::filesystem::remove(temp_path, ec);
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(temp_path, path, ec);
+        if (ec)
+        {
+            std::error_code remove_ec;
+            std::filesystem::remove(temp_path, remove_ec);
+
+            // Windows can't replace a file another instance has open; that one holds the same bytes
+            if (std::filesystem::exists(path, remove_ec))
+                return true;
+
+            warn("Failed to publish cache entry: " + path.string() + " - " + ec.message());
+            return false;
+        }
+        return true;
+    }
+} // namespace RealmEngine
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+
+namespace RealmEngine
+{
+    /**
+     * Content-addressed store the model and texture caches keep their cooked files in.
+     *
+     * Entries are named by a key hashing everything the cooked data depends on (source bytes, dependencies,
+     * options, cooked version) and never reference the machine or checkout that wrote them, so one folder can be
+     * shared by every checkout and engine instance, build farm included. An entry is written to a temp file unique
+     * to the writing process and thread, then renamed into place: readers see either the whole file or nothing,
+     * and two instances cooking the same key just publish identical bytes twice.
+     *
+     * The store is kept under a size limit by deleting the least recently used entries, using the file
+     * modification time as the use stamp (touch() refreshes it on every hit).
+     */
+    class AssetCache
+    {
+    public:
+        static constexpr uint64_t DEFAULT_SIZE_LIMIT = uint64_t(4) << 30;
+
+        AssetCache()           = default;
+        ~AssetCache() noexcept = default;
+
+        AssetCache(const AssetCache&)            = delete;
+        AssetCache& operator=(const AssetCache&) = delete;
+        AssetCache(AssetCache&&)                 = delete;
+        AssetCache& operator=(AssetCache&&)      = delete;
+
+        // 0 as size limit disables pruning.
+        void initialize(const std::filesystem::path& cache_folder, uint64_t size_limit = DEFAULT_SIZE_LIMIT);
+
+        bool                         isEnabled() const { return m_enabled; }
+        const std::filesystem::path& getFolder() const { return m_folder; }
+
+        void     setSizeLimit(uint64_t bytes);
+        uint64_t getSizeLimit() const { return m_size_limit.load(); }
+        // Bytes in the store as of the last scan, plus what this instance published since.
+        uint64_t getSize() const { return m_size.load(); }
+
+        // <folder>/<first two hex digits>/<16 hex digits><extension>
+        std::filesystem::path getEntryPath(uint64_t key, const char* extension) const;
+
+        // Publishes a cooked file under path, pruning once the store outgrows its limit.
+        bool publish(const std::filesystem::path& path, const void* data, size_t size);
+        // Marks an entry as just used.
+        void touch(const std::filesystem::path& path) const;
+
+        /**
+         * Deletes the least recently used entries until the store is back under 90% of its limit, and leftover
+         * temp files of crashed writers. Only one prune runs per instance at a time; entries another instance
+         * still has open are skipped where the OS refuses to delete them.
+         */
+        void prune();
+
+        // Writes to a temp file next to path and renames it over path.
+        static bool writeAtomically(const std::filesystem::path& path, const void* data, size_t size);
+
+    private:
+        std::filesystem::path m_folder;
+        bool                  m_enabled {false};
+        std::atomic<uint64_t> m_size_limit {DEFAULT_SIZE_LIMIT};
+        std::atomic<uint64_t> m_size {0};
+        std::mutex            m_prune_mutex;
+    };
+} // namespace RealmEngine
@@ -0,0 +1,833 @@
+#include "model_cache.h"
+#include "asset_cache.h"
+#include "hash.h"
+#include "plateform/mapped_file.h"
+#include "resource/datatype/model/animation.h"
+#include "resource/datatype/model/material.h"
+#include "resource/datatype/model/mesh.h"
+#include "resource/datatype/model/node.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace RealmEngine
+{
+    namespace
+    {
+        constexpr char     COOKED_MAGIC[4] = {'R', 'M', 'D', 'L'};
+        constexpr uint32_t INVALID_OFFSET  = 0xFFFFFFFFu;
+        constexpr size_t   BLOB_ALIGNMENT  = 16;
+        constexpr size_t   TEXTURE_COUNT   = 5;
+
+        // CookedMesh::flags
+        constexpr uint32_t COOKED_MESH_QUANTIZED_POSITIONS = 1u << 0;
+        constexpr uint32_t COOKED_MESH_16BIT_INDICES       = 1u << 1;
+        constexpr uint32_t COOKED_MESH_SKINNED_VERTICES    = 1u << 2; // encoded stream carries PackedSkin
+
+        static_assert(std::is_trivially_copyable_v<Vertex>, "Vertex must be raw-copyable into cooked files");
+        static_assert(std::is_trivially_copyable_v<SubMesh>, "SubMesh must be raw-copyable into cooked files");
+        static_assert(std::is_trivially_copyable_v<MeshLod>, "MeshLod must be raw-copyable into cooked files");
+        static_assert(std::is_trivially_copyable_v<Bone>, "Bone must be raw-copyable into cooked files");
+        static_assert(std::is_trivially_copyable_v<MeshBvh::Node>, "BVH nodes must be raw-copyable into cooked files");
+        static_assert(std::is_trivially_copyable_v<MeshBvh::TriangleBlock>,
+                      "BVH triangle blocks must be raw-copyable into cooked files");
+        static_assert(std::is_trivially_copyable_v<glm::quat>, "glm::quat must be raw-copyable into cooked files");
+
+        // ===== On-disk records =====
+        // All offsets are relative to the start of the file.
+
+        struct CookedHeader
+        {
+            char     magic[4];
+            uint32_t version;
+            uint64_t key;
+            uint64_t file_size;
+
+            uint32_t mesh_count;
+            uint32_t material_count;
+            uint32_t node_count;
+            uint32_t string_table_size;
+            uint32_t animation_count;
+            uint32_t padding;
+
+            uint64_t mesh_table;
+            uint64_t material_table;
+            uint64_t node_table;
+            uint64_t animation_table;
+            uint64_t string_table;
+        };
+
+        struct CookedMesh
+        {
+            uint64_t vertex_offset;
+            uint64_t index_offset;
+            uint64_t submesh_offset;
+            uint64_t encoded_offset; // vertex_count * encoded_stride bytes
+            uint64_t lod_offset;
+            uint64_t bone_offset;
+            uint64_t bvh_node_offset;
+            uint64_t bvh_block_offset;
+            uint32_t vertex_count;
+            uint32_t index_count;
+            uint32_t submesh_count;
+            uint32_t encoded_stride; // 0 if the mesh has no encoded vertices
+            uint32_t flags;
+            uint32_t lod_count;
+            uint32_t bone_count;
+            uint32_t bvh_node_count; // 0 if the mesh has no BVH
+            uint32_t bvh_block_count;
+            uint32_t skin_node;
+            float    aabb_min[3];
+            float    aabb_max[3];
+            float    position_offset[3];
+            float    position_scale[3];
+        };
+
+        struct CookedString
+        {
+            uint32_t offset; // into the string table, INVALID_OFFSET if absent
+            uint32_t length;
+        };
+
+        struct CookedMaterial
+        {
+            CookedString textures[TEXTURE_COUNT]; // base color, metallic-roughness, normal, occlusion, emissive
+            float        base_color_factor[4];
+            float        emissive_factor[3];
+            float        metallic_factor;
+            float        roughness_factor;
+            float        normal_scale;
+            float        occlusion_strength;
+            uint8_t      blend_mode;
+            uint8_t      cull_mode;
+            uint8_t      depth_test;
+            uint8_t      depth_write;
+        };
+
+        struct CookedNode
+        {
+            float    local_transform[16];
+            int32_t  parent; // index into the node table, -1 for the root; parents always precede children
+            uint32_t mesh_index_count;
+            uint64_t mesh_index_offset;
+        };
+
+        // Keyframes of one animated node, each track as separate time and value arrays.
+        struct CookedChannel
+        {
+            uint32_t node;
+            uint32_t translation_count;
+            uint32_t rotation_count;
+            uint32_t scale_count;
+            uint64_t translation_times;
+            uint64_t translation_values;
+            uint64_t rotation_times;
+            uint64_t rotation_values;
+            uint64_t scale_times;
+            uint64_t scale_values;
+        };
+
+        struct CookedAnimation
+        {
+            CookedString name;
+            float        duration;
+            uint32_t     channel_count;
+            uint64_t     channel_offset;
+        };
+
+        // ===== Writer =====
+
+        class BlobWriter
+        {
+        public:
+            size_t tell() const { return m_bytes.size(); }
+
+            void align()
+            {
+                while (m_bytes.size() % BLOB_ALIGNMENT != 0)
+                    m_bytes.push_back(0);
+            }
+
+            size_t write(const void* data, size_t size)
+            {
+                align();
+                size_t offset = m_bytes.size();
+                if (size > 0)
+                {
+                    m_bytes.resize(offset + size);
+                    std::memcpy(m_bytes.data() + offset, data, size);
+                }
+                return offset;
+            }
+
+            template<typename T>
+            size_t reserve(size_t count)
+            {
+                align();
+                size_t offset = m_bytes.size();
+                m_bytes.resize(offset + sizeof(T) * count, 0);
+                return offset;
+            }
+
+            template<typename T>
+            T& at(size_t offset)
+            {
+                return *reinterpret_cast<T*>(m_bytes.data() + offset);
+            }
+
+            std::vector<uint8_t> release() { return std::move(m_bytes); }
+
+        private:
+            std::vector<uint8_t> m_bytes;
+        };
+
+        CookedString addString(std::string& table, const std::string& value)
+        {
+            CookedString str {static_cast<uint32_t>(table.size()), static_cast<uint32_t>(value.size())};
+            table += value;
+            return str;
+        }
+
+        // relative to the source folder, so the entry doesn't tie itself to the checkout that cooked it
+        CookedString
+        addString(std::string& table, const std::optional<TextureRef>& texture, const std::filesystem::path& folder)
+        {
+            if (!texture.has_value())
+                return CookedString {INVALID_OFFSET, 0};
+
+            const std::filesystem::path relative = std::filesystem::path(texture->path).lexically_relative(folder);
+            return addString(table, relative.empty() ? texture->path : relative.generic_string());
+        }
+
+        std::string resolveTexturePath(const std::string& stored, const std::filesystem::path& folder)
+        {
+            const std::filesystem::path path(stored);
+            return path.is_relative() ? (folder / path).generic_string() : stored;
+        }
+
+        // the folder texture paths are relative to; "." for a bare file name, like the importers' base dir
+        std::filesystem::path getSourceFolder(const std::string& source_path)
+        {
+            std::filesystem::path folder = std::filesystem::path(source_path).parent_path();
+            return folder.empty() ? std::filesystem::path(".") : folder;
+        }
+
+        template<typename T>
+        void writeTrack(BlobWriter& writer, const AnimationTrack<T>& track, uint64_t& times, uint64_t& values)
+        {
+            times  = writer.write(track.times.data(), track.times.size() * sizeof(float));
+            values = writer.write(track.values.data(), track.values.size() * sizeof(T));
+        }
+
+        // ===== Reader =====
+
+        class BlobReader
+        {
+        public:
+            BlobReader(const uint8_t* base, size_t size) : m_base(base), m_size(size) {}
+
+            // Resolves an offset into a typed pointer, nullptr if the range falls outside the file.
+            template<typename T>
+            const T* resolve(uint64_t offset, uint64_t count) const
+            {
+                if (offset > m_size || count > (m_size - offset) / sizeof(T))
+                    return nullptr;
+                return reinterpret_cast<const T*>(m_base + offset);
+            }
+
+        private:
+            const uint8_t* m_base;
+            size_t         m_size;
+        };
+
+        template<typename T>
+        bool copyArray(const BlobReader& reader, uint64_t offset, uint64_t count, std::vector<T>& out)
+        {
+            const T* src = reader.resolve<T>(offset, count);
+            if (!src)
+                return false;
+
+            out.resize(count);
+            if (count > 0)
+                std::memcpy(out.data(), src, sizeof(T) * count);
+            return true;
+        }
+
+        template<typename T>
+        bool readTrack(const BlobReader&  reader,
+                       uint32_t           count,
+                       uint64_t           times,
+                       uint64_t           values,
+                       AnimationTrack<T>& out)
+        {
+            return copyArray(reader, times, count, out.times) && copyArray(reader, values, count, out.values);
+        }
+
+        bool isRangeInside(uint32_t base, uint32_t count, size_t size)
+        {
+            return static_cast<uint64_t>(base) + count <= size;
+        }
+
+        // Every index the loaded mesh hands on stays inside the arrays it indexes: the GPU upload, the animator
+        // and ray queries trust them. Bone and skin nodes are only followed when the mesh has bones.
+        bool checkMeshIndices(const std::vector<Vertex>&                 vertices,
+                              const std::vector<uint32_t>&               indices,
+                              const std::vector<SubMesh>&                submeshes,
+                              const std::vector<MeshLod>&                lods,
+                              const std::vector<Bone>&                   bones,
+                              const std::vector<MeshBvh::TriangleBlock>& bvh_blocks,
+                              uint32_t                                   skin_node,
+                              uint32_t                                   node_count)
+        {
+            for (uint32_t index : indices)
+            {
+                if (index >= vertices.size())
+                    return false;
+            }
+            for (const SubMesh& submesh : submeshes)
+            {
+                if (!isRangeInside(submesh.base_index, submesh.index_count, indices.size()) ||
+                    !isRangeInside(submesh.lod_offset, submesh.lod_count, lods.size()))
+                    return false;
+            }
+            for (const MeshLod& lod : lods)
+            {
+                if (!isRangeInside(lod.base_index, lod.index_count, indices.size()))
+                    return false;
+            }
+
+            if (!bones.empty())
+            {
+                if (skin_node >= node_count)
+                    return false;
+                for (const Bone& bone : bones)
+                {
+                    if (bone.node >= node_count)
+                        return false;
+                }
+                for (const Vertex& vertex : vertices)
+                {
+                    for (uint16_t joint : vertex.joints)
+                    {
+                        if (joint >= bones.size())
+                            return false;
+                    }
+                }
+            }
+
+            const size_t triangle_count = indices.size() / 3;
+            for (const MeshBvh::TriangleBlock& block : bvh_blocks)
+            {
+                for (uint32_t triangle : block.triangle)
+                {
+                    if (triangle != RayHit::INVALID_TRIANGLE && triangle >= triangle_count)
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        // the joints of the encoded stream, which is what the GPU skins with
+        bool checkEncodedJoints(const EncodedVertices& encoded, size_t bone_count)
+        {
+            if (!encoded.encoding.skinned || bone_count == 0 || encoded.data.empty())
+                return true;
+
+            const uint8_t* skins = encoded.data.data() + encoded.encoding.getSkinOffset();
+            for (uint32_t i = 0; i < encoded.vertex_count; ++i)
+            {
+                PackedSkin skin;
+                std::memcpy(&skin, skins + size_t(i) * encoded.encoding.stride, sizeof(skin));
+                for (uint16_t joint : skin.joints)
+                {
+                    if (joint >= bone_count)
+                        return false;
+                }
+            }
+            return true;
+        }
+    } // namespace
+
+    void ModelCache::initialize(AssetCache& store)
+    {
+        m_store = &store;
+        if (!m_store->isEnabled())
+            m_enabled = false;
+    }
+
+    uint64_t ModelCache::computeKey(const std::string& source_path, const ModelImporter::LoadOptions& options) const
+    {
+        MappedFile source;
+        if (!source.open(source_path))
+            return 0;
+
+        uint64_t key = Hash::hashBytes(source.data(), source.size());
+
+        // a missing dependency still keys: the import fails the same way until it shows up
+        for (const std::string& dependency : ModelImporter::findDependencies(source_path))
+        {
+            MappedFile file;
+            key = file.open(dependency) ? Hash::combine(key, Hash::hashBytes(file.data(), file.size())) :
+                                          Hash::combine(key, Hash::hashString(dependency));
+        }
+
+        key = Hash::combine(key, options.hash());
+        key = Hash::combine(key, COOKED_MODEL_VERSION);
+        return key == 0 ? 1 : key;
+    }
+
+    std::unique_ptr<Model> ModelCache::load(uint64_t key, const std::string& source_path) const
+    {
+        if (!m_enabled || key == 0)
+            return nullptr;
+
+        std::filesystem::path cooked_path = m_store->getEntryPath(key, ".rmdl");
+        if (!std::filesystem::exists(cooked_path))
+            return nullptr;
+
+        std::unique_ptr<Model> model = readCookedModel(cooked_path, key, getSourceFolder(source_path));
+        if (model)
+            m_store->touch(cooked_path);
+        return model;
+    }
+
+    bool ModelCache::store(uint64_t key, const Model& model, const std::string& source_path) const
+    {
+        if (!m_enabled || key == 0)
+            return false;
+
+        const std::vector<uint8_t> bytes = cookModel(key, model, getSourceFolder(source_path));
+        return m_store->publish(m_store->getEntryPath(key, ".rmdl"), bytes.data(), bytes.size());
+    }
+
+    std::unique_ptr<Model> ModelCache::readCookedModel(const std::filesystem::path& path,
+                                                       uint64_t                     key,
+                                                       const std::filesystem::path& source_folder)
+    {
+        MappedFile file;
+        if (!file.open(path))
+        {
+            warn("Failed to map cooked model: " + path.string());
+            return nullptr;
+        }
+
+        BlobReader          reader(file.data(), file.size());
+        const CookedHeader* header = reader.resolve<CookedHeader>(0, 1);
+        if (!header || std::memcmp(header->magic, COOKED_MAGIC, sizeof(COOKED_MAGIC)) != 0 ||
+            header->version != COOKED_MODEL_VERSION || header->key != key || header->file_size != file.size())
+        {
+            warn("Stale or corrupted cooked model, ignoring: " + path.string());
+            return nullptr;
+        }
+
+        const CookedMesh*     meshes    = reader.resolve<CookedMesh>(header->mesh_table, header->mesh_count);
+        const CookedMaterial* materials = reader.resolve<CookedMaterial>(header->material_table, header->material_count);
+        const CookedNode*     nodes     = reader.resolve<CookedNode>(header->node_table, header->node_count);
+        const CookedAnimation* animations =
+            reader.resolve<CookedAnimation>(header->animation_table, header->animation_count);
+        const char* strings = reader.resolve<char>(header->string_table, header->string_table_size);
+        if (!meshes || !materials || !nodes || !animations || !strings)
+        {
+            warn("Cooked model tables out of range: " + path.string());
+            return nullptr;
+        }
+
+        std::unique_ptr<Model> model = std::make_unique<Model>();
+
+        // materials
+        for (uint32_t i = 0; i < header->material_count; ++i)
+        {
+            const CookedMaterial& src = materials[i];
+            Material              material;
+
+            std::string texture_paths[TEXTURE_COUNT];
+            bool        has_texture[TEXTURE_COUNT] = {};
+            for (size_t t = 0; t < TEXTURE_COUNT; ++t)
+            {
+                const CookedString& str = src.textures[t];
+                if (str.offset == INVALID_OFFSET)
+                    continue;
+                if (static_cast<uint64_t>(str.offset) + str.length > header->string_table_size)
+                    return nullptr;
+
+                texture_paths[t] = resolveTexturePath(std::string(strings + str.offset, str.length), source_folder);
+                has_texture[t]   = true;
+            }
+
+            if (has_texture[0])
+                material.setBaseColorTexture(texture_paths[0]);
+            if (has_texture[1])
+                material.setMetallicRoughnessTexture(texture_paths[1]);
+            if (has_texture[2])
+                material.setNormalTexture(texture_paths[2]);
+            if (has_texture[3])
+                material.setOcclusionTexture(texture_paths[3]);
+            if (has_texture[4])
+                material.setEmissiveTexture(texture_paths[4]);
+
+            material.setBaseColorFactor(glm::vec4(src.base_color_factor[0],
+                                                  src.base_color_factor[1],
+                                                  src.base_color_factor[2],
+                                                  src.base_color_factor[3]));
+            material.setEmissiveFactor(
+                glm::vec3(src.emissive_factor[0], src.emissive_factor[1], src.emissive_factor[2]));
+            material.setMetallicFactor(src.metallic_factor);
+            material.setRoughnessFactor(src.roughness_factor);
+            material.setNormalScale(src.normal_scale);
+            material.setOcclusionStrength(src.occlusion_strength);
+
+            RenderState render_state;
+            render_state.blend_mode  = static_cast<RenderState::BlendMode>(src.blend_mode);
+            render_state.cull_mode   = static_cast<RenderState::CullMode>(src.cull_mode);
+            render_state.depth_test  = static_cast<RenderState::DepthTest>(src.depth_test);
+            render_state.depth_write = src.depth_write != 0;
+            material.setRenderState(render_state);
+
+            model->addMaterial(std::move(material));
+        }
+
+        // meshes
+        for (uint32_t i = 0; i < header->mesh_count; ++i)
+        {
+            const CookedMesh& src = meshes[i];
+            Mesh              mesh;
+
+            std::vector<Vertex>   vertices;
+            std::vector<uint32_t> indices;
+            std::vector<SubMesh>  submeshes;
+            std::vector<MeshLod>  lods;
+            std::vector<Bone>     bones;
+            bool                  indices_ok;
+
+            std::vector<MeshBvh::Node>          bvh_nodes;
+            std::vector<MeshBvh::TriangleBlock> bvh_blocks;
+            if (src.flags & COOKED_MESH_16BIT_INDICES)
+            {
+                std::vector<uint16_t> short_indices;
+                indices_ok = copyArray(reader, src.index_offset, src.index_count, short_indices);
+                indices.assign(short_indices.begin(), short_indices.end());
+            }
+            else
+            {
+                indices_ok = copyArray(reader, src.index_offset, src.index_count, indices);
+            }
+            if (!indices_ok || !copyArray(reader, src.vertex_offset, src.vertex_count, vertices) ||
+                !copyArray(reader, src.submesh_offset, src.submesh_count, submeshes) ||
+                !copyArray(reader, src.lod_offset, src.lod_count, lods) ||
+                !copyArray(reader, src.bone_offset, src.bone_count, bones) ||
+                !copyArray(reader, src.bvh_node_offset, src.bvh_node_count, bvh_nodes) ||
+                !copyArray(reader, src.bvh_block_offset, src.bvh_block_count, bvh_blocks))
+            {
+                warn("Cooked mesh data out of range: " + path.string());
+                return nullptr;
+            }
+            if (!checkMeshIndices(
+                    vertices, indices, submeshes, lods, bones, bvh_blocks, src.skin_node, header->node_count))
+            {
+                warn("Cooked mesh indices out of range: " + path.string());
+                return nullptr;
+            }
+
+            const size_t bone_count = bones.size();
+            mesh.setVertices(std::move(vertices));
+            mesh.setIndices(std::move(indices));
+            mesh.setBones(std::move(bones));
+            mesh.setSkinNode(src.skin_node);
+
+            if (src.encoded_stride != 0)
+            {
+                EncodedVertices encoded;
+                encoded.encoding.quantized_positions = (src.flags & COOKED_MESH_QUANTIZED_POSITIONS) != 0;
+                encoded.encoding.skinned             = (src.flags & COOKED_MESH_SKINNED_VERTICES) != 0;
+                encoded.encoding.stride              = src.encoded_stride;
+                encoded.encoding.position_offset =
+                    glm::vec3(src.position_offset[0], src.position_offset[1], src.position_offset[2]);
+                encoded.encoding.position_scale =
+                    glm::vec3(src.position_scale[0], src.position_scale[1], src.position_scale[2]);
+                encoded.vertex_count = src.vertex_count;
+                if (src.encoded_stride != encoded.encoding.getExpectedStride() ||
+                    !copyArray(
+                        reader, src.encoded_offset, uint64_t(src.vertex_count) * src.encoded_stride, encoded.data) ||
+                    !checkEncodedJoints(encoded, bone_count))
+                {
+                    warn("Cooked encoded vertices out of range: " + path.string());
+                    return nullptr;
+                }
+                mesh.setEncodedVertices(std::move(encoded));
+            }
+            for (const auto& submesh : submeshes)
+                mesh.addSubMesh(submesh);
+            mesh.getLods() = std::move(lods);
+
+            mesh.getAABB().min = glm::vec3(src.aabb_min[0], src.aabb_min[1], src.aabb_min[2]);
+            mesh.getAABB().max = glm::vec3(src.aabb_max[0], src.aabb_max[1], src.aabb_max[2]);
+
+            // after the indices, which would drop it; a broken tree costs the mesh its ray queries, not the model
+            if (!bvh_nodes.empty())
+            {
+                MeshBvh bvh(std::move(bvh_nodes), std::move(bvh_blocks));
+                if (bvh.isValid())
+                    mesh.setBvh(std::move(bvh));
+                else
+                    warn("Cooked mesh BVH is malformed, mesh left without one: " + path.string());
+            }
+
+            model->addMesh(std::move(mesh));
+        }
+
+        // node tree, stored in pre-order with parent indices
+        std::vector<Node*>    raw_nodes(header->node_count, nullptr);
+        std::unique_ptr<Node> root;
+        for (uint32_t i = 0; i < header->node_count; ++i)
+        {
+            const CookedNode& src = nodes[i];
+            if ((i == 0) != (src.parent < 0) || (src.parent >= static_cast<int32_t>(i)))
+            {
+                warn("Cooked node hierarchy is malformed: " + path.string());
+                return nullptr;
+            }
+
+            std::unique_ptr<Node> node = std::make_unique<Node>();
+
+            glm::mat4 local_transform;
+            std::memcpy(&local_transform[0][0], src.local_transform, sizeof(src.local_transform));
+            node->setLocalTransform(local_transform);
+
+            std::vector<uint32_t> mesh_indices;
+            if (!copyArray(reader, src.mesh_index_offset, src.mesh_index_count, mesh_indices) ||
+                std::any_of(mesh_indices.begin(), mesh_indices.end(), [&](uint32_t mesh_index) {
+                    return mesh_index >= header->mesh_count;
+                }))
+            {
+                warn("Cooked node meshes out of range: " + path.string());
+                return nullptr;
+            }
+            node->setMeshIndices(mesh_indices);
+
+            raw_nodes[i] = node.get();
+            if (src.parent < 0)
+                root = std::move(node);
+            else
+                raw_nodes[src.parent]->addChild(std::move(node));
+        }
+        model->setRoot(std::move(root));
+
+        // animations, channels refer to nodes by the pre-order index above
+        for (uint32_t i = 0; i < header->animation_count; ++i)
+        {
+            const CookedAnimation& src      = animations[i];
+            const CookedChannel*   channels = reader.resolve<CookedChannel>(src.channel_offset, src.channel_count);
+            if (!channels || static_cast<uint64_t>(src.name.offset) + src.name.length > header->string_table_size)
+            {
+                warn("Cooked animation out of range: " + path.string());
+                return nullptr;
+            }
+
+            Animation animation;
+            animation.setName(std::string(strings + src.name.offset, src.name.length));
+            animation.setDuration(src.duration);
+            animation.getChannels().resize(src.channel_count);
+            for (uint32_t c = 0; c < src.channel_count; ++c)
+            {
+                const CookedChannel& cooked  = channels[c];
+                AnimationChannel&    channel = animation.getChannels()[c];
+                channel.node                 = cooked.node;
+                if (cooked.node >= header->node_count ||
+                    !readTrack(reader,
+                               cooked.translation_count,
+                               cooked.translation_times,
+                               cooked.translation_values,
+                               channel.translations) ||
+                    !readTrack(reader,
+                               cooked.rotation_count,
+                               cooked.rotation_times,
+                               cooked.rotation_values,
+                               channel.rotations) ||
+                    !readTrack(reader, cooked.scale_count, cooked.scale_times, cooked.scale_values, channel.scales))
+                {
+                    warn("Cooked animation channel out of range: " + path.string());
+                    return nullptr;
+                }
+            }
+            model->addAnimation(std::move(animation));
+        }
+
+        return model;
+    }
+
+    std::vector<uint8_t>
+    ModelCache::cookModel(uint64_t key, const Model& model, const std::filesystem::path& source_folder)
+    {
+        BlobWriter  writer;
+        std::string string_table;
+
+        // the hierarchy is already flat in pre-order, so parents always come first
+        const NodeHierarchy& hierarchy = model.getHierarchy();
+
+        const size_t header_offset = writer.reserve<CookedHeader>(1);
+        const size_t mesh_table    = writer.reserve<CookedMesh>(model.getMeshCount());
+        const size_t mat_table     = writer.reserve<CookedMaterial>(model.getMaterialCount());
+        const size_t node_table    = writer.reserve<CookedNode>(hierarchy.getNodeCount());
+        const size_t anim_table    = writer.reserve<CookedAnimation>(model.getAnimationCount());
+
+        for (size_t i = 0; i < model.getMeshCount(); ++i)
+        {
+            const Mesh& mesh = model.getMesh(i);
+
+            const size_t vertex_offset =
+                writer.write(mesh.getVertices().data(), mesh.getVertices().size() * sizeof(Vertex));
+            const IndexBuffer packed_indices = mesh.packIndices();
+            const size_t      index_offset   = writer.write(packed_indices.data.data(), packed_indices.data.size());
+            const size_t submesh_offset =
+                writer.write(mesh.getSubMeshes().data(), mesh.getSubMeshes().size() * sizeof(SubMesh));
+            const size_t lod_offset = writer.write(mesh.getLods().data(), mesh.getLods().size() * sizeof(MeshLod));
+            const size_t bone_offset = writer.write(mesh.getBones().data(), mesh.getBones().size() * sizeof(Bone));
+
+            const MeshBvh& bvh = mesh.getBvh();
+            const size_t   bvh_node_offset =
+                writer.write(bvh.getNodes().data(), bvh.getNodes().size() * sizeof(MeshBvh::Node));
+            const size_t bvh_block_offset =
+                writer.write(bvh.getBlocks().data(), bvh.getBlocks().size() * sizeof(MeshBvh::TriangleBlock));
+
+            // a stale encoded stream (vertex count mismatch) is simply not cooked
+            const EncodedVertices& encoded     = mesh.getEncodedVertices();
+            const bool             has_encoded = !encoded.empty() && encoded.vertex_count == mesh.getVertices().size();
+            const size_t           encoded_offset =
+                has_encoded ? writer.write(encoded.data.data(), encoded.data.size()) : writer.tell();
+
+            CookedMesh& dst      = writer.at<CookedMesh>(mesh_table + i * sizeof(CookedMesh));
+            dst.vertex_offset    = vertex_offset;
+            dst.index_offset     = index_offset;
+            dst.submesh_offset   = submesh_offset;
+            dst.encoded_offset   = encoded_offset;
+            dst.lod_offset       = lod_offset;
+            dst.bone_offset      = bone_offset;
+            dst.bvh_node_offset  = bvh_node_offset;
+            dst.bvh_block_offset = bvh_block_offset;
+            dst.vertex_count     = static_cast<uint32_t>(mesh.getVertices().size());
+            dst.index_count      = static_cast<uint32_t>(mesh.getIndices().size());
+            dst.submesh_count    = static_cast<uint32_t>(mesh.getSubMeshes().size());
+            dst.encoded_stride   = has_encoded ? encoded.encoding.stride : 0;
+            dst.lod_count        = static_cast<uint32_t>(mesh.getLods().size());
+            dst.bone_count       = static_cast<uint32_t>(mesh.getBones().size());
+            dst.bvh_node_count   = static_cast<uint32_t>(bvh.getNodes().size());
+            dst.bvh_block_count  = static_cast<uint32_t>(bvh.getBlocks().size());
+            dst.skin_node        = mesh.getSkinNode();
+            dst.flags            = 0;
+            if (has_encoded && encoded.encoding.quantized_positions)
+                dst.flags |= COOKED_MESH_QUANTIZED_POSITIONS;
+            if (has_encoded && encoded.encoding.skinned)
+                dst.flags |= COOKED_MESH_SKINNED_VERTICES;
+            if (packed_indices.type == IndexType::UInt16)
+                dst.flags |= COOKED_MESH_16BIT_INDICES;
+            for (int c = 0; c < 3; ++c)
+            {
+                dst.aabb_min[c]        = mesh.getBounds().min[c];
+                dst.aabb_max[c]        = mesh.getBounds().max[c];
+                dst.position_offset[c] = encoded.encoding.position_offset[c];
+                dst.position_scale[c]  = encoded.encoding.position_scale[c];
+            }
+        }
+
+        for (size_t i = 0; i < model.getMaterialCount(); ++i)
+        {
+            const Material& material = model.getMaterial(i);
+            CookedMaterial& dst      = writer.at<CookedMaterial>(mat_table + i * sizeof(CookedMaterial));
+
+            dst.textures[0] = addString(string_table, material.getBaseColorTexture(), source_folder);
+            dst.textures[1] = addString(string_table, material.getMetallicRoughnessTexture(), source_folder);
+            dst.textures[2] = addString(string_table, material.getNormalTexture(), source_folder);
+            dst.textures[3] = addString(string_table, material.getOcclusionTexture(), source_folder);
+            dst.textures[4] = addString(string_table, material.getEmissiveTexture(), source_folder);
+
+            for (int c = 0; c < 4; ++c)
+                dst.base_color_factor[c] = material.getBaseColorFactor()[c];
+            for (int c = 0; c < 3; ++c)
+                dst.emissive_factor[c] = material.getEmissiveFactor()[c];
+            dst.metallic_factor    = material.getMetallicFactor();
+            dst.roughness_factor   = material.getRoughnessFactor();
+            dst.normal_scale       = material.getNormalScale();
+            dst.occlusion_strength = material.getOcclusionStrength();
+
+            const RenderState& render_state = material.getRenderState();
+            dst.blend_mode                  = static_cast<uint8_t>(render_state.blend_mode);
+            dst.cull_mode                   = static_cast<uint8_t>(render_state.cull_mode);
+            dst.depth_test                  = static_cast<uint8_t>(render_state.depth_test);
+            dst.depth_write                 = render_state.depth_write ? 1 : 0;
+        }
+
+        for (size_t i = 0; i < hierarchy.getNodeCount(); ++i)
+        {
+            const Node*                  node         = hierarchy.getNode(i);
+            const std::vector<uint32_t>& mesh_indices = node->getMeshIndices();
+
+            const size_t mesh_index_offset = writer.write(mesh_indices.data(), mesh_indices.size() * sizeof(uint32_t));
+
+            CookedNode& dst = writer.at<CookedNode>(node_table + i * sizeof(CookedNode));
+            std::memcpy(dst.local_transform, &node->getLocalTransform()[0][0], sizeof(dst.local_transform));
+            dst.parent            = hierarchy.getParent(i);
+            dst.mesh_index_count  = static_cast<uint32_t>(mesh_indices.size());
+            dst.mesh_index_offset = mesh_index_offset;
+        }
+
+        for (size_t i = 0; i < model.getAnimationCount(); ++i)
+        {
+            const Animation& animation      = model.getAnimation(i);
+            const auto&      channels       = animation.getChannels();
+            const size_t     channel_offset = writer.reserve<CookedChannel>(channels.size());
+
+            for (size_t c = 0; c < channels.size(); ++c)
+            {
+                CookedChannel cooked {};
+                cooked.node              = channels[c].node;
+                cooked.translation_count = static_cast<uint32_t>(channels[c].translations.times.size());
+                cooked.rotation_count    = static_cast<uint32_t>(channels[c].rotations.times.size());
+                cooked.scale_count       = static_cast<uint32_t>(channels[c].scales.times.size());
+                writeTrack(writer, channels[c].translations, cooked.translation_times, cooked.translation_values);
+                writeTrack(writer, channels[c].rotations, cooked.rotation_times, cooked.rotation_values);
+                writeTrack(writer, channels[c].scales, cooked.scale_times, cooked.scale_values);
+
+                // written last, the blobs above may have grown the buffer
+                writer.at<CookedChannel>(channel_offset + c * sizeof(CookedChannel)) = cooked;
+            }
+
+            CookedAnimation& dst = writer.at<CookedAnimation>(anim_table + i * sizeof(CookedAnimation));
+            dst.name             = addString(string_table, animation.getName());
+            dst.duration         = animation.getDuration();
+            dst.channel_count    = static_cast<uint32_t>(channels.size());
+            dst.channel_offset   = channel_offset;
+        }
+
+        const size_t string_offset = writer.write(string_table.data(), string_table.size());
+        writer.align();
+
+        CookedHeader& header = writer.at<CookedHeader>(header_offset);
+        std::memcpy(header.magic, COOKED_MAGIC, sizeof(COOKED_MAGIC));
+        header.version           = COOKED_MODEL_VERSION;
+        header.key               = key;
+        header.file_size         = writer.tell();
+        header.mesh_count        = static_cast<uint32_t>(model.getMeshCount());
+        header.material_count    = static_cast<uint32_t>(model.getMaterialCount());
+        header.node_count        = static_cast<uint32_t>(hierarchy.getNodeCount());
+        header.string_table_size = static_cast<uint32_t>(string_table.size());
+        header.animation_count   = static_cast<uint32_t>(model.getAnimationCount());
+        header.mesh_table        = mesh_table;
+        header.material_table    = mat_table;
+        header.node_table        = node_table;
+        header.animation_table   = anim_table;
+        header.string_table      = string_offset;
+
+        return writer.release();
+    }
+} // namespace RealmEngine
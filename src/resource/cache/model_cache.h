@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include "resource/datatype/model/model.h"
+#include "resource/importer/model_importer.h"
+
+namespace RealmEngine
+{
+    class AssetCache;
+
+    /**
+     * Cache of fully processed models ("cooked" models), kept in the shared AssetCache.
+     *
+     * A cooked file is a header followed by fixed-size mesh/material/node/animation tables and raw vertex, index,
+     * bone, keyframe and string blobs. Every reference inside the file is an offset from the file start, so reading
+     * it back is one mmap plus offset-to-pointer fix-ups and bulk copies; no parsing or post-processing happens.
+     * Texture paths are stored relative to the source model's folder, so a cooked model written from one checkout
+     * loads in any other.
+     */
+    class ModelCache
+    {
+    public:
+        // Bump whenever the cooked layout or anything stored in it changes.
+        static constexpr uint32_t COOKED_MODEL_VERSION = 7;
+
+        ModelCache()           = default;
+        ~ModelCache() noexcept = default;
+
+        ModelCache(const ModelCache&)            = delete;
+        ModelCache& operator=(const ModelCache&) = delete;
+        ModelCache(ModelCache&&)                 = delete;
+        ModelCache& operator=(ModelCache&&)      = delete;
+
+        void initialize(AssetCache& store);
+
+        void setEnabled(bool enabled) { m_enabled = enabled; }
+        bool isEnabled() const { return m_enabled; }
+
+        /**
+         * Hash of the source bytes, the bytes of the files it pulls in (glTF buffers, OBJ material libraries) and
+         * the import options; 0 if the source can't be read. Paths and timestamps play no part, so a fresh checkout
+         * of unchanged assets hits the entries cooked anywhere else.
+         */
+        uint64_t computeKey(const std::string& source_path, const ModelImporter::LoadOptions& options) const;
+
+        std::unique_ptr<Model> load(uint64_t key, const std::string& source_path) const;
+        bool                   store(uint64_t key, const Model& model, const std::string& source_path) const;
+
+        static std::unique_ptr<Model>
+        readCookedModel(const std::filesystem::path& path, uint64_t key, const std::filesystem::path& source_folder);
+        static std::vector<uint8_t>
+        cookModel(uint64_t key, const Model& model, const std::filesystem::path& source_folder);
+
+    private:
+        AssetCache* m_store {nullptr};
+        bool        m_enabled {true};
+    };
+} // namespace RealmEngine
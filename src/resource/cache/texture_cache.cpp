@@ -0,0 +1,178 @@
+#include "texture_cache.h"
+#include "asset_cache.h"
+#include "hash.h"
+#include "plateform/mapped_file.h"
+#include "utils.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace RealmEngine
+{
+    namespace
+    {
+        constexpr char     COOKED_MAGIC[4] = {'R', 'T', 'E', 'X'};
+        constexpr uint32_t MAX_LEVELS      = 32;
+        constexpr size_t   DATA_ALIGNMENT  = 16;
+
+        // ===== On-disk records =====
+        // All offsets are relative to the start of the file.
+
+        struct CookedHeader
+        {
+            char     magic[4];
+            uint32_t version;
+            uint64_t key;
+            uint64_t file_size;
+
+            uint8_t  format; // TextureFormat
+            uint8_t  srgb;
+            uint16_t reserved;
+            uint32_t level_count;
+            uint64_t level_table;
+        };
+
+        struct CookedLevel
+        {
+            uint32_t width;
+            uint32_t height;
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        size_t alignUp(size_t value) { return (value + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT; }
+    } // namespace
+
+    void TextureCache::initialize(AssetCache& store)
+    {
+        m_store = &store;
+        if (!m_store->isEnabled())
+            m_enabled = false;
+    }
+
+    uint64_t TextureCache::computeKey(const std::string& source_path, uint64_t options_hash) const
+    {
+        MappedFile source;
+        if (!source.open(source_path))
+            return 0;
+
+        uint64_t key = Hash::hashBytes(source.data(), source.size());
+        key          = Hash::combine(key, options_hash);
+        key          = Hash::combine(key, COOKED_TEXTURE_VERSION);
+        return key == 0 ? 1 : key;
+    }
+
+    std::unique_ptr<CompressedTexture> TextureCache::load(uint64_t key) const
+    {
+        if (!m_enabled || key == 0)
+            return nullptr;
+
+        std::filesystem::path cooked_path = m_store->getEntryPath(key, ".rtex");
+        if (!std::filesystem::exists(cooked_path))
+            return nullptr;
+
+        std::unique_ptr<CompressedTexture> texture = readCookedTexture(cooked_path, key);
+        if (texture)
+            m_store->touch(cooked_path);
+        return texture;
+    }
+
+    bool TextureCache::store(uint64_t key, const CompressedTexture& texture) const
+    {
+        if (!m_enabled || key == 0)
+            return false;
+
+        const std::vector<uint8_t> bytes = cookTexture(key, texture);
+        return !bytes.empty() && m_store->publish(m_store->getEntryPath(key, ".rtex"), bytes.data(), bytes.size());
+    }
+
+    std::unique_ptr<CompressedTexture> TextureCache::readCookedTexture(const std::filesystem::path& path, uint64_t key)
+    {
+        MappedFile file;
+        if (!file.open(path))
+        {
+            warn("Failed to map cooked texture: " + path.string());
+            return nullptr;
+        }
+
+        CookedHeader header;
+        if (file.size() < sizeof(header))
+        {
+            warn("Stale or corrupted cooked texture, ignoring: " + path.string());
+            return nullptr;
+        }
+        std::memcpy(&header, file.data(), sizeof(header));
+
+        if (std::memcmp(header.magic, COOKED_MAGIC, sizeof(COOKED_MAGIC)) != 0 ||
+            header.version != COOKED_TEXTURE_VERSION || header.key != key || header.file_size != file.size() ||
+            header.format > static_cast<uint8_t>(TextureFormat::BC7) || header.level_count == 0 ||
+            header.level_count > MAX_LEVELS || header.level_table > file.size() ||
+            sizeof(CookedLevel) * header.level_count > file.size() - header.level_table)
+        {
+            warn("Stale or corrupted cooked texture, ignoring: " + path.string());
+            return nullptr;
+        }
+
+        std::unique_ptr<CompressedTexture> texture = std::make_unique<CompressedTexture>();
+        texture->format                            = static_cast<TextureFormat>(header.format);
+        texture->srgb                              = header.srgb != 0;
+        texture->levels.resize(header.level_count);
+
+        for (uint32_t i = 0; i < header.level_count; ++i)
+        {
+            CookedLevel level;
+            std::memcpy(&level, file.data() + header.level_table + sizeof(CookedLevel) * i, sizeof(level));
+
+            if (level.offset > file.size() || level.size > file.size() - level.offset ||
+                level.size != TextureEncoder::getLevelSize(texture->format, level.width, level.height))
+            {
+                warn("Cooked texture levels out of range: " + path.string());
+                return nullptr;
+            }
+
+            TextureLevel& out = texture->levels[i];
+            out.width         = level.width;
+            out.height        = level.height;
+            out.data.assign(file.data() + level.offset, file.data() + level.offset + level.size);
+        }
+
+        return texture;
+    }
+
+    std::vector<uint8_t> TextureCache::cookTexture(uint64_t key, const CompressedTexture& texture)
+    {
+        const uint32_t level_count = static_cast<uint32_t>(texture.levels.size());
+        if (level_count == 0 || level_count > MAX_LEVELS)
+            return {};
+
+        CookedHeader header {};
+        std::memcpy(header.magic, COOKED_MAGIC, sizeof(COOKED_MAGIC));
+        header.version     = COOKED_TEXTURE_VERSION;
+        header.key         = key;
+        header.format      = static_cast<uint8_t>(texture.format);
+        header.srgb        = texture.srgb ? 1 : 0;
+        header.level_count = level_count;
+        header.level_table = alignUp(sizeof(CookedHeader));
+
+        std::vector<CookedLevel> levels(level_count);
+        size_t                   offset = alignUp(header.level_table + sizeof(CookedLevel) * level_count);
+        for (uint32_t i = 0; i < level_count; ++i)
+        {
+            const TextureLevel& level = texture.levels[i];
+            levels[i]                 = CookedLevel {level.width, level.height, offset, level.data.size()};
+            offset                    = alignUp(offset + level.data.size());
+        }
+        header.file_size = offset;
+
+        std::vector<uint8_t> bytes(offset, 0);
+        std::memcpy(bytes.data(), &header, sizeof(header));
+        std::memcpy(bytes.data() + header.level_table, levels.data(), sizeof(CookedLevel) * level_count);
+        for (uint32_t i = 0; i < level_count; ++i)
+            std::memcpy(bytes.data() + levels[i].offset, texture.levels[i].data.data(), levels[i].size);
+
+        return bytes;
+    }
+} // namespace RealmEngine
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include "resource/processor/texture_encoder.h"
+
+namespace RealmEngine
+{
+    class AssetCache;
+
+    /**
+     * Cache of block-compressed textures in the shared AssetCache, so images are encoded once per source file.
+     *
+     * A cooked texture is a small KTX2/DDS-like container: a header with the format and size, a level table,
+     * then the level data ready for glCompressedTexImage2D. Files are named by the key, which hashes the source
+     * bytes with everything that affects encoding, so an edited source simply gets a new entry.
+     */
+    class TextureCache
+    {
+    public:
+        // Bump whenever the cooked layout or the encoder output changes.
+        static constexpr uint32_t COOKED_TEXTURE_VERSION = 1;
+
+        TextureCache()           = default;
+        ~TextureCache() noexcept = default;
+
+        TextureCache(const TextureCache&)            = delete;
+        TextureCache& operator=(const TextureCache&) = delete;
+        TextureCache(TextureCache&&)                 = delete;
+        TextureCache& operator=(TextureCache&&)      = delete;
+
+        void initialize(AssetCache& store);
+
+        void setEnabled(bool enabled) { m_enabled = enabled; }
+        bool isEnabled() const { return m_enabled; }
+
+        // Hash of the source bytes combined with the encode options; 0 if the source can't be read.
+        uint64_t computeKey(const std::string& source_path, uint64_t options_hash) const;
+
+        std::unique_ptr<CompressedTexture> load(uint64_t key) const;
+        bool                               store(uint64_t key, const CompressedTexture& texture) const;
+
+        static std::unique_ptr<CompressedTexture> readCookedTexture(const std::filesystem::path& path, uint64_t key);
+        // Empty if the texture has no levels or too many.
+        static std::vector<uint8_t> cookTexture(uint64_t key, const CompressedTexture& texture);
+
+    private:
+        AssetCache* m_store {nullptr};
+        bool        m_enabled {true};
+    };
+} // namespace RealmEngine
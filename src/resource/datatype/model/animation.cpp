@@ -0,0 +1,21 @@
+#include "animation.h"
+
+namespace RealmEngine
+{
+    size_t Animation::getKeyframeCount() const
+    {
+        size_t keys = 0;
+        for (const auto& channel : m_channels)
+            keys += channel.translations.times.size() + channel.rotations.times.size() + channel.scales.times.size();
+        return keys;
+    }
+
+    size_t Animation::getMemoryUsage() const
+    {
+        size_t bytes = sizeof(Animation) + m_name.capacity() + m_channels.capacity() * sizeof(AnimationChannel);
+        for (const auto& channel : m_channels)
+            bytes += channel.translations.getMemoryUsage() + channel.rotations.getMemoryUsage() +
+                     channel.scales.getMemoryUsage();
+        return bytes;
+    }
+} // namespace RealmEngine
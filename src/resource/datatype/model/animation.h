@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "glm/ext/quaternion_float.hpp"
+#include "glm/ext/vector_float3.hpp"
+
+namespace RealmEngine
+{
+    // Keyframes of one node property, times in seconds and ascending.
+    template<typename T>
+    struct AnimationTrack
+    {
+        std::vector<float> times;
+        std::vector<T>     values;
+
+        bool   empty() const { return times.empty(); }
+        size_t getMemoryUsage() const { return times.capacity() * sizeof(float) + values.capacity() * sizeof(T); }
+    };
+
+    // Animated node; a missing track keeps that part of the node's rest transform.
+    struct AnimationChannel
+    {
+        uint32_t                  node {0}; // index into the model's NodeHierarchy
+        AnimationTrack<glm::vec3> translations;
+        AnimationTrack<glm::quat> rotations;
+        AnimationTrack<glm::vec3> scales;
+    };
+
+    class Animation
+    {
+    public:
+        Animation()           = default;
+        ~Animation() noexcept = default;
+
+        Animation(const Animation& that)                = delete;
+        Animation& operator=(const Animation& that)     = delete;
+        Animation(Animation&& that) noexcept            = default;
+        Animation& operator=(Animation&& that) noexcept = default;
+
+        const std::string& getName() const { return m_name; }
+        void               setName(std::string name) { m_name = std::move(name); }
+
+        // seconds
+        float getDuration() const { return m_duration; }
+        void  setDuration(float duration) { m_duration = duration; }
+
+        const std::vector<AnimationChannel>& getChannels() const { return m_channels; }
+        std::vector<AnimationChannel>&       getChannels() { return m_channels; }
+
+        size_t getKeyframeCount() const;
+        size_t getMemoryUsage() const;
+
+    private:
+        std::string                   m_name;
+        float                         m_duration {0.0f};
+        std::vector<AnimationChannel> m_channels;
+    };
+} // namespace RealmEngine
@@ -0,0 +1,25 @@
+#include "index_buffer.h"
+#include <cstring>
+
+namespace RealmEngine
+{
+    IndexBuffer IndexBuffer::pack(const uint32_t* indices, size_t count, size_t vertex_count)
+    {
+        IndexBuffer buffer;
+        buffer.type  = pickType(vertex_count);
+        buffer.count = static_cast<uint32_t>(count);
+        buffer.data.resize(count * buffer.getIndexSize());
+
+        if (buffer.type == IndexType::UInt16)
+        {
+            auto* out = reinterpret_cast<uint16_t*>(buffer.data.data());
+            for (size_t i = 0; i < count; ++i)
+                out[i] = static_cast<uint16_t>(indices[i]);
+        }
+        else if (count > 0)
+        {
+            std::memcpy(buffer.data.data(), indices, count * sizeof(uint32_t));
+        }
+        return buffer;
+    }
+} // namespace RealmEngine
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace RealmEngine
+{
+    enum class IndexType : uint8_t
+    {
+        UInt16,
+        UInt32,
+    };
+
+    // Index data in the narrowest type that can address all vertices, ready for upload.
+    struct IndexBuffer
+    {
+        IndexType            type {IndexType::UInt32};
+        uint32_t             count {0};
+        std::vector<uint8_t> data;
+
+        // every index of a mesh with up to 65536 vertices fits 16 bits (no primitive restart is used)
+        static constexpr IndexType pickType(size_t vertex_count)
+        {
+            return vertex_count <= 0x10000 ? IndexType::UInt16 : IndexType::UInt32;
+        }
+        static constexpr size_t getIndexSize(IndexType type) { return type == IndexType::UInt16 ? 2 : 4; }
+
+        static IndexBuffer pack(const uint32_t* indices, size_t count, size_t vertex_count);
+
+        size_t getIndexSize() const { return getIndexSize(type); }
+        // byte offset of an index, for glDrawElements
+        size_t getByteOffset(uint32_t index) const { return index * getIndexSize(); }
+        bool   empty() const { return count == 0; }
+    };
+} // namespace RealmEngine
@@ -1,4 +1,7 @@
 #include "material.h"
+#include "hash.h"
+
+#include <cstring>
 
 namespace RealmEngine
 {
@@ -40,4 +43,82 @@ namespace RealmEngine
     void               Material::setRenderState(const RenderState& state) { m_render_state = state; }
     const RenderState& Material::getRenderState() const { return m_render_state; }
 
+    size_t Material::getMemoryUsage() const
+    {
+        size_t bytes = sizeof(Material);
+        for (const auto* texture : {&m_base_color_texture,
+                                    &m_metallic_roughness_texture,
+                                    &m_normal_texture,
+                                    &m_occlusion_texture,
+                                    &m_emissive_texture})
+            if (texture->has_value())
+                bytes += (*texture)->path.capacity();
+        return bytes;
+    }
+
+    namespace
+    {
+        uint64_t hashTexture(uint64_t seed, const std::optional<TextureRef>& texture)
+        {
+            if (!texture.has_value())
+                return Hash::combine(seed, 0);
+            seed = Hash::combine(seed, Hash::hashString(texture->path));
+            seed = Hash::combine(seed, texture->slot);
+            return Hash::combine(seed, texture->srgb);
+        }
+
+        bool sameTexture(const std::optional<TextureRef>& a, const std::optional<TextureRef>& b)
+        {
+            if (a.has_value() != b.has_value())
+                return false;
+            return !a.has_value() || (a->path == b->path && a->slot == b->slot && a->srgb == b->srgb);
+        }
+
+        // bitwise, so -0.0 and 0.0 stay apart like they hash
+        template<typename T>
+        bool sameBits(const T& a, const T& b)
+        {
+            return std::memcmp(&a, &b, sizeof(T)) == 0;
+        }
+    } // namespace
+
+    uint64_t Material::hash() const
+    {
+        uint64_t seed = 0;
+        seed          = hashTexture(seed, m_base_color_texture);
+        seed          = hashTexture(seed, m_metallic_roughness_texture);
+        seed          = hashTexture(seed, m_normal_texture);
+        seed          = hashTexture(seed, m_occlusion_texture);
+        seed          = hashTexture(seed, m_emissive_texture);
+        seed          = Hash::combine(seed, Hash::hashValue(m_base_color_factor));
+        seed          = Hash::combine(seed, Hash::hashValue(m_metallic_factor));
+        seed          = Hash::combine(seed, Hash::hashValue(m_roughness_factor));
+        seed          = Hash::combine(seed, Hash::hashValue(m_emissive_factor));
+        seed          = Hash::combine(seed, Hash::hashValue(m_normal_scale));
+        seed          = Hash::combine(seed, Hash::hashValue(m_occlusion_strength));
+        seed          = Hash::combine(seed, static_cast<uint64_t>(m_render_state.blend_mode));
+        seed          = Hash::combine(seed, static_cast<uint64_t>(m_render_state.cull_mode));
+        seed          = Hash::combine(seed, static_cast<uint64_t>(m_render_state.depth_test));
+        seed          = Hash::combine(seed, m_render_state.depth_write);
+        return seed;
+    }
+
+    bool Material::operator==(const Material& that) const
+    {
+        return sameTexture(m_base_color_texture, that.m_base_color_texture) &&
+               sameTexture(m_metallic_roughness_texture, that.m_metallic_roughness_texture) &&
+               sameTexture(m_normal_texture, that.m_normal_texture) &&
+               sameTexture(m_occlusion_texture, that.m_occlusion_texture) &&
+               sameTexture(m_emissive_texture, that.m_emissive_texture) &&
+               sameBits(m_base_color_factor, that.m_base_color_factor) &&
+               sameBits(m_metallic_factor, that.m_metallic_factor) &&
+               sameBits(m_roughness_factor, that.m_roughness_factor) &&
+               sameBits(m_emissive_factor, that.m_emissive_factor) &&
+               sameBits(m_normal_scale, that.m_normal_scale) &&
+               sameBits(m_occlusion_strength, that.m_occlusion_strength) &&
+               m_render_state.blend_mode == that.m_render_state.blend_mode &&
+               m_render_state.cull_mode == that.m_render_state.cull_mode &&
+               m_render_state.depth_test == that.m_render_state.depth_test &&
+               m_render_state.depth_write == that.m_render_state.depth_write;
+    }
 } // namespace RealmEngine
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <string>
@@ -90,6 +91,14 @@ namespace RealmEngine
         void               setRenderState(const RenderState& state);
         const RenderState& getRenderState() const;
 
+        // CPU memory held by this material, texture paths included
+        size_t getMemoryUsage() const;
+
+        // Over every texture and parameter, so equal materials hash equal; used to merge duplicates at import.
+        uint64_t hash() const;
+        bool     operator==(const Material& that) const;
+        bool     operator!=(const Material& that) const { return !(*this == that); }
+
     private:
         // PBR textures
         std::optional<TextureRef> m_base_color_texture;
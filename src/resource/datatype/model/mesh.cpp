@@ -2,165 +2,178 @@
 #include <cmath>
 #include <utility>
 #include "glm/geometric.hpp"
+#include "resource/processor/mesh_kernels.h"
+#include "resource/processor/vertex_encoder.h"
 
 namespace RealmEngine
 {
+    namespace
+    {
+        // SoA copy of the positions for MeshKernels
+        Vec3Stream gatherPositions(const std::vector<Vertex>& vertices)
+        {
+            Vec3Stream positions;
+            positions.resize(vertices.size());
+            for (size_t i = 0; i < vertices.size(); ++i)
+            {
+                positions.x[i] = vertices[i].position.x;
+                positions.y[i] = vertices[i].position.y;
+                positions.z[i] = vertices[i].position.z;
+            }
+            return positions;
+        }
+    } // namespace
+
     const std::vector<Vertex>&   Mesh::getVertices() const { return m_verts; }
     const std::vector<uint32_t>& Mesh::getIndices() const { return m_indices; }
     const std::vector<SubMesh>&  Mesh::getSubMeshes() const { return m_submeshes; }
     const AABB&                  Mesh::getBounds() const { return m_aabb; }
+    const std::vector<MeshLod>&  Mesh::getLods() const { return m_lods; }
 
-    std::vector<Vertex>&   Mesh::getVertices() { return m_verts; }
-    std::vector<uint32_t>& Mesh::getIndices() { return m_indices; }
-    std::vector<SubMesh>&  Mesh::getSubMeshes() { return m_submeshes; }
-    AABB&                  Mesh::getAABB() { return m_aabb; }
+    // the caller may write through a mutable reference, so handing one out counts as a change
+    std::vector<Vertex>& Mesh::getVertices()
+    {
+        ++m_gpu_data_version;
+        return m_verts;
+    }
+    std::vector<uint32_t>& Mesh::getIndices()
+    {
+        ++m_gpu_data_version;
+        return m_indices;
+    }
+    std::vector<SubMesh>& Mesh::getSubMeshes()
+    {
+        ++m_gpu_data_version;
+        return m_submeshes;
+    }
+    AABB& Mesh::getAABB()
+    {
+        ++m_gpu_data_version;
+        return m_aabb;
+    }
+    std::vector<MeshLod>& Mesh::getLods()
+    {
+        ++m_gpu_data_version;
+        return m_lods;
+    }
 
     void Mesh::setVertices(std::vector<Vertex>&& vertices)
     {
-        m_verts          = std::move(vertices);
-        m_gpu_data_dirty = true;
+        m_verts         = std::move(vertices);
+        m_encoded_verts = {};
+        ++m_gpu_data_version;
+        m_bvh.clear();
     }
     void Mesh::setIndices(std::vector<uint32_t>&& indices)
     {
-        m_indices        = std::move(indices);
-        m_gpu_data_dirty = true;
+        m_indices = std::move(indices);
+        ++m_gpu_data_version;
+        m_bvh.clear();
     }
 
-    void Mesh::addSubMesh(const SubMesh& submesh) { m_submeshes.push_back(submesh); }
-    void Mesh::clearSubMeshes() { m_submeshes.clear(); }
+    const MeshBvh& Mesh::getBvh() const { return m_bvh; }
+    void           Mesh::setBvh(MeshBvh&& bvh) { m_bvh = std::move(bvh); }
+    bool           Mesh::hasBvh() const { return !m_bvh.isEmpty(); }
 
-    bool Mesh::isGpuDataDirty() const { return m_gpu_data_dirty; }
-    void Mesh::markGpuDataSynced() { m_gpu_data_dirty = false; }
+    const EncodedVertices& Mesh::getEncodedVertices() const { return m_encoded_verts; }
+    void                   Mesh::setEncodedVertices(EncodedVertices&& encoded)
+    {
+        m_encoded_verts = std::move(encoded);
+        ++m_gpu_data_version;
+    }
+    bool Mesh::hasEncodedVertices() const { return !m_encoded_verts.empty(); }
 
-    void Mesh::calculateNormals()
+    IndexType   Mesh::getIndexType() const { return IndexBuffer::pickType(m_verts.size()); }
+    IndexBuffer Mesh::packIndices() const
     {
-        if (m_indices.empty() || m_verts.empty())
-            return;
+        return IndexBuffer::pack(m_indices.data(), m_indices.size(), m_verts.size());
+    }
 
-        for (auto& vert : m_verts)
-            vert.normal = glm::vec3(0.0f);
+    const std::vector<Bone>& Mesh::getBones() const { return m_bones; }
+    void                     Mesh::setBones(std::vector<Bone>&& bones)
+    {
+        m_bones         = std::move(bones);
+        m_encoded_verts = {};
+        ++m_gpu_data_version;
+    }
+    bool     Mesh::isSkinned() const { return !m_bones.empty(); }
+    uint32_t Mesh::getSkinNode() const { return m_skin_node; }
+    void     Mesh::setSkinNode(uint32_t node) { m_skin_node = node; }
 
-        for (size_t i = 0; i < m_indices.size(); i += 3)
-        {
-            uint32_t idx0 = m_indices[i];
-            uint32_t idx1 = m_indices[i + 1];
-            uint32_t idx2 = m_indices[i + 2];
+    void Mesh::addSubMesh(const SubMesh& submesh) { m_submeshes.push_back(submesh); }
+    void Mesh::clearSubMeshes() { m_submeshes.clear(); }
 
-            if (idx0 >= m_verts.size() || idx1 >= m_verts.size() || idx2 >= m_verts.size())
-                continue;
+    uint64_t Mesh::getGpuDataVersion() const { return m_gpu_data_version; }
 
-            const glm::vec3& p0 = m_verts[idx0].position;
-            const glm::vec3& p1 = m_verts[idx1].position;
-            const glm::vec3& p2 = m_verts[idx2].position;
+    void Mesh::calculateNormals(ThreadPool* pool)
+    {
+        if (m_indices.empty() || m_verts.empty())
+            return;
 
-            glm::vec3 edge1       = p1 - p0;
-            glm::vec3 edge2       = p2 - p0;
-            glm::vec3 face_normal = glm::cross(edge1, edge2);
+        const Vec3Stream positions = gatherPositions(m_verts);
+        Vec3Stream       normals;
 
-            m_verts[idx0].normal += face_normal;
-            m_verts[idx1].normal += face_normal;
-            m_verts[idx2].normal += face_normal;
-        }
+        MeshKernels::computeNormals(m_indices.data(), m_indices.size(), positions, normals, pool);
 
-        for (auto& vert : m_verts)
-            if (glm::length(vert.normal) > 0.0f)
-                vert.normal = glm::normalize(vert.normal);
+        for (size_t i = 0; i < m_verts.size(); ++i)
+            m_verts[i].normal = glm::vec3(normals.x[i], normals.y[i], normals.z[i]);
 
-        m_gpu_data_dirty = true;
+        m_encoded_verts = {};
+        ++m_gpu_data_version;
     }
 
-    void Mesh::calculateTangents()
+    void Mesh::calculateTangents(ThreadPool* pool)
     {
         if (m_indices.empty() || m_verts.empty())
             return;
 
-        for (auto& vert : m_verts)
+        const Vec3Stream   positions = gatherPositions(m_verts);
+        Vec3Stream         normals, tangents, bitangents;
+        std::vector<float> u(m_verts.size()), v(m_verts.size());
+        normals.resize(m_verts.size());
+        for (size_t i = 0; i < m_verts.size(); ++i)
         {
-            vert.tangent   = glm::vec3(0.0f);
-            vert.bitangent = glm::vec3(0.0f);
+            normals.x[i] = m_verts[i].normal.x;
+            normals.y[i] = m_verts[i].normal.y;
+            normals.z[i] = m_verts[i].normal.z;
+            u[i]         = m_verts[i].tex_coord.x;
+            v[i]         = m_verts[i].tex_coord.y;
         }
 
-        for (size_t i = 0; i < m_indices.size(); i += 3)
-        {
-            uint32_t idx0 = m_indices[i];
-            uint32_t idx1 = m_indices[i + 1];
-            uint32_t idx2 = m_indices[i + 2];
-
-            if (idx0 >= m_verts.size() || idx1 >= m_verts.size() || idx2 >= m_verts.size())
-                continue;
-
-            const glm::vec3& p0 = m_verts[idx0].position;
-            const glm::vec3& p1 = m_verts[idx1].position;
-            const glm::vec3& p2 = m_verts[idx2].position;
-
-            const glm::vec2& uv0 = m_verts[idx0].tex_coord;
-            const glm::vec2& uv1 = m_verts[idx1].tex_coord;
-            const glm::vec2& uv2 = m_verts[idx2].tex_coord;
-
-            glm::vec3 edge1 = p1 - p0;
-            glm::vec3 edge2 = p2 - p0;
-
-            glm::vec2 delta_uv1 = uv1 - uv0;
-            glm::vec2 delta_uv2 = uv2 - uv0;
-
-            float det = delta_uv1.x * delta_uv2.y - delta_uv2.x * delta_uv1.y;
-
-            constexpr float epsilon = 1e-6f;
-            if (std::abs(det) < epsilon)
-                continue;
-
-            float f = 1.0f / det;
-
-            glm::vec3 tangent;
-            tangent.x = f * (delta_uv2.y * edge1.x - delta_uv1.y * edge2.x);
-            tangent.y = f * (delta_uv2.y * edge1.y - delta_uv1.y * edge2.y);
-            tangent.z = f * (delta_uv2.y * edge1.z - delta_uv1.y * edge2.z);
-
-            glm::vec3 bitangent;
-            bitangent.x = f * (-delta_uv2.x * edge1.x + delta_uv1.x * edge2.x);
-            bitangent.y = f * (-delta_uv2.x * edge1.y + delta_uv1.x * edge2.y);
-            bitangent.z = f * (-delta_uv2.x * edge1.z + delta_uv1.x * edge2.z);
-
-            m_verts[idx0].tangent += tangent;
-            m_verts[idx1].tangent += tangent;
-            m_verts[idx2].tangent += tangent;
+        MeshKernels::computeTangents(
+            m_indices.data(), m_indices.size(), positions, u, v, normals, tangents, bitangents, pool);
 
-            m_verts[idx0].bitangent += bitangent;
-            m_verts[idx1].bitangent += bitangent;
-            m_verts[idx2].bitangent += bitangent;
-        }
-
-        for (auto& vert : m_verts)
+        for (size_t i = 0; i < m_verts.size(); ++i)
         {
-            if (glm::length(vert.tangent) > 0.0f)
-                // Gram-Schmidt orthogonalization
-                vert.tangent = glm::normalize(vert.tangent - vert.normal * glm::dot(vert.normal, vert.tangent));
-
-            if (glm::length(vert.bitangent) > 0.0f)
-                vert.bitangent = glm::normalize(vert.bitangent);
+            m_verts[i].tangent   = glm::vec3(tangents.x[i], tangents.y[i], tangents.z[i]);
+            m_verts[i].bitangent = glm::vec3(bitangents.x[i], bitangents.y[i], bitangents.z[i]);
         }
 
-        m_gpu_data_dirty = true;
+        m_encoded_verts = {};
+        ++m_gpu_data_version;
     }
 
-    void Mesh::calculateAABB()
+    void Mesh::calculateAABB(ThreadPool* pool)
     {
-        if (m_verts.empty())
-        {
-            m_aabb.min = glm::vec3(0.0f);
-            m_aabb.max = glm::vec3(0.0f);
-            return;
-        }
+        m_aabb = MeshKernels::computeBounds(gatherPositions(m_verts), pool);
+    }
 
-        m_aabb.min = m_verts[0].position;
-        m_aabb.max = m_verts[0].position;
+    void Mesh::encodeVertices(bool quantize_positions)
+    {
+        setEncodedVertices(VertexEncoder::encode(m_verts, m_aabb, quantize_positions, isSkinned()));
+    }
 
-        for (const auto& vert : m_verts)
-        {
-            m_aabb.min = glm::min(m_aabb.min, vert.position);
-            m_aabb.max = glm::max(m_aabb.max, vert.position);
-        }
+    size_t Mesh::getVertexMemoryUsage() const
+    {
+        return m_verts.capacity() * sizeof(Vertex) + m_encoded_verts.data.capacity() +
+               m_bones.capacity() * sizeof(Bone);
+    }
+    size_t Mesh::getIndexMemoryUsage() const
+    {
+        return m_indices.capacity() * sizeof(uint32_t) + m_submeshes.capacity() * sizeof(SubMesh) +
+               m_lods.capacity() * sizeof(MeshLod);
     }
+    size_t Mesh::getBvhMemoryUsage() const { return m_bvh.getMemoryUsage(); }
 
     bool Mesh::isValid() const
     {
@@ -194,9 +207,14 @@ namespace RealmEngine
         m_verts.clear();
         m_indices.clear();
         m_submeshes.clear();
-        m_aabb.min       = glm::vec3(0.0f);
-        m_aabb.max       = glm::vec3(0.0f);
-        m_gpu_data_dirty = true;
+        m_lods.clear();
+        m_bones.clear();
+        m_skin_node     = 0;
+        m_encoded_verts = {};
+        m_bvh.clear();
+        m_aabb.min = glm::vec3(0.0f);
+        m_aabb.max = glm::vec3(0.0f);
+        ++m_gpu_data_version;
     }
 
 } // namespace RealmEngine
\ No newline at end of file
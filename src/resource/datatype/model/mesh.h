@@ -1,14 +1,20 @@
 #pragma once
 
 #include <cstdint>
+#include <glm/ext/matrix_float4x4.hpp>
 #include <glm/ext/vector_float2.hpp>
 #include <glm/ext/vector_float3.hpp>
 #include <glm/ext/vector_float4.hpp>
 #include <vector>
 #include "math.h"
+#include "resource/datatype/model/index_buffer.h"
+#include "resource/datatype/model/mesh_bvh.h"
+#include "resource/datatype/model/packed_vertex.h"
 
 namespace RealmEngine
 {
+    class ThreadPool;
+
     struct Vertex
     {
         glm::vec3 position;
@@ -17,6 +23,28 @@ namespace RealmEngine
         glm::vec3 tangent;
         glm::vec3 bitangent;
         glm::vec4 color;
+
+        // skinning, up to 4 influences with weights summing to 1; all zero for static meshes
+        uint16_t  joints[4] {0, 0, 0, 0};
+        glm::vec4 weights {0.0f};
+    };
+
+    // Joints one skinned mesh can reference, the size of the joint palette in pbr.vert.
+    constexpr uint32_t MAX_MESH_BONES = 128;
+
+    // A joint of a skinned mesh: the node it follows and the matrix from mesh space into the joint's bind space.
+    struct Bone
+    {
+        uint32_t  node {0}; // index into the model's NodeHierarchy
+        glm::mat4 inverse_bind {1.0f};
+    };
+
+    // A simplified index range over the mesh vertices. error is the object-space deviation from LOD 0.
+    struct MeshLod
+    {
+        uint32_t base_index {0};
+        uint32_t index_count {0};
+        float    error {0.0f};
     };
 
     struct SubMesh
@@ -25,9 +53,13 @@ namespace RealmEngine
         uint32_t index_count;
         uint32_t material_idx;
 
-        SubMesh() : base_index(0), index_count(0), material_idx(0) {}
+        // coarser levels, stored as Mesh::getLods()[lod_offset, lod_offset + lod_count); LOD 0 is this range
+        uint32_t lod_offset;
+        uint32_t lod_count;
+
+        SubMesh() : base_index(0), index_count(0), material_idx(0), lod_offset(0), lod_count(0) {}
         SubMesh(uint32_t base_idx, uint32_t idx_count, uint32_t mat_idx) :
-            base_index(base_idx), index_count(idx_count), material_idx(mat_idx)
+            base_index(base_idx), index_count(idx_count), material_idx(mat_idx), lod_offset(0), lod_count(0)
         {}
 
         constexpr uint32_t getTriangleCount() const { return index_count / 3; }
@@ -52,36 +84,72 @@ namespace RealmEngine
         const std::vector<uint32_t>& getIndices() const;
         const std::vector<SubMesh>&  getSubMeshes() const;
         const AABB&                  getBounds() const;
+        const std::vector<MeshLod>&  getLods() const;
 
+        // Mutable access bumps the GPU data version whether or not the caller writes, read through a const Mesh.
         std::vector<Vertex>&   getVertices();
         std::vector<uint32_t>& getIndices();
         std::vector<SubMesh>&  getSubMeshes();
         AABB&                  getAABB();
+        std::vector<MeshLod>&  getLods();
 
         void setVertices(std::vector<Vertex>&& vertices);
         void setIndices(std::vector<uint32_t>&& indices);
 
+        // Compact GPU copy of the vertices, dropped whenever the float vertices change.
+        const EncodedVertices& getEncodedVertices() const;
+        void                   setEncodedVertices(EncodedVertices&& encoded);
+        bool                   hasEncodedVertices() const;
+
+        // Ray query tree over the LOD 0 triangles, dropped with the vertices or indices it was built from.
+        const MeshBvh& getBvh() const;
+        void           setBvh(MeshBvh&& bvh);
+        bool           hasBvh() const;
+
+        // Narrowest index type for the vertex count; indices are kept 32-bit on the CPU while processing.
+        IndexType   getIndexType() const;
+        IndexBuffer packIndices() const;
+
+        // Skinning. Vertex::joints index into the bones; the skin node is the node the mesh hangs from, whose
+        // world transform is divided out of the joint matrices so skinned vertices stay in mesh space.
+        const std::vector<Bone>& getBones() const;
+        void                     setBones(std::vector<Bone>&& bones);
+        bool                     isSkinned() const;
+        uint32_t                 getSkinNode() const;
+        void                     setSkinNode(uint32_t node);
+
         // SubMesh
         void addSubMesh(const SubMesh& submesh);
         void clearSubMeshes();
 
-        // Mesh Utilities
-        void calculateNormals();
-        void calculateTangents();
-        void calculateAABB();
+        // Mesh Utilities, vectorised by MeshKernels and split over the pool when one is given
+        void calculateNormals(ThreadPool* pool = nullptr);
+        void calculateTangents(ThreadPool* pool = nullptr);
+        void calculateAABB(ThreadPool* pool = nullptr);
+        void encodeVertices(bool quantize_positions);
         bool isValid() const;
         void clear();
 
-        // GPU data management
-        bool isGpuDataDirty() const;
-        void markGpuDataSynced();
+        // CPU memory held by vertex data (including bones), index data (including submesh ranges) and the BVH
+        size_t getVertexMemoryUsage() const;
+        size_t getIndexMemoryUsage() const;
+        size_t getBvhMemoryUsage() const;
+
+        // Bumped by every change a GPU copy has to follow, never 0. Each copy remembers the version it was made
+        // from, so any number of renderers can share the mesh without writing to it.
+        uint64_t getGpuDataVersion() const;
 
     private:
         std::vector<Vertex>   m_verts;
         std::vector<uint32_t> m_indices;
         std::vector<SubMesh>  m_submeshes;
+        std::vector<MeshLod>  m_lods;
+        std::vector<Bone>     m_bones;
+        uint32_t              m_skin_node {0};
         AABB                  m_aabb;
+        EncodedVertices       m_encoded_verts;
+        MeshBvh               m_bvh;
 
-        bool m_gpu_data_dirty {true};
+        uint64_t m_gpu_data_version {1};
     };
 } // namespace RealmEngine
\ No newline at end of file
@@ -0,0 +1,398 @@
+#include "mesh_bvh.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include "resource/processor/mesh_kernels.h"
+#include "resource/processor/simd_target.h"
+
+namespace RealmEngine
+{
+    namespace
+    {
+        using SimdLevel = MeshKernels::SimdLevel;
+        using Node      = MeshBvh::Node;
+        using Block     = MeshBvh::TriangleBlock;
+
+        constexpr uint32_t WIDTH      = MeshBvh::WIDTH;
+        constexpr size_t   STACK_SIZE = MeshBvh::MAX_DEPTH * WIDTH; // each level leaves at most WIDTH - 1 behind
+        constexpr float    HUGE_SLOPE = 1e30f; // stands in for 1 / 0 on axes the ray runs parallel to
+
+        // a subtree or leaf still to visit, and where the ray enters its box
+        struct StackEntry
+        {
+            uint32_t child;
+            uint32_t count;
+            float    t_near;
+        };
+
+        struct RayData
+        {
+            float origin[3];
+            float direction[3];
+            float inv_direction[3];
+        };
+
+        RayData prepareRay(const Ray& ray)
+        {
+            RayData data;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const float d            = ray.direction[axis];
+                data.origin[axis]        = ray.origin[axis];
+                data.direction[axis]     = d;
+                data.inv_direction[axis] = std::fabs(d) > 1.0f / HUGE_SLOPE ? 1.0f / d : std::copysign(HUGE_SLOPE, d);
+            }
+            return data;
+        }
+
+        uint32_t blockCount(uint32_t triangles) { return (triangles + WIDTH - 1) / WIDTH; }
+
+        // ===== Scalar reference =====
+
+        // Bit k set when the ray enters child k within [t_min, t_max]; t_near receives the entry distances.
+        uint32_t intersectNodeScalar(const Node& node, const RayData& ray, float t_min, float t_max, float* t_near)
+        {
+            const float* mins[3] = {node.min_x, node.min_y, node.min_z};
+            const float* maxs[3] = {node.max_x, node.max_y, node.max_z};
+
+            uint32_t mask = 0;
+            for (uint32_t k = 0; k < WIDTH; ++k)
+            {
+                float t_enter = t_min;
+                float t_exit  = t_max;
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    const float t0 = (mins[axis][k] - ray.origin[axis]) * ray.inv_direction[axis];
+                    const float t1 = (maxs[axis][k] - ray.origin[axis]) * ray.inv_direction[axis];
+                    t_enter        = std::max(t_enter, std::min(t0, t1));
+                    t_exit         = std::min(t_exit, std::max(t0, t1));
+                }
+                t_near[k] = t_enter;
+                if (t_enter <= t_exit)
+                    mask |= 1u << k;
+            }
+            return mask;
+        }
+
+        // Bit k set when triangle k crosses the ray with t in [t_min, t_max); t, u and v receive the hits.
+        uint32_t intersectBlockScalar(const Block&   block,
+                                      const RayData& ray,
+                                      float          t_min,
+                                      float          t_max,
+                                      float*         t,
+                                      float*         u,
+                                      float*         v)
+        {
+            const float* d = ray.direction;
+
+            uint32_t mask = 0;
+            for (uint32_t k = 0; k < WIDTH; ++k)
+            {
+                const float e1[3] = {block.e1_x[k], block.e1_y[k], block.e1_z[k]};
+                const float e2[3] = {block.e2_x[k], block.e2_y[k], block.e2_z[k]};
+                const float s[3]  = {ray.origin[0] - block.v0_x[k],
+                                     ray.origin[1] - block.v0_y[k],
+                                     ray.origin[2] - block.v0_z[k]};
+
+                const float p[3] = {
+                    d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0]};
+                const float q[3] = {
+                    s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0]};
+
+                const float det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+                if (det == 0.0f)
+                    continue;
+
+                const float inv_det = 1.0f / det;
+                u[k]                = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inv_det;
+                v[k]                = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * inv_det;
+                t[k]                = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * inv_det;
+                if (u[k] >= 0.0f && v[k] >= 0.0f && u[k] + v[k] <= 1.0f && t[k] >= t_min && t[k] < t_max)
+                    mask |= 1u << k;
+            }
+            return mask;
+        }
+
+#if defined(REALM_KERNELS_X86)
+        // ===== SSE2 =====
+        // The same steps on all four lanes at once.
+
+        struct RayLanes
+        {
+            __m128 origin[3];
+            __m128 direction[3];
+            __m128 inv_direction[3];
+        };
+
+        RayLanes broadcastRay(const RayData& ray)
+        {
+            RayLanes lanes;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                lanes.origin[axis]        = _mm_set1_ps(ray.origin[axis]);
+                lanes.direction[axis]     = _mm_set1_ps(ray.direction[axis]);
+                lanes.inv_direction[axis] = _mm_set1_ps(ray.inv_direction[axis]);
+            }
+            return lanes;
+        }
+
+        uint32_t intersectNodeSse2(const Node& node, const RayLanes& ray, float t_min, float t_max, float* t_near)
+        {
+            const float* mins[3] = {node.min_x, node.min_y, node.min_z};
+            const float* maxs[3] = {node.max_x, node.max_y, node.max_z};
+
+            __m128 t_enter = _mm_set1_ps(t_min);
+            __m128 t_exit  = _mm_set1_ps(t_max);
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const __m128 lower = _mm_sub_ps(_mm_load_ps(mins[axis]), ray.origin[axis]);
+                const __m128 upper = _mm_sub_ps(_mm_load_ps(maxs[axis]), ray.origin[axis]);
+                const __m128 t0    = _mm_mul_ps(lower, ray.inv_direction[axis]);
+                const __m128 t1    = _mm_mul_ps(upper, ray.inv_direction[axis]);
+                t_enter            = _mm_max_ps(t_enter, _mm_min_ps(t0, t1));
+                t_exit             = _mm_min_ps(t_exit, _mm_max_ps(t0, t1));
+            }
+            _mm_storeu_ps(t_near, t_enter);
+            return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(t_enter, t_exit)));
+        }
+
+        uint32_t intersectBlockSse2(const Block&    block,
+                                    const RayLanes& ray,
+                                    float           t_min,
+                                    float           t_max,
+                                    float*          t,
+                                    float*          u,
+                                    float*          v)
+        {
+            const __m128* d     = ray.direction;
+            const __m128  e1[3] = {_mm_load_ps(block.e1_x), _mm_load_ps(block.e1_y), _mm_load_ps(block.e1_z)};
+            const __m128  e2[3] = {_mm_load_ps(block.e2_x), _mm_load_ps(block.e2_y), _mm_load_ps(block.e2_z)};
+            const __m128  s[3]  = {_mm_sub_ps(ray.origin[0], _mm_load_ps(block.v0_x)),
+                                   _mm_sub_ps(ray.origin[1], _mm_load_ps(block.v0_y)),
+                                   _mm_sub_ps(ray.origin[2], _mm_load_ps(block.v0_z))};
+
+            auto cross = [](const __m128* a, const __m128* b, __m128* out) {
+                out[0] = _mm_sub_ps(_mm_mul_ps(a[1], b[2]), _mm_mul_ps(a[2], b[1]));
+                out[1] = _mm_sub_ps(_mm_mul_ps(a[2], b[0]), _mm_mul_ps(a[0], b[2]));
+                out[2] = _mm_sub_ps(_mm_mul_ps(a[0], b[1]), _mm_mul_ps(a[1], b[0]));
+            };
+            auto dot = [](const __m128* a, const __m128* b) {
+                return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])), _mm_mul_ps(a[2], b[2]));
+            };
+
+            __m128 p[3];
+            __m128 q[3];
+            cross(d, e2, p);
+            cross(s, e1, q);
+
+            const __m128 zero    = _mm_setzero_ps();
+            const __m128 det     = dot(e1, p);
+            const __m128 inv_det = _mm_div_ps(_mm_set1_ps(1.0f), det);
+            const __m128 lane_u  = _mm_mul_ps(dot(s, p), inv_det);
+            const __m128 lane_v  = _mm_mul_ps(dot(d, q), inv_det);
+            const __m128 lane_t  = _mm_mul_ps(dot(e2, q), inv_det);
+
+            // comparisons with a NaN are false, which drops the det == 0 lanes along with the misses
+            __m128 hit = _mm_cmpneq_ps(det, zero);
+            hit        = _mm_and_ps(hit, _mm_cmpge_ps(lane_u, zero));
+            hit        = _mm_and_ps(hit, _mm_cmpge_ps(lane_v, zero));
+            hit        = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(lane_u, lane_v), _mm_set1_ps(1.0f)));
+            hit        = _mm_and_ps(hit, _mm_cmpge_ps(lane_t, _mm_set1_ps(t_min)));
+            hit        = _mm_and_ps(hit, _mm_cmplt_ps(lane_t, _mm_set1_ps(t_max)));
+
+            _mm_storeu_ps(t, lane_t);
+            _mm_storeu_ps(u, lane_u);
+            _mm_storeu_ps(v, lane_v);
+            return static_cast<uint32_t>(_mm_movemask_ps(hit));
+        }
+#endif
+
+        /**
+         * Depth-first walk shared by both queries and both instruction sets. Nearer children are visited first
+         * and subtrees the ray enters past the current best are skipped; any_hit stops at the first triangle.
+         */
+        template<typename IntersectNode, typename IntersectBlock>
+        bool traverse(const std::vector<Node>&  nodes,
+                      const std::vector<Block>& blocks,
+                      float                     t_min,
+                      RayHit&                   hit,
+                      bool                      any_hit,
+                      IntersectNode&&           intersect_node,
+                      IntersectBlock&&          intersect_block)
+        {
+            StackEntry stack[STACK_SIZE];
+            size_t     size  = 0;
+            bool       found = false;
+            stack[size++]    = StackEntry {0, 0, t_min};
+
+            while (size > 0)
+            {
+                const StackEntry entry = stack[--size];
+                if (entry.t_near > hit.t)
+                    continue;
+
+                if (entry.count > 0)
+                {
+                    const uint32_t end = entry.child + blockCount(entry.count);
+                    for (uint32_t b = entry.child; b < end; ++b)
+                    {
+                        float    t[WIDTH], u[WIDTH], v[WIDTH];
+                        const uint32_t mask = intersect_block(blocks[b], t_min, hit.t, t, u, v);
+                        for (uint32_t k = 0; k < WIDTH; ++k)
+                        {
+                            if (!(mask & (1u << k)) || t[k] >= hit.t)
+                                continue;
+                            hit.t        = t[k];
+                            hit.u        = u[k];
+                            hit.v        = v[k];
+                            hit.triangle = blocks[b].triangle[k];
+                            found        = true;
+                            if (any_hit)
+                                return true;
+                        }
+                    }
+                    continue;
+                }
+
+                const Node&    node = nodes[entry.child];
+                float          t_near[WIDTH];
+                const uint32_t mask = intersect_node(node, t_min, hit.t, t_near);
+
+                // push the children far to near, so the nearest comes off the stack first
+                StackEntry hits[WIDTH];
+                uint32_t   hit_count = 0;
+                for (uint32_t k = 0; k < WIDTH; ++k)
+                {
+                    if (!(mask & (1u << k)) || node.child[k] == MeshBvh::EMPTY_CHILD)
+                        continue;
+
+                    StackEntry child {node.child[k], node.count[k], t_near[k]};
+                    uint32_t   at = hit_count++;
+                    for (; at > 0 && hits[at - 1].t_near < child.t_near; --at)
+                        hits[at] = hits[at - 1];
+                    hits[at] = child;
+                }
+                for (uint32_t i = 0; i < hit_count; ++i)
+                    stack[size++] = hits[i];
+            }
+            return found;
+        }
+
+        template<typename Visit>
+        bool query(const RayData& ray, Visit&& visit)
+        {
+#if defined(REALM_KERNELS_X86)
+            if (MeshKernels::getSimdLevel() != SimdLevel::Scalar)
+            {
+                const RayLanes lanes = broadcastRay(ray);
+                return visit(
+                    [&](const Node& node, float t_min, float t_max, float* t_near) {
+                        return intersectNodeSse2(node, lanes, t_min, t_max, t_near);
+                    },
+                    [&](const Block& block, float t_min, float t_max, float* t, float* u, float* v) {
+                        return intersectBlockSse2(block, lanes, t_min, t_max, t, u, v);
+                    });
+            }
+#endif
+            return visit(
+                [&](const Node& node, float t_min, float t_max, float* t_near) {
+                    return intersectNodeScalar(node, ray, t_min, t_max, t_near);
+                },
+                [&](const Block& block, float t_min, float t_max, float* t, float* u, float* v) {
+                    return intersectBlockScalar(block, ray, t_min, t_max, t, u, v);
+                });
+        }
+    } // namespace
+
+    MeshBvh::MeshBvh(std::vector<Node>&& nodes, std::vector<TriangleBlock>&& blocks) :
+        m_nodes(std::move(nodes)), m_blocks(std::move(blocks))
+    {}
+
+    void MeshBvh::clear()
+    {
+        m_nodes.clear();
+        m_blocks.clear();
+    }
+
+    AABB MeshBvh::getBounds() const
+    {
+        AABB bounds {glm::vec3(std::numeric_limits<float>::max()), glm::vec3(-std::numeric_limits<float>::max())};
+        if (m_nodes.empty())
+            return AABB {glm::vec3(0.0f), glm::vec3(0.0f)};
+
+        const Node& root = m_nodes.front();
+        for (uint32_t k = 0; k < WIDTH; ++k)
+        {
+            if (root.child[k] == EMPTY_CHILD)
+                continue;
+            bounds.merge(AABB {glm::vec3(root.min_x[k], root.min_y[k], root.min_z[k]),
+                               glm::vec3(root.max_x[k], root.max_y[k], root.max_z[k])});
+        }
+        return bounds;
+    }
+
+    size_t MeshBvh::getMemoryUsage() const
+    {
+        return m_nodes.capacity() * sizeof(Node) + m_blocks.capacity() * sizeof(TriangleBlock);
+    }
+
+    bool MeshBvh::closestHit(const Ray& ray, RayHit& hit, float t_min) const
+    {
+        if (m_nodes.empty())
+            return false;
+
+        RayHit best   = hit;
+        best.triangle = RayHit::INVALID_TRIANGLE;
+        const bool found = query(prepareRay(ray), [&](auto&& intersect_node, auto&& intersect_block) {
+            return traverse(m_nodes, m_blocks, t_min, best, false, intersect_node, intersect_block);
+        });
+        if (found)
+            hit = best;
+        return found;
+    }
+
+    bool MeshBvh::anyHit(const Ray& ray, float t_max, float t_min) const
+    {
+        if (m_nodes.empty())
+            return false;
+
+        // the walk excludes hits at the bound itself, nudge it so t_max counts
+        RayHit hit;
+        hit.t = std::nextafter(t_max, std::numeric_limits<float>::infinity());
+        return query(prepareRay(ray), [&](auto&& intersect_node, auto&& intersect_block) {
+            return traverse(m_nodes, m_blocks, t_min, hit, true, intersect_node, intersect_block);
+        });
+    }
+
+    bool MeshBvh::isValid() const
+    {
+        if (m_nodes.empty())
+            return m_blocks.empty();
+
+        // children always follow their parent, which rules out cycles; depth bounds the traversal stack
+        std::vector<uint32_t> depth(m_nodes.size(), 0);
+        for (size_t i = 0; i < m_nodes.size(); ++i)
+        {
+            const Node& node = m_nodes[i];
+            for (uint32_t k = 0; k < WIDTH; ++k)
+            {
+                const uint32_t child = node.child[k];
+                if (child == EMPTY_CHILD)
+                    continue;
+
+                if (node.count[k] > 0)
+                {
+                    if (child > m_blocks.size() || blockCount(node.count[k]) > m_blocks.size() - child)
+                        return false;
+                }
+                else
+                {
+                    if (child <= i || child >= m_nodes.size() || depth[i] + 1 >= MAX_DEPTH)
+                        return false;
+                    depth[child] = std::max(depth[child], depth[i] + 1);
+                }
+            }
+        }
+        return true;
+    }
+} // namespace RealmEngine
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "math.h"
+
+namespace RealmEngine
+{
+    // Result of a ray query against a MeshBvh.
+    struct RayHit
+    {
+        static constexpr uint32_t INVALID_TRIANGLE = 0xFFFFFFFFu;
+
+        float    t {std::numeric_limits<float>::infinity()}; // distance along the ray, in multiples of its direction
+        float    u {0.0f};                                   // barycentric weight of the triangle's second corner
+        float    v {0.0f};                                   // and of its third
+        uint32_t triangle {INVALID_TRIANGLE};                // indices triangle * 3 .. + 2 of Mesh::getIndices()
+
+        bool hasHit() const { return triangle != INVALID_TRIANGLE; }
+    };
+
+    /**
+     * Bounding volume hierarchy over the LOD 0 triangles of a Mesh, for ray queries: picking, line of sight and
+     * baking. Built by BvhBuilder, cooked with the model.
+     *
+     * The tree is 4-wide and flattened depth-first. A node keeps the boxes of its four children as SoA lanes and
+     * leaves keep their triangles in blocks of four, vertex and edges as SoA lanes too, so one SSE2 step tests
+     * a ray against all children of a node or all triangles of a block. Both arrays are plain data, written to
+     * and read from cooked files as they are. Queries are const and can run on any number of threads.
+     */
+    class MeshBvh
+    {
+    public:
+        static constexpr uint32_t WIDTH       = 4;
+        static constexpr uint32_t MAX_DEPTH   = 64; // node levels below the root, bounds the traversal stack
+        static constexpr uint32_t EMPTY_CHILD = 0xFFFFFFFFu;
+
+        // 128 bytes: four child boxes, then what each child is
+        struct alignas(16) Node
+        {
+            float min_x[WIDTH], min_y[WIDTH], min_z[WIDTH];
+            float max_x[WIDTH], max_y[WIDTH], max_z[WIDTH];
+
+            // inner child: node index and count 0; leaf child: first block and its triangle count;
+            // unused lane: EMPTY_CHILD
+            uint32_t child[WIDTH];
+            uint32_t count[WIDTH];
+        };
+
+        // four triangles as corner 0 and the edges to corners 1 and 2, the Moller-Trumbore inputs
+        struct alignas(16) TriangleBlock
+        {
+            float v0_x[WIDTH], v0_y[WIDTH], v0_z[WIDTH];
+            float e1_x[WIDTH], e1_y[WIDTH], e1_z[WIDTH];
+            float e2_x[WIDTH], e2_y[WIDTH], e2_z[WIDTH];
+
+            uint32_t triangle[WIDTH]; // RayHit::triangle of each lane, INVALID_TRIANGLE pads a partial block
+        };
+
+        MeshBvh() = default;
+        MeshBvh(std::vector<Node>&& nodes, std::vector<TriangleBlock>&& blocks);
+
+        bool isEmpty() const { return m_nodes.empty(); }
+        void clear();
+
+        const std::vector<Node>&          getNodes() const { return m_nodes; }
+        const std::vector<TriangleBlock>& getBlocks() const { return m_blocks; }
+        AABB                              getBounds() const;
+        size_t                            getMemoryUsage() const;
+
+        /**
+         * Nearest triangle the ray crosses with t in [t_min, hit.t), both faces counting; a hit passed in with
+         * a finite t bounds the search. Returns true and fills hit if one was found, leaves hit alone otherwise.
+         */
+        bool closestHit(const Ray& ray, RayHit& hit, float t_min = 0.0f) const;
+        // Whether any triangle crosses the ray with t in [t_min, t_max], stopping at the first one found.
+        bool anyHit(const Ray& ray, float t_max, float t_min = 0.0f) const;
+
+        // Node and block checks of a file or a builder, so queries can trust every index they follow.
+        bool isValid() const;
+
+    private:
+        std::vector<Node>          m_nodes; // root first
+        std::vector<TriangleBlock> m_blocks;
+    };
+} // namespace RealmEngine
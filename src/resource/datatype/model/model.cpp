@@ -1,13 +1,18 @@
 #include "model.h"
 #include <utility>
 #include "glm/common.hpp"
+#include "glm/matrix.hpp"
 
 namespace RealmEngine
 {
     // node tree
     Node*       Model::getRoot() { return m_root.get(); }
     const Node* Model::getRoot() const { return m_root.get(); }
-    void        Model::setRoot(std::unique_ptr<Node> root) { m_root = std::move(root); }
+    void        Model::setRoot(std::unique_ptr<Node> root)
+    {
+        m_root = std::move(root);
+        m_hierarchy.build(m_root.get());
+    }
 
     // mesh management
     size_t      Model::getMeshCount() const { return m_meshes.size(); }
@@ -24,6 +29,7 @@ namespace RealmEngine
         m_meshes.push_back(std::move(mesh));
         return m_meshes.size() - 1;
     }
+    void Model::resizeMeshes(size_t count) { m_meshes.resize(count); }
     void Model::clearMeshes() { m_meshes.clear(); }
 
     // material management
@@ -41,16 +47,46 @@ namespace RealmEngine
         m_materials.push_back(std::move(material));
         return m_materials.size() - 1;
     }
+    void Model::resizeMaterials(size_t count) { m_materials.resize(count); }
     void Model::clearMaterials() { m_materials.clear(); }
 
+    // animation management
+    size_t           Model::getAnimationCount() const { return m_animations.size(); }
+    const Animation& Model::getAnimation(size_t idx) const { return m_animations[idx]; }
+    const Animation* Model::findAnimation(const std::string& name) const
+    {
+        for (const auto& animation : m_animations)
+            if (animation.getName() == name)
+                return &animation;
+        return nullptr;
+    }
+    size_t Model::addAnimation(Animation&& animation)
+    {
+        m_animations.push_back(std::move(animation));
+        return m_animations.size() - 1;
+    }
+    void Model::clearAnimations() { m_animations.clear(); }
+    bool Model::isSkinned() const
+    {
+        for (const auto& mesh : m_meshes)
+            if (mesh.isSkinned())
+                return true;
+        return false;
+    }
+
     // misc
     void Model::clear()
     {
         m_root.reset();
+        m_hierarchy.clear();
         m_meshes.clear();
         m_materials.clear();
+        m_animations.clear();
+    }
+    bool Model::isEmpty() const
+    {
+        return m_root == nullptr && m_meshes.empty() && m_materials.empty() && m_animations.empty();
     }
-    bool Model::isEmpty() const { return m_root == nullptr && m_meshes.empty() && m_materials.empty(); }
     AABB Model::calculateAABB() const
     {
         AABB result;
@@ -81,4 +117,47 @@ namespace RealmEngine
         return result;
     }
 
+    ModelMemoryUsage Model::calculateMemoryUsage() const
+    {
+        ModelMemoryUsage usage;
+        for (const auto& mesh : m_meshes)
+        {
+            usage.vertex_bytes += mesh.getVertexMemoryUsage();
+            usage.index_bytes += mesh.getIndexMemoryUsage();
+            usage.bvh_bytes += mesh.getBvhMemoryUsage();
+        }
+        for (const auto& material : m_materials)
+            usage.material_bytes += material.getMemoryUsage();
+        for (const auto& animation : m_animations)
+            usage.animation_bytes += animation.getMemoryUsage();
+        return usage;
+    }
+
+    bool Model::closestHit(const Ray& ray, ModelRayHit& hit, const NodeHierarchy* pose) const
+    {
+        const NodeHierarchy& hierarchy = pose ? *pose : m_hierarchy;
+
+        bool found = false;
+        for (size_t node = 0; node < hierarchy.getNodeCount(); ++node)
+        {
+            const std::vector<uint32_t>& mesh_indices = hierarchy.getNode(node)->getMeshIndices();
+            if (mesh_indices.empty())
+                continue;
+
+            // the inverse keeps the ray's parameterisation, so t compares across instances
+            const Ray local = ray.transform(glm::inverse(hierarchy.getWorldTransform(node)));
+            for (uint32_t mesh_idx : mesh_indices)
+            {
+                const Mesh* mesh = tryGetMesh(mesh_idx);
+                if (mesh && mesh->hasBvh() && mesh->getBvh().closestHit(local, hit.hit))
+                {
+                    hit.mesh = mesh_idx;
+                    hit.node = static_cast<uint32_t>(node);
+                    found    = true;
+                }
+            }
+        }
+        return found;
+    }
+
 } // namespace RealmEngine
\ No newline at end of file
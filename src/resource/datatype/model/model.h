@@ -1,15 +1,43 @@
 #pragma once
 
 #include "math.h"
+#include "resource/datatype/model/animation.h"
 #include "resource/datatype/model/material.h"
 #include "resource/datatype/model/mesh.h"
 #include "resource/datatype/model/node.h"
+#include "resource/datatype/model/node_hierarchy.h"
 
 #include <cstddef>
 #include <memory>
+#include <string>
 #include <vector>
+
 namespace RealmEngine
 {
+    struct ModelMemoryUsage
+    {
+        size_t vertex_bytes {0};
+        size_t index_bytes {0};
+        size_t material_bytes {0};
+        size_t animation_bytes {0};
+        size_t bvh_bytes {0};
+
+        constexpr size_t total() const
+        {
+            return vertex_bytes + index_bytes + material_bytes + animation_bytes + bvh_bytes;
+        }
+    };
+
+    // Model::closestHit() result: the mesh triangle and the node instancing the mesh.
+    struct ModelRayHit
+    {
+        RayHit   hit;
+        uint32_t mesh {0};
+        uint32_t node {0};
+
+        bool hasHit() const { return hit.hasHit(); }
+    };
+
     class Model
     {
     public:
@@ -21,10 +49,12 @@ namespace RealmEngine
         Model(Model&&) noexcept            = default;
         Model& operator=(Model&&) noexcept = default;
 
-        // node tree
-        Node*       getRoot();
-        const Node* getRoot() const;
-        void        setRoot(std::unique_ptr<Node> root);
+        // node tree, flattened into the hierarchy by setRoot()
+        Node*                getRoot();
+        const Node*          getRoot() const;
+        void                 setRoot(std::unique_ptr<Node> root);
+        NodeHierarchy&       getHierarchy() { return m_hierarchy; }
+        const NodeHierarchy& getHierarchy() const { return m_hierarchy; }
 
         // mesh management
         size_t      getMeshCount() const;
@@ -32,6 +62,7 @@ namespace RealmEngine
         const Mesh& getMesh(size_t idx) const;
         const Mesh* tryGetMesh(size_t idx) const;
         size_t      addMesh(Mesh&& mesh);
+        void        resizeMeshes(size_t count);
         void        clearMeshes();
 
         // material management
@@ -40,16 +71,36 @@ namespace RealmEngine
         const Material& getMaterial(size_t idx) const;
         const Material* tryGetMaterial(size_t idx) const;
         size_t          addMaterial(Material&& material);
+        void            resizeMaterials(size_t count);
         void            clearMaterials();
 
+        // animation management, channels refer to nodes by hierarchy index
+        size_t           getAnimationCount() const;
+        const Animation& getAnimation(size_t idx) const;
+        const Animation* findAnimation(const std::string& name) const;
+        size_t           addAnimation(Animation&& animation);
+        void             clearAnimations();
+        bool             isSkinned() const;
+
         // misc
         void clear();
         bool isEmpty() const;
-        AABB calculateAABB() const;
+        AABB             calculateAABB() const;
+        ModelMemoryUsage calculateMemoryUsage() const;
+
+        /**
+         * Nearest triangle of any mesh instance the model-space ray crosses, through the meshes' BVHs; meshes
+         * without one are skipped. Node transforms come from pose, the model's own hierarchy by default, so an
+         * animated instance can pass its copy. Skinned meshes are tested in bind pose. A finite hit.hit.t bounds
+         * the search; t stays in multiples of the ray's direction.
+         */
+        bool closestHit(const Ray& ray, ModelRayHit& hit, const NodeHierarchy* pose = nullptr) const;
 
     private:
-        std::unique_ptr<Node> m_root;
-        std::vector<Mesh>     m_meshes;
-        std::vector<Material> m_materials;
+        std::unique_ptr<Node>  m_root;
+        NodeHierarchy          m_hierarchy;
+        std::vector<Mesh>      m_meshes;
+        std::vector<Material>  m_materials;
+        std::vector<Animation> m_animations;
     };
 } // namespace RealmEngine
\ No newline at end of file
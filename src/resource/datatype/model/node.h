@@ -34,12 +34,19 @@ namespace RealmEngine
         // Transform
         const glm::mat4& getLocalTransform() const;
         void             setLocalTransform(const glm::mat4& transform);
-        glm::mat4        getWorldTransform() const;
+        // Walks up to the root on every call; NodeHierarchy::getWorldTransform() is the cached one.
+        glm::mat4 getWorldTransform() const;
+
+        // position in the owning Model's NodeHierarchy
+        uint32_t getIndex() const { return m_index; }
 
     private:
+        friend class NodeHierarchy;
+
         glm::mat4                          m_local_trans {1.0f};
         std::vector<uint32_t>              m_mesh_indices;
         Node*                              m_parent {nullptr};
         std::vector<std::unique_ptr<Node>> m_children;
+        uint32_t                           m_index {0};
     };
 } // namespace RealmEngine
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "node_hierarchy.h"
+#include <algorithm>
+#include <utility>
+#include "resource/datatype/model/node.h"
+
+namespace RealmEngine
+{
+    void NodeHierarchy::build(Node* root)
+    {
+        clear();
+        if (!root)
+            return;
+
+        // explicit stack, so deep skeletons can't overflow the call stack
+        std::vector<std::pair<Node*, int32_t>> stack;
+        stack.emplace_back(root, -1);
+        while (!stack.empty())
+        {
+            auto [node, parent] = stack.back();
+            stack.pop_back();
+
+            const uint32_t index = static_cast<uint32_t>(m_nodes.size());
+            node->m_index        = index;
+            m_nodes.push_back(node);
+            m_parents.push_back(parent);
+            m_local_transforms.push_back(node->getLocalTransform());
+            m_world_transforms.push_back(parent < 0 ? node->getLocalTransform() :
+                                                      m_world_transforms[parent] * node->getLocalTransform());
+
+            // reversed, so the first child is visited first
+            const auto& children = node->getChildren();
+            for (auto child = children.rbegin(); child != children.rend(); ++child)
+                stack.emplace_back(child->get(), static_cast<int32_t>(index));
+        }
+
+        // pre-order: a subtree ends where the last subtree of its children ends
+        const size_t count = m_nodes.size();
+        m_subtree_ends.resize(count);
+        for (size_t i = 0; i < count; ++i)
+            m_subtree_ends[i] = static_cast<uint32_t>(i + 1);
+        for (size_t i = count; i-- > 1;)
+        {
+            uint32_t& parent_end = m_subtree_ends[m_parents[i]];
+            parent_end           = std::max(parent_end, m_subtree_ends[i]);
+        }
+
+        m_dirty.assign(count, 0);
+        m_first_dirty = count;
+    }
+
+    void NodeHierarchy::clear()
+    {
+        m_nodes.clear();
+        m_parents.clear();
+        m_subtree_ends.clear();
+        m_local_transforms.clear();
+        m_world_transforms.clear();
+        m_dirty.clear();
+        m_dirty_count = 0;
+        m_first_dirty = 0;
+    }
+
+    void NodeHierarchy::setLocalTransform(size_t node, const glm::mat4& transform)
+    {
+        m_local_transforms[node] = transform;
+        if (m_dirty[node])
+            return;
+
+        m_dirty[node] = 1;
+        ++m_dirty_count;
+        m_first_dirty = std::min(m_first_dirty, node);
+    }
+
+    size_t NodeHierarchy::updateWorldTransforms()
+    {
+        if (m_dirty_count == 0)
+            return 0;
+
+        size_t       updated = 0;
+        const size_t count   = m_nodes.size();
+        for (size_t i = m_first_dirty; i < count && m_dirty_count > 0;)
+        {
+            if (!m_dirty[i])
+            {
+                ++i;
+                continue;
+            }
+
+            // parents come first, so each one is final by the time its children read it
+            const size_t end = m_subtree_ends[i];
+            for (size_t j = i; j < end; ++j)
+            {
+                const int32_t parent  = m_parents[j];
+                m_world_transforms[j] = parent < 0 ? m_local_transforms[j] :
+                                                     m_world_transforms[parent] * m_local_transforms[j];
+                if (m_dirty[j])
+                {
+                    m_dirty[j] = 0;
+                    --m_dirty_count;
+                }
+            }
+            updated += end - i;
+            i = end;
+        }
+
+        m_first_dirty = count;
+        return updated;
+    }
+} // namespace RealmEngine
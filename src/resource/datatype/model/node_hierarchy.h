@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "glm/ext/matrix_float4x4.hpp"
+
+namespace RealmEngine
+{
+    class Node;
+
+    /**
+     * Flattened copy of a Model's node tree for transform work.
+     *
+     * Nodes are stored in pre-order, so a parent always comes before its children and every subtree is one
+     * contiguous range. Local and world matrices live in parallel arrays; setLocalTransform() only marks the
+     * node dirty, and updateWorldTransforms() refreshes the subtrees under dirty nodes in one forward pass,
+     * skipping clean ones. The Node tree keeps the imported transforms; runtime changes go through here.
+     * A copy is an independent pose over the same nodes, which is how each animated instance gets its own.
+     */
+    class NodeHierarchy
+    {
+    public:
+        NodeHierarchy()           = default;
+        ~NodeHierarchy() noexcept = default;
+
+        NodeHierarchy(const NodeHierarchy&)                = default;
+        NodeHierarchy& operator=(const NodeHierarchy&)     = default;
+        NodeHierarchy(NodeHierarchy&&) noexcept            = default;
+        NodeHierarchy& operator=(NodeHierarchy&&) noexcept = default;
+
+        // Flattens the tree under root and computes its world transforms. Sets each node's index.
+        void build(Node* root);
+        void clear();
+
+        size_t      getNodeCount() const { return m_parents.size(); }
+        const Node* getNode(size_t node) const { return m_nodes[node]; }
+        // -1 for the root
+        int32_t getParent(size_t node) const { return m_parents[node]; }
+        // one past the last node of the subtree under node
+        uint32_t getSubtreeEnd(size_t node) const { return m_subtree_ends[node]; }
+
+        const glm::mat4& getLocalTransform(size_t node) const { return m_local_transforms[node]; }
+        void             setLocalTransform(size_t node, const glm::mat4& transform);
+
+        // up to date as of the last updateWorldTransforms()
+        const glm::mat4&              getWorldTransform(size_t node) const { return m_world_transforms[node]; }
+        const std::vector<glm::mat4>& getWorldTransforms() const { return m_world_transforms; }
+
+        bool isDirty() const { return m_dirty_count != 0; }
+        // Recomputes every node under a dirty one. Returns the number of world transforms written.
+        size_t updateWorldTransforms();
+
+    private:
+        std::vector<const Node*> m_nodes;
+        std::vector<int32_t>     m_parents;
+        std::vector<uint32_t>    m_subtree_ends;
+        std::vector<glm::mat4>   m_local_transforms;
+        std::vector<glm::mat4>   m_world_transforms;
+        std::vector<uint8_t>     m_dirty;
+        size_t                   m_dirty_count {0};
+        size_t                   m_first_dirty {0}; // no dirty node comes before it
+    };
+} // namespace RealmEngine
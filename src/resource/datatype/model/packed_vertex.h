@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/ext/vector_float3.hpp>
+#include <vector>
+
+namespace RealmEngine
+{
+    // Compact vertex attributes, decoded by the vertex fetch (normalized / half float) and the vertex shader.
+    struct PackedVertexAttributes
+    {
+        int16_t  normal[2];    // octahedral, snorm16
+        int8_t   tangent[4];   // octahedral snorm8 in xy, bitangent sign in z, w unused
+        uint16_t tex_coord[2]; // half float
+        uint8_t  color[4];     // unorm8
+    };
+    static_assert(sizeof(PackedVertexAttributes) == 16, "PackedVertexAttributes must stay tightly packed");
+
+    // Skin influences of a skinned vertex, joints as integers (glVertexAttribIPointer) and weights as unorm8
+    // summing to exactly 255.
+    struct PackedSkin
+    {
+        uint16_t joints[4];
+        uint8_t  weights[4];
+    };
+    static_assert(sizeof(PackedSkin) == 12, "PackedSkin must stay tightly packed");
+
+    // Position quantized to unorm16 inside the mesh AABB, w is padding for 4-byte alignment.
+    struct PackedPosition
+    {
+        uint16_t xyzw[4];
+    };
+
+    struct VertexEncoding
+    {
+        bool     quantized_positions {false};
+        bool     skinned {false};
+        uint32_t stride {0};
+
+        // position = fetched position * position_scale + position_offset
+        glm::vec3 position_offset {0.0f};
+        glm::vec3 position_scale {1.0f};
+
+        // each vertex is [position (vec3 or PackedPosition)][PackedVertexAttributes][PackedSkin, if skinned]
+        constexpr uint32_t getAttributeOffset() const
+        {
+            return quantized_positions ? sizeof(PackedPosition) : sizeof(glm::vec3);
+        }
+        constexpr uint32_t getSkinOffset() const { return getAttributeOffset() + sizeof(PackedVertexAttributes); }
+        constexpr uint32_t getExpectedStride() const
+        {
+            return getSkinOffset() + (skinned ? sizeof(PackedSkin) : 0);
+        }
+    };
+
+    struct EncodedVertices
+    {
+        VertexEncoding       encoding;
+        uint32_t             vertex_count {0};
+        std::vector<uint8_t> data;
+
+        bool empty() const { return vertex_count == 0; }
+    };
+} // namespace RealmEngine
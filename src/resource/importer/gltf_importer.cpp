@@ -0,0 +1,1287 @@
+#include "gltf_importer.h"
+#include "glm/ext/quaternion_float.hpp"
+#include "glm/ext/vector_float2.hpp"
+#include "glm/ext/vector_float3.hpp"
+#include "glm/ext/vector_float4.hpp"
+#include "glm/geometric.hpp"
+#include "glm/gtc/quaternion.hpp"
+#include "hash.h"
+#include "import_helpers.h"
+#include "import_stats.h"
+#include "json.hpp"
+#include "resource/datatype/model/node.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+namespace RealmEngine
+{
+    namespace
+    {
+        using Json = nlohmann::json;
+
+        constexpr uint32_t GLB_MAGIC      = 0x46546C67; // "glTF"
+        constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+        constexpr uint32_t GLB_CHUNK_BIN  = 0x004E4942;
+
+        constexpr uint32_t COMPONENT_BYTE           = 5120;
+        constexpr uint32_t COMPONENT_UNSIGNED_BYTE  = 5121;
+        constexpr uint32_t COMPONENT_SHORT          = 5122;
+        constexpr uint32_t COMPONENT_UNSIGNED_SHORT = 5123;
+        constexpr uint32_t COMPONENT_UNSIGNED_INT   = 5125;
+        constexpr uint32_t COMPONENT_FLOAT          = 5126;
+
+        constexpr uint32_t MODE_TRIANGLES      = 4;
+        constexpr uint32_t MODE_TRIANGLE_STRIP = 5;
+        constexpr uint32_t MODE_TRIANGLE_FAN   = 6;
+
+        // A file the native reader doesn't cover, with the reason.
+        struct Unsupported : std::runtime_error
+        {
+            using std::runtime_error::runtime_error;
+        };
+
+        uint32_t componentSize(uint32_t component_type)
+        {
+            switch (component_type)
+            {
+                case COMPONENT_BYTE:
+                case COMPONENT_UNSIGNED_BYTE:
+                    return 1;
+                case COMPONENT_SHORT:
+                case COMPONENT_UNSIGNED_SHORT:
+                    return 2;
+                case COMPONENT_UNSIGNED_INT:
+                case COMPONENT_FLOAT:
+                    return 4;
+                default:
+                    return 0;
+            }
+        }
+
+        uint32_t componentCount(const std::string& type)
+        {
+            if (type == "SCALAR")
+                return 1;
+            if (type == "VEC2")
+                return 2;
+            if (type == "VEC3")
+                return 3;
+            if (type == "VEC4" || type == "MAT2")
+                return 4;
+            if (type == "MAT3")
+                return 9;
+            if (type == "MAT4")
+                return 16;
+            return 0;
+        }
+
+        // little endian, like every platform the engine runs on
+        uint32_t readU32(const uint8_t* bytes)
+        {
+            uint32_t value;
+            std::memcpy(&value, bytes, sizeof(value));
+            return value;
+        }
+
+        int32_t optionalIndex(const Json& object, const char* key)
+        {
+            auto it = object.find(key);
+            return it != object.end() && it->is_number_unsigned() ? it->get<int32_t>() : -1;
+        }
+
+        // relative URIs may percent-encode spaces and other characters
+        std::string decodeUri(const std::string& uri)
+        {
+            std::string path;
+            path.reserve(uri.size());
+            for (size_t i = 0; i < uri.size(); ++i)
+            {
+                if (uri[i] == '%' && i + 2 < uri.size() && std::isxdigit(static_cast<unsigned char>(uri[i + 1])) &&
+                    std::isxdigit(static_cast<unsigned char>(uri[i + 2])))
+                {
+                    path.push_back(static_cast<char>(std::stoi(uri.substr(i + 1, 2), nullptr, 16)));
+                    i += 2;
+                }
+                else
+                {
+                    path.push_back(uri[i]);
+                }
+            }
+            return path;
+        }
+
+        // A plain .gltf is all JSON. A GLB is a 12 byte header, then a JSON chunk and an optional BIN chunk, each
+        // behind an 8 byte chunk header. False for a GLB with a broken header.
+        bool splitGlb(const uint8_t*  data,
+                      size_t          size,
+                      const uint8_t*& json,
+                      size_t&         json_size,
+                      const uint8_t*& bin,
+                      size_t&         bin_size)
+        {
+            if (size < 12 || readU32(data) != GLB_MAGIC)
+            {
+                json      = data;
+                json_size = size;
+                return true;
+            }
+
+            const size_t length = std::min<size_t>(readU32(data + 8), size);
+            json_size           = length >= 20 ? readU32(data + 12) : 0;
+            if (readU32(data + 4) != 2 || length < 20 || readU32(data + 16) != GLB_CHUNK_JSON ||
+                json_size > length - 20)
+                return false;
+            json = data + 20;
+
+            const size_t next = 20 + json_size;
+            if (next + 8 <= length && readU32(data + next + 4) == GLB_CHUNK_BIN)
+            {
+                bin_size = std::min<size_t>(readU32(data + next), length - next - 8);
+                bin      = data + next + 8;
+            }
+            return true;
+        }
+
+        bool decodeBase64(const std::string& text, size_t begin, std::vector<uint8_t>& bytes)
+        {
+            auto sextet = [](char c) -> int {
+                if (c >= 'A' && c <= 'Z')
+                    return c - 'A';
+                if (c >= 'a' && c <= 'z')
+                    return c - 'a' + 26;
+                if (c >= '0' && c <= '9')
+                    return c - '0' + 52;
+                if (c == '+')
+                    return 62;
+                if (c == '/')
+                    return 63;
+                return -1;
+            };
+
+            bytes.reserve((text.size() - begin) / 4 * 3);
+            uint32_t bits  = 0;
+            int      count = 0;
+            for (size_t i = begin; i < text.size() && text[i] != '='; ++i)
+            {
+                const int value = sextet(text[i]);
+                if (value < 0)
+                    return false;
+                bits = (bits << 6) | static_cast<uint32_t>(value);
+                count += 6;
+                if (count >= 8)
+                {
+                    count -= 8;
+                    bytes.push_back(static_cast<uint8_t>(bits >> count));
+                }
+            }
+            return true;
+        }
+
+        template<typename T>
+        float toFloat(T value, bool normalized)
+        {
+            if (!normalized || std::is_same_v<T, float>)
+                return static_cast<float>(value);
+            const float scaled = static_cast<float>(value) / static_cast<float>(std::numeric_limits<T>::max());
+            return std::is_signed_v<T> ? std::max(scaled, -1.0f) : scaled;
+        }
+
+        template<typename T>
+        void readComponents(const uint8_t* src,
+                            size_t         count,
+                            size_t         stride,
+                            bool           normalized,
+                            uint32_t       components,
+                            uint8_t*       out,
+                            size_t         out_stride)
+        {
+            for (size_t i = 0; i < count; ++i, src += stride, out += out_stride)
+            {
+                if constexpr (std::is_same_v<T, float>)
+                {
+                    // the layout already matches, a straight copy out of the mapping
+                    std::memcpy(out, src, components * sizeof(float));
+                }
+                else
+                {
+                    for (uint32_t c = 0; c < components; ++c)
+                    {
+                        T value;
+                        std::memcpy(&value, src + c * sizeof(T), sizeof(T));
+                        const float converted = toFloat(value, normalized);
+                        std::memcpy(out + c * sizeof(float), &converted, sizeof(float));
+                    }
+                }
+            }
+        }
+
+        template<typename T>
+        void readIntegers(const uint8_t* src, size_t count, size_t stride, uint32_t base, uint32_t* out)
+        {
+            for (size_t i = 0; i < count; ++i, src += stride)
+            {
+                T value;
+                std::memcpy(&value, src, sizeof(T));
+                out[i] = static_cast<uint32_t>(value) + base;
+            }
+        }
+
+        // triangle lists out of strips and fans, per the glTF spec's vertex order
+        void triangulate(uint32_t mode, std::vector<uint32_t>& indices, size_t begin)
+        {
+            const std::vector<uint32_t> source(indices.begin() + begin, indices.end());
+            indices.resize(begin);
+            for (size_t i = 0; i + 2 < source.size(); ++i)
+            {
+                uint32_t triangle[3];
+                if (mode == MODE_TRIANGLE_STRIP)
+                {
+                    triangle[0] = source[i];
+                    triangle[1] = source[i + 1 + i % 2];
+                    triangle[2] = source[i + 2 - i % 2];
+                }
+                else
+                {
+                    triangle[0] = source[i + 1];
+                    triangle[1] = source[i + 2];
+                    triangle[2] = source[0];
+                }
+                indices.insert(indices.end(), triangle, triangle + 3);
+            }
+        }
+    } // namespace
+
+    bool GltfImporter::isGltf(const std::string& filepath)
+    {
+        const size_t dot = filepath.find_last_of('.');
+        if (dot == std::string::npos)
+            return false;
+
+        std::string extension = filepath.substr(dot);
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) {
+            return static_cast<char>(std::tolower(c));
+        });
+        return extension == ".gltf" || extension == ".glb";
+    }
+
+    bool GltfImporter::open(const std::string& filepath)
+    {
+        m_base_dir = ImportHelpers::getBaseDir(filepath);
+
+        if (!m_file.open(filepath))
+        {
+            warn("Failed to map glTF file: " + filepath);
+            return false;
+        }
+
+        const uint8_t* json      = nullptr;
+        size_t         json_size = 0;
+        const uint8_t* bin       = nullptr;
+        size_t         bin_size  = 0;
+        if (!splitGlb(m_file.data(), m_file.size(), json, json_size, bin, bin_size))
+        {
+            warn("Invalid GLB header in: " + filepath);
+            return false;
+        }
+        return readDocument(json, json_size, bin, bin_size);
+    }
+
+    std::vector<std::string> GltfImporter::findDependencies(const std::string& filepath)
+    {
+        MappedFile file;
+        if (!file.open(filepath))
+            return {};
+
+        const uint8_t* json      = nullptr;
+        size_t         json_size = 0;
+        const uint8_t* bin       = nullptr;
+        size_t         bin_size  = 0;
+        if (!splitGlb(file.data(), file.size(), json, json_size, bin, bin_size))
+            return {};
+
+        // Images are left out: the model only keeps their paths, and textures are cooked under their own bytes.
+        std::vector<std::string> dependencies;
+        try
+        {
+            const Json        document = Json::parse(json, json + json_size);
+            const std::string base_dir = ImportHelpers::getBaseDir(filepath);
+            for (const Json& buffer : document.value("buffers", Json::array()))
+            {
+                const std::string uri = buffer.value("uri", "");
+                if (!uri.empty() && uri.rfind("data:", 0) != 0)
+                    dependencies.push_back(base_dir + decodeUri(uri));
+            }
+        }
+        catch (const std::exception&)
+        {
+            // open() reports the broken document, the source bytes alone key it
+        }
+        return dependencies;
+    }
+
+    bool GltfImporter::readDocument(const uint8_t* json,
+                                    size_t         json_size,
+                                    const uint8_t* glb_bin,
+                                    size_t         glb_bin_size)
+    {
+        try
+        {
+            const Json document = Json::parse(json, json + json_size);
+
+            const std::string version = document.at("asset").value("version", "");
+            if (version.empty() || version[0] != '2')
+                throw Unsupported("glTF version '" + version + "'");
+
+            // compression and the like, which Assimp may still decode
+            for (const Json& extension : document.value("extensionsRequired", Json::array()))
+            {
+                const std::string name = extension.get<std::string>();
+                if (name != "KHR_mesh_quantization")
+                    throw Unsupported("required extension " + name);
+            }
+
+            // ===== Buffers, buffer views and accessors =====
+            std::vector<std::pair<const uint8_t*, size_t>> buffers;
+            for (const Json& buffer : document.value("buffers", Json::array()))
+            {
+                const size_t   byte_length = buffer.at("byteLength").get<size_t>();
+                const uint8_t* bytes       = glb_bin; // no uri: the GLB binary chunk
+                size_t         size        = glb_bin_size;
+
+                auto uri = buffer.find("uri");
+                if (uri != buffer.end())
+                {
+                    const std::string& text = uri->get_ref<const std::string&>();
+                    if (text.rfind("data:", 0) == 0)
+                    {
+                        const size_t          payload = text.find(";base64,");
+                        std::vector<uint8_t>& decoded = m_decoded_buffers.emplace_back();
+                        if (payload == std::string::npos || !decodeBase64(text, payload + 8, decoded))
+                            throw Unsupported("buffer data URI that isn't base64");
+                        bytes = decoded.data();
+                        size  = decoded.size();
+                    }
+                    else
+                    {
+                        MappedFile& file = m_buffer_files.emplace_back();
+                        if (!file.open(m_base_dir + decodeUri(text)))
+                            throw Unsupported("buffer " + text + " can't be mapped");
+                        bytes = file.data();
+                        size  = file.size();
+                    }
+                }
+                if (!bytes || size < byte_length)
+                    throw Unsupported("buffer shorter than its byteLength");
+                buffers.emplace_back(bytes, byte_length);
+            }
+
+            struct View
+            {
+                const uint8_t* data;
+                size_t         size;
+                size_t         stride;
+            };
+            std::vector<View> views;
+            for (const Json& view : document.value("bufferViews", Json::array()))
+            {
+                const size_t buffer = view.at("buffer").get<size_t>();
+                const size_t offset = view.value("byteOffset", size_t(0));
+                const size_t length = view.at("byteLength").get<size_t>();
+                if (buffer >= buffers.size() || offset > buffers[buffer].second ||
+                    length > buffers[buffer].second - offset)
+                    throw Unsupported("buffer view out of its buffer");
+                views.push_back(View {buffers[buffer].first + offset, length, view.value("byteStride", size_t(0))});
+            }
+
+            for (const Json& accessor : document.value("accessors", Json::array()))
+            {
+                if (accessor.contains("sparse"))
+                    throw Unsupported("sparse accessor");
+
+                Accessor result;
+                result.component_type = accessor.at("componentType").get<uint32_t>();
+                result.components     = componentCount(accessor.at("type").get<std::string>());
+                result.normalized     = accessor.value("normalized", false);
+                result.count          = accessor.at("count").get<size_t>();
+
+                const size_t element_size = componentSize(result.component_type) * result.components;
+                const size_t view_index   = static_cast<size_t>(optionalIndex(accessor, "bufferView"));
+                if (element_size == 0)
+                    throw Unsupported("accessor of unknown type");
+                if (view_index >= views.size())
+                    throw Unsupported("accessor without a buffer view");
+
+                const View&  view   = views[view_index];
+                const size_t offset = accessor.value("byteOffset", size_t(0));
+                result.stride       = view.stride > 0 ? view.stride : element_size;
+                if (result.count > 0 && (offset > view.size || result.count > view.size ||
+                                         (result.count - 1) * result.stride + element_size > view.size - offset))
+                    throw Unsupported("accessor out of its buffer view");
+                result.data = view.data + offset;
+                m_accessors.push_back(result);
+            }
+
+            auto accessor = [&](int32_t index, std::initializer_list<uint32_t> components) -> int32_t {
+                if (index < 0)
+                    return -1;
+                if (static_cast<size_t>(index) >= m_accessors.size() ||
+                    std::find(components.begin(), components.end(), m_accessors[index].components) ==
+                        components.end())
+                    throw Unsupported("accessor of the wrong type");
+                return index;
+            };
+
+            // ===== Materials =====
+            std::vector<std::string> images;
+            bool                     embedded_images = false;
+            for (const Json& image : document.value("images", Json::array()))
+            {
+                const std::string uri = image.value("uri", "");
+                embedded_images |= uri.empty() || uri.rfind("data:", 0) == 0;
+                images.push_back(uri.empty() || uri.rfind("data:", 0) == 0 ? std::string() :
+                                                                              m_base_dir + decodeUri(uri));
+            }
+            if (embedded_images)
+                warn("Embedded glTF images aren't supported, the textures using them are skipped.");
+
+            std::vector<int32_t> texture_images;
+            for (const Json& texture : document.value("textures", Json::array()))
+                texture_images.push_back(optionalIndex(texture, "source"));
+
+            auto texturePath = [&](const Json& object, const char* key) -> std::string {
+                auto info = object.find(key);
+                if (info == object.end())
+                    return std::string();
+                const int32_t texture = optionalIndex(*info, "index");
+                if (texture < 0 || static_cast<size_t>(texture) >= texture_images.size())
+                    return std::string();
+                const int32_t image = texture_images[texture];
+                return image >= 0 && static_cast<size_t>(image) < images.size() ? images[image] : std::string();
+            };
+
+            for (const Json& info : document.value("materials", Json::array()))
+            {
+                Material    material;
+                std::string path;
+
+                auto pbr = info.find("pbrMetallicRoughness");
+                if (pbr != info.end())
+                {
+                    const std::vector<float> color = pbr->value("baseColorFactor", std::vector<float> {1, 1, 1, 1});
+                    if (color.size() == 4)
+                        material.setBaseColorFactor(glm::vec4(color[0], color[1], color[2], color[3]));
+                    material.setMetallicFactor(pbr->value("metallicFactor", 1.0f));
+                    material.setRoughnessFactor(pbr->value("roughnessFactor", 1.0f));
+
+                    if (!(path = texturePath(*pbr, "baseColorTexture")).empty())
+                        material.setBaseColorTexture(path);
+                    if (!(path = texturePath(*pbr, "metallicRoughnessTexture")).empty())
+                        material.setMetallicRoughnessTexture(path);
+                }
+
+                if (!(path = texturePath(info, "normalTexture")).empty())
+                {
+                    material.setNormalTexture(path);
+                    material.setNormalScale(info.at("normalTexture").value("scale", 1.0f));
+                }
+                if (!(path = texturePath(info, "occlusionTexture")).empty())
+                {
+                    material.setOcclusionTexture(path);
+                    material.setOcclusionStrength(info.at("occlusionTexture").value("strength", 1.0f));
+                }
+                if (!(path = texturePath(info, "emissiveTexture")).empty())
+                    material.setEmissiveTexture(path);
+
+                const std::vector<float> emissive = info.value("emissiveFactor", std::vector<float> {0, 0, 0});
+                if (emissive.size() == 3)
+                {
+                    float strength = 1.0f;
+                    auto  extensions = info.find("extensions");
+                    if (extensions != info.end() && extensions->contains("KHR_materials_emissive_strength"))
+                        strength = extensions->at("KHR_materials_emissive_strength").value("emissiveStrength", 1.0f);
+                    material.setEmissiveFactor(glm::vec3(emissive[0], emissive[1], emissive[2]) * strength);
+                }
+
+                // MASK is alpha tested in the shader, only BLEND needs sorting and blending
+                RenderState render_state;
+                render_state.blend_mode  = info.value("alphaMode", "OPAQUE") == "BLEND" ?
+                                               RenderState::BlendMode::AlphaBlend :
+                                               RenderState::BlendMode::Opaque;
+                render_state.cull_mode   = info.value("doubleSided", false) ? RenderState::CullMode::None :
+                                                                              RenderState::CullMode::Back;
+                render_state.depth_test  = RenderState::DepthTest::Less;
+                render_state.depth_write = render_state.blend_mode == RenderState::BlendMode::Opaque;
+                material.setRenderState(render_state);
+
+                m_materials.push_back(std::move(material));
+            }
+            const size_t material_count   = m_materials.size();
+            bool         default_material = false;
+
+            // ===== Meshes =====
+            for (const Json& mesh : document.value("meshes", Json::array()))
+            {
+                MeshInfo info;
+                info.name            = mesh.value("name", "");
+                size_t vertex_count  = 0;
+                size_t skipped_modes = 0;
+                for (const Json& primitive : mesh.at("primitives"))
+                {
+                    Primitive result;
+                    result.mode = primitive.value("mode", MODE_TRIANGLES);
+                    if (result.mode != MODE_TRIANGLES && result.mode != MODE_TRIANGLE_STRIP &&
+                        result.mode != MODE_TRIANGLE_FAN)
+                    {
+                        ++skipped_modes;
+                        continue;
+                    }
+
+                    const Json& attributes = primitive.at("attributes");
+                    result.position        = accessor(optionalIndex(attributes, "POSITION"), {3});
+                    result.normal          = accessor(optionalIndex(attributes, "NORMAL"), {3});
+                    result.tangent         = accessor(optionalIndex(attributes, "TANGENT"), {4});
+                    result.tex_coord       = accessor(optionalIndex(attributes, "TEXCOORD_0"), {2});
+                    result.color           = accessor(optionalIndex(attributes, "COLOR_0"), {3, 4});
+                    result.joints          = accessor(optionalIndex(attributes, "JOINTS_0"), {4});
+                    result.weights         = accessor(optionalIndex(attributes, "WEIGHTS_0"), {4});
+                    result.indices         = accessor(optionalIndex(primitive, "indices"), {1});
+                    if (result.position < 0)
+                        throw Unsupported("primitive without positions");
+
+                    const size_t count = m_accessors[result.position].count;
+                    for (int32_t attribute : {result.normal,
+                                              result.tangent,
+                                              result.tex_coord,
+                                              result.color,
+                                              result.joints,
+                                              result.weights})
+                    {
+                        if (attribute >= 0 && m_accessors[attribute].count != count)
+                            throw Unsupported("attributes of different lengths");
+                    }
+                    if (result.joints >= 0 && m_accessors[result.joints].component_type != COMPONENT_UNSIGNED_BYTE &&
+                        m_accessors[result.joints].component_type != COMPONENT_UNSIGNED_SHORT)
+                        throw Unsupported("joint indices that aren't unsigned bytes or shorts");
+                    if (result.indices >= 0 && m_accessors[result.indices].component_type != COMPONENT_UNSIGNED_BYTE &&
+                        m_accessors[result.indices].component_type != COMPONENT_UNSIGNED_SHORT &&
+                        m_accessors[result.indices].component_type != COMPONENT_UNSIGNED_INT)
+                        throw Unsupported("indices that aren't unsigned integers");
+
+                    const int32_t material = optionalIndex(primitive, "material");
+                    if (material >= 0 && static_cast<size_t>(material) >= material_count)
+                        throw Unsupported("primitive with a missing material");
+                    // the default material goes after the file's own, like Assimp puts it
+                    default_material |= material < 0;
+                    result.material = material >= 0 ? static_cast<uint32_t>(material) :
+                                                      static_cast<uint32_t>(material_count);
+
+                    vertex_count += count;
+                    info.primitives.push_back(result);
+                }
+                if (vertex_count > std::numeric_limits<uint32_t>::max())
+                    throw Unsupported("mesh with more than 2^32 vertices");
+                if (skipped_modes > 0)
+                    debug("  glTF mesh '" + info.name + "' - skipped " + std::to_string(skipped_modes) +
+                          " point or line primitive(s)");
+                m_meshes.push_back(std::move(info));
+            }
+            if (default_material)
+                m_materials.emplace_back();
+
+            // ===== Nodes, skins and the scene =====
+            const std::vector<Json> nodes = document.value("nodes", std::vector<Json>());
+            m_nodes.resize(nodes.size());
+            for (size_t i = 0; i < nodes.size(); ++i)
+            {
+                const Json& node   = nodes[i];
+                NodeInfo&   result = m_nodes[i];
+
+                const std::vector<float> matrix = node.value("matrix", std::vector<float>());
+                if (matrix.size() == 16)
+                {
+                    // column major, like glm
+                    for (int c = 0; c < 4; ++c)
+                        result.transform[c] = glm::vec4(matrix[c * 4], matrix[c * 4 + 1], matrix[c * 4 + 2],
+                                                        matrix[c * 4 + 3]);
+                }
+                else
+                {
+                    const std::vector<float> t = node.value("translation", std::vector<float> {0, 0, 0});
+                    const std::vector<float> r = node.value("rotation", std::vector<float> {0, 0, 0, 1});
+                    const std::vector<float> s = node.value("scale", std::vector<float> {1, 1, 1});
+                    if (t.size() != 3 || r.size() != 4 || s.size() != 3)
+                        throw Unsupported("malformed node transform");
+
+                    // T * R * S
+                    result.transform = glm::mat4_cast(glm::quat(r[3], r[0], r[1], r[2]));
+                    result.transform[0] *= s[0];
+                    result.transform[1] *= s[1];
+                    result.transform[2] *= s[2];
+                    result.transform[3] = glm::vec4(t[0], t[1], t[2], 1.0f);
+                }
+
+                result.mesh = optionalIndex(node, "mesh");
+                result.skin = optionalIndex(node, "skin");
+                if (result.mesh >= 0 && static_cast<size_t>(result.mesh) >= m_meshes.size())
+                    throw Unsupported("node with a missing mesh");
+                for (const Json& child : node.value("children", Json::array()))
+                {
+                    const uint32_t index = child.get<uint32_t>();
+                    if (index >= nodes.size())
+                        throw Unsupported("node with a missing child");
+                    result.children.push_back(index);
+                }
+            }
+
+            const std::vector<Json> scenes = document.value("scenes", std::vector<Json>());
+            if (!scenes.empty())
+            {
+                const size_t scene = document.value("scene", size_t(0));
+                if (scene >= scenes.size())
+                    throw Unsupported("missing default scene");
+                for (const Json& root : scenes[scene].value("nodes", Json::array()))
+                    m_scene_roots.push_back(root.get<uint32_t>());
+            }
+            else
+            {
+                // no scene, every node that isn't a child is a root
+                std::vector<uint8_t> is_child(m_nodes.size(), 0);
+                for (const NodeInfo& node : m_nodes)
+                    for (uint32_t child : node.children)
+                        is_child[child] = 1;
+                for (uint32_t i = 0; i < m_nodes.size(); ++i)
+                    if (!is_child[i])
+                        m_scene_roots.push_back(i);
+            }
+
+            // the node graph has to be a forest, so every node ends up in the hierarchy once
+            std::vector<uint32_t> stack;
+            for (uint32_t root : m_scene_roots)
+            {
+                if (root >= m_nodes.size())
+                    throw Unsupported("scene with a missing node");
+                stack.push_back(root);
+            }
+            while (!stack.empty())
+            {
+                NodeInfo& node = m_nodes[stack.back()];
+                stack.pop_back();
+                if (node.in_scene)
+                    throw Unsupported("node graph that isn't a tree");
+                node.in_scene = true;
+                stack.insert(stack.end(), node.children.begin(), node.children.end());
+            }
+
+            for (const Json& skin : document.value("skins", Json::array()))
+            {
+                SkinInfo result;
+                for (const Json& joint : skin.at("joints"))
+                {
+                    const uint32_t node = joint.get<uint32_t>();
+                    if (node >= m_nodes.size() || !m_nodes[node].in_scene)
+                        throw Unsupported("joint outside the scene");
+                    result.joints.push_back(node);
+                }
+                // Assimp splits meshes over several palettes, natively a skin has to fit one (with the rigid slot)
+                if (result.joints.size() > MAX_MESH_BONES - 1)
+                    throw Unsupported("skin with " + std::to_string(result.joints.size()) + " joints");
+
+                result.inverse_binds = accessor(optionalIndex(skin, "inverseBindMatrices"), {16});
+                if (result.inverse_binds >= 0 &&
+                    (m_accessors[result.inverse_binds].component_type != COMPONENT_FLOAT ||
+                     m_accessors[result.inverse_binds].count < result.joints.size()))
+                    throw Unsupported("malformed inverse bind matrices");
+                m_skins.push_back(std::move(result));
+            }
+            for (const NodeInfo& node : m_nodes)
+            {
+                if (node.skin >= 0 && static_cast<size_t>(node.skin) >= m_skins.size())
+                    throw Unsupported("node with a missing skin");
+            }
+
+            // ===== Animations =====
+            for (const Json& animation : document.value("animations", Json::array()))
+            {
+                AnimationInfo result;
+                result.name          = animation.value("name", "");
+                const Json& samplers = animation.at("samplers");
+
+                for (const Json& channel : animation.at("channels"))
+                {
+                    const Json&       target = channel.at("target");
+                    const int32_t     node   = optionalIndex(target, "node");
+                    const std::string path   = target.at("path").get<std::string>();
+                    if (node < 0 || static_cast<size_t>(node) >= m_nodes.size() || !m_nodes[node].in_scene ||
+                        path == "weights")
+                        continue; // morph weights aren't supported, by Assimp either
+
+                    ChannelInfo info;
+                    info.node = static_cast<uint32_t>(node);
+                    if (path == "translation")
+                        info.path = Path::Translation;
+                    else if (path == "rotation")
+                        info.path = Path::Rotation;
+                    else if (path == "scale")
+                        info.path = Path::Scale;
+                    else
+                        throw Unsupported("animation path " + path);
+
+                    const Json&       sampler       = samplers.at(channel.at("sampler").get<size_t>());
+                    const std::string interpolation = sampler.value("interpolation", "LINEAR");
+                    if (interpolation == "STEP")
+                        info.interpolation = Interpolation::Step;
+                    else if (interpolation == "CUBICSPLINE")
+                        info.interpolation = Interpolation::CubicSpline;
+                    else if (interpolation != "LINEAR")
+                        throw Unsupported("interpolation " + interpolation);
+
+                    const uint32_t components = info.path == Path::Rotation ? 4 : 3;
+                    info.input  = static_cast<uint32_t>(accessor(optionalIndex(sampler, "input"), {1}));
+                    info.output = static_cast<uint32_t>(accessor(optionalIndex(sampler, "output"), {components}));
+                    if (optionalIndex(sampler, "input") < 0 || optionalIndex(sampler, "output") < 0)
+                        throw Unsupported("animation sampler without keys");
+
+                    const size_t keys_per_time = info.interpolation == Interpolation::CubicSpline ? 3 : 1;
+                    if (m_accessors[info.input].component_type != COMPONENT_FLOAT ||
+                        m_accessors[info.output].count < m_accessors[info.input].count * keys_per_time)
+                        throw Unsupported("malformed animation sampler");
+                    result.channels.push_back(info);
+                }
+                if (!result.channels.empty())
+                    m_animations.push_back(std::move(result));
+            }
+        }
+        catch (const Unsupported& reason)
+        {
+            warn("glTF file not supported by the native importer: " + std::string(reason.what()));
+            return false;
+        }
+        catch (const std::exception& error)
+        {
+            warn("Malformed glTF document: " + std::string(error.what()));
+            return false;
+        }
+
+        debug("< glTF document parsed > - Meshes: " + std::to_string(m_meshes.size()) +
+              ", Materials: " + std::to_string(m_materials.size()) + ", Nodes: " + std::to_string(m_nodes.size()) +
+              ", Skins: " + std::to_string(m_skins.size()) + ", Animations: " + std::to_string(m_animations.size()) +
+              ", Mapped buffers: " + std::to_string(m_buffer_files.size()));
+        return true;
+    }
+
+    Material GltfImporter::takeMaterial(size_t material) { return std::move(m_materials[material]); }
+
+    void GltfImporter::readNodes(Model& model)
+    {
+        std::unique_ptr<Node> root = std::make_unique<Node>();
+        std::vector<Node*>    created(m_nodes.size(), nullptr);
+
+        // depth first with children pushed in reverse, so siblings keep their order in the file
+        std::vector<std::pair<uint32_t, Node*>> stack;
+        for (size_t i = m_scene_roots.size(); i-- > 0;)
+            stack.emplace_back(m_scene_roots[i], root.get());
+        while (!stack.empty())
+        {
+            const auto [index, parent] = stack.back();
+            stack.pop_back();
+
+            const NodeInfo&       info = m_nodes[index];
+            std::unique_ptr<Node> node = std::make_unique<Node>();
+            node->setLocalTransform(info.transform);
+            if (info.mesh >= 0)
+                node->addMeshIndex(static_cast<uint32_t>(info.mesh));
+
+            created[index] = node.get();
+            parent->addChild(std::move(node));
+            for (size_t i = info.children.size(); i-- > 0;)
+                stack.emplace_back(info.children[i], created[index]);
+        }
+
+        model.setRoot(std::move(root));
+
+        // now that the hierarchy is built, the first node (in hierarchy order) drawing each mesh skins it
+        std::vector<uint8_t> mesh_found(m_meshes.size(), 0);
+        for (size_t i = 0; i < m_nodes.size(); ++i)
+        {
+            NodeInfo& info = m_nodes[i];
+            if (!created[i])
+                continue;
+            info.index = created[i]->getIndex();
+            if (info.mesh < 0)
+                continue;
+
+            MeshInfo& mesh = m_meshes[info.mesh];
+            if (!mesh_found[info.mesh] || info.index < mesh.node)
+            {
+                mesh.node             = info.index;
+                mesh.skin             = info.skin;
+                mesh_found[info.mesh] = 1;
+            }
+        }
+    }
+
+    Animation GltfImporter::readAnimation(size_t animation) const
+    {
+        const AnimationInfo& info = m_animations[animation];
+
+        Animation result;
+        result.setName(info.name);
+
+        std::unordered_map<uint32_t, size_t> node_channels;
+        float                                duration = 0.0f;
+        std::vector<float>                   times;
+        std::vector<float>                   values;
+
+        // Steps become pairs of keys at the same time, cubic splines keep their values and drop the tangents;
+        // the sampler only interpolates linearly.
+        auto readTrack = [&](const ChannelInfo& channel, uint32_t components, auto make_value, auto& track) {
+            const Accessor& output = m_accessors[channel.output];
+            values.resize(output.count * components);
+            readAccessorFloats(output, values.data(), components * sizeof(float), components);
+
+            const bool   cubic  = channel.interpolation == Interpolation::CubicSpline;
+            const size_t stride = cubic ? 3 : 1;
+            track.times.clear();
+            track.values.clear();
+            for (size_t k = 0; k < times.size(); ++k)
+            {
+                if (channel.interpolation == Interpolation::Step && k > 0)
+                {
+                    track.times.push_back(times[k]);
+                    track.values.push_back(track.values.back());
+                }
+                track.times.push_back(times[k]);
+                track.values.push_back(make_value(&values[(k * stride + (cubic ? 1 : 0)) * components]));
+            }
+        };
+        auto makeVec3 = [](const float* v) { return glm::vec3(v[0], v[1], v[2]); };
+        auto makeQuat = [](const float* v) { return glm::normalize(glm::quat(v[3], v[0], v[1], v[2])); };
+
+        for (const ChannelInfo& channel : info.channels)
+        {
+            const Accessor& input = m_accessors[channel.input];
+            times.resize(input.count);
+            readAccessorFloats(input, times.data(), sizeof(float), 1);
+            if (!times.empty())
+                duration = std::max(duration, times.back());
+
+            const uint32_t node     = m_nodes[channel.node].index;
+            auto [it, inserted]     = node_channels.emplace(node, result.getChannels().size());
+            if (inserted)
+            {
+                AnimationChannel created;
+                created.node = node;
+                result.getChannels().push_back(std::move(created));
+            }
+
+            AnimationChannel& target = result.getChannels()[it->second];
+            switch (channel.path)
+            {
+                case Path::Translation:
+                    readTrack(channel, 3, makeVec3, target.translations);
+                    break;
+                case Path::Rotation:
+                    readTrack(channel, 4, makeQuat, target.rotations);
+                    break;
+                case Path::Scale:
+                    readTrack(channel, 3, makeVec3, target.scales);
+                    break;
+            }
+        }
+        result.setDuration(duration);
+
+        debug("  Animation '" + result.getName() + "' - Duration: " + std::to_string(result.getDuration()) +
+              " s, Channels: " + std::to_string(result.getChannels().size()) +
+              ", Keyframes: " + std::to_string(result.getKeyframeCount()));
+        return result;
+    }
+
+    size_t GltfImporter::getVertexCount(size_t mesh) const
+    {
+        size_t count = 0;
+        for (const Primitive& primitive : m_meshes[mesh].primitives)
+            count += m_accessors[primitive.position].count;
+        return count;
+    }
+
+    size_t GltfImporter::getTriangleCount(size_t mesh) const
+    {
+        size_t count = 0;
+        for (const Primitive& primitive : m_meshes[mesh].primitives)
+        {
+            const size_t indices = m_accessors[primitive.indices >= 0 ? primitive.indices : primitive.position].count;
+            if (primitive.mode == MODE_TRIANGLES)
+                count += indices / 3;
+            else if (indices >= 3)
+                count += indices - 2;
+        }
+        return count;
+    }
+
+    uint64_t GltfImporter::hashMesh(size_t mesh, const std::vector<uint32_t>& material_remap, bool skinning) const
+    {
+        const MeshInfo& info = m_meshes[mesh];
+        if (skinning && info.skin >= 0)
+            return 0;
+
+        uint64_t seed = Hash::combine(0, info.primitives.size());
+        for (const Primitive& primitive : info.primitives)
+        {
+            const uint32_t material =
+                primitive.material < material_remap.size() ? material_remap[primitive.material] : primitive.material;
+            seed = Hash::combine(seed, primitive.mode);
+            seed = Hash::combine(seed, material);
+            for (int32_t accessor : {primitive.position,
+                                     primitive.normal,
+                                     primitive.tangent,
+                                     primitive.tex_coord,
+                                     primitive.color,
+                                     primitive.joints,
+                                     primitive.weights,
+                                     primitive.indices})
+                seed = hashAccessor(accessor, seed);
+        }
+        return seed == 0 ? 1 : seed;
+    }
+
+    bool GltfImporter::sameMesh(size_t a, size_t b, const std::vector<uint32_t>& material_remap) const
+    {
+        const std::vector<Primitive>& first  = m_meshes[a].primitives;
+        const std::vector<Primitive>& second = m_meshes[b].primitives;
+        if (first.size() != second.size())
+            return false;
+
+        auto material = [&](uint32_t index) {
+            return index < material_remap.size() ? material_remap[index] : index;
+        };
+        for (size_t i = 0; i < first.size(); ++i)
+        {
+            const Primitive& x = first[i];
+            const Primitive& y = second[i];
+            if (x.mode != y.mode || material(x.material) != material(y.material) ||
+                !sameAccessor(x.position, y.position) || !sameAccessor(x.normal, y.normal) ||
+                !sameAccessor(x.tangent, y.tangent) || !sameAccessor(x.tex_coord, y.tex_coord) ||
+                !sameAccessor(x.color, y.color) || !sameAccessor(x.joints, y.joints) ||
+                !sameAccessor(x.weights, y.weights) || !sameAccessor(x.indices, y.indices))
+                return false;
+        }
+        return true;
+    }
+
+    uint64_t GltfImporter::hashAccessor(int32_t accessor, uint64_t seed) const
+    {
+        if (accessor < 0)
+            return Hash::combine(seed, 0);
+
+        const Accessor& view         = m_accessors[accessor];
+        const size_t    element_size = componentSize(view.component_type) * view.components;
+        seed                         = Hash::combine(seed, view.count);
+        seed                         = Hash::combine(seed, view.component_type);
+        seed                         = Hash::combine(seed, view.components);
+        seed                         = Hash::combine(seed, view.normalized);
+        if (view.stride == element_size)
+            return Hash::hashBytes(view.data, view.count * element_size, seed);
+
+        // interleaved: element by element, chained through the seed
+        for (size_t i = 0; i < view.count; ++i)
+            seed = Hash::hashBytes(view.data + i * view.stride, element_size, seed);
+        return seed;
+    }
+
+    bool GltfImporter::sameAccessor(int32_t a, int32_t b) const
+    {
+        if (a == b)
+            return true;
+        if (a < 0 || b < 0)
+            return false;
+
+        const Accessor& x = m_accessors[a];
+        const Accessor& y = m_accessors[b];
+        if (x.count != y.count || x.component_type != y.component_type || x.components != y.components ||
+            x.normalized != y.normalized)
+            return false;
+
+        const size_t element_size = componentSize(x.component_type) * x.components;
+        if (x.stride == element_size && y.stride == element_size)
+            return std::memcmp(x.data, y.data, x.count * element_size) == 0;
+        for (size_t i = 0; i < x.count; ++i)
+        {
+            if (std::memcmp(x.data + i * x.stride, y.data + i * y.stride, element_size) != 0)
+                return false;
+        }
+        return true;
+    }
+
+    Mesh GltfImporter::readMesh(size_t          mesh,
+                                bool            flip_uvs,
+                                bool            calculate_tangents,
+                                bool            skinning,
+                                ImportProfiler* profiler) const
+    {
+        bool missing_normals  = false;
+        bool missing_tangents = false;
+        Mesh result;
+        {
+            ImportProfiler::Scope scope(profiler, "vertex_conversion");
+            result = readGeometry(mesh, flip_uvs, skinning, missing_normals, missing_tangents);
+        }
+
+        // generated for the whole mesh when any primitive lacks them, like Assimp's GenNormals/CalcTangentSpace
+        if (missing_normals || (calculate_tangents && missing_tangents))
+        {
+            ImportProfiler::Scope scope(profiler, "tangent_space");
+            if (missing_normals)
+                result.calculateNormals();
+            if (calculate_tangents && missing_tangents)
+                result.calculateTangents();
+        }
+
+        result.calculateAABB();
+        return result;
+    }
+
+    Mesh GltfImporter::readGeometry(size_t mesh,
+                                    bool   flip_uvs,
+                                    bool   skinning,
+                                    bool&  missing_normals,
+                                    bool&  missing_tangents) const
+    {
+        const MeshInfo& info = m_meshes[mesh];
+        const SkinInfo* skin = skinning && info.skin >= 0 ? &m_skins[info.skin] : nullptr;
+
+        std::vector<Vertex>   vertices;
+        std::vector<uint32_t> indices;
+        vertices.reserve(getVertexCount(mesh));
+        indices.reserve(getTriangleCount(mesh) * 3);
+
+        Mesh   result;
+        bool   has_normals    = true;
+        bool   has_tangents   = true;
+        bool   has_uvs        = false;
+        size_t invalid_index  = 0;
+        size_t invalid_joints = 0;
+        for (const Primitive& primitive : info.primitives)
+        {
+            const Accessor& positions = m_accessors[primitive.position];
+            const uint32_t  base      = static_cast<uint32_t>(vertices.size());
+
+            Vertex defaults;
+            defaults.normal    = glm::vec3(0.0f, 1.0f, 0.0f);
+            defaults.tex_coord = glm::vec2(0.0f);
+            defaults.tangent   = glm::vec3(1.0f, 0.0f, 0.0f);
+            defaults.bitangent = glm::vec3(0.0f, 0.0f, 1.0f);
+            defaults.color     = glm::vec4(1.0f);
+            vertices.resize(base + positions.count, defaults);
+            Vertex* first = vertices.data() + base;
+
+            // each attribute is read straight out of the mapped buffer into its Vertex field
+            readAccessorFloats(positions, &first->position.x, sizeof(Vertex), 3);
+            if (primitive.normal >= 0)
+                readAccessorFloats(m_accessors[primitive.normal], &first->normal.x, sizeof(Vertex), 3);
+            else
+                has_normals = false;
+
+            if (primitive.tex_coord >= 0)
+            {
+                // glTF's UV origin is the top left corner, which is what the renderer samples with (Assimp gets
+                // there by flipping twice), so only an import without flip_uvs changes the coordinates
+                readAccessorFloats(m_accessors[primitive.tex_coord], &first->tex_coord.x, sizeof(Vertex), 2);
+                if (!flip_uvs)
+                    for (size_t i = 0; i < positions.count; ++i)
+                        first[i].tex_coord.y = 1.0f - first[i].tex_coord.y;
+                has_uvs = true;
+            }
+
+            if (primitive.tangent >= 0)
+            {
+                // xyz and the handedness of the bitangent in w
+                std::vector<glm::vec4> tangents(positions.count);
+                readAccessorFloats(m_accessors[primitive.tangent], &tangents[0].x, sizeof(glm::vec4), 4);
+                for (size_t i = 0; i < positions.count; ++i)
+                {
+                    first[i].tangent   = glm::vec3(tangents[i]);
+                    first[i].bitangent = glm::cross(first[i].normal, first[i].tangent) * tangents[i].w;
+                }
+            }
+            else
+            {
+                has_tangents = false;
+            }
+
+            if (primitive.color >= 0)
+                readAccessorFloats(m_accessors[primitive.color], &first->color.x, sizeof(Vertex), 4);
+
+            if (skin && primitive.joints >= 0 && primitive.weights >= 0)
+            {
+                readAccessorJoints(m_accessors[primitive.joints], first->joints, sizeof(Vertex));
+                readAccessorFloats(m_accessors[primitive.weights], &first->weights.x, sizeof(Vertex), 4);
+                for (size_t i = 0; i < positions.count; ++i)
+                {
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        if (first[i].joints[c] < skin->joints.size())
+                            continue;
+                        first[i].joints[c]  = 0;
+                        first[i].weights[c] = 0.0f;
+                        ++invalid_joints;
+                    }
+                }
+            }
+
+            const size_t index_begin = indices.size();
+            if (primitive.indices >= 0)
+            {
+                const Accessor& accessor = m_accessors[primitive.indices];
+                indices.resize(index_begin + accessor.count);
+                readAccessorIndices(accessor, base, indices.data() + index_begin);
+            }
+            else
+            {
+                indices.resize(index_begin + positions.count);
+                for (size_t i = 0; i < positions.count; ++i)
+                    indices[index_begin + i] = base + static_cast<uint32_t>(i);
+            }
+            for (size_t i = index_begin; i < indices.size(); ++i)
+            {
+                // the data isn't trusted, an index past the primitive's vertices would read out of bounds later
+                if (indices[i] - base >= positions.count)
+                {
+                    indices[i] = base;
+                    ++invalid_index;
+                }
+            }
+
+            if (primitive.mode != MODE_TRIANGLES)
+                triangulate(primitive.mode, indices, index_begin);
+            indices.resize(index_begin + (indices.size() - index_begin) / 3 * 3);
+
+            result.addSubMesh(SubMesh(static_cast<uint32_t>(index_begin),
+                                      static_cast<uint32_t>(indices.size() - index_begin),
+                                      primitive.material));
+        }
+
+        debug("  Mesh '" + (info.name.empty() ? std::string("<unnamed>") : info.name) +
+              "' - Vertices: " + std::to_string(vertices.size()) + ", Faces: " + std::to_string(indices.size() / 3) +
+              ", Primitives: " + std::to_string(info.primitives.size()) + ", UVs: " + (has_uvs ? "YES" : "NO") +
+              ", Normals: " + (has_normals ? "YES" : "NO") + ", Tangents: " + (has_tangents ? "YES" : "NO"));
+        if (invalid_index > 0 || invalid_joints > 0)
+            warn("  Mesh '" + info.name + "' - " + std::to_string(invalid_index) + " index(es) and " +
+                 std::to_string(invalid_joints) + " joint(s) out of range were dropped.");
+
+        if (skin)
+        {
+            std::vector<Bone> bones;
+            bones.reserve(skin->joints.size() + 1);
+            for (size_t i = 0; i < skin->joints.size(); ++i)
+            {
+                Bone bone {m_nodes[skin->joints[i]].index, glm::mat4(1.0f)};
+                if (skin->inverse_binds >= 0)
+                {
+                    const Accessor& inverse_binds = m_accessors[skin->inverse_binds];
+                    std::memcpy(&bone.inverse_bind[0][0], inverse_binds.data + i * inverse_binds.stride,
+                                sizeof(glm::mat4));
+                }
+                bones.push_back(bone);
+            }
+
+            ImportHelpers::finishSkin(vertices, bones, info.node);
+            result.setSkinNode(info.node);
+            result.setBones(std::move(bones));
+        }
+
+        result.setVertices(std::move(vertices));
+        result.setIndices(std::move(indices));
+
+        missing_normals  = !has_normals;
+        missing_tangents = !has_tangents && has_uvs;
+        return result;
+    }
+
+    void GltfImporter::readAccessorFloats(const Accessor& accessor,
+                                          float*          out,
+                                          size_t          out_stride,
+                                          uint32_t        components)
+    {
+        uint8_t*       dst = reinterpret_cast<uint8_t*>(out);
+        const uint32_t n   = std::min(components, accessor.components);
+        switch (accessor.component_type)
+        {
+            case COMPONENT_FLOAT:
+                readComponents<float>(accessor.data, accessor.count, accessor.stride, false, n, dst, out_stride);
+                break;
+            case COMPONENT_BYTE:
+                readComponents<int8_t>(accessor.data, accessor.count, accessor.stride, accessor.normalized, n, dst,
+                                       out_stride);
+                break;
+            case COMPONENT_UNSIGNED_BYTE:
+                readComponents<uint8_t>(accessor.data, accessor.count, accessor.stride, accessor.normalized, n, dst,
+                                        out_stride);
+                break;
+            case COMPONENT_SHORT:
+                readComponents<int16_t>(accessor.data, accessor.count, accessor.stride, accessor.normalized, n, dst,
+                                        out_stride);
+                break;
+            case COMPONENT_UNSIGNED_SHORT:
+                readComponents<uint16_t>(accessor.data, accessor.count, accessor.stride, accessor.normalized, n, dst,
+                                         out_stride);
+                break;
+            case COMPONENT_UNSIGNED_INT:
+                readComponents<uint32_t>(accessor.data, accessor.count, accessor.stride, false, n, dst, out_stride);
+                break;
+            default:
+                break;
+        }
+    }
+
+    void GltfImporter::readAccessorIndices(const Accessor& accessor, uint32_t base_vertex, uint32_t* out)
+    {
+        switch (accessor.component_type)
+        {
+            case COMPONENT_UNSIGNED_INT:
+                if (accessor.stride == sizeof(uint32_t) && base_vertex == 0)
+                {
+                    // tightly packed 32-bit indices are already in the engine's layout
+                    std::memcpy(out, accessor.data, accessor.count * sizeof(uint32_t));
+                    break;
+                }
+                readIntegers<uint32_t>(accessor.data, accessor.count, accessor.stride, base_vertex, out);
+                break;
+            case COMPONENT_UNSIGNED_SHORT:
+                readIntegers<uint16_t>(accessor.data, accessor.count, accessor.stride, base_vertex, out);
+                break;
+            case COMPONENT_UNSIGNED_BYTE:
+                readIntegers<uint8_t>(accessor.data, accessor.count, accessor.stride, base_vertex, out);
+                break;
+            default:
+                break;
+        }
+    }
+
+    void GltfImporter::readAccessorJoints(const Accessor& accessor, uint16_t* out, size_t out_stride)
+    {
+        uint8_t*       dst = reinterpret_cast<uint8_t*>(out);
+        const uint8_t* src = accessor.data;
+        for (size_t i = 0; i < accessor.count; ++i, src += accessor.stride, dst += out_stride)
+        {
+            uint16_t joints[4];
+            for (int c = 0; c < 4; ++c)
+            {
+                if (accessor.component_type == COMPONENT_UNSIGNED_BYTE)
+                    joints[c] = src[c];
+                else
+                    std::memcpy(&joints[c], src + c * sizeof(uint16_t), sizeof(uint16_t));
+            }
+            std::memcpy(dst, joints, sizeof(joints));
+        }
+    }
+} // namespace RealmEngine
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "glm/ext/matrix_float4x4.hpp"
+#include "plateform/mapped_file.h"
+#include "resource/datatype/model/animation.h"
+#include "resource/datatype/model/material.h"
+#include "resource/datatype/model/mesh.h"
+#include "resource/datatype/model/model.h"
+
+namespace RealmEngine
+{
+    class ImportProfiler;
+
+    /**
+     * Native glTF 2.0 reader for .gltf and .glb files. Buffers are memory mapped (the GLB binary chunk is read in
+     * place) and accessors are read straight from the mapping into the engine's Vertex and index arrays, with no
+     * intermediate scene. open() parses and validates the whole document up front, so once it returned true the
+     * read functions can't fail and are safe to call from several threads at once.
+     * Files using something the reader doesn't cover (compression extensions, sparse accessors, skins larger than
+     * one joint palette, ...) are rejected by open() and left to Assimp by ModelImporter.
+     */
+    class GltfImporter
+    {
+    public:
+        GltfImporter()           = default;
+        ~GltfImporter() noexcept = default;
+
+        GltfImporter(const GltfImporter& that)            = delete;
+        GltfImporter(GltfImporter&& that)                 = delete;
+        GltfImporter& operator=(const GltfImporter& that) = delete;
+        GltfImporter& operator=(GltfImporter&& that)      = delete;
+
+        static bool isGltf(const std::string& filepath);
+
+        // Maps the file and the buffers it references and parses the document. False when it can't be read natively.
+        bool open(const std::string& filepath);
+
+        // The external buffer files the document references, for keying cooked models.
+        static std::vector<std::string> findDependencies(const std::string& filepath);
+
+        size_t   getMaterialCount() const { return m_materials.size(); }
+        // moves the material out, call once per index
+        Material takeMaterial(size_t material);
+
+        // Builds the model's node tree from the default scene, under an identity root holding the scene's roots,
+        // and resolves glTF node indices to NodeHierarchy indices for the skins, meshes and animations.
+        void readNodes(Model& model);
+
+        // after readNodes()
+        size_t    getAnimationCount() const { return m_animations.size(); }
+        Animation readAnimation(size_t animation) const;
+
+        size_t getMeshCount() const { return m_meshes.size(); }
+        // Over the primitives' accessor data, modes and materials (through material_remap, when not empty).
+        // 0 for a mesh readMesh() would skin, its skin node ties it to one node.
+        uint64_t hashMesh(size_t mesh, const std::vector<uint32_t>& material_remap, bool skinning) const;
+        bool     sameMesh(size_t a, size_t b, const std::vector<uint32_t>& material_remap) const;
+        size_t getVertexCount(size_t mesh) const;
+        size_t getTriangleCount(size_t mesh) const;
+
+        // One Mesh per glTF mesh with a submesh per primitive, skinned when skinning is set and the first node
+        // drawing it has a skin. After readNodes().
+        Mesh readMesh(size_t          mesh,
+                      bool            flip_uvs,
+                      bool            calculate_tangents,
+                      bool            skinning,
+                      ImportProfiler* profiler = nullptr) const;
+
+    private:
+        // A typed view into a buffer, bounds checked by open().
+        struct Accessor
+        {
+            const uint8_t* data {nullptr};
+            size_t         count {0};
+            size_t         stride {0};
+            uint32_t       component_type {0};
+            uint32_t       components {0};
+            bool           normalized {false};
+        };
+
+        struct Primitive
+        {
+            int32_t  position {-1}; // accessor indices, -1 when absent
+            int32_t  normal {-1};
+            int32_t  tangent {-1};
+            int32_t  tex_coord {-1};
+            int32_t  color {-1};
+            int32_t  joints {-1};
+            int32_t  weights {-1};
+            int32_t  indices {-1};
+            uint32_t mode {4}; // triangles
+            uint32_t material {0};
+        };
+
+        struct MeshInfo
+        {
+            std::string            name;
+            std::vector<Primitive> primitives;
+            uint32_t               node {0};  // hierarchy index of the first node drawing the mesh
+            int32_t                skin {-1}; // skin of that node
+        };
+
+        struct NodeInfo
+        {
+            glm::mat4             transform {1.0f};
+            int32_t               mesh {-1};
+            int32_t               skin {-1};
+            std::vector<uint32_t> children;
+            uint32_t              index {0}; // in the NodeHierarchy, set by readNodes()
+            bool                  in_scene {false};
+        };
+
+        struct SkinInfo
+        {
+            std::vector<uint32_t> joints; // glTF node indices
+            int32_t               inverse_binds {-1};
+        };
+
+        enum class Path : uint8_t
+        {
+            Translation,
+            Rotation,
+            Scale,
+        };
+
+        enum class Interpolation : uint8_t
+        {
+            Linear,
+            Step,
+            CubicSpline,
+        };
+
+        struct ChannelInfo
+        {
+            uint32_t      node {0};
+            uint32_t      input {0};
+            uint32_t      output {0};
+            Path          path {Path::Translation};
+            Interpolation interpolation {Interpolation::Linear};
+        };
+
+        struct AnimationInfo
+        {
+            std::string              name;
+            std::vector<ChannelInfo> channels;
+        };
+
+        // readMesh() without the generated normals and tangents
+        Mesh readGeometry(size_t mesh,
+                          bool   flip_uvs,
+                          bool   skinning,
+                          bool&  missing_normals,
+                          bool&  missing_tangents) const;
+
+        bool readDocument(const uint8_t* json, size_t json_size, const uint8_t* glb_bin, size_t glb_bin_size);
+
+        uint64_t hashAccessor(int32_t accessor, uint64_t seed) const;
+        bool     sameAccessor(int32_t a, int32_t b) const;
+
+        // out_stride in bytes, so the destination can be a field of an array of structs
+        static void readAccessorFloats(const Accessor& accessor, float* out, size_t out_stride, uint32_t components);
+        static void readAccessorIndices(const Accessor& accessor, uint32_t base_vertex, uint32_t* out);
+        static void readAccessorJoints(const Accessor& accessor, uint16_t* out, size_t out_stride);
+
+        std::string m_base_dir;
+
+        MappedFile                        m_file;
+        std::vector<MappedFile>           m_buffer_files;
+        std::vector<std::vector<uint8_t>> m_decoded_buffers; // data: URIs
+
+        std::vector<Accessor>      m_accessors;
+        std::vector<Material>      m_materials;
+        std::vector<MeshInfo>      m_meshes;
+        std::vector<NodeInfo>      m_nodes;
+        std::vector<uint32_t>      m_scene_roots;
+        std::vector<SkinInfo>      m_skins;
+        std::vector<AnimationInfo> m_animations;
+    };
+} // namespace RealmEngine
@@ -0,0 +1,40 @@
+#include "import_helpers.h"
+#include "utils.h"
+
+#include <limits>
+
+namespace RealmEngine
+{
+    namespace ImportHelpers
+    {
+        std::string getBaseDir(const std::string& filepath)
+        {
+            const size_t last_slash_pos = filepath.find_last_of("/\\");
+            return last_slash_pos != std::string::npos ? filepath.substr(0, last_slash_pos + 1) : "./";
+        }
+
+        void finishSkin(std::vector<Vertex>& vertices, std::vector<Bone>& bones, uint32_t skin_node)
+        {
+            uint16_t rigid_joint = std::numeric_limits<uint16_t>::max();
+            for (auto& vert : vertices)
+            {
+                const float total = vert.weights.x + vert.weights.y + vert.weights.z + vert.weights.w;
+                if (total > 0.0f)
+                {
+                    vert.weights = vert.weights * (1.0f / total);
+                    continue;
+                }
+
+                if (rigid_joint == std::numeric_limits<uint16_t>::max())
+                {
+                    rigid_joint = static_cast<uint16_t>(bones.size());
+                    bones.push_back(Bone {skin_node, glm::mat4(1.0f)});
+                }
+                vert.joints[0] = rigid_joint;
+                vert.weights   = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+            }
+
+            debug("  Skin - Bones: " + std::to_string(bones.size()) + ", Skin node: " + std::to_string(skin_node));
+        }
+    } // namespace ImportHelpers
+} // namespace RealmEngine
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "resource/datatype/model/mesh.h"
+
+namespace RealmEngine
+{
+    // Steps the Assimp and the native glTF importer share, so a fix to either lands in both paths.
+    namespace ImportHelpers
+    {
+        // Directory of filepath with the trailing separator, "./" for a bare file name.
+        std::string getBaseDir(const std::string& filepath);
+
+        /**
+         * Finishes the skin of a mesh once every joint influence is in: weights are normalized, and vertices no
+         * joint reaches get an extra bone following skin_node, the node the mesh hangs from.
+         */
+        void finishSkin(std::vector<Vertex>& vertices, std::vector<Bone>& bones, uint32_t skin_node);
+    } // namespace ImportHelpers
+} // namespace RealmEngine
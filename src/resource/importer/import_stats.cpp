@@ -0,0 +1,129 @@
+#include "import_stats.h"
+#include "json.hpp"
+#include "plateform/plateform.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace RealmEngine
+{
+    const ImportStats::Stage* ImportStats::findStage(const std::string& name) const
+    {
+        auto it = std::find_if(stages.begin(), stages.end(), [&](const Stage& stage) { return stage.name == name; });
+        return it != stages.end() ? &*it : nullptr;
+    }
+
+    void ImportStats::addStage(const std::string& name, double milliseconds, size_t peak)
+    {
+        auto it = std::find_if(stages.begin(), stages.end(), [&](const Stage& stage) { return stage.name == name; });
+        if (it == stages.end())
+            it = stages.insert(stages.end(), Stage {name});
+
+        it->milliseconds += milliseconds;
+        it->peak_memory = std::max(it->peak_memory, peak);
+        ++it->runs;
+    }
+
+    nlohmann::json ImportStats::toJson() const
+    {
+        nlohmann::json json;
+        json["source"]            = source;
+        json["importer"]          = importer;
+        json["succeeded"]         = succeeded;
+        json["meshes"]            = meshes;
+        json["materials"]         = materials;
+        json["vertices"]          = vertices;
+        json["triangles"]         = triangles;
+        json["total_ms"]          = total_milliseconds;
+        json["peak_memory_bytes"] = peak_memory;
+
+        nlohmann::json& json_stages = json["stages"];
+        json_stages                 = nlohmann::json::array();
+        for (const Stage& stage : stages)
+        {
+            json_stages.push_back({{"name", stage.name},
+                                   {"ms", stage.milliseconds},
+                                   {"peak_memory_bytes", stage.peak_memory},
+                                   {"runs", stage.runs}});
+        }
+        return json;
+    }
+
+    bool ImportStats::writeJson(const std::string& path) const
+    {
+        std::ofstream file(path);
+        if (!file)
+        {
+            err("Failed to write import stats to: " + path);
+            return false;
+        }
+        file << toJson().dump(2) << '\n';
+        return file.good();
+    }
+
+    void ImportStats::log() const
+    {
+        debug("< Import stats > " + source + " - " + importer + ", " + std::to_string(total_milliseconds) +
+              " ms, peak " + formatMegabytes(peak_memory));
+        for (const Stage& stage : stages)
+        {
+            const double share = total_milliseconds > 0.0 ? stage.milliseconds / total_milliseconds * 100.0 : 0.0;
+            debug("  " + stage.name + ": " + std::to_string(stage.milliseconds) + " ms (" +
+                  std::to_string(static_cast<int>(share + 0.5)) + "%), peak " + formatMegabytes(stage.peak_memory) +
+                  (stage.runs > 1 ? ", " + std::to_string(stage.runs) + " runs" : std::string()));
+        }
+    }
+
+    ImportProfiler::Scope::Scope(ImportProfiler* profiler, const char* stage) :
+        m_profiler(profiler && profiler->isEnabled() ? profiler : nullptr), m_stage(stage)
+    {
+        if (m_profiler)
+            m_start = Clock::now();
+    }
+
+    ImportProfiler::Scope::~Scope() noexcept
+    {
+        if (m_profiler)
+            m_profiler->record(m_stage, std::chrono::duration<double, std::milli>(Clock::now() - m_start).count());
+    }
+
+    ImportProfiler::ImportProfiler(ImportStats* stats) : m_stats(stats)
+    {
+        if (!m_stats)
+            return;
+
+        m_start           = Clock::now();
+        m_peak_resettable = Plateform::resetPeakResidentMemory();
+    }
+
+    void ImportProfiler::record(const char* stage, double milliseconds)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // The peak since the last stage ended anywhere, exact for the serial stages. Where the OS can't restart
+        // the peak, the resident size at the end of the stage is the closest there is.
+        size_t peak = Plateform::getResidentMemory();
+        if (m_peak_resettable)
+        {
+            peak = std::max(peak, Plateform::getPeakResidentMemory());
+            Plateform::resetPeakResidentMemory();
+        }
+        m_stats->addStage(stage, milliseconds, peak);
+    }
+
+    void ImportProfiler::finish(bool succeeded)
+    {
+        if (!m_stats)
+            return;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats->succeeded          = succeeded;
+        m_stats->total_milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - m_start).count();
+        m_stats->peak_memory        = Plateform::getResidentMemory();
+        if (m_peak_resettable)
+            m_stats->peak_memory = std::max(m_stats->peak_memory, Plateform::getPeakResidentMemory());
+        for (const ImportStats::Stage& stage : m_stats->stages)
+            m_stats->peak_memory = std::max(m_stats->peak_memory, stage.peak_memory);
+    }
+} // namespace RealmEngine
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "json_fwd.hpp"
+
+namespace RealmEngine
+{
+    /**
+     * Where one model import spent its time and memory, stage by stage, in the order the stages first ran.
+     * Stages that run per mesh on the thread pool are summed over the workers, so together they can exceed the
+     * wall clock total. Memory is the process' resident set size, which only describes this import while no
+     * other import runs alongside it.
+     */
+    struct ImportStats
+    {
+        struct Stage
+        {
+            std::string name;
+            double      milliseconds {0.0};
+            size_t      peak_memory {0}; // highest resident set size while the stage ran, in bytes
+            uint32_t    runs {0};        // one per mesh for the per mesh stages
+        };
+
+        std::string        source;
+        std::string        importer; // "gltf" or "assimp"
+        bool               succeeded {false};
+        size_t             meshes {0};
+        size_t             materials {0};
+        size_t             vertices {0};
+        size_t             triangles {0};
+        double             total_milliseconds {0.0};
+        size_t             peak_memory {0};
+        std::vector<Stage> stages;
+
+        const Stage*   findStage(const std::string& name) const;
+        // Adds to the stage of that name, creating it at the end.
+        void           addStage(const std::string& name, double milliseconds, size_t peak_memory);
+
+        nlohmann::json toJson() const;
+        bool           writeJson(const std::string& path) const;
+        void           log() const;
+    };
+
+    /**
+     * Times the stages of one import into an ImportStats, from the importing thread and pool workers alike.
+     * With a null ImportStats every call is a no-op, so importers time their stages unconditionally.
+     */
+    class ImportProfiler
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // Ends a stage when it goes out of scope.
+        class Scope
+        {
+        public:
+            Scope(ImportProfiler* profiler, const char* stage);
+            ~Scope() noexcept;
+
+            Scope(const Scope& that)            = delete;
+            Scope(Scope&& that)                 = delete;
+            Scope& operator=(const Scope& that) = delete;
+            Scope& operator=(Scope&& that)      = delete;
+
+        private:
+            ImportProfiler*   m_profiler;
+            const char*       m_stage;
+            Clock::time_point m_start;
+        };
+
+        explicit ImportProfiler(ImportStats* stats);
+        ~ImportProfiler() noexcept = default;
+
+        ImportProfiler(const ImportProfiler& that)            = delete;
+        ImportProfiler(ImportProfiler&& that)                 = delete;
+        ImportProfiler& operator=(const ImportProfiler& that) = delete;
+        ImportProfiler& operator=(ImportProfiler&& that)      = delete;
+
+        bool         isEnabled() const { return m_stats != nullptr; }
+        ImportStats* getStats() const { return m_stats; }
+
+        // Sets the wall clock total and the overall peak.
+        void finish(bool succeeded);
+
+    private:
+        void record(const char* stage, double milliseconds);
+
+        ImportStats*      m_stats;
+        std::mutex        m_mutex;
+        Clock::time_point m_start;
+        bool              m_peak_resettable {false};
+    };
+} // namespace RealmEngine
@@ -1,36 +1,254 @@
 #include "model_importer.h"
 #include "assimp/Importer.hpp"
+#include "assimp/anim.h"
+#include "assimp/config.h"
 #include "assimp/material.h"
 #include "assimp/mesh.h"
 #include "assimp/postprocess.h"
 #include "assimp/scene.h"
 #include "assimp/types.h"
 #include "glm/ext/matrix_float4x4.hpp"
+#include "glm/ext/quaternion_float.hpp"
 #include "glm/ext/vector_float2.hpp"
 #include "glm/ext/vector_float3.hpp"
 #include "glm/ext/vector_float4.hpp"
+#include "gltf_importer.h"
+#include "hash.h"
+#include "import_helpers.h"
+#include "plateform/mapped_file.h"
 #include "resource/datatype/model/material.h"
+#include "global_context.h"
 #include "resource/datatype/model/node.h"
+#include "resource/processor/bvh_builder.h"
+#include "resource/processor/mesh_optimizer.h"
+#include "resource/processor/model_deduplicator.h"
+#include "thread_pool.h"
 #include "utils.h"
 
+#include <algorithm>
+#include <cctype>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <filesystem>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
 
 namespace RealmEngine
 {
-    std::unique_ptr<Model> ModelImporter::loadModel(const std::string& filepath, const LoadOptions& options)
+    namespace
+    {
+        int weakestInfluence(const glm::vec4& weights)
+        {
+            int weakest = 0;
+            for (int i = 1; i < 4; ++i)
+                if (weights[i] < weights[weakest])
+                    weakest = i;
+            return weakest;
+        }
+
+        // Everything processMesh() reads of an aiMesh, each stream as it's laid out in the scene.
+        template<typename Visit>
+        bool visitMeshStreams(const aiMesh* ai_mesh, Visit&& visit)
+        {
+            const size_t vertex_bytes = ai_mesh->mNumVertices * sizeof(aiVector3D);
+            if (!visit(ai_mesh->mVertices, vertex_bytes) ||
+                !visit(ai_mesh->HasNormals() ? ai_mesh->mNormals : nullptr, vertex_bytes) ||
+                !visit(ai_mesh->HasTextureCoords(0) ? ai_mesh->mTextureCoords[0] : nullptr, vertex_bytes) ||
+                !visit(ai_mesh->HasTangentsAndBitangents() ? ai_mesh->mTangents : nullptr, vertex_bytes) ||
+                !visit(ai_mesh->HasTangentsAndBitangents() ? ai_mesh->mBitangents : nullptr, vertex_bytes) ||
+                !visit(ai_mesh->HasVertexColors(0) ? ai_mesh->mColors[0] : nullptr,
+                       ai_mesh->mNumVertices * sizeof(aiColor4D)))
+                return false;
+
+            for (size_t i = 0; i < ai_mesh->mNumFaces; ++i)
+            {
+                const aiFace& face = ai_mesh->mFaces[i];
+                if (!visit(face.mIndices, face.mNumIndices * sizeof(unsigned int)))
+                    return false;
+            }
+            return true;
+        }
+
+        uint64_t hashSourceMesh(const aiMesh* ai_mesh, uint32_t material)
+        {
+            uint64_t seed = Hash::combine(ai_mesh->mNumVertices, ai_mesh->mNumFaces);
+            seed          = Hash::combine(seed, material);
+            visitMeshStreams(ai_mesh, [&](const void* data, size_t size) {
+                // absent streams count too, a mesh without normals differs from one with zero normals
+                seed = data ? Hash::hashBytes(data, size, seed) : Hash::combine(seed, 0);
+                return true;
+            });
+            return seed == 0 ? 1 : seed;
+        }
+
+        bool sameSourceMesh(const aiMesh* a, const aiMesh* b)
+        {
+            if (a->mNumVertices != b->mNumVertices || a->mNumFaces != b->mNumFaces)
+                return false;
+
+            std::vector<std::pair<const void*, size_t>> streams;
+            visitMeshStreams(a, [&](const void* data, size_t size) {
+                streams.emplace_back(data, size);
+                return true;
+            });
+
+            size_t stream = 0;
+            return visitMeshStreams(b, [&](const void* data, size_t size) {
+                const auto& [other, other_size] = streams[stream++];
+                if (!data || !other)
+                    return data == other;
+                return size == other_size && std::memcmp(data, other, size) == 0;
+            });
+        }
+
+        // the material libraries an OBJ names on its "mtllib" lines, next to the OBJ
+        std::vector<std::string> findObjMaterialLibraries(const std::string& filepath)
+        {
+            MappedFile file;
+            if (!file.open(filepath))
+                return {};
+
+            const std::filesystem::path folder = std::filesystem::path(filepath).parent_path();
+            const char*                 text   = reinterpret_cast<const char*>(file.data());
+            const char*                 end    = text + file.size();
+
+            std::vector<std::string> libraries;
+            for (const char* line = text; line < end;)
+            {
+                const char* line_end = std::find(line, end, '\n');
+                if (line_end - line > 7 && std::strncmp(line, "mtllib", 6) == 0 &&
+                    std::isspace(static_cast<unsigned char>(line[6])))
+                {
+                    std::istringstream names(std::string(line + 7, line_end));
+                    std::string        name;
+                    while (names >> name)
+                        libraries.push_back((folder / name).generic_string());
+                }
+                line = line_end + 1;
+            }
+            return libraries;
+        }
+    } // namespace
+
+    uint64_t ModelImporter::LoadOptions::hash() const
+    {
+        uint64_t seed = 0;
+        seed          = Hash::combine(seed, calculate_tangents);
+        seed          = Hash::combine(seed, flip_uvs);
+        seed          = Hash::combine(seed, optimize_meshes);
+        seed          = Hash::combine(seed, optimize_graph);
+        seed          = Hash::combine(seed, optimize_vertex_order);
+        seed          = Hash::combine(seed, encode_vertices);
+        seed          = Hash::combine(seed, quantize_positions);
+        seed          = Hash::combine(seed, import_animations);
+        seed          = Hash::combine(seed, native_gltf);
+        seed          = Hash::combine(seed, deduplicate);
+        seed          = Hash::combine(seed, build_bvh);
+        seed          = Hash::combine(seed, static_cast<uint8_t>(vertex_welding));
+        seed          = Hash::combine(seed, Hash::hashValue(weld_epsilon));
+        seed          = Hash::combine(seed, lod_count);
+        seed          = Hash::combine(seed, Hash::hashValue(lod_reduction));
+        seed          = Hash::combine(seed, Hash::hashValue(lod_max_error));
+        return seed;
+    }
+
+    std::vector<std::string> ModelImporter::findDependencies(const std::string& filepath)
+    {
+        if (GltfImporter::isGltf(filepath))
+            return GltfImporter::findDependencies(filepath);
+
+        std::string extension = std::filesystem::path(filepath).extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) {
+            return static_cast<char>(std::tolower(c));
+        });
+        if (extension == ".obj")
+            return findObjMaterialLibraries(filepath);
+
+        // the other formats Assimp reads keep their geometry and materials in the one file
+        return {};
+    }
+
+    std::unique_ptr<Model>
+    ModelImporter::loadModel(const std::string& filepath, const LoadOptions& options, ImportStats* stats)
+    {
+        std::unique_ptr<Model> model = std::make_unique<Model>();
+        if (!importModel(*model, filepath, options, {}, stats))
+            return nullptr;
+        return model;
+    }
+
+    bool ModelImporter::importModel(Model&                 model,
+                                    const std::string&     filepath,
+                                    const LoadOptions&     options,
+                                    const ImportCallbacks& callbacks,
+                                    ImportStats*           stats)
     {
         info("Loading model from: " + filepath);
+        debug("< Import options > - Calculate tangents: " + std::string(options.calculate_tangents ? "ON" : "OFF") +
+              ", Flip UVs: " + std::string(options.flip_uvs ? "ON" : "OFF") +
+              ", Optimize meshes: " + std::string(options.optimize_meshes ? "ON" : "OFF") +
+              ", Optimize graph: " + std::string(options.optimize_graph ? "ON" : "OFF") +
+              ", Optimize vertex order: " + std::string(options.optimize_vertex_order ? "ON" : "OFF") +
+              ", Encode vertices: " + std::string(options.encode_vertices ? "ON" : "OFF") +
+              ", Quantize positions: " + std::string(options.quantize_positions ? "ON" : "OFF") +
+              ", Import animations: " + std::string(options.import_animations ? "ON" : "OFF") +
+              ", Native glTF: " + std::string(options.native_gltf ? "ON" : "OFF") +
+              ", Deduplicate: " + std::string(options.deduplicate ? "ON" : "OFF") +
+              ", Build BVH: " + std::string(options.build_bvh ? "ON" : "OFF") + ", Vertex welding: " +
+              std::string(options.vertex_welding == VertexWelding::Engine ? "engine" : "assimp") +
+              ", Weld epsilon: " + std::to_string(options.weld_epsilon) +
+              ", LOD count: " + std::to_string(options.lod_count));
+
+        if (stats)
+        {
+            *stats        = ImportStats();
+            stats->source = filepath;
+        }
+        ImportProfiler profiler(stats);
+
+        bool imported = false;
+        bool native   = false;
+        if (options.native_gltf && GltfImporter::isGltf(filepath))
+        {
+            GltfImporter gltf;
+            {
+                ImportProfiler::Scope scope(&profiler, "gltf_parse");
+                native = gltf.open(filepath);
+            }
+            if (native)
+                imported = importGltf(model, gltf, options, callbacks, profiler);
+            else
+                warn("Falling back to Assimp for: " + filepath);
+        }
+        if (!native)
+            imported = importAssimp(model, filepath, options, callbacks, profiler);
+
+        if (stats)
+        {
+            stats->importer = native ? "gltf" : "assimp";
+            profiler.finish(imported);
+            stats->log();
+        }
+        return imported;
+    }
 
+    bool ModelImporter::importAssimp(Model&                 model,
+                                     const std::string&     filepath,
+                                     const LoadOptions&     options,
+                                     const ImportCallbacks& callbacks,
+                                     ImportProfiler&        profiler)
+    {
         Assimp::Importer importer;
 
         // process flags
-        unsigned int ai_flags = aiProcess_Triangulate | aiProcess_GenNormals | aiProcess_GenUVCoords |
-                                aiProcess_JoinIdenticalVertices | aiProcess_ValidateDataStructure;
+        unsigned int ai_flags =
+            aiProcess_Triangulate | aiProcess_GenNormals | aiProcess_GenUVCoords | aiProcess_ValidateDataStructure;
+        if (options.vertex_welding == VertexWelding::Assimp)
+            ai_flags |= aiProcess_JoinIdenticalVertices;
         if (options.calculate_tangents)
             ai_flags |= aiProcess_CalcTangentSpace;
         if (options.flip_uvs)
@@ -39,64 +257,405 @@ namespace RealmEngine
             ai_flags |= aiProcess_OptimizeGraph;
         if (options.optimize_meshes)
             ai_flags |= aiProcess_OptimizeMeshes;
-        debug("< Import options > - Calculate tangents: " + std::string(options.calculate_tangents ? "ON" : "OFF") +
-              ", Flip UVs: " + std::string(options.flip_uvs ? "ON" : "OFF") +
-              ", Optimize meshes: " + std::string(options.optimize_meshes ? "ON" : "OFF") +
-              ", Optimize graph: " + std::string(options.optimize_graph ? "ON" : "OFF"));
+        if (options.import_animations)
+        {
+            // 4 influences per vertex, and meshes split so their joints fit the palette, one slot is kept for
+            // the vertices no bone reaches
+            ai_flags |= aiProcess_LimitBoneWeights | aiProcess_SplitByBoneCount;
+            importer.SetPropertyInteger(AI_CONFIG_PP_LBW_MAX_WEIGHTS, 4);
+            importer.SetPropertyInteger(AI_CONFIG_PP_SBBC_MAX_BONES, static_cast<int>(MAX_MESH_BONES - 1));
+        }
 
-        // load from file
-        const aiScene* scene = importer.ReadFile(filepath, ai_flags);
+        // load from file, then post-process as a separate step so both can be timed; ReadFile() with the flags
+        // runs the very same ApplyPostProcessing()
+        const aiScene* scene = nullptr;
+        {
+            ImportProfiler::Scope scope(&profiler, "assimp_read");
+            scene = importer.ReadFile(filepath, 0);
+        }
+        if (scene)
+        {
+            ImportProfiler::Scope scope(&profiler, "assimp_postprocess");
+            scene = importer.ApplyPostProcessing(ai_flags);
+        }
         if (!scene || scene->mFlags == AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
         {
             err("An error occured when Assimp try to load model from :" + filepath +
                 " - Error: " + importer.GetErrorString());
-            return nullptr;
+            return false;
         }
 
         debug("< Assimp scene loaded successfully > - Meshes: " + std::to_string(scene->mNumMeshes) + ", Materials: " +
               std::to_string(scene->mNumMaterials) + ", Textures: " + std::to_string(scene->mNumTextures) +
               ", Animations: " + std::to_string(scene->mNumAnimations));
 
-        std::unique_ptr<Model> model = std::make_unique<Model>();
+        const std::string base_dir = ImportHelpers::getBaseDir(filepath);
 
-        // get base dir path
-        std::string base_dir;
-        size_t      last_slash_pos = filepath.find_last_of("/\\");
-        if (last_slash_pos != std::string::npos)
-            base_dir = filepath.substr(0, last_slash_pos + 1);
-        else
-            base_dir = "./";
+        // Materials and meshes are independent of each other, so they're converted on the thread pool straight
+        // into preallocated slots. Slot i always holds scene entry i, keeping the result deterministic.
+        ThreadPool* pool = g_context.m_thread_pool.get();
 
         // load all material
         debug("< Processing " + std::to_string(scene->mNumMaterials) + " material(s)... >");
-        for (size_t i = 0; i < scene->mNumMaterials; ++i)
+        model.resizeMaterials(scene->mNumMaterials);
+        auto process_materials = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                model.getMaterial(i) = processMaterial(scene->mMaterials[i], base_dir);
+        };
+        {
+            ImportProfiler::Scope scope(&profiler, "materials");
+            if (pool)
+                pool->parallelFor(0, scene->mNumMaterials, 1, process_materials);
+            else
+                process_materials(0, scene->mNumMaterials);
+        }
+        ModelDeduplicator::Remap materials;
+        if (options.deduplicate)
+        {
+            ImportProfiler::Scope scope(&profiler, "deduplication");
+            materials = ModelDeduplicator::deduplicateMaterials(model);
+        }
+
+        // recursively process node tree
+        debug("< Processing scene graph hierarchy... >");
+        {
+            ImportProfiler::Scope scope(&profiler, "node_graph");
+            model.setRoot(processNode(scene->mRootNode, scene));
+        }
+
+        // bones and channels name their nodes, resolved to hierarchy indices
+        NodeIndex nodes;
+        if (options.import_animations)
+        {
+            ImportProfiler::Scope scope(&profiler, "animations");
+            nodes = indexNodes(scene);
+            for (size_t i = 0; i < scene->mNumAnimations; ++i)
+            {
+                Animation animation = processAnimation(scene->mAnimations[i], nodes);
+                if (!animation.getChannels().empty())
+                    model.addAnimation(std::move(animation));
+            }
+        }
+
+        // Identical meshes collapse into one slot before anything is converted, so copies cost nothing past
+        // hashing. Skinned meshes stay apart, their skin node ties them to the node they hang from.
+        ModelDeduplicator::Remap meshes;
+        if (options.deduplicate)
         {
-            Material&& material = processMaterial(scene->mMaterials[i], base_dir);
-            model->addMaterial(std::move(material));
+            ImportProfiler::Scope scope(&profiler, "deduplication");
+            auto material = [&](const aiMesh* ai_mesh) {
+                const uint32_t index = ai_mesh->mMaterialIndex;
+                return index < materials.remap.size() ? materials.remap[index] : index;
+            };
+            auto hash = [&](size_t i) -> uint64_t {
+                const aiMesh* ai_mesh = scene->mMeshes[i];
+                if (options.import_animations && ai_mesh->HasBones())
+                    return 0;
+                return hashSourceMesh(ai_mesh, material(ai_mesh));
+            };
+            auto same = [&](uint32_t a, uint32_t b) {
+                const aiMesh* first  = scene->mMeshes[a];
+                const aiMesh* second = scene->mMeshes[b];
+                return material(first) == material(second) && sameSourceMesh(first, second);
+            };
+            meshes = deduplicateMeshes(model, scene->mNumMeshes, hash, same);
         }
+        const size_t mesh_count = options.deduplicate ? meshes.sources.size() : scene->mNumMeshes;
+        auto         source     = [&](size_t mesh) { return options.deduplicate ? meshes.sources[mesh] : mesh; };
+
+        // everything but the mesh data is final from here on
+        model.resizeMeshes(mesh_count);
+        if (callbacks.on_skeleton)
+            callbacks.on_skeleton(model);
 
         // load all mesh
-        debug("< Processing " + std::to_string(scene->mNumMeshes) + " mesh(es)... >");
+        debug("< Processing " + std::to_string(mesh_count) + " mesh(es)... >");
         size_t total_vertices  = 0;
         size_t total_triangles = 0;
-        for (size_t i = 0; i < scene->mNumMeshes; ++i)
+        for (size_t i = 0; i < mesh_count; ++i)
+        {
+            total_vertices += scene->mMeshes[source(i)]->mNumVertices;
+            total_triangles += scene->mMeshes[source(i)]->mNumFaces;
+        }
+
+        VertexWelder::Settings weld_settings;
+        weld_settings.epsilon = options.weld_epsilon;
+        const bool engine_welding = options.vertex_welding == VertexWelding::Engine;
+
+        std::vector<MeshOptimizer::Report> optimize_reports(mesh_count);
+        std::vector<VertexWelder::Report>  weld_reports(mesh_count);
+        auto                               process_meshes = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const aiMesh* ai_mesh = scene->mMeshes[source(i)];
+                Mesh&         mesh    = model.getMesh(i);
+                {
+                    ImportProfiler::Scope scope(&profiler, "vertex_conversion");
+                    mesh = processMesh(ai_mesh);
+                    ModelDeduplicator::remapMaterials(mesh, materials.remap);
+                }
+                if (options.import_animations && ai_mesh->HasBones())
+                {
+                    ImportProfiler::Scope scope(&profiler, "skinning");
+                    processSkin(ai_mesh, nodes, nodes.mesh_nodes[source(i)], mesh);
+                }
+                if (engine_welding)
+                {
+                    // after skinning so the joints and weights take part in the key
+                    ImportProfiler::Scope scope(&profiler, "vertex_welding");
+                    weld_reports[i] = VertexWelder::weld(mesh, weld_settings, pool);
+                }
+                finishMesh(mesh, options, optimize_reports[i], profiler);
+                if (callbacks.on_mesh)
+                    callbacks.on_mesh(model, i);
+            }
+        };
+        if (pool)
+            pool->parallelFor(0, mesh_count, 1, process_meshes);
+        else
+            process_meshes(0, mesh_count);
+
+        if (engine_welding)
         {
-            const aiMesh* ai_mesh = scene->mMeshes[i];
-            total_vertices += ai_mesh->mNumVertices;
-            total_triangles += ai_mesh->mNumFaces;
+            size_t welded = 0;
+            for (const VertexWelder::Report& report : weld_reports)
+                welded += report.vertices_before - report.vertices_after;
+            total_vertices -= welded;
+            debug("Welded " + std::to_string(welded) + " duplicate vertices");
+        }
+
+        logMeshStats(model, options, optimize_reports, total_vertices, total_triangles, profiler.getStats());
+        return true;
+    }
+
+    bool ModelImporter::importGltf(Model&                 model,
+                                   GltfImporter&          gltf,
+                                   const LoadOptions&     options,
+                                   const ImportCallbacks& callbacks,
+                                   ImportProfiler&        profiler)
+    {
+        // same stages, and the same callbacks, as the Assimp path
+        ThreadPool* pool = g_context.m_thread_pool.get();
 
-            Mesh&& mesh = processMesh(ai_mesh);
-            model->addMesh(std::move(mesh));
+        debug("< Processing " + std::to_string(gltf.getMaterialCount()) + " material(s)... >");
+        {
+            ImportProfiler::Scope scope(&profiler, "materials");
+            model.resizeMaterials(gltf.getMaterialCount());
+            for (size_t i = 0; i < gltf.getMaterialCount(); ++i)
+                model.getMaterial(i) = gltf.takeMaterial(i);
+        }
+        ModelDeduplicator::Remap materials;
+        if (options.deduplicate)
+        {
+            ImportProfiler::Scope scope(&profiler, "deduplication");
+            materials = ModelDeduplicator::deduplicateMaterials(model);
         }
+
+        debug("< Processing scene graph hierarchy... >");
+        {
+            ImportProfiler::Scope scope(&profiler, "node_graph");
+            gltf.readNodes(model);
+        }
+
+        if (options.import_animations)
+        {
+            ImportProfiler::Scope scope(&profiler, "animations");
+            for (size_t i = 0; i < gltf.getAnimationCount(); ++i)
+            {
+                Animation animation = gltf.readAnimation(i);
+                if (!animation.getChannels().empty())
+                    model.addAnimation(std::move(animation));
+            }
+        }
+
+        // glTF nodes already share a mesh by index; this catches meshes exported once per copy
+        ModelDeduplicator::Remap meshes;
+        if (options.deduplicate)
+        {
+            ImportProfiler::Scope scope(&profiler, "deduplication");
+            auto hash = [&](size_t i) { return gltf.hashMesh(i, materials.remap, options.import_animations); };
+            auto same = [&](uint32_t a, uint32_t b) { return gltf.sameMesh(a, b, materials.remap); };
+            meshes    = deduplicateMeshes(model, gltf.getMeshCount(), hash, same);
+        }
+        const size_t mesh_count = options.deduplicate ? meshes.sources.size() : gltf.getMeshCount();
+        auto         source     = [&](size_t mesh) { return options.deduplicate ? meshes.sources[mesh] : mesh; };
+
+        model.resizeMeshes(mesh_count);
+        if (callbacks.on_skeleton)
+            callbacks.on_skeleton(model);
+
+        debug("< Processing " + std::to_string(mesh_count) + " mesh(es)... >");
+        size_t total_vertices  = 0;
+        size_t total_triangles = 0;
+        for (size_t i = 0; i < mesh_count; ++i)
+        {
+            total_vertices += gltf.getVertexCount(source(i));
+            total_triangles += gltf.getTriangleCount(source(i));
+        }
+
+        std::vector<MeshOptimizer::Report> optimize_reports(mesh_count);
+        auto                               process_meshes = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                Mesh& mesh = model.getMesh(i);
+                mesh       = gltf.readMesh(
+                    source(i), options.flip_uvs, options.calculate_tangents, options.import_animations, &profiler);
+                ModelDeduplicator::remapMaterials(mesh, materials.remap);
+                finishMesh(mesh, options, optimize_reports[i], profiler);
+                if (callbacks.on_mesh)
+                    callbacks.on_mesh(model, i);
+            }
+        };
+        if (pool)
+            pool->parallelFor(0, mesh_count, 1, process_meshes);
+        else
+            process_meshes(0, mesh_count);
+
+        logMeshStats(model, options, optimize_reports, total_vertices, total_triangles, profiler.getStats());
+        return true;
+    }
+
+    ModelDeduplicator::Remap
+    ModelImporter::deduplicateMeshes(Model&                                         model,
+                                     size_t                                         count,
+                                     const std::function<uint64_t(size_t)>&         hash,
+                                     const std::function<bool(uint32_t, uint32_t)>& same)
+    {
+        // hashing reads every source byte once, split over the pool like the conversion itself
+        std::vector<uint64_t> hashes(count);
+        auto                  hash_meshes = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                hashes[i] = hash(i);
+        };
+        if (ThreadPool* pool = g_context.m_thread_pool.get())
+            pool->parallelFor(0, count, 1, hash_meshes);
+        else
+            hash_meshes(0, count);
+
+        ModelDeduplicator::Remap meshes = ModelDeduplicator::group(hashes, same);
+        if (!meshes.isIdentity())
+        {
+            ModelDeduplicator::remapNodeMeshes(*model.getRoot(), meshes.remap);
+            debug("Merged " + std::to_string(meshes.getDuplicateCount()) + " duplicate mesh(es), " +
+                  std::to_string(meshes.sources.size()) + " left");
+        }
+        return meshes;
+    }
+
+    void ModelImporter::finishMesh(Mesh&                  mesh,
+                                   const LoadOptions&     options,
+                                   MeshOptimizer::Report& report,
+                                   ImportProfiler&        profiler)
+    {
+        MeshSimplifier::Settings lod_settings;
+        lod_settings.lod_count = options.lod_count;
+        lod_settings.reduction = options.lod_reduction;
+        lod_settings.max_error = options.lod_max_error;
+
+        if (options.optimize_vertex_order)
+        {
+            ImportProfiler::Scope scope(&profiler, "vertex_order");
+            report = MeshOptimizer::optimize(mesh);
+        }
+        if (options.lod_count > 0)
+        {
+            ImportProfiler::Scope scope(&profiler, "lods");
+            MeshSimplifier::generateLods(mesh, lod_settings);
+        }
+        if (options.build_bvh)
+        {
+            // last of the steps that move indices around, the BVH names triangles by their position
+            ImportProfiler::Scope scope(&profiler, "bvh");
+            mesh.setBvh(BvhBuilder::build(mesh, BvhBuilder::Settings {}, g_context.m_thread_pool.get()));
+        }
+        if (options.encode_vertices)
+        {
+            ImportProfiler::Scope scope(&profiler, "vertex_encoding");
+            mesh.encodeVertices(options.quantize_positions);
+        }
+    }
+
+    void ModelImporter::logMeshStats(const Model&                              model,
+                                     const LoadOptions&                        options,
+                                     const std::vector<MeshOptimizer::Report>& reports,
+                                     size_t                                    total_vertices,
+                                     size_t                                    total_triangles,
+                                     ImportStats*                              stats)
+    {
+        if (stats)
+        {
+            stats->meshes    = model.getMeshCount();
+            stats->materials = model.getMaterialCount();
+            stats->vertices  = total_vertices;
+            stats->triangles = total_triangles;
+        }
+
         debug("Total vertices: " + std::to_string(total_vertices) +
               ", Total triangles: " + std::to_string(total_triangles));
+        if (options.optimize_vertex_order)
+            logOptimizeReports(&model, reports);
+        if (options.lod_count > 0)
+        {
+            size_t lod_levels    = 0;
+            size_t lod_triangles = 0;
+            for (size_t i = 0; i < model.getMeshCount(); ++i)
+            {
+                for (const auto& lod : model.getMesh(i).getLods())
+                {
+                    ++lod_levels;
+                    lod_triangles += lod.index_count / 3;
+                }
+            }
+            debug("Generated " + std::to_string(lod_levels) + " LOD level(s), " + std::to_string(lod_triangles) +
+                  " triangles in total");
+        }
+        if (options.encode_vertices)
+        {
+            size_t encoded_bytes = 0;
+            for (size_t i = 0; i < model.getMeshCount(); ++i)
+                encoded_bytes += model.getMesh(i).getEncodedVertices().data.size();
+            debug("Encoded vertex data: " + std::to_string(encoded_bytes) + " bytes (" +
+                  std::to_string(total_vertices * sizeof(Vertex)) + " bytes as float vertices)");
+        }
+        {
+            size_t index_count = 0;
+            size_t index_bytes = 0;
+            for (size_t i = 0; i < model.getMeshCount(); ++i)
+            {
+                const Mesh& mesh = model.getMesh(i);
+                index_count += mesh.getIndices().size();
+                index_bytes += mesh.getIndices().size() * IndexBuffer::getIndexSize(mesh.getIndexType());
+            }
+            debug("Index data: " + std::to_string(index_bytes) + " bytes (" +
+                  std::to_string(index_count * sizeof(uint32_t)) + " bytes as 32-bit indices)");
+        }
+    }
 
-        // recursively process node tree
-        debug("< Processing scene graph hierarchy... >");
-        auto root = processNode(scene->mRootNode, scene);
-        model->setRoot(std::move(root));
+    void ModelImporter::logOptimizeReports(const Model* model, const std::vector<MeshOptimizer::Report>& reports)
+    {
+        // triangle-weighted averages, so large meshes dominate like they do on the GPU
+        double triangles = 0.0;
+        double before[2] = {0.0, 0.0};
+        double after[2]  = {0.0, 0.0};
+        for (size_t i = 0; i < reports.size(); ++i)
+        {
+            const double weight = static_cast<double>(model->getMesh(i).getIndices().size() / 3);
+            triangles += weight;
+            before[0] += reports[i].before.acmr * weight;
+            before[1] += reports[i].before.atvr * weight;
+            after[0] += reports[i].after.acmr * weight;
+            after[1] += reports[i].after.atvr * weight;
 
-        return model;
+            debug("  Mesh " + std::to_string(i) + " - ACMR: " + std::to_string(reports[i].before.acmr) + " -> " +
+                  std::to_string(reports[i].after.acmr) + ", ATVR: " + std::to_string(reports[i].before.atvr) +
+                  " -> " + std::to_string(reports[i].after.atvr));
+        }
+        if (triangles <= 0.0)
+            return;
+
+        debug("Vertex order optimized - ACMR: " + std::to_string(before[0] / triangles) + " -> " +
+              std::to_string(after[0] / triangles) + ", ATVR: " + std::to_string(before[1] / triangles) + " -> " +
+              std::to_string(after[1] / triangles));
     }
 
     std::unique_ptr<Node> ModelImporter::processNode(const aiNode* ai_node, const aiScene* ai_scene)
@@ -124,6 +683,41 @@ namespace RealmEngine
         return node;
     }
 
+    ModelImporter::NodeIndex ModelImporter::indexNodes(const aiScene* ai_scene)
+    {
+        NodeIndex nodes;
+        nodes.mesh_nodes.assign(ai_scene->mNumMeshes, 0);
+        std::vector<uint8_t> mesh_found(ai_scene->mNumMeshes, 0);
+
+        // same pre-order walk as NodeHierarchy::build(), which processNode() mirrors child for child
+        std::vector<const aiNode*> stack {ai_scene->mRootNode};
+        uint32_t                   index = 0;
+        while (!stack.empty())
+        {
+            const aiNode* ai_node = stack.back();
+            stack.pop_back();
+
+            nodes.by_name.emplace(ai_node->mName.C_Str(), index);
+            for (size_t i = 0; i < ai_node->mNumMeshes; ++i)
+            {
+                const uint32_t mesh = ai_node->mMeshes[i];
+                if (mesh < ai_scene->mNumMeshes && !mesh_found[mesh])
+                {
+                    nodes.mesh_nodes[mesh] = index;
+                    mesh_found[mesh]       = 1;
+                }
+            }
+            ++index;
+
+            for (size_t i = ai_node->mNumChildren; i-- > 0;)
+            {
+                if (ai_node->mChildren[i])
+                    stack.push_back(ai_node->mChildren[i]);
+            }
+        }
+        return nodes;
+    }
+
     Mesh ModelImporter::processMesh(const aiMesh* ai_mesh)
     {
         Mesh mesh;
@@ -202,13 +796,14 @@ namespace RealmEngine
             const aiFace& face = ai_mesh->mFaces[i];
 
             for (size_t j = 0; j < face.mNumIndices; ++j)
-                indices.push_back(face.mIndices[i]);
+                indices.push_back(face.mIndices[j]);
         }
 
+        const uint32_t index_count = static_cast<uint32_t>(indices.size());
         mesh.setIndices(std::move(indices));
 
         // auto gen the default submesh
-        SubMesh submesh(0, static_cast<uint32_t>(indices.size()), ai_mesh->mMaterialIndex);
+        SubMesh submesh(0, index_count, ai_mesh->mMaterialIndex);
         mesh.addSubMesh(submesh);
 
         // calculate bounding box.
@@ -216,6 +811,105 @@ namespace RealmEngine
         return mesh;
     }
 
+    void ModelImporter::processSkin(const aiMesh* ai_mesh, const NodeIndex& nodes, uint32_t skin_node, Mesh& mesh)
+    {
+        std::vector<Vertex>& vertices = mesh.getVertices();
+        std::vector<Bone>    bones;
+        std::vector<uint8_t> influences(vertices.size(), 0);
+        bones.reserve(ai_mesh->mNumBones + 1);
+
+        for (size_t i = 0; i < ai_mesh->mNumBones; ++i)
+        {
+            const aiBone* ai_bone = ai_mesh->mBones[i];
+            auto          node    = nodes.by_name.find(ai_bone->mName.C_Str());
+            if (node == nodes.by_name.end())
+            {
+                warn("  Bone '" + std::string(ai_bone->mName.C_Str()) + "' has no node, its weights are dropped.");
+                continue;
+            }
+
+            const uint16_t joint = static_cast<uint16_t>(bones.size());
+            bones.push_back(Bone {node->second, convertMatrix(ai_bone->mOffsetMatrix)});
+
+            for (size_t w = 0; w < ai_bone->mNumWeights; ++w)
+            {
+                const aiVertexWeight& weight = ai_bone->mWeights[w];
+                if (weight.mVertexId >= vertices.size() || weight.mWeight <= 0.0f)
+                    continue;
+
+                // keep the 4 strongest influences, in case the weights weren't limited
+                Vertex&   vert = vertices[weight.mVertexId];
+                uint8_t&  used = influences[weight.mVertexId];
+                const int slot = used < 4 ? used++ : weakestInfluence(vert.weights);
+                if (vert.weights[slot] >= weight.mWeight)
+                    continue;
+                vert.joints[slot]  = joint;
+                vert.weights[slot] = weight.mWeight;
+            }
+        }
+        if (bones.empty())
+            return;
+
+        ImportHelpers::finishSkin(vertices, bones, skin_node);
+        mesh.setSkinNode(skin_node);
+        mesh.setBones(std::move(bones));
+    }
+
+    Animation ModelImporter::processAnimation(const aiAnimation* ai_animation, const NodeIndex& nodes)
+    {
+        Animation animation;
+        animation.setName(ai_animation->mName.C_Str());
+
+        // keys are in ticks, 0 ticks per second means the format doesn't say
+        const double ticks_per_second = ai_animation->mTicksPerSecond > 0.0 ? ai_animation->mTicksPerSecond : 25.0;
+        const double seconds_per_tick = 1.0 / ticks_per_second;
+        animation.setDuration(static_cast<float>(ai_animation->mDuration * seconds_per_tick));
+
+        auto copyVectorKeys = [&](const aiVectorKey* keys, unsigned int count, AnimationTrack<glm::vec3>& track) {
+            track.times.resize(count);
+            track.values.resize(count);
+            for (unsigned int k = 0; k < count; ++k)
+            {
+                track.times[k]  = static_cast<float>(keys[k].mTime * seconds_per_tick);
+                track.values[k] = glm::vec3(keys[k].mValue.x, keys[k].mValue.y, keys[k].mValue.z);
+            }
+        };
+
+        size_t missing = 0;
+        for (size_t i = 0; i < ai_animation->mNumChannels; ++i)
+        {
+            const aiNodeAnim* ai_channel = ai_animation->mChannels[i];
+            auto              node       = nodes.by_name.find(ai_channel->mNodeName.C_Str());
+            if (node == nodes.by_name.end())
+            {
+                ++missing;
+                continue;
+            }
+
+            AnimationChannel channel;
+            channel.node = node->second;
+            copyVectorKeys(ai_channel->mPositionKeys, ai_channel->mNumPositionKeys, channel.translations);
+            copyVectorKeys(ai_channel->mScalingKeys, ai_channel->mNumScalingKeys, channel.scales);
+
+            channel.rotations.times.resize(ai_channel->mNumRotationKeys);
+            channel.rotations.values.resize(ai_channel->mNumRotationKeys);
+            for (unsigned int k = 0; k < ai_channel->mNumRotationKeys; ++k)
+            {
+                const aiQuatKey& key        = ai_channel->mRotationKeys[k];
+                channel.rotations.times[k]  = static_cast<float>(key.mTime * seconds_per_tick);
+                channel.rotations.values[k] = glm::quat(key.mValue.w, key.mValue.x, key.mValue.y, key.mValue.z);
+            }
+
+            animation.getChannels().push_back(std::move(channel));
+        }
+
+        debug("  Animation '" + animation.getName() + "' - Duration: " + std::to_string(animation.getDuration()) +
+              " s, Channels: " + std::to_string(animation.getChannels().size()) +
+              ", Keyframes: " + std::to_string(animation.getKeyframeCount()) +
+              (missing > 0 ? ", Channels without a node: " + std::to_string(missing) : std::string()));
+        return animation;
+    }
+
     Material ModelImporter::processMaterial(const aiMaterial* ai_material, const std::string& base_dir)
     {
         Material material;
@@ -1,35 +1,135 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
+#include "assimp/anim.h"
 #include "assimp/material.h"
 #include "assimp/matrix4x4.h"
 #include "assimp/mesh.h"
 #include "assimp/scene.h"
 #include "glm/ext/matrix_float4x4.hpp"
+#include "resource/datatype/model/animation.h"
 #include "resource/datatype/model/material.h"
 #include "resource/datatype/model/mesh.h"
 #include "resource/datatype/model/model.h"
+#include "resource/importer/import_stats.h"
+#include "resource/processor/mesh_optimizer.h"
+#include "resource/processor/mesh_simplifier.h"
+#include "resource/processor/model_deduplicator.h"
+#include "resource/processor/vertex_welder.h"
 
 namespace RealmEngine
 {
+    class GltfImporter;
+
     class ModelImporter
     {
     public:
+        // who joins the identical vertices of an Assimp import; glTF data is already indexed by the exporter
+        enum class VertexWelding : uint8_t
+        {
+            Engine = 0, // VertexWelder on the thread pool after conversion, with an optional epsilon
+            Assimp = 1  // aiProcess_JoinIdenticalVertices, single threaded inside the post-processing
+        };
+
         struct LoadOptions
         {
             bool calculate_tangents {true};
             bool flip_uvs {true};
             bool optimize_meshes {true};
             bool optimize_graph {false};
+            bool optimize_vertex_order {true}; // vertex cache, overdraw and fetch reordering per submesh
+            bool encode_vertices {true};       // build the compact GPU vertex stream at import
+            bool quantize_positions {true};    // unorm16 positions inside the mesh bounds
+            bool import_animations {true};     // bones, skin weights and animation clips
+            bool native_gltf {true};           // .gltf/.glb through GltfImporter, Assimp only as the fallback
+            bool deduplicate {true};           // merge identical materials and meshes, nodes share the mesh
+            bool build_bvh {true};             // per mesh ray query tree over LOD 0, cooked with the model
+
+            VertexWelding vertex_welding {VertexWelding::Engine};
+            float         weld_epsilon {0.0f}; // engine welder only, 0 joins exact duplicates like Assimp does
+
+            // simplified levels per submesh, see MeshSimplifier (lod_count 0 disables them)
+            uint32_t lod_count {3};
+            float    lod_reduction {0.5f};
+            float    lod_max_error {0.05f};
+
+            // Identifies the options when keying cooked data, so a change here invalidates caches.
+            uint64_t hash() const;
         };
 
-        static std::unique_ptr<Model> loadModel(const std::string& filepath, const LoadOptions& options);
+        // Hooks of a progressive import, called on the importing thread or on pool workers.
+        struct ImportCallbacks
+        {
+            // materials, node tree, animations and empty mesh slots are in place
+            std::function<void(Model& model)> on_skeleton;
+            // mesh is final and won't be touched by the importer again
+            std::function<void(Model& model, size_t mesh)> on_mesh;
+        };
+
+        // Files besides filepath whose bytes the import reads: glTF buffers, OBJ material libraries.
+        static std::vector<std::string> findDependencies(const std::string& filepath);
+
+        // stats, when given, receives the time and memory of every import stage
+        static std::unique_ptr<Model>
+        loadModel(const std::string& filepath, const LoadOptions& options, ImportStats* stats = nullptr);
+
+        // Imports into model, reporting the skeleton and then each mesh as it finishes. Meshes are processed
+        // on the thread pool in parallel, so on_mesh arrives in no particular order.
+        static bool importModel(Model&                 model,
+                                const std::string&     filepath,
+                                const LoadOptions&     options,
+                                const ImportCallbacks& callbacks = {},
+                                ImportStats*           stats     = nullptr);
 
     private:
+        // Node lookups for bones and animation channels, by index in the model's NodeHierarchy.
+        struct NodeIndex
+        {
+            std::unordered_map<std::string, uint32_t> by_name;    // first node with the name
+            std::vector<uint32_t>                     mesh_nodes; // first node drawing each mesh
+        };
+
+        static bool importAssimp(Model&                 model,
+                                 const std::string&     filepath,
+                                 const LoadOptions&     options,
+                                 const ImportCallbacks& callbacks,
+                                 ImportProfiler&        profiler);
+        static bool importGltf(Model&                 model,
+                               GltfImporter&          gltf,
+                               const LoadOptions&     options,
+                               const ImportCallbacks& callbacks,
+                               ImportProfiler&        profiler);
+
+        // Hashes count source meshes, merges the duplicates and points the model's nodes at the kept ones.
+        static ModelDeduplicator::Remap deduplicateMeshes(Model&                                         model,
+                                                          size_t                                         count,
+                                                          const std::function<uint64_t(size_t)>&         hash,
+                                                          const std::function<bool(uint32_t, uint32_t)>& same);
+        // the format independent tail of a mesh import: vertex order, LODs and vertex encoding
+        static void finishMesh(Mesh&                  mesh,
+                               const LoadOptions&     options,
+                               MeshOptimizer::Report& report,
+                               ImportProfiler&        profiler);
+        static void logMeshStats(const Model&                              model,
+                                 const LoadOptions&                        options,
+                                 const std::vector<MeshOptimizer::Report>& reports,
+                                 size_t                                    total_vertices,
+                                 size_t                                    total_triangles,
+                                 ImportStats*                              stats);
+
         static std::unique_ptr<Node> processNode(const aiNode* ai_node, const aiScene* ai_scene);
+        static NodeIndex             indexNodes(const aiScene* ai_scene);
         static Mesh                  processMesh(const aiMesh* ai_mesh);
-        static Material              processMaterial(const aiMaterial* ai_material, const std::string& base_dir);
+        static void      processSkin(const aiMesh* ai_mesh, const NodeIndex& nodes, uint32_t skin_node, Mesh& mesh);
+        static Animation processAnimation(const aiAnimation* ai_animation, const NodeIndex& nodes);
+        static Material  processMaterial(const aiMaterial* ai_material, const std::string& base_dir);
+        static void logOptimizeReports(const Model* model, const std::vector<MeshOptimizer::Report>& reports);
 
         constexpr static glm::mat4 convertMatrix(const aiMatrix4x4& ai_mat);
     };
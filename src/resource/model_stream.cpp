@@ -0,0 +1,83 @@
+#include "resource/model_stream.h"
+
+#include <utility>
+
+namespace RealmEngine
+{
+    ModelStream::ModelStream(std::string path, ModelStreamCallbacks callbacks) :
+        m_path(std::move(path)), m_callbacks(std::move(callbacks))
+    {}
+
+    ModelHandle ModelStream::getModel() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_model;
+    }
+
+    bool ModelStream::isMeshReady(size_t mesh) const
+    {
+        return mesh < getMeshCount() && m_ready[mesh].load(std::memory_order_acquire) != 0;
+    }
+
+    float ModelStream::getProgress() const
+    {
+        if (isComplete())
+            return 1.0f;
+        const size_t mesh_count = getMeshCount();
+        return mesh_count ? static_cast<float>(getReadyMeshCount()) / static_cast<float>(mesh_count) : 0.0f;
+    }
+
+    void ModelStream::publishModel(ModelHandle model)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_model)
+                return;
+
+            const size_t mesh_count = model->getMeshCount();
+            m_ready                 = std::make_unique<std::atomic<uint8_t>[]>(mesh_count);
+            for (size_t i = 0; i < mesh_count; ++i)
+                m_ready[i].store(0, std::memory_order_relaxed);
+            m_model = std::move(model);
+
+            // readers check the count first, so the flags are initialized before any of them is read
+            m_mesh_count.store(mesh_count, std::memory_order_release);
+        }
+        notifyProgress();
+    }
+
+    void ModelStream::publishMesh(size_t mesh)
+    {
+        if (mesh >= getMeshCount() || m_ready[mesh].exchange(1, std::memory_order_acq_rel) != 0)
+            return;
+        m_ready_count.fetch_add(1, std::memory_order_acq_rel);
+        notifyProgress();
+    }
+
+    void ModelStream::complete(ModelHandle model)
+    {
+        if (isComplete())
+            return;
+
+        if (model)
+        {
+            publishModel(model);
+            for (size_t i = 0; i < getMeshCount(); ++i)
+                publishMesh(i);
+        }
+        else
+        {
+            m_failed.store(true, std::memory_order_release);
+        }
+        m_complete.store(true, std::memory_order_release);
+
+        if (m_callbacks.on_complete)
+            m_callbacks.on_complete(model);
+    }
+
+    void ModelStream::notifyProgress()
+    {
+        if (m_callbacks.on_progress)
+            m_callbacks.on_progress(getModel(), getReadyMeshCount(), getMeshCount());
+    }
+} // namespace RealmEngine
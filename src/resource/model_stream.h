@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "resource/datatype/model/model.h"
+
+namespace RealmEngine
+{
+    // Ref-counted model reference. A model stays resident while any handle to it is alive.
+    using ModelHandle = std::shared_ptr<Model>;
+
+    // Both run on the worker that made the progress; hand work for the GL thread over to it yourself.
+    struct ModelStreamCallbacks
+    {
+        std::function<void(const ModelHandle& model, size_t ready_meshes, size_t mesh_count)> on_progress;
+        // model is null if the import failed
+        std::function<void(const ModelHandle& model)> on_complete;
+    };
+
+    /**
+     * Progress of a progressive model load, shared by the loader and whoever draws the model.
+     *
+     * The model is published as soon as its materials, node tree and mesh slots exist, then its meshes one by
+     * one as workers finish them. Until isMeshReady(i) returns true, mesh i may still be written by a worker
+     * and must not be touched; everything else in the published model is final.
+     */
+    class ModelStream
+    {
+    public:
+        ModelStream(std::string path, ModelStreamCallbacks callbacks);
+        ~ModelStream() noexcept = default;
+
+        ModelStream(const ModelStream& that)            = delete;
+        ModelStream(ModelStream&& that)                 = delete;
+        ModelStream& operator=(const ModelStream& that) = delete;
+        ModelStream& operator=(ModelStream&& that)      = delete;
+
+        const std::string& getPath() const { return m_path; }
+
+        // null until the model is published
+        ModelHandle getModel() const;
+        size_t      getMeshCount() const { return m_mesh_count.load(std::memory_order_acquire); }
+        size_t      getReadyMeshCount() const { return m_ready_count.load(std::memory_order_acquire); }
+        bool        isMeshReady(size_t mesh) const;
+        // 0 to 1 over the meshes; the scene parse before the model is published can't be measured
+        float getProgress() const;
+        bool  isComplete() const { return m_complete.load(std::memory_order_acquire); }
+        bool  isFailed() const { return m_failed.load(std::memory_order_acquire); }
+
+        // loader side
+        void publishModel(ModelHandle model);
+        void publishMesh(size_t mesh);
+        // Publishes whatever was not published yet; a null model marks the load as failed.
+        void complete(ModelHandle model);
+
+    private:
+        void notifyProgress();
+
+        const std::string          m_path;
+        const ModelStreamCallbacks m_callbacks;
+
+        mutable std::mutex                      m_mutex;
+        ModelHandle                             m_model;
+        std::unique_ptr<std::atomic<uint8_t>[]> m_ready;
+        std::atomic<size_t>                     m_mesh_count {0};
+        std::atomic<size_t>                     m_ready_count {0};
+        std::atomic<bool>                       m_complete {false};
+        std::atomic<bool>                       m_failed {false};
+    };
+} // namespace RealmEngine
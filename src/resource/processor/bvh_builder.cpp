@@ -0,0 +1,423 @@
+#include "bvh_builder.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace RealmEngine
+{
+    namespace
+    {
+        using Node  = MeshBvh::Node;
+        using Block = MeshBvh::TriangleBlock;
+
+        constexpr uint32_t WIDTH          = MeshBvh::WIDTH;
+        constexpr size_t   TRIANGLE_GRAIN = 16384;
+        constexpr uint32_t PARALLEL_SPLIT = 8192; // nodes with more triangles build their halves as pool tasks
+        constexpr uint32_t MAX_BINS       = 64;
+
+        void forRange(ThreadPool*                                pool,
+                      size_t                                     begin,
+                      size_t                                     end,
+                      size_t                                     grain,
+                      const std::function<void(size_t, size_t)>& body)
+        {
+            if (pool)
+                pool->parallelFor(begin, end, grain, body);
+            else if (begin < end)
+                body(begin, end);
+        }
+
+        AABB emptyBounds()
+        {
+            return AABB {glm::vec3(std::numeric_limits<float>::max()), glm::vec3(-std::numeric_limits<float>::max())};
+        }
+
+        void grow(AABB& bounds, const glm::vec3& point)
+        {
+            bounds.min = glm::min(bounds.min, point);
+            bounds.max = glm::max(bounds.max, point);
+        }
+
+        // half the surface area, all SAH needs; 0 for the empty box
+        float halfArea(const AABB& bounds)
+        {
+            const glm::vec3 extent = glm::max(bounds.max - bounds.min, glm::vec3(0.0f));
+            return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+        }
+
+        float blockCost(uint32_t triangles) { return static_cast<float>((triangles + WIDTH - 1) / WIDTH); }
+
+        // binary tree node; leaves own order[first, first + count), inner nodes have children first and first + 1
+        struct BuildNode
+        {
+            AABB     bounds;
+            uint32_t first;
+            uint32_t count;
+        };
+
+        struct Bin
+        {
+            AABB     bounds;
+            uint32_t count;
+        };
+
+        class BinaryBuilder
+        {
+        public:
+            BinaryBuilder(const std::vector<AABB>&      boxes,
+                          const std::vector<glm::vec3>& centroids,
+                          const BvhBuilder::Settings&   settings,
+                          ThreadPool*                   pool) :
+                m_boxes(boxes), m_centroids(centroids), m_settings(settings), m_pool(pool),
+                m_order(boxes.size()), m_nodes(std::max<size_t>(1, boxes.size() * 2))
+            {
+                for (uint32_t i = 0; i < m_order.size(); ++i)
+                    m_order[i] = i;
+                m_bin_count = std::clamp(settings.bin_count, 2u, MAX_BINS);
+            }
+
+            void build() { buildNode(0, 0, static_cast<uint32_t>(m_order.size()), 0); }
+
+            const std::vector<BuildNode>& getNodes() const { return m_nodes; }
+            const std::vector<uint32_t>&  getOrder() const { return m_order; }
+
+        private:
+            void buildNode(uint32_t index, uint32_t first, uint32_t count, uint32_t depth)
+            {
+                AABB bounds          = emptyBounds();
+                AABB centroid_bounds = emptyBounds();
+                for (uint32_t i = first; i < first + count; ++i)
+                {
+                    bounds.merge(m_boxes[m_order[i]]);
+                    grow(centroid_bounds, m_centroids[m_order[i]]);
+                }
+                m_nodes[index] = BuildNode {bounds, first, count};
+
+                // the 4-wide tree can't be deeper than the binary one, so capping here caps the traversal stack
+                if (count <= 1 || depth + 1 >= MeshBvh::MAX_DEPTH)
+                    return;
+
+                uint32_t split = 0;
+                if (!findSplit(first, count, bounds, centroid_bounds, split))
+                {
+                    if (count <= m_settings.max_leaf_size)
+                        return;
+                    split = first + count / 2; // no usable plane (all centroids coincide), halve the range
+                }
+
+                const uint32_t children = m_next_node.fetch_add(2);
+                m_nodes[index].first    = children;
+                m_nodes[index].count    = 0;
+
+                const uint32_t child_first[2] = {first, split};
+                const uint32_t child_count[2] = {split - first, first + count - split};
+                auto           build_child    = [&](size_t begin, size_t end) {
+                    for (size_t c = begin; c < end; ++c)
+                        buildNode(children + static_cast<uint32_t>(c), child_first[c], child_count[c], depth + 1);
+                };
+                if (m_pool && count > PARALLEL_SPLIT)
+                    m_pool->parallelFor(0, 2, 1, build_child);
+                else
+                    build_child(0, 2);
+            }
+
+            // Best binned SAH plane, partitioning order around it; false if a leaf is cheaper or nothing splits.
+            bool findSplit(uint32_t    first,
+                           uint32_t    count,
+                           const AABB& bounds,
+                           const AABB& centroid_bounds,
+                           uint32_t&   split)
+            {
+                const glm::vec3 extent = centroid_bounds.max - centroid_bounds.min;
+
+                Bin bins[3][MAX_BINS];
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    for (uint32_t b = 0; b < m_bin_count; ++b)
+                        bins[axis][b] = Bin {emptyBounds(), 0};
+                }
+
+                glm::vec3 scale(0.0f);
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    if (extent[axis] > 0.0f)
+                        scale[axis] = static_cast<float>(m_bin_count) / extent[axis];
+                }
+                auto binOf = [&](uint32_t primitive, int axis) {
+                    const float offset = (m_centroids[primitive][axis] - centroid_bounds.min[axis]) * scale[axis];
+                    return std::min(m_bin_count - 1, static_cast<uint32_t>(offset));
+                };
+
+                for (uint32_t i = first; i < first + count; ++i)
+                {
+                    const uint32_t primitive = m_order[i];
+                    for (int axis = 0; axis < 3; ++axis)
+                    {
+                        Bin& bin = bins[axis][binOf(primitive, axis)];
+                        bin.bounds.merge(m_boxes[primitive]);
+                        ++bin.count;
+                    }
+                }
+
+                // cost of a split relative to the parent's area: traversal plus each side's area times the blocks
+                // its triangles take, a block of four being tested as one
+                float       best_cost   = std::numeric_limits<float>::infinity();
+                int         best_axis   = -1;
+                uint32_t    best_bin    = 0;
+                const float parent_area = std::max(halfArea(bounds), std::numeric_limits<float>::min());
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    if (extent[axis] <= 0.0f)
+                        continue;
+
+                    float    right_area[MAX_BINS];
+                    uint32_t right_count[MAX_BINS];
+                    AABB     right = emptyBounds();
+                    uint32_t total = 0;
+                    for (uint32_t b = m_bin_count - 1; b > 0; --b)
+                    {
+                        right.merge(bins[axis][b].bounds);
+                        total += bins[axis][b].count;
+                        right_area[b]  = halfArea(right);
+                        right_count[b] = total;
+                    }
+
+                    AABB     left       = emptyBounds();
+                    uint32_t left_count = 0;
+                    for (uint32_t b = 1; b < m_bin_count; ++b)
+                    {
+                        left.merge(bins[axis][b - 1].bounds);
+                        left_count += bins[axis][b - 1].count;
+                        if (left_count == 0 || right_count[b] == 0)
+                            continue;
+
+                        const float cost = m_settings.traversal_cost +
+                                           (halfArea(left) * blockCost(left_count) + right_area[b] * blockCost(right_count[b])) /
+                                               parent_area;
+                        if (cost < best_cost)
+                        {
+                            best_cost = cost;
+                            best_axis = axis;
+                            best_bin  = b;
+                        }
+                    }
+                }
+
+                // a small enough range stays a leaf unless splitting is cheaper
+                if (best_axis < 0)
+                    return false;
+                if (count <= m_settings.max_leaf_size && best_cost >= blockCost(count))
+                    return false;
+
+                uint32_t* begin = m_order.data() + first;
+                uint32_t* mid   = std::partition(begin, begin + count, [&](uint32_t primitive) {
+                    return binOf(primitive, best_axis) < best_bin;
+                });
+                split = static_cast<uint32_t>(mid - m_order.data());
+                return true;
+            }
+
+            const std::vector<AABB>&      m_boxes;
+            const std::vector<glm::vec3>& m_centroids;
+            const BvhBuilder::Settings&   m_settings;
+            ThreadPool*                   m_pool;
+            uint32_t                      m_bin_count {16};
+
+            std::vector<uint32_t>  m_order;
+            std::vector<BuildNode> m_nodes; // 2n - 1 at most, for single triangle leaves
+            std::atomic<uint32_t>  m_next_node {1};
+        };
+
+        class Collapser
+        {
+        public:
+            Collapser(const std::vector<BuildNode>& binary,
+                      const std::vector<uint32_t>&  order,
+                      const std::vector<uint32_t>&  triangles,
+                      const Vertex*                 vertices,
+                      const uint32_t*               indices) :
+                m_binary(binary), m_order(order), m_triangles(triangles), m_vertices(vertices), m_indices(indices)
+            {}
+
+            void collapse(uint32_t root)
+            {
+                const BuildNode& node = m_binary[root];
+                if (node.count > 0)
+                {
+                    // a leaf root still gets a node, queries always start at one
+                    m_nodes.emplace_back();
+                    clearNode(m_nodes.back());
+                    setChild(0, 0, root);
+                    return;
+                }
+                emitNode(root);
+            }
+
+            std::vector<Node>  takeNodes() { return std::move(m_nodes); }
+            std::vector<Block> takeBlocks() { return std::move(m_blocks); }
+
+        private:
+            static void clearNode(Node& node)
+            {
+                for (uint32_t k = 0; k < WIDTH; ++k)
+                {
+                    node.min_x[k] = node.min_y[k] = node.min_z[k] = 0.0f;
+                    node.max_x[k] = node.max_y[k] = node.max_z[k] = 0.0f;
+                    node.child[k] = MeshBvh::EMPTY_CHILD;
+                    node.count[k] = 0;
+                }
+            }
+
+            // inner binary node -> 4-wide node, returning its index
+            uint32_t emitNode(uint32_t binary)
+            {
+                // open the largest inner child until there are WIDTH children or only leaves
+                uint32_t children[WIDTH] = {m_binary[binary].first, m_binary[binary].first + 1};
+                uint32_t child_count     = 2;
+                while (child_count < WIDTH)
+                {
+                    int   widest = -1;
+                    float area   = -1.0f;
+                    for (uint32_t k = 0; k < child_count; ++k)
+                    {
+                        const BuildNode& child = m_binary[children[k]];
+                        if (child.count == 0 && halfArea(child.bounds) > area)
+                        {
+                            widest = static_cast<int>(k);
+                            area   = halfArea(child.bounds);
+                        }
+                    }
+                    if (widest < 0)
+                        break;
+
+                    const uint32_t opened   = children[widest];
+                    children[widest]        = m_binary[opened].first;
+                    children[child_count++] = m_binary[opened].first + 1;
+                }
+
+                const uint32_t index = static_cast<uint32_t>(m_nodes.size());
+                m_nodes.emplace_back();
+                clearNode(m_nodes.back());
+                for (uint32_t k = 0; k < child_count; ++k)
+                    setChild(index, k, children[k]);
+                return index;
+            }
+
+            void setChild(uint32_t index, uint32_t lane, uint32_t binary)
+            {
+                const BuildNode& child = m_binary[binary];
+
+                uint32_t target = 0;
+                if (child.count > 0)
+                    target = emitLeaf(child);
+                else
+                    target = emitNode(binary); // may grow m_nodes, so the node is looked up afterwards
+
+                Node& node       = m_nodes[index];
+                node.min_x[lane] = child.bounds.min.x;
+                node.min_y[lane] = child.bounds.min.y;
+                node.min_z[lane] = child.bounds.min.z;
+                node.max_x[lane] = child.bounds.max.x;
+                node.max_y[lane] = child.bounds.max.y;
+                node.max_z[lane] = child.bounds.max.z;
+                node.child[lane] = target;
+                node.count[lane] = child.count;
+            }
+
+            // the leaf's triangles as blocks of four, returning the first block
+            uint32_t emitLeaf(const BuildNode& leaf)
+            {
+                const uint32_t first = static_cast<uint32_t>(m_blocks.size());
+                for (uint32_t i = 0; i < leaf.count; i += WIDTH)
+                {
+                    Block block {};
+                    for (uint32_t k = 0; k < WIDTH; ++k)
+                    {
+                        block.triangle[k] = RayHit::INVALID_TRIANGLE;
+                        if (i + k >= leaf.count)
+                            continue; // zero edges never hit
+
+                        const uint32_t  triangle = m_triangles[m_order[leaf.first + i + k]];
+                        const glm::vec3 v0       = m_vertices[m_indices[triangle * 3 + 0]].position;
+                        const glm::vec3 e1       = m_vertices[m_indices[triangle * 3 + 1]].position - v0;
+                        const glm::vec3 e2       = m_vertices[m_indices[triangle * 3 + 2]].position - v0;
+
+                        block.v0_x[k]     = v0.x;
+                        block.v0_y[k]     = v0.y;
+                        block.v0_z[k]     = v0.z;
+                        block.e1_x[k]     = e1.x;
+                        block.e1_y[k]     = e1.y;
+                        block.e1_z[k]     = e1.z;
+                        block.e2_x[k]     = e2.x;
+                        block.e2_y[k]     = e2.y;
+                        block.e2_z[k]     = e2.z;
+                        block.triangle[k] = triangle;
+                    }
+                    m_blocks.push_back(block);
+                }
+                return first;
+            }
+
+            const std::vector<BuildNode>& m_binary;
+            const std::vector<uint32_t>&  m_order;
+            const std::vector<uint32_t>&  m_triangles;
+            const Vertex*                 m_vertices;
+            const uint32_t*               m_indices;
+
+            std::vector<Node>  m_nodes;
+            std::vector<Block> m_blocks;
+        };
+    } // namespace
+
+    MeshBvh BvhBuilder::build(const Mesh& mesh, const Settings& settings, ThreadPool* pool)
+    {
+        const std::vector<Vertex>&   vertices = mesh.getVertices();
+        const std::vector<uint32_t>& indices  = mesh.getIndices();
+
+        // LOD 0 of every submesh, the whole index buffer for a mesh without any; LOD levels sit past those ranges
+        std::vector<uint32_t> triangles;
+        auto                  add_range = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i + 2 < end && i + 2 < indices.size(); i += 3)
+            {
+                const size_t vertex_count = vertices.size();
+                if (indices[i] < vertex_count && indices[i + 1] < vertex_count && indices[i + 2] < vertex_count)
+                    triangles.push_back(static_cast<uint32_t>(i / 3));
+            }
+        };
+        if (mesh.getSubMeshes().empty())
+            add_range(0, indices.size());
+        for (const SubMesh& submesh : mesh.getSubMeshes())
+        {
+            // a triangle is named by its first index over three, which needs the range to start on a triangle
+            if (submesh.base_index % 3 == 0)
+                add_range(submesh.base_index, submesh.getEndIndex());
+        }
+        if (triangles.empty())
+            return MeshBvh();
+
+        std::vector<AABB>      boxes(triangles.size());
+        std::vector<glm::vec3> centroids(triangles.size());
+        forRange(pool, 0, triangles.size(), TRIANGLE_GRAIN, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const uint32_t* corners = &indices[triangles[i] * 3];
+                const glm::vec3 a       = vertices[corners[0]].position;
+                const glm::vec3 b       = vertices[corners[1]].position;
+                const glm::vec3 c       = vertices[corners[2]].position;
+                boxes[i]                = AABB {glm::min(a, glm::min(b, c)), glm::max(a, glm::max(b, c))};
+                centroids[i]            = boxes[i].center();
+            }
+        });
+
+        BinaryBuilder binary(boxes, centroids, settings, pool);
+        binary.build();
+
+        Collapser collapser(binary.getNodes(), binary.getOrder(), triangles, vertices.data(), indices.data());
+        collapser.collapse(0);
+        return MeshBvh(collapser.takeNodes(), collapser.takeBlocks());
+    }
+} // namespace RealmEngine
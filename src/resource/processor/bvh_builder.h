@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "resource/datatype/model/mesh.h"
+#include "resource/datatype/model/mesh_bvh.h"
+
+namespace RealmEngine
+{
+    class ThreadPool;
+
+    /**
+     * Builds the MeshBvh of a mesh's LOD 0 triangles.
+     *
+     * A binary tree is split top-down with the surface area heuristic evaluated over a few bins per axis, the two
+     * halves of large nodes building in parallel on the pool. The tree is then collapsed into the 4-wide layout,
+     * each node pulling up the grandchildren of its largest children, and written out depth-first with the
+     * triangle blocks of each leaf following the order leaves are reached in.
+     */
+    class BvhBuilder
+    {
+    public:
+        struct Settings
+        {
+            uint32_t max_leaf_size {8};     // triangles a leaf may hold when SAH prefers it to a split
+            uint32_t bin_count {16};        // candidate split planes per axis are bin_count - 1
+            float    traversal_cost {1.0f}; // of a node visit, relative to testing one triangle
+        };
+
+        // Triangles referencing vertices out of range are left out. An empty mesh gives an empty BVH.
+        static MeshBvh build(const Mesh& mesh, const Settings& settings, ThreadPool* pool = nullptr);
+    };
+} // namespace RealmEngine
@@ -0,0 +1,850 @@
+#include "mesh_kernels.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include "resource/processor/simd_target.h"
+#include "thread_pool.h"
+
+namespace RealmEngine
+{
+    namespace
+    {
+        using SimdLevel = MeshKernels::SimdLevel;
+
+        constexpr size_t TRIANGLE_GRAIN  = 16384;
+        constexpr size_t VERTEX_GRAIN    = 16384;
+        constexpr float  TANGENT_EPSILON = 1e-6f; // smallest UV determinant that still defines a tangent frame
+
+        SimdLevel detectSimdLevel()
+        {
+#if defined(REALM_KERNELS_X86) && defined(_MSC_VER) && !defined(__clang__)
+            int info[4];
+            __cpuid(info, 0);
+            const int max_leaf = info[0];
+            __cpuid(info, 1);
+            const bool os_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 0x6) == 0x6;
+            if (os_avx && max_leaf >= 7)
+            {
+                __cpuidex(info, 7, 0);
+                if (info[1] & (1 << 5))
+                    return SimdLevel::AVX2;
+            }
+            return SimdLevel::SSE2;
+#elif defined(REALM_KERNELS_X86)
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") ? SimdLevel::AVX2 : SimdLevel::SSE2;
+#else
+            return SimdLevel::Scalar;
+#endif
+        }
+
+        std::atomic<SimdLevel>& activeSimdLevel()
+        {
+            static std::atomic<SimdLevel> level {MeshKernels::getSupportedSimdLevel()};
+            return level;
+        }
+
+        void forRange(ThreadPool*                                pool,
+                      size_t                                     begin,
+                      size_t                                     end,
+                      size_t                                     grain,
+                      const std::function<void(size_t, size_t)>& body)
+        {
+            if (pool)
+                pool->parallelFor(begin, end, grain, body);
+            else if (begin < end)
+                body(begin, end);
+        }
+
+        // Per-face output of a kernel call over triangles [begin, end); element 0 belongs to triangle begin.
+        struct FaceStreams
+        {
+            float* x;
+            float* y;
+            float* z;
+
+            FaceStreams advance(size_t count) const { return FaceStreams {x + count, y + count, z + count}; }
+        };
+
+        // ===== Scalar reference =====
+
+        void boundsScalar(const Vec3Stream& p, size_t begin, size_t end, AABB& bounds)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                bounds.min = glm::min(bounds.min, glm::vec3(p.x[i], p.y[i], p.z[i]));
+                bounds.max = glm::max(bounds.max, glm::vec3(p.x[i], p.y[i], p.z[i]));
+            }
+        }
+
+        void
+        faceNormalsScalar(const uint32_t* indices, size_t begin, size_t end, const Vec3Stream& p, const FaceStreams& f)
+        {
+            const size_t vertex_count = p.size();
+            for (size_t t = begin; t < end; ++t)
+            {
+                const uint32_t i0 = indices[t * 3];
+                const uint32_t i1 = indices[t * 3 + 1];
+                const uint32_t i2 = indices[t * 3 + 2];
+                if (i0 >= vertex_count || i1 >= vertex_count || i2 >= vertex_count)
+                {
+                    f.x[t - begin] = f.y[t - begin] = f.z[t - begin] = 0.0f;
+                    continue;
+                }
+
+                const float e1x = p.x[i1] - p.x[i0], e1y = p.y[i1] - p.y[i0], e1z = p.z[i1] - p.z[i0];
+                const float e2x = p.x[i2] - p.x[i0], e2y = p.y[i2] - p.y[i0], e2z = p.z[i2] - p.z[i0];
+
+                f.x[t - begin] = e1y * e2z - e1z * e2y;
+                f.y[t - begin] = e1z * e2x - e1x * e2z;
+                f.z[t - begin] = e1x * e2y - e1y * e2x;
+            }
+        }
+
+        void faceTangentsScalar(const uint32_t*           indices,
+                                size_t                    begin,
+                                size_t                    end,
+                                const Vec3Stream&         p,
+                                const std::vector<float>& u,
+                                const std::vector<float>& v,
+                                const FaceStreams&        ft,
+                                const FaceStreams&        fb)
+        {
+            const size_t vertex_count = p.size();
+            for (size_t t = begin; t < end; ++t)
+            {
+                const uint32_t i0 = indices[t * 3];
+                const uint32_t i1 = indices[t * 3 + 1];
+                const uint32_t i2 = indices[t * 3 + 2];
+
+                ft.x[t - begin] = ft.y[t - begin] = ft.z[t - begin] = 0.0f;
+                fb.x[t - begin] = fb.y[t - begin] = fb.z[t - begin] = 0.0f;
+                if (i0 >= vertex_count || i1 >= vertex_count || i2 >= vertex_count)
+                    continue;
+
+                const float e1x = p.x[i1] - p.x[i0], e1y = p.y[i1] - p.y[i0], e1z = p.z[i1] - p.z[i0];
+                const float e2x = p.x[i2] - p.x[i0], e2y = p.y[i2] - p.y[i0], e2z = p.z[i2] - p.z[i0];
+                const float du1 = u[i1] - u[i0], dv1 = v[i1] - v[i0];
+                const float du2 = u[i2] - u[i0], dv2 = v[i2] - v[i0];
+
+                const float det = du1 * dv2 - du2 * dv1;
+                if (std::abs(det) < TANGENT_EPSILON)
+                    continue;
+
+                const float r = 1.0f / det;
+                ft.x[t - begin]       = r * (dv2 * e1x - dv1 * e2x);
+                ft.y[t - begin]       = r * (dv2 * e1y - dv1 * e2y);
+                ft.z[t - begin]       = r * (dv2 * e1z - dv1 * e2z);
+                fb.x[t - begin]       = r * (-du2 * e1x + du1 * e2x);
+                fb.y[t - begin]       = r * (-du2 * e1y + du1 * e2y);
+                fb.z[t - begin]       = r * (-du2 * e1z + du1 * e2z);
+            }
+        }
+
+        void normalizeScalar(Vec3Stream& s, size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const float length2 = s.x[i] * s.x[i] + s.y[i] * s.y[i] + s.z[i] * s.z[i];
+                if (length2 <= 0.0f)
+                    continue;
+
+                const float inv_length = 1.0f / std::sqrt(length2);
+                s.x[i] *= inv_length;
+                s.y[i] *= inv_length;
+                s.z[i] *= inv_length;
+            }
+        }
+
+        // t -= n * dot(n, t)
+        void orthogonalizeScalar(Vec3Stream& t, const Vec3Stream& n, size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const float d = n.x[i] * t.x[i] + n.y[i] * t.y[i] + n.z[i] * t.z[i];
+                t.x[i] -= n.x[i] * d;
+                t.y[i] -= n.y[i] * d;
+                t.z[i] -= n.z[i] * d;
+            }
+        }
+
+#if defined(REALM_KERNELS_X86)
+        // ===== SSE2 (x86-64 baseline), 4 lanes =====
+        // Corners are loaded one by one (as on AVX2); the arithmetic is the same as the scalar path,
+        // so results match it bit for bit.
+
+        void boundsSse2(const Vec3Stream& p, size_t begin, size_t end, AABB& bounds)
+        {
+            __m128 min_x = _mm_set1_ps(bounds.min.x), min_y = _mm_set1_ps(bounds.min.y),
+                   min_z = _mm_set1_ps(bounds.min.z);
+            __m128 max_x = _mm_set1_ps(bounds.max.x), max_y = _mm_set1_ps(bounds.max.y),
+                   max_z = _mm_set1_ps(bounds.max.z);
+
+            size_t i = begin;
+            for (; i + 4 <= end; i += 4)
+            {
+                const __m128 x = _mm_loadu_ps(&p.x[i]), y = _mm_loadu_ps(&p.y[i]), z = _mm_loadu_ps(&p.z[i]);
+                min_x = _mm_min_ps(min_x, x), min_y = _mm_min_ps(min_y, y), min_z = _mm_min_ps(min_z, z);
+                max_x = _mm_max_ps(max_x, x), max_y = _mm_max_ps(max_y, y), max_z = _mm_max_ps(max_z, z);
+            }
+
+            alignas(16) float lanes[6][4];
+            _mm_store_ps(lanes[0], min_x), _mm_store_ps(lanes[1], min_y), _mm_store_ps(lanes[2], min_z);
+            _mm_store_ps(lanes[3], max_x), _mm_store_ps(lanes[4], max_y), _mm_store_ps(lanes[5], max_z);
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                bounds.min = glm::min(bounds.min, glm::vec3(lanes[0][lane], lanes[1][lane], lanes[2][lane]));
+                bounds.max = glm::max(bounds.max, glm::vec3(lanes[3][lane], lanes[4][lane], lanes[5][lane]));
+            }
+            boundsScalar(p, i, end, bounds);
+        }
+
+        struct Corners4
+        {
+            __m128 x[3], y[3], z[3];
+        };
+
+        // false (and nothing loaded) if one of the 12 indices is out of range
+        bool loadCorners4(const uint32_t* tri, const Vec3Stream& p, Corners4& c)
+        {
+            uint32_t max_index = 0;
+            for (int i = 0; i < 12; ++i)
+                max_index = std::max(max_index, tri[i]);
+            if (max_index >= p.size())
+                return false;
+
+            for (int k = 0; k < 3; ++k)
+            {
+                c.x[k] = _mm_setr_ps(p.x[tri[k]], p.x[tri[3 + k]], p.x[tri[6 + k]], p.x[tri[9 + k]]);
+                c.y[k] = _mm_setr_ps(p.y[tri[k]], p.y[tri[3 + k]], p.y[tri[6 + k]], p.y[tri[9 + k]]);
+                c.z[k] = _mm_setr_ps(p.z[tri[k]], p.z[tri[3 + k]], p.z[tri[6 + k]], p.z[tri[9 + k]]);
+            }
+            return true;
+        }
+
+        void
+        faceNormalsSse2(const uint32_t* indices, size_t begin, size_t end, const Vec3Stream& p, const FaceStreams& f)
+        {
+            size_t t = begin;
+            for (; t + 4 <= end; t += 4)
+            {
+                Corners4 c;
+                if (!loadCorners4(indices + t * 3, p, c))
+                {
+                    faceNormalsScalar(indices, t, t + 4, p, f.advance(t - begin));
+                    continue;
+                }
+
+                const __m128 e1x = _mm_sub_ps(c.x[1], c.x[0]), e1y = _mm_sub_ps(c.y[1], c.y[0]),
+                             e1z = _mm_sub_ps(c.z[1], c.z[0]);
+                const __m128 e2x = _mm_sub_ps(c.x[2], c.x[0]), e2y = _mm_sub_ps(c.y[2], c.y[0]),
+                             e2z = _mm_sub_ps(c.z[2], c.z[0]);
+
+                _mm_storeu_ps(&f.x[t - begin], _mm_sub_ps(_mm_mul_ps(e1y, e2z), _mm_mul_ps(e1z, e2y)));
+                _mm_storeu_ps(&f.y[t - begin], _mm_sub_ps(_mm_mul_ps(e1z, e2x), _mm_mul_ps(e1x, e2z)));
+                _mm_storeu_ps(&f.z[t - begin], _mm_sub_ps(_mm_mul_ps(e1x, e2y), _mm_mul_ps(e1y, e2x)));
+            }
+            faceNormalsScalar(indices, t, end, p, f.advance(t - begin));
+        }
+
+        void faceTangentsSse2(const uint32_t*           indices,
+                              size_t                    begin,
+                              size_t                    end,
+                              const Vec3Stream&         p,
+                              const std::vector<float>& u,
+                              const std::vector<float>& v,
+                              const FaceStreams&        ft,
+                              const FaceStreams&        fb)
+        {
+            const __m128 sign    = _mm_set1_ps(-0.0f);
+            const __m128 epsilon = _mm_set1_ps(TANGENT_EPSILON);
+            const __m128 one     = _mm_set1_ps(1.0f);
+
+            size_t t = begin;
+            for (; t + 4 <= end; t += 4)
+            {
+                const uint32_t* tri = indices + t * 3;
+                Corners4        c;
+                if (!loadCorners4(tri, p, c))
+                {
+                    faceTangentsScalar(indices, t, t + 4, p, u, v, ft.advance(t - begin), fb.advance(t - begin));
+                    continue;
+                }
+
+                __m128 cu[3], cv[3];
+                for (int k = 0; k < 3; ++k)
+                {
+                    cu[k] = _mm_setr_ps(u[tri[k]], u[tri[3 + k]], u[tri[6 + k]], u[tri[9 + k]]);
+                    cv[k] = _mm_setr_ps(v[tri[k]], v[tri[3 + k]], v[tri[6 + k]], v[tri[9 + k]]);
+                }
+
+                const __m128 e1x = _mm_sub_ps(c.x[1], c.x[0]), e1y = _mm_sub_ps(c.y[1], c.y[0]),
+                             e1z = _mm_sub_ps(c.z[1], c.z[0]);
+                const __m128 e2x = _mm_sub_ps(c.x[2], c.x[0]), e2y = _mm_sub_ps(c.y[2], c.y[0]),
+                             e2z = _mm_sub_ps(c.z[2], c.z[0]);
+                const __m128 du1 = _mm_sub_ps(cu[1], cu[0]), dv1 = _mm_sub_ps(cv[1], cv[0]);
+                const __m128 du2 = _mm_sub_ps(cu[2], cu[0]), dv2 = _mm_sub_ps(cv[2], cv[0]);
+
+                const __m128 det   = _mm_sub_ps(_mm_mul_ps(du1, dv2), _mm_mul_ps(du2, dv1));
+                const __m128 valid = _mm_cmpge_ps(_mm_andnot_ps(sign, det), epsilon);
+                const __m128 r     = _mm_and_ps(valid, _mm_div_ps(one, det)); // zero frames for degenerate UVs
+                const __m128 ndu2  = _mm_xor_ps(du2, sign);
+
+                _mm_storeu_ps(&ft.x[t - begin], _mm_mul_ps(r, _mm_sub_ps(_mm_mul_ps(dv2, e1x), _mm_mul_ps(dv1, e2x))));
+                _mm_storeu_ps(&ft.y[t - begin], _mm_mul_ps(r, _mm_sub_ps(_mm_mul_ps(dv2, e1y), _mm_mul_ps(dv1, e2y))));
+                _mm_storeu_ps(&ft.z[t - begin], _mm_mul_ps(r, _mm_sub_ps(_mm_mul_ps(dv2, e1z), _mm_mul_ps(dv1, e2z))));
+                _mm_storeu_ps(&fb.x[t - begin], _mm_mul_ps(r, _mm_add_ps(_mm_mul_ps(ndu2, e1x), _mm_mul_ps(du1, e2x))));
+                _mm_storeu_ps(&fb.y[t - begin], _mm_mul_ps(r, _mm_add_ps(_mm_mul_ps(ndu2, e1y), _mm_mul_ps(du1, e2y))));
+                _mm_storeu_ps(&fb.z[t - begin], _mm_mul_ps(r, _mm_add_ps(_mm_mul_ps(ndu2, e1z), _mm_mul_ps(du1, e2z))));
+            }
+            faceTangentsScalar(indices, t, end, p, u, v, ft.advance(t - begin), fb.advance(t - begin));
+        }
+
+        // mask ? a : b, per lane (SSE2 has no blendv)
+        __m128 select4(__m128 mask, __m128 a, __m128 b)
+        {
+            return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+        }
+
+        void normalizeSse2(Vec3Stream& s, size_t begin, size_t end)
+        {
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 one  = _mm_set1_ps(1.0f);
+
+            size_t i = begin;
+            for (; i + 4 <= end; i += 4)
+            {
+                const __m128 x = _mm_loadu_ps(&s.x[i]), y = _mm_loadu_ps(&s.y[i]), z = _mm_loadu_ps(&s.z[i]);
+                const __m128 length2 =
+                    _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+                const __m128 non_zero   = _mm_cmpgt_ps(length2, zero);
+                const __m128 inv_length = _mm_div_ps(one, _mm_sqrt_ps(length2));
+
+                // zero vectors stay zero instead of turning into NaN
+                _mm_storeu_ps(&s.x[i], select4(non_zero, _mm_mul_ps(x, inv_length), x));
+                _mm_storeu_ps(&s.y[i], select4(non_zero, _mm_mul_ps(y, inv_length), y));
+                _mm_storeu_ps(&s.z[i], select4(non_zero, _mm_mul_ps(z, inv_length), z));
+            }
+            normalizeScalar(s, i, end);
+        }
+
+        void orthogonalizeSse2(Vec3Stream& t, const Vec3Stream& n, size_t begin, size_t end)
+        {
+            size_t i = begin;
+            for (; i + 4 <= end; i += 4)
+            {
+                const __m128 nx = _mm_loadu_ps(&n.x[i]), ny = _mm_loadu_ps(&n.y[i]), nz = _mm_loadu_ps(&n.z[i]);
+                const __m128 tx = _mm_loadu_ps(&t.x[i]), ty = _mm_loadu_ps(&t.y[i]), tz = _mm_loadu_ps(&t.z[i]);
+                const __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, tx), _mm_mul_ps(ny, ty)), _mm_mul_ps(nz, tz));
+
+                _mm_storeu_ps(&t.x[i], _mm_sub_ps(tx, _mm_mul_ps(nx, d)));
+                _mm_storeu_ps(&t.y[i], _mm_sub_ps(ty, _mm_mul_ps(ny, d)));
+                _mm_storeu_ps(&t.z[i], _mm_sub_ps(tz, _mm_mul_ps(nz, d)));
+            }
+            orthogonalizeScalar(t, n, i, end);
+        }
+
+        // ===== AVX2, 8 lanes =====
+        // FMA is deliberately not used so every level produces the same numbers.
+
+        REALM_TARGET_AVX2 void boundsAvx2(const Vec3Stream& p, size_t begin, size_t end, AABB& bounds)
+        {
+            __m256 min_x = _mm256_set1_ps(bounds.min.x), min_y = _mm256_set1_ps(bounds.min.y),
+                   min_z = _mm256_set1_ps(bounds.min.z);
+            __m256 max_x = _mm256_set1_ps(bounds.max.x), max_y = _mm256_set1_ps(bounds.max.y),
+                   max_z = _mm256_set1_ps(bounds.max.z);
+
+            size_t i = begin;
+            for (; i + 8 <= end; i += 8)
+            {
+                const __m256 x = _mm256_loadu_ps(&p.x[i]), y = _mm256_loadu_ps(&p.y[i]), z = _mm256_loadu_ps(&p.z[i]);
+                min_x = _mm256_min_ps(min_x, x), min_y = _mm256_min_ps(min_y, y), min_z = _mm256_min_ps(min_z, z);
+                max_x = _mm256_max_ps(max_x, x), max_y = _mm256_max_ps(max_y, y), max_z = _mm256_max_ps(max_z, z);
+            }
+
+            alignas(32) float lanes[6][8];
+            _mm256_store_ps(lanes[0], min_x), _mm256_store_ps(lanes[1], min_y), _mm256_store_ps(lanes[2], min_z);
+            _mm256_store_ps(lanes[3], max_x), _mm256_store_ps(lanes[4], max_y), _mm256_store_ps(lanes[5], max_z);
+            for (int lane = 0; lane < 8; ++lane)
+            {
+                bounds.min = glm::min(bounds.min, glm::vec3(lanes[0][lane], lanes[1][lane], lanes[2][lane]));
+                bounds.max = glm::max(bounds.max, glm::vec3(lanes[3][lane], lanes[4][lane], lanes[5][lane]));
+            }
+            boundsScalar(p, i, end, bounds);
+        }
+
+        struct Corners8
+        {
+            __m256 x[3], y[3], z[3];
+        };
+
+        // Lane j of corner k, read from stream s. Plain loads rather than vgather: on current Intel microcode the
+        // gather data sampling mitigation makes hardware gathers slower than eight scalar loads.
+        REALM_TARGET_AVX2 inline __m256 loadCorner8(const float* s, const uint32_t* tri, int k)
+        {
+            return _mm256_setr_ps(s[tri[k]],
+                                  s[tri[3 + k]],
+                                  s[tri[6 + k]],
+                                  s[tri[9 + k]],
+                                  s[tri[12 + k]],
+                                  s[tri[15 + k]],
+                                  s[tri[18 + k]],
+                                  s[tri[21 + k]]);
+        }
+
+        // Corners of triangles tri[0..8); false (and nothing loaded) if one of the 24 indices is out of range.
+        REALM_TARGET_AVX2 bool loadCorners8(const uint32_t* tri, const Vec3Stream& p, Corners8& c)
+        {
+            // unsigned index < vertex_count, as a signed compare of both sides with the top bit flipped
+            const __m256i bias  = _mm256_set1_epi32(INT32_MIN);
+            const __m256i limit = _mm256_set1_epi32(
+                static_cast<int32_t>(static_cast<uint32_t>(std::min<size_t>(p.size(), UINT32_MAX)) ^ 0x80000000u));
+
+            __m256i in_range = _mm256_set1_epi32(-1);
+            for (int i = 0; i < 3; ++i)
+            {
+                const __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tri + i * 8));
+                in_range = _mm256_and_si256(in_range, _mm256_cmpgt_epi32(limit, _mm256_xor_si256(index, bias)));
+            }
+            if (_mm256_movemask_epi8(in_range) != -1)
+                return false;
+
+            for (int k = 0; k < 3; ++k)
+            {
+                c.x[k] = loadCorner8(p.x.data(), tri, k);
+                c.y[k] = loadCorner8(p.y.data(), tri, k);
+                c.z[k] = loadCorner8(p.z.data(), tri, k);
+            }
+            return true;
+        }
+
+        REALM_TARGET_AVX2 void
+        faceNormalsAvx2(const uint32_t* indices, size_t begin, size_t end, const Vec3Stream& p, const FaceStreams& f)
+        {
+            size_t t = begin;
+            for (; t + 8 <= end; t += 8)
+            {
+                Corners8 c;
+                if (!loadCorners8(indices + t * 3, p, c))
+                {
+                    faceNormalsScalar(indices, t, t + 8, p, f.advance(t - begin));
+                    continue;
+                }
+
+                const __m256 e1x = _mm256_sub_ps(c.x[1], c.x[0]), e1y = _mm256_sub_ps(c.y[1], c.y[0]),
+                             e1z = _mm256_sub_ps(c.z[1], c.z[0]);
+                const __m256 e2x = _mm256_sub_ps(c.x[2], c.x[0]), e2y = _mm256_sub_ps(c.y[2], c.y[0]),
+                             e2z = _mm256_sub_ps(c.z[2], c.z[0]);
+
+                _mm256_storeu_ps(&f.x[t - begin], _mm256_sub_ps(_mm256_mul_ps(e1y, e2z), _mm256_mul_ps(e1z, e2y)));
+                _mm256_storeu_ps(&f.y[t - begin], _mm256_sub_ps(_mm256_mul_ps(e1z, e2x), _mm256_mul_ps(e1x, e2z)));
+                _mm256_storeu_ps(&f.z[t - begin], _mm256_sub_ps(_mm256_mul_ps(e1x, e2y), _mm256_mul_ps(e1y, e2x)));
+            }
+            faceNormalsScalar(indices, t, end, p, f.advance(t - begin));
+        }
+
+        REALM_TARGET_AVX2 void faceTangentsAvx2(const uint32_t*           indices,
+                                                size_t                    begin,
+                                                size_t                    end,
+                                                const Vec3Stream&         p,
+                                                const std::vector<float>& u,
+                                                const std::vector<float>& v,
+                                                const FaceStreams&        ft,
+                                                const FaceStreams&        fb)
+        {
+            const __m256 sign    = _mm256_set1_ps(-0.0f);
+            const __m256 epsilon = _mm256_set1_ps(TANGENT_EPSILON);
+            const __m256 one     = _mm256_set1_ps(1.0f);
+
+            size_t t = begin;
+            for (; t + 8 <= end; t += 8)
+            {
+                Corners8 c;
+                if (!loadCorners8(indices + t * 3, p, c))
+                {
+                    faceTangentsScalar(indices, t, t + 8, p, u, v, ft.advance(t - begin), fb.advance(t - begin));
+                    continue;
+                }
+
+                __m256 cu[3], cv[3];
+                for (int k = 0; k < 3; ++k)
+                {
+                    cu[k] = loadCorner8(u.data(), indices + t * 3, k);
+                    cv[k] = loadCorner8(v.data(), indices + t * 3, k);
+                }
+
+                const __m256 e1x = _mm256_sub_ps(c.x[1], c.x[0]), e1y = _mm256_sub_ps(c.y[1], c.y[0]),
+                             e1z = _mm256_sub_ps(c.z[1], c.z[0]);
+                const __m256 e2x = _mm256_sub_ps(c.x[2], c.x[0]), e2y = _mm256_sub_ps(c.y[2], c.y[0]),
+                             e2z = _mm256_sub_ps(c.z[2], c.z[0]);
+                const __m256 du1 = _mm256_sub_ps(cu[1], cu[0]), dv1 = _mm256_sub_ps(cv[1], cv[0]);
+                const __m256 du2 = _mm256_sub_ps(cu[2], cu[0]), dv2 = _mm256_sub_ps(cv[2], cv[0]);
+
+                const __m256 det   = _mm256_sub_ps(_mm256_mul_ps(du1, dv2), _mm256_mul_ps(du2, dv1));
+                const __m256 valid = _mm256_cmp_ps(_mm256_andnot_ps(sign, det), epsilon, _CMP_GE_OQ);
+                const __m256 r     = _mm256_and_ps(valid, _mm256_div_ps(one, det));
+                const __m256 ndu2  = _mm256_xor_ps(du2, sign);
+
+                _mm256_storeu_ps(&ft.x[t - begin],
+                                 _mm256_mul_ps(r, _mm256_sub_ps(_mm256_mul_ps(dv2, e1x), _mm256_mul_ps(dv1, e2x))));
+                _mm256_storeu_ps(&ft.y[t - begin],
+                                 _mm256_mul_ps(r, _mm256_sub_ps(_mm256_mul_ps(dv2, e1y), _mm256_mul_ps(dv1, e2y))));
+                _mm256_storeu_ps(&ft.z[t - begin],
+                                 _mm256_mul_ps(r, _mm256_sub_ps(_mm256_mul_ps(dv2, e1z), _mm256_mul_ps(dv1, e2z))));
+                _mm256_storeu_ps(&fb.x[t - begin],
+                                 _mm256_mul_ps(r, _mm256_add_ps(_mm256_mul_ps(ndu2, e1x), _mm256_mul_ps(du1, e2x))));
+                _mm256_storeu_ps(&fb.y[t - begin],
+                                 _mm256_mul_ps(r, _mm256_add_ps(_mm256_mul_ps(ndu2, e1y), _mm256_mul_ps(du1, e2y))));
+                _mm256_storeu_ps(&fb.z[t - begin],
+                                 _mm256_mul_ps(r, _mm256_add_ps(_mm256_mul_ps(ndu2, e1z), _mm256_mul_ps(du1, e2z))));
+            }
+            faceTangentsScalar(indices, t, end, p, u, v, ft.advance(t - begin), fb.advance(t - begin));
+        }
+
+        REALM_TARGET_AVX2 void normalizeAvx2(Vec3Stream& s, size_t begin, size_t end)
+        {
+            const __m256 zero = _mm256_setzero_ps();
+            const __m256 one  = _mm256_set1_ps(1.0f);
+
+            size_t i = begin;
+            for (; i + 8 <= end; i += 8)
+            {
+                const __m256 x = _mm256_loadu_ps(&s.x[i]), y = _mm256_loadu_ps(&s.y[i]), z = _mm256_loadu_ps(&s.z[i]);
+                const __m256 length2 =
+                    _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+                const __m256 non_zero   = _mm256_cmp_ps(length2, zero, _CMP_GT_OQ);
+                const __m256 inv_length = _mm256_div_ps(one, _mm256_sqrt_ps(length2));
+
+                _mm256_storeu_ps(&s.x[i], _mm256_blendv_ps(x, _mm256_mul_ps(x, inv_length), non_zero));
+                _mm256_storeu_ps(&s.y[i], _mm256_blendv_ps(y, _mm256_mul_ps(y, inv_length), non_zero));
+                _mm256_storeu_ps(&s.z[i], _mm256_blendv_ps(z, _mm256_mul_ps(z, inv_length), non_zero));
+            }
+            normalizeScalar(s, i, end);
+        }
+
+        REALM_TARGET_AVX2 void orthogonalizeAvx2(Vec3Stream& t, const Vec3Stream& n, size_t begin, size_t end)
+        {
+            size_t i = begin;
+            for (; i + 8 <= end; i += 8)
+            {
+                const __m256 nx = _mm256_loadu_ps(&n.x[i]), ny = _mm256_loadu_ps(&n.y[i]),
+                             nz = _mm256_loadu_ps(&n.z[i]);
+                const __m256 tx = _mm256_loadu_ps(&t.x[i]), ty = _mm256_loadu_ps(&t.y[i]),
+                             tz = _mm256_loadu_ps(&t.z[i]);
+                const __m256 d =
+                    _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, tx), _mm256_mul_ps(ny, ty)), _mm256_mul_ps(nz, tz));
+
+                _mm256_storeu_ps(&t.x[i], _mm256_sub_ps(tx, _mm256_mul_ps(nx, d)));
+                _mm256_storeu_ps(&t.y[i], _mm256_sub_ps(ty, _mm256_mul_ps(ny, d)));
+                _mm256_storeu_ps(&t.z[i], _mm256_sub_ps(tz, _mm256_mul_ps(nz, d)));
+            }
+            orthogonalizeScalar(t, n, i, end);
+        }
+#endif
+
+        // ===== Dispatch =====
+
+        void bounds(SimdLevel level, const Vec3Stream& p, size_t begin, size_t end, AABB& result)
+        {
+#if defined(REALM_KERNELS_X86)
+            if (level == SimdLevel::AVX2)
+                return boundsAvx2(p, begin, end, result);
+            if (level == SimdLevel::SSE2)
+                return boundsSse2(p, begin, end, result);
+#endif
+            boundsScalar(p, begin, end, result);
+        }
+
+        void faceNormals(SimdLevel          level,
+                         const uint32_t*    indices,
+                         size_t             begin,
+                         size_t             end,
+                         const Vec3Stream&  p,
+                         const FaceStreams& f)
+        {
+#if defined(REALM_KERNELS_X86)
+            if (level == SimdLevel::AVX2)
+                return faceNormalsAvx2(indices, begin, end, p, f);
+            if (level == SimdLevel::SSE2)
+                return faceNormalsSse2(indices, begin, end, p, f);
+#endif
+            faceNormalsScalar(indices, begin, end, p, f);
+        }
+
+        void faceTangents(SimdLevel                 level,
+                          const uint32_t*           indices,
+                          size_t                    begin,
+                          size_t                    end,
+                          const Vec3Stream&         p,
+                          const std::vector<float>& u,
+                          const std::vector<float>& v,
+                          const FaceStreams&        ft,
+                          const FaceStreams&        fb)
+        {
+#if defined(REALM_KERNELS_X86)
+            if (level == SimdLevel::AVX2)
+                return faceTangentsAvx2(indices, begin, end, p, u, v, ft, fb);
+            if (level == SimdLevel::SSE2)
+                return faceTangentsSse2(indices, begin, end, p, u, v, ft, fb);
+#endif
+            faceTangentsScalar(indices, begin, end, p, u, v, ft, fb);
+        }
+
+        void normalize(SimdLevel level, Vec3Stream& s, size_t begin, size_t end)
+        {
+#if defined(REALM_KERNELS_X86)
+            if (level == SimdLevel::AVX2)
+                return normalizeAvx2(s, begin, end);
+            if (level == SimdLevel::SSE2)
+                return normalizeSse2(s, begin, end);
+#endif
+            normalizeScalar(s, begin, end);
+        }
+
+        void orthogonalize(SimdLevel level, Vec3Stream& t, const Vec3Stream& n, size_t begin, size_t end)
+        {
+#if defined(REALM_KERNELS_X86)
+            if (level == SimdLevel::AVX2)
+                return orthogonalizeAvx2(t, n, begin, end);
+            if (level == SimdLevel::SSE2)
+                return orthogonalizeSse2(t, n, begin, end);
+#endif
+            orthogonalizeScalar(t, n, begin, end);
+        }
+
+        // ===== Conflict-free accumulation =====
+
+        constexpr size_t FACE_BLOCK = 256; // triangles per block of the single-threaded path, kept in L1
+
+        void clear(Vec3Stream& s, size_t count)
+        {
+            s.x.assign(count, 0.0f);
+            s.y.assign(count, 0.0f);
+            s.z.assign(count, 0.0f);
+        }
+
+        // Floats per packed face and per vertex sum: the xyz of each stream padded to 4, so a corner is updated
+        // with STREAMS four-wide adds on one cache line.
+        template<size_t STREAMS>
+        constexpr size_t PACKED_FLOATS = STREAMS * 4;
+
+        /**
+         * Runs face_kernel(begin, end, FaceStreams[STREAMS]) over [begin, end) in blocks small enough for L1 and
+         * packs the results per triangle into packed, element 0 being triangle begin.
+         */
+        template<size_t STREAMS, typename FaceKernel>
+        void produceFaces(const FaceKernel& face_kernel, size_t begin, size_t end, float* __restrict packed)
+        {
+            constexpr size_t STRIDE = PACKED_FLOATS<STREAMS>;
+
+            float       block[STREAMS][3][FACE_BLOCK];
+            FaceStreams faces[STREAMS];
+            for (size_t s = 0; s < STREAMS; ++s)
+                faces[s] = FaceStreams {block[s][0], block[s][1], block[s][2]};
+
+            for (size_t block_begin = begin; block_begin < end; block_begin += FACE_BLOCK)
+            {
+                const size_t count = std::min(FACE_BLOCK, end - block_begin);
+                face_kernel(block_begin, block_begin + count, faces);
+
+                float* out = packed + (block_begin - begin) * STRIDE;
+                for (size_t t = 0; t < count; ++t)
+                {
+                    for (size_t s = 0; s < STREAMS; ++s)
+                    {
+                        float* face = out + t * STRIDE + s * 4;
+                        face[0]     = block[s][0][t];
+                        face[1]     = block[s][1][t];
+                        face[2]     = block[s][2][t];
+                        face[3]     = 0.0f;
+                    }
+                }
+            }
+        }
+
+        // Adds packed faces [begin, end) to the corners in [vertex_begin, vertex_end), in index order.
+        template<size_t STREAMS>
+        void scatterFaces(const uint32_t*          indices,
+                          size_t                   begin,
+                          size_t                   end,
+                          const float* __restrict  faces,
+                          float* __restrict        sums,
+                          size_t                   vertex_begin,
+                          size_t                   vertex_end)
+        {
+            constexpr size_t STRIDE = PACKED_FLOATS<STREAMS>;
+
+            const size_t span = vertex_end - vertex_begin;
+            for (size_t t = begin; t < end; ++t)
+            {
+                const float* face = faces + (t - begin) * STRIDE;
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    const size_t vertex = indices[t * 3 + k];
+                    if (vertex - vertex_begin >= span) // also rejects vertex < vertex_begin through wrap-around
+                        continue;
+
+                    float* sum = sums + vertex * STRIDE;
+                    for (size_t i = 0; i < STRIDE; ++i)
+                        sum[i] += face[i];
+                }
+            }
+        }
+
+        /**
+         * Sums the per-face values produced by face_kernel(begin, end, FaceStreams[STREAMS]) into the vertex streams.
+         *
+         * Alone, faces are produced block by block and scattered right away. With a pool, all faces are produced in
+         * parallel first; then each worker owns a range of vertices and scans the whole index buffer but writes only
+         * its own vertices, so no two workers touch the same memory. Either way every vertex receives its faces in
+         * index order, so the sums are the same for any thread count.
+         */
+        template<size_t STREAMS, typename FaceKernel>
+        void accumulateFaces(ThreadPool*        pool,
+                             const uint32_t*    indices,
+                             size_t             triangle_count,
+                             Vec3Stream* const* vertices,
+                             const FaceKernel&  face_kernel)
+        {
+            constexpr size_t STRIDE = PACKED_FLOATS<STREAMS>;
+
+            const size_t vertex_count = vertices[0]->size();
+            const size_t range_count  = pool ? pool->getThreadCount() + 1 : 1; // the caller takes a range too
+            const size_t grain        = std::max((vertex_count + range_count - 1) / range_count, VERTEX_GRAIN);
+
+            std::vector<float> sums(vertex_count * STRIDE, 0.0f);
+
+            if (range_count == 1)
+            {
+                std::vector<float> faces(FACE_BLOCK * STRIDE);
+                for (size_t begin = 0; begin < triangle_count; begin += FACE_BLOCK)
+                {
+                    const size_t end = std::min(begin + FACE_BLOCK, triangle_count);
+                    produceFaces<STREAMS>(face_kernel, begin, end, faces.data());
+                    scatterFaces<STREAMS>(indices, begin, end, faces.data(), sums.data(), 0, vertex_count);
+                }
+            }
+            else
+            {
+                std::vector<float> faces(triangle_count * STRIDE);
+                pool->parallelFor(0, triangle_count, TRIANGLE_GRAIN, [&](size_t begin, size_t end) {
+                    produceFaces<STREAMS>(face_kernel, begin, end, faces.data() + begin * STRIDE);
+                });
+                pool->parallelFor(0, vertex_count, grain, [&](size_t begin, size_t end) {
+                    scatterFaces<STREAMS>(indices, 0, triangle_count, faces.data(), sums.data(), begin, end);
+                });
+            }
+
+            // back to SoA for the vectorised per-vertex passes
+            forRange(pool, 0, vertex_count, grain, [&](size_t begin, size_t end) {
+                for (size_t v = begin; v < end; ++v)
+                {
+                    const float* sum = sums.data() + v * STRIDE;
+                    for (size_t s = 0; s < STREAMS; ++s)
+                    {
+                        vertices[s]->x[v] = sum[s * 4];
+                        vertices[s]->y[v] = sum[s * 4 + 1];
+                        vertices[s]->z[v] = sum[s * 4 + 2];
+                    }
+                }
+            });
+        }
+    } // namespace
+
+    MeshKernels::SimdLevel MeshKernels::getSupportedSimdLevel()
+    {
+        static const SimdLevel supported = detectSimdLevel();
+        return supported;
+    }
+
+    MeshKernels::SimdLevel MeshKernels::getSimdLevel() { return activeSimdLevel().load(std::memory_order_relaxed); }
+
+    void MeshKernels::setSimdLevel(SimdLevel level)
+    {
+        activeSimdLevel().store(std::min(level, getSupportedSimdLevel()), std::memory_order_relaxed);
+    }
+
+    AABB MeshKernels::computeBounds(const Vec3Stream& positions, ThreadPool* pool)
+    {
+        const size_t count = positions.size();
+        if (count == 0)
+            return AABB {glm::vec3(0.0f), glm::vec3(0.0f)};
+
+        const SimdLevel level = getSimdLevel();
+        const glm::vec3 first(positions.x[0], positions.y[0], positions.z[0]);
+
+        std::vector<AABB> chunks((count + VERTEX_GRAIN - 1) / VERTEX_GRAIN, AABB {first, first});
+        forRange(pool, 0, count, VERTEX_GRAIN, [&](size_t begin, size_t end) {
+            bounds(level, positions, begin, end, chunks[begin / VERTEX_GRAIN]);
+        });
+
+        AABB result = chunks[0];
+        for (const auto& chunk : chunks)
+            result.merge(chunk);
+        return result;
+    }
+
+    void MeshKernels::computeNormals(const uint32_t*   indices,
+                                     size_t            index_count,
+                                     const Vec3Stream& positions,
+                                     Vec3Stream&       normals,
+                                     ThreadPool*       pool)
+    {
+        const size_t vertex_count   = positions.size();
+        const size_t triangle_count = index_count / 3;
+        if (vertex_count == 0 || triangle_count == 0)
+        {
+            clear(normals, vertex_count);
+            return;
+        }
+        normals.resize(vertex_count); // fully written by accumulateFaces
+
+        const SimdLevel level = getSimdLevel();
+
+        Vec3Stream* const sums[1] = {&normals};
+        accumulateFaces<1>(pool, indices, triangle_count, sums, [&](size_t begin, size_t end, FaceStreams* faces) {
+            faceNormals(level, indices, begin, end, positions, faces[0]);
+        });
+
+        forRange(pool, 0, vertex_count, VERTEX_GRAIN, [&](size_t begin, size_t end) {
+            normalize(level, normals, begin, end);
+        });
+    }
+
+    void MeshKernels::computeTangents(const uint32_t*           indices,
+                                      size_t                    index_count,
+                                      const Vec3Stream&         positions,
+                                      const std::vector<float>& u,
+                                      const std::vector<float>& v,
+                                      const Vec3Stream&         normals,
+                                      Vec3Stream&               tangents,
+                                      Vec3Stream&               bitangents,
+                                      ThreadPool*               pool)
+    {
+        const size_t vertex_count   = positions.size();
+        const size_t triangle_count = index_count / 3;
+        if (vertex_count == 0 || triangle_count == 0)
+        {
+            clear(tangents, vertex_count);
+            clear(bitangents, vertex_count);
+            return;
+        }
+        tangents.resize(vertex_count);
+        bitangents.resize(vertex_count);
+
+        const SimdLevel level = getSimdLevel();
+
+        Vec3Stream* const sums[2] = {&tangents, &bitangents};
+        accumulateFaces<2>(pool, indices, triangle_count, sums, [&](size_t begin, size_t end, FaceStreams* faces) {
+            faceTangents(level, indices, begin, end, positions, u, v, faces[0], faces[1]);
+        });
+
+        forRange(pool, 0, vertex_count, VERTEX_GRAIN, [&](size_t begin, size_t end) {
+            orthogonalize(level, tangents, normals, begin, end);
+            normalize(level, tangents, begin, end);
+            normalize(level, bitangents, begin, end);
+        });
+    }
+} // namespace RealmEngine
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "math.h"
+
+namespace RealmEngine
+{
+    class ThreadPool;
+
+    // One float array per component (SoA), so SIMD lanes map to consecutive vertices or gathered indices.
+    struct Vec3Stream
+    {
+        std::vector<float> x, y, z;
+
+        void resize(size_t count)
+        {
+            x.resize(count);
+            y.resize(count);
+            z.resize(count);
+        }
+        size_t size() const { return x.size(); }
+    };
+
+    /**
+     * Vectorised geometry kernels behind Mesh::calculateNormals, calculateTangents and calculateAABB.
+     *
+     * Per-face work is done in SIMD batches of 4 (SSE2) or 8 (AVX2, when the CPU supports it) triangles whose
+     * corners are gathered from SoA streams. Faces are then summed into their vertices by workers
+     * owning disjoint vertex ranges, which needs no atomics and adds faces in index order, so the result is
+     * identical for any thread count. SimdLevel::Scalar runs the same steps one element at a time as a reference.
+     */
+    class MeshKernels
+    {
+    public:
+        enum class SimdLevel : uint8_t
+        {
+            Scalar,
+            SSE2,
+            AVX2,
+        };
+
+        static SimdLevel getSupportedSimdLevel();
+        static SimdLevel getSimdLevel();
+        // clamped to the supported level, mainly for benchmarks and checking against the scalar path
+        static void setSimdLevel(SimdLevel level);
+
+        static AABB computeBounds(const Vec3Stream& positions, ThreadPool* pool = nullptr);
+
+        // Area-weighted vertex normals, normalized; vertices without faces get a zero normal.
+        // Triangles referencing a vertex outside positions are skipped.
+        static void computeNormals(const uint32_t*   indices,
+                                   size_t            index_count,
+                                   const Vec3Stream& positions,
+                                   Vec3Stream&       normals,
+                                   ThreadPool*       pool = nullptr);
+
+        // Per-vertex tangent frames from UV gradients, tangents Gram-Schmidt orthogonalized against normals.
+        static void computeTangents(const uint32_t*           indices,
+                                    size_t                    index_count,
+                                    const Vec3Stream&         positions,
+                                    const std::vector<float>& u,
+                                    const std::vector<float>& v,
+                                    const Vec3Stream&         normals,
+                                    Vec3Stream&               tangents,
+                                    Vec3Stream&               bitangents,
+                                    ThreadPool*               pool = nullptr);
+    };
+} // namespace RealmEngine
@@ -0,0 +1,386 @@
+#include "mesh_optimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <utility>
+#include "glm/geometric.hpp"
+
+namespace RealmEngine
+{
+    namespace
+    {
+        constexpr uint32_t INVALID_INDEX = 0xFFFFFFFFu;
+
+        // ===== Forsyth vertex scoring =====
+        // https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+
+        constexpr size_t FORSYTH_CACHE_SIZE  = 32;
+        constexpr float  CACHE_DECAY_POWER   = 1.5f;
+        constexpr float  LAST_TRIANGLE_SCORE = 0.75f;
+        constexpr float  VALENCE_BOOST_SCALE = 2.0f;
+        constexpr float  VALENCE_BOOST_POWER = 0.5f;
+
+        float vertexScore(int cache_position, uint32_t remaining_triangles)
+        {
+            if (remaining_triangles == 0)
+                return -1.0f;
+
+            float score = 0.0f;
+            if (cache_position >= 0)
+            {
+                // the triangle just emitted gets a fixed score so its vertices aren't favoured over the next ones
+                if (cache_position < 3)
+                    score = LAST_TRIANGLE_SCORE;
+                else
+                {
+                    const float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+                    score = std::pow(1.0f - static_cast<float>(cache_position - 3) * scaler, CACHE_DECAY_POWER);
+                }
+            }
+
+            // favour vertices with few triangles left, so lone triangles don't get stranded
+            score += VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remaining_triangles), -VALENCE_BOOST_POWER);
+            return score;
+        }
+
+        // ===== FIFO cache simulation =====
+
+        class FifoCache
+        {
+        public:
+            FifoCache(size_t vertex_count, uint32_t cache_size) :
+                m_timestamps(vertex_count, 0), m_timestamp(cache_size + 1), m_cache_size(cache_size)
+            {}
+
+            // Returns whether the vertex had to be transformed.
+            bool access(uint32_t vertex)
+            {
+                if (m_timestamp - m_timestamps[vertex] <= m_cache_size)
+                    return false;
+                m_timestamps[vertex] = m_timestamp++;
+                return true;
+            }
+
+            uint32_t accessTriangle(const uint32_t* triangle)
+            {
+                return access(triangle[0]) + access(triangle[1]) + access(triangle[2]);
+            }
+
+            void flush() { m_timestamp += m_cache_size + 1; }
+
+        private:
+            std::vector<uint32_t> m_timestamps;
+            uint32_t              m_timestamp;
+            uint32_t              m_cache_size;
+        };
+
+        glm::vec3 readPosition(const float* positions, size_t stride, uint32_t vertex)
+        {
+            const float* p =
+                reinterpret_cast<const float*>(reinterpret_cast<const unsigned char*>(positions) + vertex * stride);
+            return glm::vec3(p[0], p[1], p[2]);
+        }
+    } // namespace
+
+    MeshOptimizer::VertexCacheStats MeshOptimizer::analyzeVertexCache(const uint32_t* indices,
+                                                                      size_t          index_count,
+                                                                      size_t          vertex_count,
+                                                                      uint32_t        cache_size)
+    {
+        VertexCacheStats stats;
+        if (index_count < 3 || vertex_count == 0)
+            return stats;
+
+        FifoCache         cache(vertex_count, cache_size);
+        std::vector<bool> referenced(vertex_count, false);
+        size_t            transformed = 0;
+        size_t            unique      = 0;
+        for (size_t i = 0; i < index_count; ++i)
+        {
+            transformed += cache.access(indices[i]);
+            if (!referenced[indices[i]])
+            {
+                referenced[indices[i]] = true;
+                ++unique;
+            }
+        }
+
+        stats.acmr = static_cast<float>(transformed) / static_cast<float>(index_count / 3);
+        stats.atvr = static_cast<float>(transformed) / static_cast<float>(unique);
+        return stats;
+    }
+
+    void MeshOptimizer::optimizeVertexCache(uint32_t* indices, size_t index_count, size_t vertex_count)
+    {
+        const size_t triangle_count = index_count / 3;
+        if (triangle_count < 2 || vertex_count == 0)
+            return;
+
+        // vertex -> triangles adjacency; the live triangles of v are adjacency[offsets[v], offsets[v] + remaining[v])
+        std::vector<uint32_t> remaining(vertex_count, 0);
+        std::vector<uint32_t> offsets(vertex_count, 0);
+        std::vector<uint32_t> adjacency(triangle_count * 3);
+        for (size_t i = 0; i < triangle_count * 3; ++i)
+            ++remaining[indices[i]];
+        for (size_t v = 1; v < vertex_count; ++v)
+            offsets[v] = offsets[v - 1] + remaining[v - 1];
+        {
+            std::vector<uint32_t> fill(offsets);
+            for (size_t i = 0; i < triangle_count * 3; ++i)
+                adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        std::vector<int>   cache_position(vertex_count, -1);
+        std::vector<float> vertex_scores(vertex_count);
+        for (size_t v = 0; v < vertex_count; ++v)
+            vertex_scores[v] = vertexScore(-1, remaining[v]);
+
+        std::vector<float> triangle_scores(triangle_count);
+        std::vector<bool>  emitted(triangle_count, false);
+        uint32_t           best_triangle = 0;
+        for (size_t t = 0; t < triangle_count; ++t)
+        {
+            const uint32_t* tri = indices + t * 3;
+            triangle_scores[t]  = vertex_scores[tri[0]] + vertex_scores[tri[1]] + vertex_scores[tri[2]];
+            if (triangle_scores[t] > triangle_scores[best_triangle])
+                best_triangle = static_cast<uint32_t>(t);
+        }
+
+        std::vector<uint32_t> result(triangle_count * 3);
+        std::vector<uint32_t> cache;
+        std::vector<uint32_t> next_cache;
+        cache.reserve(FORSYTH_CACHE_SIZE + 3);
+        next_cache.reserve(FORSYTH_CACHE_SIZE + 3);
+        size_t input_cursor = 0;
+
+        for (size_t out = 0; out < triangle_count; ++out)
+        {
+            // nothing adjacent to the cache is left: continue with the next unemitted triangle in input order
+            if (best_triangle == INVALID_INDEX)
+            {
+                while (emitted[input_cursor])
+                    ++input_cursor;
+                best_triangle = static_cast<uint32_t>(input_cursor);
+            }
+
+            const uint32_t  triangle = best_triangle;
+            const uint32_t* tri      = indices + triangle * 3;
+            result[out * 3 + 0]      = tri[0];
+            result[out * 3 + 1]      = tri[1];
+            result[out * 3 + 2]      = tri[2];
+            emitted[triangle]        = true;
+
+            // drop the triangle from its vertices' live lists
+            for (int k = 0; k < 3; ++k)
+            {
+                const uint32_t v     = tri[k];
+                uint32_t*      begin = adjacency.data() + offsets[v];
+                uint32_t*      end   = begin + remaining[v];
+                uint32_t*      it    = std::find(begin, end, triangle);
+                std::swap(*it, *(end - 1));
+                --remaining[v];
+            }
+
+            // emitted vertices move to the front of the cache, everything else shifts back
+            next_cache.clear();
+            for (int k = 0; k < 3; ++k)
+                if (std::find(next_cache.begin(), next_cache.end(), tri[k]) == next_cache.end())
+                    next_cache.push_back(tri[k]);
+            for (uint32_t v : cache)
+                if (v != tri[0] && v != tri[1] && v != tri[2])
+                    next_cache.push_back(v);
+
+            // rescore touched vertices, including the ones pushed out of the cache
+            for (size_t i = 0; i < next_cache.size(); ++i)
+            {
+                const uint32_t v = next_cache[i];
+                cache_position[v] = i < FORSYTH_CACHE_SIZE ? static_cast<int>(i) : -1;
+
+                const float score = vertexScore(cache_position[v], remaining[v]);
+                const float delta = score - vertex_scores[v];
+                vertex_scores[v]  = score;
+                for (uint32_t j = 0; j < remaining[v]; ++j)
+                    triangle_scores[adjacency[offsets[v] + j]] += delta;
+            }
+
+            if (next_cache.size() > FORSYTH_CACHE_SIZE)
+                next_cache.resize(FORSYTH_CACHE_SIZE);
+            cache.swap(next_cache);
+
+            best_triangle    = INVALID_INDEX;
+            float best_score = -1.0f;
+            for (uint32_t v : cache)
+            {
+                for (uint32_t j = 0; j < remaining[v]; ++j)
+                {
+                    const uint32_t candidate = adjacency[offsets[v] + j];
+                    if (triangle_scores[candidate] > best_score)
+                    {
+                        best_score    = triangle_scores[candidate];
+                        best_triangle = candidate;
+                    }
+                }
+            }
+        }
+
+        std::copy(result.begin(), result.end(), indices);
+    }
+
+    void MeshOptimizer::optimizeOverdraw(uint32_t*    indices,
+                                         size_t       index_count,
+                                         const float* positions,
+                                         size_t       position_stride,
+                                         size_t       vertex_count,
+                                         float        threshold)
+    {
+        const size_t triangle_count = index_count / 3;
+        if (triangle_count < 2 || !positions || vertex_count == 0)
+            return;
+
+        FifoCache cache(vertex_count, DEFAULT_CACHE_SIZE);
+
+        // hard boundaries: triangles missing all three vertices start a fresh cache run anyway
+        std::vector<size_t> hard_clusters;
+        for (size_t t = 0; t < triangle_count; ++t)
+            if (cache.accessTriangle(indices + t * 3) == 3 || t == 0)
+                hard_clusters.push_back(t);
+        hard_clusters.push_back(triangle_count);
+
+        // soft boundaries: split runs further wherever the prefix ACMR is already close to the run's own ACMR
+        std::vector<size_t> clusters;
+        for (size_t c = 0; c + 1 < hard_clusters.size(); ++c)
+        {
+            const size_t begin = hard_clusters[c];
+            const size_t end   = hard_clusters[c + 1];
+
+            cache.flush();
+            size_t run_misses = 0;
+            for (size_t t = begin; t < end; ++t)
+                run_misses += cache.accessTriangle(indices + t * 3);
+            const float run_threshold = threshold * static_cast<float>(run_misses) / static_cast<float>(end - begin);
+
+            cache.flush();
+            size_t cluster_begin  = begin;
+            size_t cluster_misses = 0;
+            clusters.push_back(begin);
+            for (size_t t = begin; t < end; ++t)
+            {
+                cluster_misses += cache.accessTriangle(indices + t * 3);
+
+                const float acmr = static_cast<float>(cluster_misses) / static_cast<float>(t - cluster_begin + 1);
+                if (acmr <= run_threshold && t + 1 < end)
+                {
+                    clusters.push_back(t + 1);
+                    cluster_begin  = t + 1;
+                    cluster_misses = 0;
+                    cache.flush();
+                }
+            }
+        }
+        clusters.push_back(triangle_count);
+
+        const size_t cluster_count = clusters.size() - 1;
+        if (cluster_count < 2)
+            return;
+
+        glm::vec3 mesh_centroid(0.0f);
+        for (size_t i = 0; i < index_count; ++i)
+            mesh_centroid += readPosition(positions, position_stride, indices[i]);
+        mesh_centroid /= static_cast<float>(index_count);
+
+        // sort key: how far the cluster sits out along its own average normal
+        std::vector<float> sort_keys(cluster_count, 0.0f);
+        for (size_t c = 0; c < cluster_count; ++c)
+        {
+            glm::vec3 centroid(0.0f);
+            glm::vec3 normal(0.0f);
+            float     area_sum = 0.0f;
+            for (size_t t = clusters[c]; t < clusters[c + 1]; ++t)
+            {
+                const glm::vec3 p0 = readPosition(positions, position_stride, indices[t * 3 + 0]);
+                const glm::vec3 p1 = readPosition(positions, position_stride, indices[t * 3 + 1]);
+                const glm::vec3 p2 = readPosition(positions, position_stride, indices[t * 3 + 2]);
+
+                const glm::vec3 n    = glm::cross(p1 - p0, p2 - p0);
+                const float     area = glm::length(n);
+                centroid += (p0 + p1 + p2) * (area / 3.0f);
+                normal += n;
+                area_sum += area;
+            }
+
+            const float normal_length = glm::length(normal);
+            if (area_sum > 0.0f && normal_length > 0.0f)
+                sort_keys[c] = glm::dot(centroid / area_sum - mesh_centroid, normal / normal_length);
+        }
+
+        std::vector<uint32_t> order(cluster_count);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(
+            order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sort_keys[a] > sort_keys[b]; });
+
+        std::vector<uint32_t> result;
+        result.reserve(triangle_count * 3);
+        for (uint32_t c : order)
+            result.insert(result.end(), indices + clusters[c] * 3, indices + clusters[c + 1] * 3);
+
+        std::copy(result.begin(), result.end(), indices);
+    }
+
+    std::vector<uint32_t> MeshOptimizer::optimizeVertexFetch(uint32_t* indices, size_t index_count, size_t vertex_count)
+    {
+        std::vector<uint32_t> remap(vertex_count, INVALID_INDEX);
+        uint32_t              next = 0;
+        for (size_t i = 0; i < index_count; ++i)
+        {
+            uint32_t& mapped = remap[indices[i]];
+            if (mapped == INVALID_INDEX)
+                mapped = next++;
+            indices[i] = mapped;
+        }
+
+        for (auto& mapped : remap)
+            if (mapped == INVALID_INDEX)
+                mapped = next++;
+
+        return remap;
+    }
+
+    MeshOptimizer::Report MeshOptimizer::optimize(Mesh& mesh, float overdraw_threshold)
+    {
+        Report report;
+
+        std::vector<Vertex>   vertices = std::move(mesh.getVertices());
+        std::vector<uint32_t> indices  = std::move(mesh.getIndices());
+
+        const bool in_range = std::all_of(
+            indices.begin(), indices.end(), [&](uint32_t index) { return index < vertices.size(); });
+        if (!vertices.empty() && !indices.empty() && in_range)
+        {
+            report.before = analyzeVertexCache(indices.data(), indices.size(), vertices.size());
+
+            // each submesh is reordered within its own range so material ranges stay intact
+            for (const auto& submesh : mesh.getSubMeshes())
+            {
+                if (!submesh.isValid() || submesh.getEndIndex() > indices.size())
+                    continue;
+
+                uint32_t* range = indices.data() + submesh.base_index;
+                optimizeVertexCache(range, submesh.index_count, vertices.size());
+                optimizeOverdraw(range,
+                                 submesh.index_count,
+                                 reinterpret_cast<const float*>(&vertices[0].position),
+                                 sizeof(Vertex),
+                                 vertices.size(),
+                                 overdraw_threshold);
+            }
+
+            remapVertices(vertices, optimizeVertexFetch(indices.data(), indices.size(), vertices.size()));
+
+            report.after = analyzeVertexCache(indices.data(), indices.size(), vertices.size());
+        }
+
+        mesh.setVertices(std::move(vertices));
+        mesh.setIndices(std::move(indices));
+        return report;
+    }
+} // namespace RealmEngine
@@ -0,0 +1,440 @@
+#include "mesh_simplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+#include "glm/common.hpp"
+#include "glm/geometric.hpp"
+#include "resource/processor/mesh_optimizer.h"
+
+namespace RealmEngine
+{
+    namespace
+    {
+        constexpr uint32_t INVALID_INDEX = 0xFFFFFFFFu;
+
+        enum class VertexKind : uint8_t
+        {
+            Manifold, // interior vertex with a single attribute set, free to collapse
+            Locked,   // border, non-manifold or seam vertex, never moves
+        };
+
+        struct Quadric
+        {
+            double a00 {0}, a11 {0}, a22 {0};
+            double a01 {0}, a02 {0}, a12 {0};
+            double b0 {0}, b1 {0}, b2 {0};
+            double c {0};
+            double weight {0};
+
+            void addPlane(const glm::vec3& n, float d, float w)
+            {
+                a00 += w * n.x * n.x;
+                a11 += w * n.y * n.y;
+                a22 += w * n.z * n.z;
+                a01 += w * n.x * n.y;
+                a02 += w * n.x * n.z;
+                a12 += w * n.y * n.z;
+                b0 += w * n.x * d;
+                b1 += w * n.y * d;
+                b2 += w * n.z * d;
+                c += w * d * d;
+                weight += w;
+            }
+
+            void add(const Quadric& q)
+            {
+                a00 += q.a00;
+                a11 += q.a11;
+                a22 += q.a22;
+                a01 += q.a01;
+                a02 += q.a02;
+                a12 += q.a12;
+                b0 += q.b0;
+                b1 += q.b1;
+                b2 += q.b2;
+                c += q.c;
+                weight += q.weight;
+            }
+
+            // area weighted sum of squared plane distances
+            double evaluate(const glm::vec3& p) const
+            {
+                const double x = p.x, y = p.y, z = p.z;
+                double       r = a00 * x * x + a11 * y * y + a22 * z * z;
+                r += 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z);
+                r += 2.0 * (b0 * x + b1 * y + b2 * z);
+                r += c;
+                return std::max(r, 0.0);
+            }
+        };
+
+        struct PositionHasher
+        {
+            size_t operator()(const glm::vec3& p) const
+            {
+                uint32_t bits[3];
+                std::memcpy(bits, &p, sizeof(bits));
+                return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+            }
+        };
+
+        struct PositionEqual
+        {
+            bool operator()(const glm::vec3& a, const glm::vec3& b) const
+            {
+                return std::memcmp(&a, &b, sizeof(glm::vec3)) == 0;
+            }
+        };
+
+        struct Collapse
+        {
+            uint32_t from; // vertex (not canonical) that disappears
+            uint32_t to;
+            float    cost; // squared distance
+        };
+
+        uint64_t edgeKey(uint32_t a, uint32_t b) { return (static_cast<uint64_t>(a) << 32) | b; }
+    } // namespace
+
+    std::vector<uint32_t> MeshSimplifier::simplify(const uint32_t* indices,
+                                                   size_t          index_count,
+                                                   const float*    positions,
+                                                   size_t          position_stride,
+                                                   size_t          vertex_count,
+                                                   size_t          target_index_count,
+                                                   float           target_error,
+                                                   float*          result_error)
+    {
+        std::vector<uint32_t> current(indices, indices + index_count / 3 * 3);
+        if (result_error)
+            *result_error = 0.0f;
+        if (current.size() <= target_index_count || vertex_count == 0)
+            return current;
+
+        auto position = [&](uint32_t vertex) {
+            const float* p = reinterpret_cast<const float*>(reinterpret_cast<const unsigned char*>(positions) +
+                                                            vertex * position_stride);
+            return glm::vec3(p[0], p[1], p[2]);
+        };
+
+        // vertices sharing a position are wedges of one canonical vertex
+        std::vector<uint32_t> canonical(vertex_count, INVALID_INDEX);
+        std::vector<uint32_t> wedge_count(vertex_count, 0);
+        {
+            std::unordered_map<glm::vec3, uint32_t, PositionHasher, PositionEqual> position_map;
+            position_map.reserve(current.size() / 3);
+            for (uint32_t vertex : current)
+            {
+                if (canonical[vertex] != INVALID_INDEX)
+                    continue;
+                auto [it, inserted] = position_map.try_emplace(position(vertex), vertex);
+                canonical[vertex]   = it->second;
+                ++wedge_count[it->second];
+            }
+        }
+
+        // lock seams, borders and non-manifold edges: every directed edge must have exactly one twin
+        std::vector<VertexKind> kind(vertex_count, VertexKind::Manifold);
+        {
+            std::unordered_map<uint64_t, uint32_t> edges;
+            edges.reserve(current.size());
+            for (size_t i = 0; i < current.size(); i += 3)
+                for (int k = 0; k < 3; ++k)
+                    ++edges[edgeKey(canonical[current[i + k]], canonical[current[i + (k + 1) % 3]])];
+
+            for (const auto& [key, count] : edges)
+            {
+                const uint32_t a    = static_cast<uint32_t>(key >> 32);
+                const uint32_t b    = static_cast<uint32_t>(key & 0xFFFFFFFFu);
+                auto           twin = edges.find(edgeKey(b, a));
+                if (count != 1 || twin == edges.end() || twin->second != 1)
+                {
+                    kind[a] = VertexKind::Locked;
+                    kind[b] = VertexKind::Locked;
+                }
+            }
+            for (size_t v = 0; v < vertex_count; ++v)
+                if (wedge_count[v] > 1)
+                    kind[v] = VertexKind::Locked;
+        }
+
+        // plane quadrics, area weighted
+        std::vector<Quadric> quadrics(vertex_count);
+        for (size_t i = 0; i < current.size(); i += 3)
+        {
+            const uint32_t  c0 = canonical[current[i]], c1 = canonical[current[i + 1]], c2 = canonical[current[i + 2]];
+            const glm::vec3 p0 = position(c0), p1 = position(c1), p2 = position(c2);
+
+            glm::vec3   n    = glm::cross(p1 - p0, p2 - p0);
+            const float area = glm::length(n);
+            if (area <= 0.0f)
+                continue;
+            n /= area;
+
+            const float d = -glm::dot(n, p0);
+            quadrics[c0].addPlane(n, d, area * 0.5f);
+            quadrics[c1].addPlane(n, d, area * 0.5f);
+            quadrics[c2].addPlane(n, d, area * 0.5f);
+        }
+
+        auto collapseCost = [&](uint32_t from, uint32_t to) {
+            Quadric q = quadrics[from];
+            q.add(quadrics[to]);
+            return q.weight > 0.0 ? static_cast<float>(q.evaluate(position(to)) / q.weight) : 0.0f;
+        };
+
+        const float           max_cost = target_error * target_error;
+        float                 reached  = 0.0f;
+        std::vector<uint32_t> remap(vertex_count, INVALID_INDEX);
+        std::vector<uint8_t>  pass_locked(vertex_count, 0);
+        std::vector<uint32_t> tri_offsets(vertex_count + 1);
+        std::vector<uint32_t> tri_list;
+        std::vector<Collapse> collapses;
+
+        while (current.size() > target_index_count)
+        {
+            const size_t triangle_count = current.size() / 3;
+
+            // canonical vertex -> triangles
+            std::fill(tri_offsets.begin(), tri_offsets.end(), 0);
+            for (uint32_t vertex : current)
+                ++tri_offsets[canonical[vertex] + 1];
+            for (size_t v = 0; v < vertex_count; ++v)
+                tri_offsets[v + 1] += tri_offsets[v];
+            tri_list.resize(current.size());
+            {
+                std::vector<uint32_t> fill(tri_offsets.begin(), tri_offsets.end() - 1);
+                for (size_t i = 0; i < current.size(); ++i)
+                    tri_list[fill[canonical[current[i]]]++] = static_cast<uint32_t>(i / 3);
+            }
+
+            // one candidate per edge (manifold edges show up once per direction), in its cheaper direction
+            collapses.clear();
+            for (size_t i = 0; i < current.size(); i += 3)
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    const uint32_t v0 = current[i + k];
+                    const uint32_t v1 = current[i + (k + 1) % 3];
+                    const uint32_t c0 = canonical[v0];
+                    const uint32_t c1 = canonical[v1];
+                    if (c0 > c1)
+                        continue;
+
+                    const bool  movable0 = kind[c0] == VertexKind::Manifold;
+                    const bool  movable1 = kind[c1] == VertexKind::Manifold;
+                    const float cost0    = movable0 ? collapseCost(c0, c1) : 0.0f;
+                    const float cost1    = movable1 ? collapseCost(c1, c0) : 0.0f;
+                    if (movable0 && (!movable1 || cost0 <= cost1))
+                        collapses.push_back({v0, v1, cost0});
+                    else if (movable1)
+                        collapses.push_back({v1, v0, cost1});
+                }
+            }
+            if (collapses.empty())
+                break;
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+                return a.cost < b.cost;
+            });
+
+            // apply an independent set of the cheapest collapses
+            const size_t excess_triangles = triangle_count - target_index_count / 3;
+            size_t       removed          = 0;
+            size_t       applied          = 0;
+            std::fill(pass_locked.begin(), pass_locked.end(), 0);
+
+            for (const Collapse& collapse : collapses)
+            {
+                if (removed >= excess_triangles || collapse.cost > max_cost)
+                    break;
+
+                const uint32_t from = canonical[collapse.from];
+                const uint32_t to   = canonical[collapse.to];
+                if (pass_locked[from] || pass_locked[to])
+                    continue;
+
+                // reject collapses that would flip a triangle around from
+                const glm::vec3 to_position = position(to);
+                bool            flips       = false;
+                size_t          shared      = 0;
+                for (uint32_t j = tri_offsets[from]; j < tri_offsets[from + 1] && !flips; ++j)
+                {
+                    const uint32_t* tri = current.data() + tri_list[j] * 3;
+                    glm::vec3       p[3];
+                    glm::vec3       q[3];
+                    bool            has_to = false;
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        const uint32_t c = canonical[tri[k]];
+                        has_to |= c == to;
+                        p[k] = position(c);
+                        q[k] = c == from ? to_position : p[k];
+                    }
+                    if (has_to)
+                    {
+                        ++shared;
+                        continue;
+                    }
+
+                    // also refuse large rotations: thin triangles can flip with a barely negative dot product
+                    const glm::vec3 n_old = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    const glm::vec3 n_new = glm::cross(q[1] - q[0], q[2] - q[0]);
+                    flips = glm::dot(n_old, n_new) <= 0.25f * glm::length(n_old) * glm::length(n_new);
+                }
+                if (flips)
+                    continue;
+
+                remap[collapse.from] = collapse.to;
+                quadrics[to].add(quadrics[from]);
+
+                // lock the one-ring so every triangle touched this pass sees up to date neighbours
+                for (uint32_t j = tri_offsets[from]; j < tri_offsets[from + 1]; ++j)
+                {
+                    const uint32_t* tri = current.data() + tri_list[j] * 3;
+                    for (int k = 0; k < 3; ++k)
+                        pass_locked[canonical[tri[k]]] = 1;
+                }
+
+                reached = std::max(reached, collapse.cost);
+                removed += shared;
+                ++applied;
+            }
+            if (applied == 0)
+                break;
+
+            // rewrite the index list and drop degenerate triangles
+            size_t write = 0;
+            for (size_t i = 0; i < current.size(); i += 3)
+            {
+                uint32_t tri[3];
+                for (int k = 0; k < 3; ++k)
+                {
+                    tri[k] = current[i + k];
+                    if (remap[tri[k]] != INVALID_INDEX)
+                        tri[k] = remap[tri[k]];
+                }
+
+                const uint32_t c0 = canonical[tri[0]], c1 = canonical[tri[1]], c2 = canonical[tri[2]];
+                if (c0 == c1 || c1 == c2 || c0 == c2)
+                    continue;
+
+                current[write++] = tri[0];
+                current[write++] = tri[1];
+                current[write++] = tri[2];
+            }
+            current.resize(write);
+            std::fill(remap.begin(), remap.end(), INVALID_INDEX);
+        }
+
+        if (result_error)
+            *result_error = std::sqrt(reached);
+        return current;
+    }
+
+    std::vector<MeshLod> MeshSimplifier::generateLods(std::vector<uint32_t>& indices,
+                                                      uint32_t               base_index,
+                                                      uint32_t               index_count,
+                                                      const float*           positions,
+                                                      size_t                 position_stride,
+                                                      size_t                 vertex_count,
+                                                      const Settings&        settings)
+    {
+        std::vector<MeshLod> lods;
+        if (settings.lod_count == 0 || index_count < 6 || base_index + index_count > indices.size())
+            return lods;
+
+        // copy: appending levels may reallocate indices
+        const std::vector<uint32_t> source(indices.begin() + base_index, indices.begin() + base_index + index_count);
+
+        glm::vec3 bounds_min(0.0f);
+        glm::vec3 bounds_max(0.0f);
+        for (size_t i = 0; i < source.size(); ++i)
+        {
+            const float* p = reinterpret_cast<const float*>(reinterpret_cast<const unsigned char*>(positions) +
+                                                            source[i] * position_stride);
+            const glm::vec3 position(p[0], p[1], p[2]);
+            bounds_min = i == 0 ? position : glm::min(bounds_min, position);
+            bounds_max = i == 0 ? position : glm::max(bounds_max, position);
+        }
+        const glm::vec3 extent = bounds_max - bounds_min;
+        const float     scale  = std::max(extent.x, std::max(extent.y, extent.z));
+        if (scale <= 0.0f)
+            return lods;
+
+        size_t previous_count = source.size();
+        float  previous_error = 0.0f;
+        for (uint32_t level = 0; level < settings.lod_count; ++level)
+        {
+            const size_t target = static_cast<size_t>(previous_count * settings.reduction) / 3 * 3;
+            if (target < 3)
+                break;
+
+            // always simplify from LOD 0 so the stored error is measured against the full detail surface
+            float                 error = 0.0f;
+            std::vector<uint32_t> lod   = simplify(source.data(),
+                                                 source.size(),
+                                                 positions,
+                                                 position_stride,
+                                                 vertex_count,
+                                                 target,
+                                                 settings.max_error * scale,
+                                                 &error);
+
+            // stop once a level saves less than 10%, it would only cost memory
+            if (lod.size() * 10 > previous_count * 9)
+                break;
+
+            MeshOptimizer::optimizeVertexCache(lod.data(), lod.size(), vertex_count);
+
+            MeshLod range;
+            range.base_index  = static_cast<uint32_t>(indices.size());
+            range.index_count = static_cast<uint32_t>(lod.size());
+            range.error       = std::max(error, previous_error);
+            indices.insert(indices.end(), lod.begin(), lod.end());
+            lods.push_back(range);
+
+            previous_count = lod.size();
+            previous_error = range.error;
+        }
+
+        return lods;
+    }
+
+    void MeshSimplifier::generateLods(Mesh& mesh, const Settings& settings)
+    {
+        std::vector<uint32_t> indices = std::move(mesh.getIndices());
+        std::vector<MeshLod>& lods    = mesh.getLods();
+        lods.clear();
+
+        // drop levels from a previous run, they live after every submesh range
+        size_t lod0_end = 0;
+        for (const auto& submesh : mesh.getSubMeshes())
+            lod0_end = std::max<size_t>(lod0_end, submesh.getEndIndex());
+        if (lod0_end < indices.size())
+            indices.resize(lod0_end);
+
+        const std::vector<Vertex>& vertices = mesh.getVertices();
+        for (auto& submesh : mesh.getSubMeshes())
+        {
+            submesh.lod_offset = static_cast<uint32_t>(lods.size());
+            submesh.lod_count  = 0;
+            if (!submesh.isValid() || vertices.empty())
+                continue;
+
+            std::vector<MeshLod> chain = generateLods(indices,
+                                                      submesh.base_index,
+                                                      submesh.index_count,
+                                                      reinterpret_cast<const float*>(&vertices[0].position),
+                                                      sizeof(Vertex),
+                                                      vertices.size(),
+                                                      settings);
+
+            submesh.lod_count = static_cast<uint32_t>(chain.size());
+            lods.insert(lods.end(), chain.begin(), chain.end());
+        }
+
+        mesh.setIndices(std::move(indices));
+    }
+} // namespace RealmEngine
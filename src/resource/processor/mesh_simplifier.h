@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "resource/datatype/model/mesh.h"
+
+namespace RealmEngine
+{
+    /**
+     * Quadric error metric simplification (Garland & Heckbert) by half-edge collapses onto existing vertices,
+     * so every level shares the vertex buffer of LOD 0 and only adds indices.
+     *
+     * Borders, non-manifold edges and attribute seams (several vertices at one position) are kept in place,
+     * which preserves silhouettes of open meshes and avoids UV tearing at the cost of some reduction.
+     */
+    class MeshSimplifier
+    {
+    public:
+        struct Settings
+        {
+            uint32_t lod_count {3};     // levels generated below LOD 0
+            float    reduction {0.5f};  // triangle ratio between consecutive levels
+            float    max_error {0.05f}; // relative to the largest extent of the range, no level goes beyond it
+        };
+
+        /**
+         * Collapses edges of one index range until it has at most target_index_count indices or the next collapse
+         * would exceed target_error (an object-space distance). result_error receives the largest error reached.
+         */
+        static std::vector<uint32_t> simplify(const uint32_t* indices,
+                                              size_t          index_count,
+                                              const float*    positions,
+                                              size_t          position_stride,
+                                              size_t          vertex_count,
+                                              size_t          target_index_count,
+                                              float           target_error,
+                                              float*          result_error = nullptr);
+
+        // Appends the LOD levels of [base_index, base_index + index_count) to indices and returns them, coarsest last.
+        static std::vector<MeshLod> generateLods(std::vector<uint32_t>& indices,
+                                                 uint32_t               base_index,
+                                                 uint32_t               index_count,
+                                                 const float*           positions,
+                                                 size_t                 position_stride,
+                                                 size_t                 vertex_count,
+                                                 const Settings&        settings);
+
+        // Rebuilds the LOD chain of every submesh, replacing any previous one.
+        static void generateLods(Mesh& mesh, const Settings& settings);
+    };
+} // namespace RealmEngine
@@ -0,0 +1,68 @@
+#include "model_deduplicator.h"
+#include "utils.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace RealmEngine
+{
+    ModelDeduplicator::Remap ModelDeduplicator::deduplicateMaterials(Model& model)
+    {
+        std::vector<uint64_t> hashes(model.getMaterialCount());
+        for (size_t i = 0; i < hashes.size(); ++i)
+            hashes[i] = model.getMaterial(i).hash();
+
+        Remap result = group(hashes, [&](uint32_t a, uint32_t b) {
+            return model.getMaterial(a) == model.getMaterial(b);
+        });
+        if (result.isIdentity())
+            return result;
+
+        std::vector<Material> kept;
+        kept.reserve(result.sources.size());
+        for (uint32_t source : result.sources)
+            kept.push_back(std::move(model.getMaterial(source)));
+
+        model.clearMaterials();
+        for (Material& material : kept)
+            model.addMaterial(std::move(material));
+
+        debug("Merged " + std::to_string(result.getDuplicateCount()) + " duplicate material(s), " +
+              std::to_string(result.sources.size()) + " left");
+        return result;
+    }
+
+    void ModelDeduplicator::remapNodeMeshes(Node& root, const std::vector<uint32_t>& remap)
+    {
+        std::vector<Node*> stack {&root};
+        while (!stack.empty())
+        {
+            Node* node = stack.back();
+            stack.pop_back();
+
+            if (node->hasMeshes())
+            {
+                std::vector<uint32_t> indices = node->getMeshIndices();
+                for (uint32_t& index : indices)
+                {
+                    if (index < remap.size())
+                        index = remap[index];
+                }
+                node->setMeshIndices(indices);
+            }
+
+            for (const std::unique_ptr<Node>& child : node->getChildren())
+                stack.push_back(child.get());
+        }
+    }
+
+    void ModelDeduplicator::remapMaterials(Mesh& mesh, const std::vector<uint32_t>& remap)
+    {
+        for (SubMesh& submesh : mesh.getSubMeshes())
+        {
+            if (submesh.material_idx < remap.size())
+                submesh.material_idx = remap[submesh.material_idx];
+        }
+    }
+} // namespace RealmEngine
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "resource/datatype/model/mesh.h"
+#include "resource/datatype/model/model.h"
+#include "resource/datatype/model/node.h"
+
+namespace RealmEngine
+{
+    /**
+     * Collapses byte-identical materials and meshes of one import, so a kit-bashed scene that copies the same
+     * mesh under many nodes keeps one Mesh (one upload, one set of GPU buffers) drawn at every node.
+     *
+     * Entries are grouped by a content hash and confirmed with a full comparison before merging, so a hash
+     * collision never merges different data. Meshes are merged from their source data, before conversion,
+     * which also skips converting and optimising the copies; the importers supply the hash and comparison.
+     */
+    class ModelDeduplicator
+    {
+    public:
+        struct Remap
+        {
+            std::vector<uint32_t> remap;   // source entry -> kept entry
+            std::vector<uint32_t> sources; // kept entry -> first source entry with its content
+
+            size_t getDuplicateCount() const { return remap.size() - sources.size(); }
+            bool   isIdentity() const { return getDuplicateCount() == 0; }
+        };
+
+        /**
+         * Merges entries whose hashes match and same(first, other) confirms, keeping the first of each group in
+         * source order. A hash of 0 keeps an entry apart, for entries that must not be shared.
+         */
+        template<typename Same>
+        static Remap group(const std::vector<uint64_t>& hashes, Same&& same)
+        {
+            Remap result;
+            result.remap.resize(hashes.size());
+
+            std::unordered_multimap<uint64_t, uint32_t> kept;
+            kept.reserve(hashes.size());
+            for (uint32_t i = 0; i < hashes.size(); ++i)
+            {
+                uint32_t target = static_cast<uint32_t>(result.sources.size());
+                if (hashes[i] != 0)
+                {
+                    auto [begin, end] = kept.equal_range(hashes[i]);
+                    for (auto it = begin; it != end; ++it)
+                    {
+                        if (same(result.sources[it->second], i))
+                        {
+                            target = it->second;
+                            break;
+                        }
+                    }
+                }
+
+                if (target == result.sources.size())
+                {
+                    if (hashes[i] != 0)
+                        kept.emplace(hashes[i], target);
+                    result.sources.push_back(i);
+                }
+                result.remap[i] = target;
+            }
+            return result;
+        }
+
+        // Merges identical materials of model in place, returning where each former material went.
+        static Remap deduplicateMaterials(Model& model);
+
+        // Rewrites the mesh indices of every node under root.
+        static void remapNodeMeshes(Node& root, const std::vector<uint32_t>& remap);
+        // Rewrites the submesh material indices; an empty remap leaves them alone.
+        static void remapMaterials(Mesh& mesh, const std::vector<uint32_t>& remap);
+    };
+} // namespace RealmEngine
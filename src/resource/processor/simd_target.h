@@ -0,0 +1,16 @@
+#pragma once
+
+// Compiler side of the SIMD kernels, shared by every translation unit that has some.
+// REALM_KERNELS_X86 is defined when SSE2 intrinsics are available, which x86-64 guarantees. Functions marked
+// REALM_TARGET_AVX2 may use AVX2 intrinsics and must only be called after MeshKernels::getSimdLevel() says so;
+// MSVC accepts the intrinsics anywhere, GCC and Clang need the target attribute.
+#if defined(__x86_64__) || defined(_M_X64)
+#define REALM_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define REALM_TARGET_AVX2
+#else
+#define REALM_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
@@ -0,0 +1,610 @@
+#include "resource/processor/texture_encoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include "thread_pool.h"
+
+namespace RealmEngine
+{
+    namespace
+    {
+        constexpr size_t BLOCK_TEXELS = 16;
+        constexpr size_t ROW_GRAIN    = 4; // block rows per parallel chunk
+
+        struct Vec4
+        {
+            float v[4] {};
+        };
+
+        // ===== Helpers =====
+
+        // Copies the 4x4 block at (bx, by), repeating edge texels of levels that aren't a multiple of 4.
+        void fetchBlock(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t bx, uint32_t by, uint8_t* block)
+        {
+            for (uint32_t y = 0; y < 4; ++y)
+            {
+                const uint32_t sy = std::min(by * 4 + y, height - 1);
+                for (uint32_t x = 0; x < 4; ++x)
+                {
+                    const uint32_t sx = std::min(bx * 4 + x, width - 1);
+                    std::memcpy(block + (y * 4 + x) * 4, rgba + (size_t(sy) * width + sx) * 4, 4);
+                }
+            }
+        }
+
+        // Principal axis of the block over the first `channels` channels, by power iteration on the covariance.
+        void principalAxis(const float (*texels)[4], int channels, Vec4& mean, Vec4& axis)
+        {
+            for (size_t i = 0; i < BLOCK_TEXELS; ++i)
+                for (int c = 0; c < channels; ++c)
+                    mean.v[c] += texels[i][c] / BLOCK_TEXELS;
+
+            float covariance[4][4] = {};
+            for (size_t i = 0; i < BLOCK_TEXELS; ++i)
+                for (int a = 0; a < channels; ++a)
+                    for (int b = 0; b < channels; ++b)
+                        covariance[a][b] += (texels[i][a] - mean.v[a]) * (texels[i][b] - mean.v[b]);
+
+            for (int c = 0; c < channels; ++c)
+                axis.v[c] = 1.0f;
+            for (int iteration = 0; iteration < 8; ++iteration)
+            {
+                Vec4  next;
+                float length = 0.0f;
+                for (int a = 0; a < channels; ++a)
+                {
+                    for (int b = 0; b < channels; ++b)
+                        next.v[a] += covariance[a][b] * axis.v[b];
+                    length = std::max(length, std::fabs(next.v[a]));
+                }
+                if (length < 1e-6f) // flat block, any axis will do
+                    return;
+                for (int c = 0; c < channels; ++c)
+                    axis.v[c] = next.v[c] / length;
+            }
+        }
+
+        // Endpoints of the block along its principal axis.
+        void axisEndpoints(const float (*texels)[4], int channels, Vec4& e0, Vec4& e1)
+        {
+            Vec4 mean, axis;
+            principalAxis(texels, channels, mean, axis);
+
+            float norm = 0.0f;
+            for (int c = 0; c < channels; ++c)
+                norm += axis.v[c] * axis.v[c];
+            if (norm > 0.0f)
+                for (int c = 0; c < channels; ++c)
+                    axis.v[c] /= norm;
+
+            float t_min = 0.0f, t_max = 0.0f;
+            for (size_t i = 0; i < BLOCK_TEXELS; ++i)
+            {
+                float t = 0.0f;
+                for (int c = 0; c < channels; ++c)
+                    t += (texels[i][c] - mean.v[c]) * axis.v[c];
+                t_min = std::min(t_min, t);
+                t_max = std::max(t_max, t);
+            }
+
+            for (int c = 0; c < channels; ++c)
+            {
+                e0.v[c] = std::clamp(mean.v[c] + axis.v[c] * t_max, 0.0f, 255.0f);
+                e1.v[c] = std::clamp(mean.v[c] + axis.v[c] * t_min, 0.0f, 255.0f);
+            }
+        }
+
+        /**
+         * Least squares endpoints for fixed palette positions: texel i is weights[i] of the way from e0 to e1.
+         * Returns false when the system is singular (every texel on the same palette entry).
+         */
+        bool refineEndpoints(const float (*texels)[4], int channels, const float* weights, Vec4& e0, Vec4& e1)
+        {
+            float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+            Vec4  ax, bx;
+            for (size_t i = 0; i < BLOCK_TEXELS; ++i)
+            {
+                const float b = weights[i], a = 1.0f - b;
+                aa += a * a, ab += a * b, bb += b * b;
+                for (int c = 0; c < channels; ++c)
+                    ax.v[c] += a * texels[i][c], bx.v[c] += b * texels[i][c];
+            }
+
+            const float determinant = aa * bb - ab * ab;
+            if (std::fabs(determinant) < 1e-6f)
+                return false;
+
+            for (int c = 0; c < channels; ++c)
+            {
+                e0.v[c] = std::clamp((ax.v[c] * bb - bx.v[c] * ab) / determinant, 0.0f, 255.0f);
+                e1.v[c] = std::clamp((bx.v[c] * aa - ax.v[c] * ab) / determinant, 0.0f, 255.0f);
+            }
+            return true;
+        }
+
+        void writeLE16(uint8_t* out, uint16_t value)
+        {
+            out[0] = static_cast<uint8_t>(value);
+            out[1] = static_cast<uint8_t>(value >> 8);
+        }
+
+        // ===== BC4 =====
+
+        // Eight-value mode: e0 > e1, texels pick e0, e1 or one of six steps in between.
+        void encodeBC4(const uint8_t* block, size_t stride, uint8_t* out)
+        {
+            uint8_t lo = 255, hi = 0;
+            for (size_t i = 0; i < BLOCK_TEXELS; ++i)
+            {
+                lo = std::min(lo, block[i * stride]);
+                hi = std::max(hi, block[i * stride]);
+            }
+
+            out[0] = hi;
+            out[1] = lo;
+
+            uint64_t indices = 0;
+            if (hi != lo)
+            {
+                int palette[8] = {hi, lo};
+                for (int k = 1; k < 7; ++k)
+                    palette[k + 1] = ((7 - k) * hi + k * lo) / 7;
+
+                for (size_t i = 0; i < BLOCK_TEXELS; ++i)
+                {
+                    const int value = block[i * stride];
+                    uint64_t  best  = 0;
+                    int       error = 256;
+                    for (int k = 0; k < 8; ++k)
+                    {
+                        const int e = std::abs(palette[k] - value);
+                        if (e < error)
+                            error = e, best = static_cast<uint64_t>(k);
+                    }
+                    indices |= best << (3 * i);
+                }
+            }
+
+            for (int b = 0; b < 6; ++b)
+                out[2 + b] = static_cast<uint8_t>(indices >> (8 * b));
+        }
+
+        // ===== BC1 =====
+
+        uint16_t packColor565(const Vec4& color)
+        {
+            const auto r = static_cast<uint16_t>(std::lround(color.v[0] * 31.0f / 255.0f));
+            const auto g = static_cast<uint16_t>(std::lround(color.v[1] * 63.0f / 255.0f));
+            const auto b = static_cast<uint16_t>(std::lround(color.v[2] * 31.0f / 255.0f));
+            return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+        }
+
+        void unpackColor565(uint16_t packed, int* rgb)
+        {
+            const int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+            rgb[0]      = (r << 3) | (r >> 2);
+            rgb[1]      = (g << 2) | (g >> 4);
+            rgb[2]      = (b << 3) | (b >> 2);
+        }
+
+        // Picks the nearest of the four-color palette for each texel; returns the summed squared error.
+        int assignBC1(const float (*texels)[4], uint16_t c0, uint16_t c1, uint8_t* indices)
+        {
+            int palette[4][3];
+            unpackColor565(c0, palette[0]);
+            unpackColor565(c1, palette[1]);
+            for (int c = 0; c < 3; ++c)
+            {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+
+            int total = 0;
+            for (size_t i = 0; i < BLOCK_TEXELS; ++i)
+            {
+                int best_error = INT32_MAX;
+                for (uint8_t k = 0; k < 4; ++k)
+                {
+                    int error = 0;
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        const int d = palette[k][c] - static_cast<int>(texels[i][c]);
+                        error += d * d;
+                    }
+                    if (error < best_error)
+                        best_error = error, indices[i] = k;
+                }
+                total += best_error;
+            }
+            return total;
+        }
+
+        // Always four-color mode (c0 > c1), as BC3 requires.
+        void encodeBC1(const uint8_t* block, uint8_t* out)
+        {
+            float texels[BLOCK_TEXELS][4];
+            for (size_t i = 0; i < BLOCK_TEXELS; ++i)
+                for (int c = 0; c < 4; ++c)
+                    texels[i][c] = block[i * 4 + c];
+
+            Vec4 e0, e1;
+            axisEndpoints(texels, 3, e0, e1);
+
+            uint16_t c0 = packColor565(e0), c1 = packColor565(e1);
+            uint8_t  indices[BLOCK_TEXELS];
+            int      error = assignBC1(texels, c0, c1, indices);
+
+            // palette positions of the four indices, as the fraction of the way from c0 to c1
+            static constexpr float WEIGHTS[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+            float                  weights[BLOCK_TEXELS];
+            for (size_t i = 0; i < BLOCK_TEXELS; ++i)
+                weights[i] = WEIGHTS[indices[i]];
+
+            if (refineEndpoints(texels, 3, weights, e0, e1))
+            {
+                const uint16_t r0 = packColor565(e0), r1 = packColor565(e1);
+                uint8_t        refined[BLOCK_TEXELS];
+                const int      refined_error = assignBC1(texels, r0, r1, refined);
+                if (refined_error < error)
+                {
+                    c0 = r0, c1 = r1, error = refined_error;
+                    std::memcpy(indices, refined, sizeof(indices));
+                }
+            }
+
+            if (c0 < c1)
+            {
+                std::swap(c0, c1);
+                for (auto& index : indices)
+                    index ^= 1; // 0 <-> 1 and 2 <-> 3
+            }
+            else if (c0 == c1)
+            {
+                std::memset(indices, 0, sizeof(indices));
+            }
+
+            uint32_t bits = 0;
+            for (size_t i = 0; i < BLOCK_TEXELS; ++i)
+                bits |= static_cast<uint32_t>(indices[i]) << (2 * i);
+
+            writeLE16(out, c0);
+            writeLE16(out + 2, c1);
+            writeLE16(out + 4, static_cast<uint16_t>(bits));
+            writeLE16(out + 6, static_cast<uint16_t>(bits >> 16));
+        }
+
+        // ===== BC7 mode 6 =====
+
+        constexpr int BC7_WEIGHTS[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+        struct BC7Candidate
+        {
+            int     endpoints[2][4]; // 7-bit
+            int     pbits[2];
+            uint8_t indices[BLOCK_TEXELS];
+            int     error {INT32_MAX};
+        };
+
+        // Quantizes one endpoint with the p-bit that lands closest to it.
+        void quantizeBC7Endpoint(const Vec4& endpoint, int* quantized, int& pbit)
+        {
+            float best_error = -1.0f;
+            for (int p = 0; p < 2; ++p)
+            {
+                int   q[4];
+                float error = 0.0f;
+                for (int c = 0; c < 4; ++c)
+                {
+                    q[c]          = std::clamp(static_cast<int>(std::lround((endpoint.v[c] - p) / 2.0f)), 0, 127);
+                    const float d = static_cast<float>((q[c] << 1) | p) - endpoint.v[c];
+                    error += d * d;
+                }
+                if (best_error < 0.0f || error < best_error)
+                {
+                    best_error = error;
+                    pbit       = p;
+                    std::memcpy(quantized, q, sizeof(q));
+                }
+            }
+        }
+
+        // Quantizes e0/e1 and assigns every texel its nearest palette entry; keeps the result if it beats best.
+        void fitBC7(const float (*texels)[4], const Vec4& e0, const Vec4& e1, BC7Candidate& best)
+        {
+            BC7Candidate candidate;
+            quantizeBC7Endpoint(e0, candidate.endpoints[0], candidate.pbits[0]);
+            quantizeBC7Endpoint(e1, candidate.endpoints[1], candidate.pbits[1]);
+
+            int palette[16][4];
+            for (int c = 0; c < 4; ++c)
+            {
+                const int lo = (candidate.endpoints[0][c] << 1) | candidate.pbits[0];
+                const int hi = (candidate.endpoints[1][c] << 1) | candidate.pbits[1];
+                for (int k = 0; k < 16; ++k)
+                    palette[k][c] = ((64 - BC7_WEIGHTS[k]) * lo + BC7_WEIGHTS[k] * hi + 32) >> 6;
+            }
+
+            candidate.error = 0;
+            for (size_t i = 0; i < BLOCK_TEXELS && candidate.error < best.error; ++i)
+            {
+                int best_error = INT32_MAX;
+                for (uint8_t k = 0; k < 16; ++k)
+                {
+                    int error = 0;
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        const int d = palette[k][c] - static_cast<int>(texels[i][c]);
+                        error += d * d;
+                    }
+                    if (error < best_error)
+                        best_error = error, candidate.indices[i] = k;
+                }
+                candidate.error += best_error;
+            }
+
+            if (candidate.error < best.error)
+                best = candidate;
+        }
+
+        class BitWriter
+        {
+        public:
+            explicit BitWriter(uint8_t* out) : m_out(out) { std::memset(m_out, 0, 16); }
+
+            void write(uint32_t value, int bits)
+            {
+                for (int b = 0; b < bits; ++b, ++m_position)
+                    if (value & (1u << b))
+                        m_out[m_position >> 3] |= static_cast<uint8_t>(1u << (m_position & 7));
+            }
+
+        private:
+            uint8_t* m_out;
+            int      m_position {0};
+        };
+
+        void encodeBC7(const uint8_t* block, uint8_t* out)
+        {
+            float texels[BLOCK_TEXELS][4];
+            for (size_t i = 0; i < BLOCK_TEXELS; ++i)
+                for (int c = 0; c < 4; ++c)
+                    texels[i][c] = block[i * 4 + c];
+
+            Vec4 e0, e1;
+            axisEndpoints(texels, 4, e1, e0); // e0 is the low end, so index 0 tends to satisfy the anchor rule
+
+            BC7Candidate best;
+            fitBC7(texels, e0, e1, best);
+
+            if (best.error > 0)
+            {
+                float weights[BLOCK_TEXELS];
+                for (size_t i = 0; i < BLOCK_TEXELS; ++i)
+                    weights[i] = BC7_WEIGHTS[best.indices[i]] / 64.0f;
+                if (refineEndpoints(texels, 4, weights, e0, e1))
+                    fitBC7(texels, e0, e1, best);
+            }
+
+            // the anchor texel stores its index with 3 bits, so its top bit has to be 0
+            if (best.indices[0] & 8)
+            {
+                std::swap(best.endpoints[0], best.endpoints[1]);
+                std::swap(best.pbits[0], best.pbits[1]);
+                for (auto& index : best.indices)
+                    index = static_cast<uint8_t>(15 - index);
+            }
+
+            BitWriter writer(out);
+            writer.write(1u << 6, 7); // mode 6
+            for (int c = 0; c < 4; ++c)
+            {
+                writer.write(static_cast<uint32_t>(best.endpoints[0][c]), 7);
+                writer.write(static_cast<uint32_t>(best.endpoints[1][c]), 7);
+            }
+            writer.write(static_cast<uint32_t>(best.pbits[0]), 1);
+            writer.write(static_cast<uint32_t>(best.pbits[1]), 1);
+            writer.write(best.indices[0], 3);
+            for (size_t i = 1; i < BLOCK_TEXELS; ++i)
+                writer.write(best.indices[i], 4);
+        }
+
+        void encodeBlock(TextureFormat format, const uint8_t* block, uint8_t* out)
+        {
+            switch (format)
+            {
+                case TextureFormat::BC1:
+                    encodeBC1(block, out);
+                    break;
+                case TextureFormat::BC3:
+                    encodeBC4(block + 3, 4, out);
+                    encodeBC1(block, out + 8);
+                    break;
+                case TextureFormat::BC4:
+                    encodeBC4(block, 4, out);
+                    break;
+                case TextureFormat::BC5:
+                    encodeBC4(block, 4, out);
+                    encodeBC4(block + 1, 4, out + 8);
+                    break;
+                case TextureFormat::BC7:
+                    encodeBC7(block, out);
+                    break;
+                case TextureFormat::RGBA8:
+                    break;
+            }
+        }
+
+        // ===== Mip filtering =====
+
+        float srgbToLinear(float value)
+        {
+            return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+        }
+
+        float linearToSrgb(float value)
+        {
+            return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+        }
+
+        uint8_t toByte(float value)
+        {
+            return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+        }
+    } // namespace
+
+    size_t CompressedTexture::getDataSize() const
+    {
+        size_t size = 0;
+        for (const auto& level : levels)
+            size += level.data.size();
+        return size;
+    }
+
+    size_t TextureEncoder::getBlockSize(TextureFormat format)
+    {
+        switch (format)
+        {
+            case TextureFormat::BC1:
+            case TextureFormat::BC4:
+                return 8;
+            case TextureFormat::BC3:
+            case TextureFormat::BC5:
+            case TextureFormat::BC7:
+                return 16;
+            case TextureFormat::RGBA8:
+                break;
+        }
+        return 0;
+    }
+
+    size_t TextureEncoder::getLevelSize(TextureFormat format, uint32_t width, uint32_t height)
+    {
+        if (format == TextureFormat::RGBA8)
+            return size_t(width) * height * 4;
+        return size_t((width + 3) / 4) * ((height + 3) / 4) * getBlockSize(format);
+    }
+
+    void TextureEncoder::compress(const uint8_t* rgba,
+                                  uint32_t       width,
+                                  uint32_t       height,
+                                  TextureFormat  format,
+                                  uint8_t*       out,
+                                  ThreadPool*    pool)
+    {
+        if (format == TextureFormat::RGBA8)
+        {
+            std::memcpy(out, rgba, getLevelSize(format, width, height));
+            return;
+        }
+
+        const uint32_t blocks_x   = (width + 3) / 4;
+        const uint32_t blocks_y   = (height + 3) / 4;
+        const size_t   block_size = getBlockSize(format);
+
+        auto encode_rows = [&](size_t begin, size_t end) {
+            uint8_t block[BLOCK_TEXELS * 4];
+            for (size_t by = begin; by < end; ++by)
+            {
+                for (uint32_t bx = 0; bx < blocks_x; ++bx)
+                {
+                    fetchBlock(rgba, width, height, bx, static_cast<uint32_t>(by), block);
+                    encodeBlock(format, block, out + (by * blocks_x + bx) * block_size);
+                }
+            }
+        };
+
+        if (pool)
+            pool->parallelFor(0, blocks_y, ROW_GRAIN, encode_rows);
+        else
+            encode_rows(0, blocks_y);
+    }
+
+    std::vector<uint8_t>
+    TextureEncoder::downsample(const uint8_t* rgba, uint32_t width, uint32_t height, const Settings& settings)
+    {
+        const uint32_t out_width  = std::max(width / 2, 1u);
+        const uint32_t out_height = std::max(height / 2, 1u);
+
+        static const auto srgb_table = []() {
+            std::vector<float> table(256);
+            for (int i = 0; i < 256; ++i)
+                table[i] = srgbToLinear(i / 255.0f);
+            return table;
+        }();
+
+        std::vector<uint8_t> result(size_t(out_width) * out_height * 4);
+        for (uint32_t y = 0; y < out_height; ++y)
+        {
+            for (uint32_t x = 0; x < out_width; ++x)
+            {
+                float sum[4] = {};
+                for (uint32_t dy = 0; dy < 2; ++dy)
+                {
+                    for (uint32_t dx = 0; dx < 2; ++dx)
+                    {
+                        const uint32_t sx    = std::min(x * 2 + dx, width - 1);
+                        const uint32_t sy    = std::min(y * 2 + dy, height - 1);
+                        const uint8_t* texel = rgba + (size_t(sy) * width + sx) * 4;
+                        for (int c = 0; c < 4; ++c)
+                            sum[c] += settings.srgb && c < 3 ? srgb_table[texel[c]] : texel[c] / 255.0f;
+                    }
+                }
+
+                uint8_t* texel = result.data() + (size_t(y) * out_width + x) * 4;
+                if (settings.normal_map)
+                {
+                    float n[3], length = 0.0f;
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        n[c] = sum[c] / 2.0f - 1.0f; // mean of 4 texels mapped to [-1, 1]
+                        length += n[c] * n[c];
+                    }
+                    length = length > 0.0f ? std::sqrt(length) : 1.0f;
+                    for (int c = 0; c < 3; ++c)
+                        texel[c] = toByte(n[c] / length * 0.5f + 0.5f);
+                }
+                else
+                {
+                    for (int c = 0; c < 3; ++c)
+                        texel[c] = toByte(settings.srgb ? linearToSrgb(sum[c] / 4.0f) : sum[c] / 4.0f);
+                }
+                texel[3] = toByte(sum[3] / 4.0f);
+            }
+        }
+        return result;
+    }
+
+    CompressedTexture TextureEncoder::encode(const uint8_t*  rgba,
+                                             uint32_t        width,
+                                             uint32_t        height,
+                                             const Settings& settings,
+                                             ThreadPool*     pool)
+    {
+        CompressedTexture texture;
+        texture.format = settings.format;
+        texture.srgb   = settings.srgb;
+
+        std::vector<uint8_t> mip;
+        const uint8_t*       source = rgba;
+        for (;;)
+        {
+            TextureLevel level;
+            level.width  = width;
+            level.height = height;
+            level.data.resize(getLevelSize(settings.format, width, height));
+            compress(source, width, height, settings.format, level.data.data(), pool);
+            texture.levels.push_back(std::move(level));
+
+            if (width == 1 && height == 1)
+                break;
+
+            mip    = downsample(source, width, height, settings);
+            source = mip.data();
+            width  = std::max(width / 2, 1u);
+            height = std::max(height / 2, 1u);
+        }
+        return texture;
+    }
+} // namespace RealmEngine
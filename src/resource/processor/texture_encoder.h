@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace RealmEngine
+{
+    class ThreadPool;
+
+    // Pixel formats of cooked textures. The BCn formats store 4x4 texel blocks.
+    enum class TextureFormat : uint8_t
+    {
+        RGBA8,
+        BC1, // RGB, 8 bytes per block
+        BC3, // RGBA, BC4 alpha + BC1 color, 16 bytes
+        BC4, // R, 8 bytes
+        BC5, // RG, two BC4 blocks, 16 bytes
+        BC7, // RGBA, 16 bytes
+    };
+
+    struct TextureLevel
+    {
+        uint32_t             width {0};
+        uint32_t             height {0};
+        std::vector<uint8_t> data;
+    };
+
+    struct CompressedTexture
+    {
+        TextureFormat             format {TextureFormat::RGBA8};
+        bool                      srgb {false};
+        std::vector<TextureLevel> levels; // full mip chain, largest first
+
+        size_t getDataSize() const;
+    };
+
+    /**
+     * CPU block compression to BC1/BC3/BC4/BC5/BC7, mip chain included.
+     *
+     * Endpoints come from the principal axis of each block and are refined once by least squares. BC7 only uses
+     * mode 6 (one subset, 7.7.7.7 endpoints with p-bits, 4-bit indices), which handles most blocks well and
+     * keeps encoding fast enough to run at load time; the result is cooked so it only happens once per source.
+     */
+    class TextureEncoder
+    {
+    public:
+        struct Settings
+        {
+            TextureFormat format {TextureFormat::BC7};
+            bool          srgb {false};       // mips are averaged in linear space
+            bool          normal_map {false}; // mips are renormalized
+        };
+
+        // bytes per 4x4 block, 0 for RGBA8
+        static size_t getBlockSize(TextureFormat format);
+        static size_t getLevelSize(TextureFormat format, uint32_t width, uint32_t height);
+
+        // rgba holds width * height texels of 4 bytes. Block rows are spread over the pool when one is given.
+        static CompressedTexture encode(const uint8_t*  rgba,
+                                        uint32_t        width,
+                                        uint32_t        height,
+                                        const Settings& settings,
+                                        ThreadPool*     pool = nullptr);
+
+        // Compresses one level into out, getLevelSize(format, width, height) bytes.
+        static void compress(const uint8_t* rgba,
+                             uint32_t       width,
+                             uint32_t       height,
+                             TextureFormat  format,
+                             uint8_t*       out,
+                             ThreadPool*    pool = nullptr);
+
+        // Box filtered half size level, at least 1x1.
+        static std::vector<uint8_t>
+        downsample(const uint8_t* rgba, uint32_t width, uint32_t height, const Settings& settings);
+    };
+} // namespace RealmEngine
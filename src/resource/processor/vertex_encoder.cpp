@@ -0,0 +1,174 @@
+#include "vertex_encoder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "glm/common.hpp"
+#include "glm/geometric.hpp"
+#include "glm/gtc/packing.hpp"
+
+namespace RealmEngine
+{
+    namespace
+    {
+        int16_t toSnorm16(float value)
+        {
+            return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+        }
+        int8_t toSnorm8(float value)
+        {
+            return static_cast<int8_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 127.0f));
+        }
+        uint16_t toUnorm16(float value)
+        {
+            return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+        }
+        uint8_t toUnorm8(float value)
+        {
+            return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+        }
+
+        float signNotZero(float value) { return value >= 0.0f ? 1.0f : -1.0f; }
+    } // namespace
+
+    VertexEncoding VertexEncoder::makeEncoding(const AABB& bounds, bool quantize_positions, bool skinned)
+    {
+        VertexEncoding encoding;
+        encoding.quantized_positions = quantize_positions;
+        encoding.skinned             = skinned;
+        encoding.stride              = encoding.getExpectedStride();
+        if (quantize_positions)
+        {
+            encoding.position_offset = bounds.min;
+            encoding.position_scale  = bounds.extent();
+        }
+        return encoding;
+    }
+
+    void VertexEncoder::encodeVertex(const VertexEncoding& encoding,
+                                     const glm::vec3&      position,
+                                     const glm::vec3&      normal,
+                                     const glm::vec2&      tex_coord,
+                                     const glm::vec3&      tangent,
+                                     const glm::vec3&      bitangent,
+                                     const glm::vec4&      color,
+                                     uint8_t*              out)
+    {
+        // position
+        if (encoding.quantized_positions)
+        {
+            PackedPosition packed {};
+            for (int c = 0; c < 3; ++c)
+            {
+                const float extent = encoding.position_scale[c];
+                const float t      = extent > 0.0f ? (position[c] - encoding.position_offset[c]) / extent : 0.0f;
+                packed.xyzw[c]     = toUnorm16(t);
+            }
+            std::memcpy(out, &packed, sizeof(packed));
+        }
+        else
+        {
+            const float raw[3] = {position.x, position.y, position.z};
+            std::memcpy(out, raw, sizeof(raw));
+        }
+
+        // attributes
+        PackedVertexAttributes attributes {};
+
+        const glm::vec2 oct_normal = encodeOctahedral(normal);
+        attributes.normal[0]       = toSnorm16(oct_normal.x);
+        attributes.normal[1]       = toSnorm16(oct_normal.y);
+
+        // the shader rebuilds the bitangent as cross(normal, tangent) * sign
+        const glm::vec2 oct_tangent = encodeOctahedral(tangent);
+        const float     handedness  = signNotZero(glm::dot(glm::cross(normal, tangent), bitangent));
+        attributes.tangent[0]       = toSnorm8(oct_tangent.x);
+        attributes.tangent[1]       = toSnorm8(oct_tangent.y);
+        attributes.tangent[2]       = toSnorm8(handedness);
+
+        attributes.tex_coord[0] = glm::packHalf1x16(tex_coord.x);
+        attributes.tex_coord[1] = glm::packHalf1x16(tex_coord.y);
+
+        for (int c = 0; c < 4; ++c)
+            attributes.color[c] = toUnorm8(color[c]);
+
+        std::memcpy(out + encoding.getAttributeOffset(), &attributes, sizeof(attributes));
+    }
+
+    void VertexEncoder::encodeSkin(const VertexEncoding& encoding,
+                                   const uint16_t        joints[4],
+                                   const glm::vec4&      weights,
+                                   uint8_t*              out)
+    {
+        PackedSkin skin {};
+
+        // rounding error goes to the largest weight, so the weights still add up to exactly one
+        int total   = 0;
+        int largest = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            skin.joints[i]  = joints[i];
+            skin.weights[i] = toUnorm8(weights[i]);
+            total += skin.weights[i];
+            if (weights[i] > weights[largest])
+                largest = i;
+        }
+        if (total > 0)
+            skin.weights[largest] = static_cast<uint8_t>(std::clamp(skin.weights[largest] + 255 - total, 0, 255));
+
+        std::memcpy(out + encoding.getSkinOffset(), &skin, sizeof(skin));
+    }
+
+    EncodedVertices VertexEncoder::encode(const std::vector<Vertex>& vertices,
+                                          const AABB&                bounds,
+                                          bool                       quantize_positions,
+                                          bool                       skinned)
+    {
+        EncodedVertices encoded;
+        encoded.encoding     = makeEncoding(bounds, quantize_positions, skinned);
+        encoded.vertex_count = static_cast<uint32_t>(vertices.size());
+        encoded.data.resize(vertices.size() * encoded.encoding.stride);
+
+        uint8_t* out = encoded.data.data();
+        for (const auto& vert : vertices)
+        {
+            encodeVertex(encoded.encoding,
+                         vert.position,
+                         vert.normal,
+                         vert.tex_coord,
+                         vert.tangent,
+                         vert.bitangent,
+                         vert.color,
+                         out);
+            if (skinned)
+                encodeSkin(encoded.encoding, vert.joints, vert.weights, out);
+            out += encoded.encoding.stride;
+        }
+        return encoded;
+    }
+
+    glm::vec2 VertexEncoder::encodeOctahedral(const glm::vec3& direction)
+    {
+        const float l1 = std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+        if (l1 <= 0.0f)
+            return glm::vec2(0.0f);
+
+        glm::vec3 n = direction / l1;
+        if (n.z < 0.0f)
+        {
+            // fold the lower hemisphere over the diagonals
+            const float x = (1.0f - std::abs(n.y)) * signNotZero(n.x);
+            const float y = (1.0f - std::abs(n.x)) * signNotZero(n.y);
+            return glm::vec2(x, y);
+        }
+        return glm::vec2(n.x, n.y);
+    }
+
+    glm::vec3 VertexEncoder::decodeOctahedral(const glm::vec2& encoded)
+    {
+        glm::vec3   n(encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+        const float t = std::max(-n.z, 0.0f);
+        n.x += n.x >= 0.0f ? -t : t;
+        n.y += n.y >= 0.0f ? -t : t;
+        return glm::normalize(n);
+    }
+} // namespace RealmEngine
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/ext/vector_float2.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
+#include <vector>
+#include "math.h"
+#include "resource/datatype/model/mesh.h"
+#include "resource/datatype/model/packed_vertex.h"
+
+namespace RealmEngine
+{
+    /**
+     * Encodes float vertices into the compact GPU layout described by VertexEncoding:
+     * octahedral normal (snorm16x2), octahedral tangent + bitangent sign (snorm8x4), half float UV,
+     * unorm8 color and either fp32 positions or unorm16 positions relative to the mesh bounds, followed by
+     * the joints and unorm8 weights for skinned meshes.
+     * A quantized vertex is 24 bytes (36 skinned), against 100 for Vertex.
+     */
+    class VertexEncoder
+    {
+    public:
+        static VertexEncoding makeEncoding(const AABB& bounds, bool quantize_positions, bool skinned = false);
+
+        static void encodeVertex(const VertexEncoding& encoding,
+                                 const glm::vec3&      position,
+                                 const glm::vec3&      normal,
+                                 const glm::vec2&      tex_coord,
+                                 const glm::vec3&      tangent,
+                                 const glm::vec3&      bitangent,
+                                 const glm::vec4&      color,
+                                 uint8_t*              out);
+        // Writes the skin of the vertex at out, for skinned encodings only.
+        static void encodeSkin(const VertexEncoding& encoding,
+                               const uint16_t        joints[4],
+                               const glm::vec4&      weights,
+                               uint8_t*              out);
+
+        static EncodedVertices encode(const std::vector<Vertex>& vertices,
+                                      const AABB&                bounds,
+                                      bool                       quantize_positions,
+                                      bool                       skinned = false);
+
+        // Unit vector <-> point in [-1, 1]^2 on the octahedron map.
+        static glm::vec2 encodeOctahedral(const glm::vec3& direction);
+        static glm::vec3 decodeOctahedral(const glm::vec2& encoded);
+    };
+} // namespace RealmEngine
@@ -0,0 +1,295 @@
+#include "vertex_welder.h"
+#include "hash.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <limits>
+
+#if defined(_MSC_VER) && !defined(__clang__) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+namespace RealmEngine
+{
+    namespace
+    {
+        constexpr size_t   VERTEX_GRAIN      = 16384; // vertices per chunk of the counting sort
+        constexpr uint32_t EMPTY_VERTEX      = std::numeric_limits<uint32_t>::max();
+        constexpr uint32_t PARTITION_BITS    = 6;
+        constexpr size_t   MIN_TABLE_SIZE    = 4096; // slots a partition table starts with
+        constexpr uint32_t PREFETCH_DISTANCE = 32;   // vertices the dedupe pass fetches ahead
+        constexpr float    MAX_CELL          = 2147483520.0f; // largest float below INT32_MAX
+
+        static_assert((1u << PARTITION_BITS) == VertexWelder::PARTITION_COUNT);
+
+        // a key is the vertex itself, word by word; only the joints aren't floats
+        constexpr size_t KEY_WORDS  = sizeof(Vertex) / sizeof(uint32_t);
+        constexpr size_t JOINT_WORD = offsetof(Vertex, joints) / sizeof(uint32_t);
+
+        static_assert(sizeof(Vertex) == 22 * sizeof(float) + sizeof(Vertex::joints),
+                      "Vertex must be padding free to be keyed by its words");
+
+        struct Key
+        {
+            uint32_t words[KEY_WORDS];
+
+            bool operator==(const Key& other) const { return std::memcmp(words, other.words, sizeof(words)) == 0; }
+        };
+
+        void forRange(ThreadPool*                                pool,
+                      size_t                                     begin,
+                      size_t                                     end,
+                      size_t                                     grain,
+                      const std::function<void(size_t, size_t)>& body)
+        {
+            if (pool)
+                pool->parallelFor(begin, end, grain, body);
+            else if (begin < end)
+                body(begin, end);
+        }
+
+        // Without an epsilon the key keeps the bit patterns, folding -0 into +0; with one it holds grid cells.
+        void makeKey(const Vertex& vertex, float inv_epsilon, Key& key)
+        {
+            std::memcpy(key.words, &vertex, sizeof(Vertex));
+            if (inv_epsilon == 0.0f)
+            {
+                for (uint32_t& word : key.words)
+                    word = (word << 1) == 0 ? 0 : word;
+            }
+            else
+            {
+                // cells past the int range, infinities included, share the edge cells and NaNs the lowest one;
+                // floored by hand and without branches, std::floor is a libm call below SSE4.1
+                for (uint32_t& word : key.words)
+                {
+                    float scaled;
+                    std::memcpy(&scaled, &word, sizeof(scaled));
+                    scaled *= inv_epsilon;
+                    scaled = scaled > -MAX_CELL ? scaled : -MAX_CELL;
+                    scaled = scaled < MAX_CELL ? scaled : MAX_CELL;
+
+                    const int32_t cell = static_cast<int32_t>(scaled);
+                    word               = static_cast<uint32_t>(cell - (static_cast<float>(cell) > scaled ? 1 : 0));
+                }
+            }
+            std::memcpy(&key.words[JOINT_WORD], vertex.joints, sizeof(vertex.joints));
+        }
+
+        void prefetch(const void* address)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(address);
+#elif defined(_M_X64) || defined(_M_IX86)
+            _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+            (void)address;
+#endif
+        }
+
+        size_t ceilPowerOfTwo(size_t value)
+        {
+            size_t result = 1;
+            while (result < value)
+                result *= 2;
+            return result;
+        }
+
+        uint32_t partitionOf(uint64_t hash) { return static_cast<uint32_t>(hash >> (64 - PARTITION_BITS)); }
+
+        // the vertex, hash bits the slot index doesn't use (most mismatches end there) and its key's index
+        struct Slot
+        {
+            uint32_t vertex;
+            uint32_t tag;
+            uint32_t key;
+        };
+
+        // doubles an open addressing table, returning the new mask
+        size_t grow(std::vector<Slot>& table, const uint64_t* hashes)
+        {
+            std::vector<Slot> grown(table.size() * 2, Slot {EMPTY_VERTEX, 0, 0});
+            const size_t      mask = grown.size() - 1;
+            for (const Slot& entry : table)
+            {
+                if (entry.vertex == EMPTY_VERTEX)
+                    continue;
+                size_t slot = static_cast<size_t>(hashes[entry.vertex]) & mask;
+                while (grown[slot].vertex != EMPTY_VERTEX)
+                    slot = (slot + 1) & mask;
+                grown[slot] = entry;
+            }
+            table.swap(grown);
+            return mask;
+        }
+    } // namespace
+
+    size_t VertexWelder::buildRemap(const Vertex*   vertices,
+                                    size_t          count,
+                                    const Settings& settings,
+                                    uint32_t*       remap,
+                                    ThreadPool*     pool)
+    {
+        if (count == 0)
+            return 0;
+
+        const float  inv_epsilon = settings.epsilon > 0.0f ? 1.0f / settings.epsilon : 0.0f;
+        const size_t chunk_count = (count + VERTEX_GRAIN - 1) / VERTEX_GRAIN;
+
+        // hash every vertex and count how many each chunk sends to each partition
+        std::vector<uint64_t> hashes(count);
+        std::vector<uint32_t> offsets(chunk_count * PARTITION_COUNT, 0);
+        forRange(pool, 0, chunk_count, 1, [&](size_t begin, size_t end) {
+            Key key;
+            for (size_t chunk = begin; chunk < end; ++chunk)
+            {
+                uint32_t*    counts = &offsets[chunk * PARTITION_COUNT];
+                const size_t last   = std::min(count, (chunk + 1) * VERTEX_GRAIN);
+                for (size_t i = chunk * VERTEX_GRAIN; i < last; ++i)
+                {
+                    makeKey(vertices[i], inv_epsilon, key);
+                    hashes[i] = Hash::hashBytes(key.words, sizeof(key.words));
+                    ++counts[partitionOf(hashes[i])];
+                }
+            }
+        });
+
+        // partition major prefix sum: each chunk's slice of a partition follows the previous chunk's, so the
+        // vertices of a partition come out in ascending order
+        std::vector<uint32_t> partition_begin(PARTITION_COUNT + 1, 0);
+        uint32_t              running = 0;
+        for (uint32_t partition = 0; partition < PARTITION_COUNT; ++partition)
+        {
+            partition_begin[partition] = running;
+            for (size_t chunk = 0; chunk < chunk_count; ++chunk)
+            {
+                uint32_t& slot = offsets[chunk * PARTITION_COUNT + partition];
+                uint32_t  size = slot;
+                slot           = running;
+                running += size;
+            }
+        }
+        partition_begin[PARTITION_COUNT] = running;
+
+        std::vector<uint32_t> order(count);
+        forRange(pool, 0, chunk_count, 1, [&](size_t begin, size_t end) {
+            for (size_t chunk = begin; chunk < end; ++chunk)
+            {
+                uint32_t*    cursor = &offsets[chunk * PARTITION_COUNT];
+                const size_t last   = std::min(count, (chunk + 1) * VERTEX_GRAIN);
+                for (size_t i = chunk * VERTEX_GRAIN; i < last; ++i)
+                    order[cursor[partitionOf(hashes[i])]++] = static_cast<uint32_t>(i);
+            }
+        });
+
+        // dedupe each partition in its own table; remap temporarily holds the first vertex with the same key
+        forRange(pool, 0, PARTITION_COUNT, 1, [&](size_t begin, size_t end) {
+            std::vector<Slot> table;
+            std::vector<Key>  keys; // of the partition's unique vertices, so probes never go back to the vertices
+            Key               key;
+            for (size_t partition = begin; partition < end; ++partition)
+            {
+                const uint32_t first = partition_begin[partition];
+                const uint32_t last  = partition_begin[partition + 1];
+                if (first == last)
+                    continue;
+
+                // sized by the unique vertices seen so far, not the partition, so tables of meshes with many
+                // duplicates stay in cache
+                size_t mask = std::min<size_t>(MIN_TABLE_SIZE, ceilPowerOfTwo(last - first) * 2) - 1;
+                table.assign(mask + 1, Slot {EMPTY_VERTEX, 0, 0});
+                keys.clear();
+
+                for (uint32_t at = first; at < last; ++at)
+                {
+                    // the partition's vertices are spread over the whole buffer, fetch them ahead
+                    if (at + PREFETCH_DISTANCE < last)
+                    {
+                        const char* ahead = reinterpret_cast<const char*>(&vertices[order[at + PREFETCH_DISTANCE]]);
+                        prefetch(ahead);
+                        prefetch(ahead + sizeof(Vertex) - 1);
+                    }
+
+                    const uint32_t vertex = order[at];
+                    const uint64_t hash   = hashes[vertex];
+                    const uint32_t tag    = static_cast<uint32_t>(hash >> 32);
+                    makeKey(vertices[vertex], inv_epsilon, key);
+
+                    size_t slot = static_cast<size_t>(hash) & mask;
+                    while (true)
+                    {
+                        const Slot entry = table[slot];
+                        if (entry.vertex == EMPTY_VERTEX)
+                        {
+                            table[slot]   = Slot {vertex, tag, static_cast<uint32_t>(keys.size())};
+                            remap[vertex] = vertex;
+                            keys.push_back(key);
+                            if (keys.size() * 2 > mask)
+                                mask = grow(table, hashes.data());
+                            break;
+                        }
+                        if (entry.tag == tag && keys[entry.key] == key)
+                        {
+                            remap[vertex] = entry.vertex;
+                            break;
+                        }
+                        slot = (slot + 1) & mask;
+                    }
+                }
+            }
+        });
+
+        // number the kept vertices in order; a duplicate always comes after the vertex it merges into
+        uint32_t kept = 0;
+        for (size_t i = 0; i < count; ++i)
+            remap[i] = remap[i] == i ? kept++ : remap[remap[i]];
+        return kept;
+    }
+
+    VertexWelder::Report VertexWelder::weld(Mesh& mesh, const Settings& settings, ThreadPool* pool)
+    {
+        std::vector<Vertex>&   vertices = mesh.getVertices();
+        std::vector<uint32_t>& indices  = mesh.getIndices();
+
+        Report report;
+        report.vertices_before = vertices.size();
+        report.vertices_after  = vertices.size();
+        if (vertices.empty())
+            return report;
+
+        std::vector<uint32_t> remap(vertices.size());
+        const size_t          kept = buildRemap(vertices.data(), vertices.size(), settings, remap.data(), pool);
+        report.vertices_after = kept;
+        if (kept == vertices.size())
+            return report;
+
+        // a kept vertex takes the next free index, a duplicate points below it, so the kept ones pack forward
+        uint32_t next = 0;
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            if (remap[i] != next)
+                continue;
+            if (next != i)
+                vertices[next] = vertices[i];
+            ++next;
+        }
+        vertices.resize(kept);
+
+        forRange(pool, 0, indices.size(), VERTEX_GRAIN, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                indices[i] = remap[indices[i]];
+        });
+
+        std::vector<Vertex>   welded_vertices = std::move(vertices);
+        std::vector<uint32_t> welded_indices  = std::move(indices);
+        welded_vertices.shrink_to_fit();
+        mesh.setVertices(std::move(welded_vertices));
+        mesh.setIndices(std::move(welded_indices));
+        if (settings.epsilon > 0.0f)
+            mesh.calculateAABB(pool);
+        return report;
+    }
+} // namespace RealmEngine
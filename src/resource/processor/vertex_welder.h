@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "resource/datatype/model/mesh.h"
+
+namespace RealmEngine
+{
+    class ThreadPool;
+
+    /**
+     * Joins duplicate vertices of an indexed mesh, the engine side replacement for aiProcess_JoinIdenticalVertices.
+     *
+     * Every vertex is reduced to a key of all its attributes (bit patterns, or grid cells with an epsilon) and
+     * hashed. The hashes pick one of PARTITION_COUNT partitions; vertices are bucketed by partition with a
+     * counting sort over fixed-size chunks, then each partition dedupes its vertices in a private open addressing
+     * table holding the keys it kept. Chunks and partitions both go over the pool, nothing is shared between tasks
+     * and no locks are taken.
+     * A vertex merges into the first vertex with the same key, so the result doesn't depend on the thread count.
+     */
+    class VertexWelder
+    {
+    public:
+        static constexpr uint32_t PARTITION_COUNT = 64;
+
+        struct Settings
+        {
+            // 0 joins vertices whose attributes are bit-identical (+0 and -0 alike). Otherwise every float
+            // attribute is snapped to a grid of that size and vertices falling in the same cells are joined,
+            // keeping the attributes of the first one; values either side of a cell edge stay apart.
+            float epsilon {0.0f};
+        };
+
+        struct Report
+        {
+            size_t vertices_before {0};
+            size_t vertices_after {0};
+        };
+
+        /**
+         * remap[i] receives the index vertex i has in the welded buffer; kept vertices stay in first-use order.
+         * Returns the number of vertices kept.
+         */
+        static size_t
+        buildRemap(const Vertex* vertices, size_t count, const Settings& settings, uint32_t* remap, ThreadPool* pool);
+
+        // Welds mesh in place, rewriting its indices. Submesh ranges are untouched, LODs must be built afterwards.
+        static Report weld(Mesh& mesh, const Settings& settings, ThreadPool* pool = nullptr);
+    };
+} // namespace RealmEngine
@@ -0,0 +1,147 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <string>
+#include "utils.h"
+
+namespace RealmEngine
+{
+    void ThreadPool::initialize(size_t thread_count)
+    {
+        if (thread_count == 0)
+        {
+            size_t hardware_threads = std::thread::hardware_concurrency();
+            thread_count            = hardware_threads > 1 ? hardware_threads - 1 : 1;
+        }
+
+        m_stopping = false;
+        m_workers.reserve(thread_count);
+        for (size_t i = 0; i < thread_count; ++i)
+            m_workers.emplace_back(&ThreadPool::workerLoop, this);
+
+        info("Thread pool initialized with " + std::to_string(thread_count) + " worker(s).");
+    }
+
+    void ThreadPool::disposal()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_condition.notify_all();
+
+        for (auto& worker : m_workers)
+            if (worker.joinable())
+                worker.join();
+        m_workers.clear();
+        m_tasks.clear();
+
+        info("Thread pool disposed all workers.");
+    }
+
+    void ThreadPool::parallelFor(size_t                                    begin,
+                                 size_t                                    end,
+                                 size_t                                    grain,
+                                 const std::function<void(size_t, size_t)>& body)
+    {
+        if (begin >= end)
+            return;
+
+        grain                    = std::max<size_t>(grain, 1);
+        const size_t chunk_count = (end - begin + grain - 1) / grain;
+        if (chunk_count == 1 || m_workers.empty())
+        {
+            body(begin, end);
+            return;
+        }
+
+        struct SharedState
+        {
+            std::atomic<size_t>     next_chunk {0};
+            std::atomic<size_t>     done_chunks {0};
+            std::mutex              mutex;
+            std::condition_variable finished;
+            std::exception_ptr      error;
+        };
+        auto state = std::make_shared<SharedState>();
+
+        // Late helpers find no chunk left and never touch body, so capturing it by reference is safe.
+        auto run_chunks = [state, begin, end, grain, chunk_count, &body]() {
+            size_t chunk;
+            while ((chunk = state->next_chunk.fetch_add(1)) < chunk_count)
+            {
+                const size_t chunk_begin = begin + chunk * grain;
+                const size_t chunk_end   = std::min(chunk_begin + grain, end);
+                try
+                {
+                    body(chunk_begin, chunk_end);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    if (!state->error)
+                        state->error = std::current_exception();
+                }
+
+                if (state->done_chunks.fetch_add(1) + 1 == chunk_count)
+                {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    state->finished.notify_all();
+                }
+            }
+        };
+
+        const size_t helper_count = std::min(m_workers.size(), chunk_count - 1);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (size_t i = 0; i < helper_count; ++i)
+                m_tasks.emplace_back(run_chunks);
+        }
+        m_condition.notify_all();
+
+        run_chunks();
+
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->finished.wait(lock, [&]() { return state->done_chunks.load() == chunk_count; });
+        }
+
+        if (state->error)
+            std::rethrow_exception(state->error);
+    }
+
+    bool ThreadPool::runPendingTask()
+    {
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_tasks.empty())
+                return false;
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+        return true;
+    }
+
+    void ThreadPool::workerLoop()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+                if (m_stopping && m_tasks.empty())
+                    return;
+
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+} // namespace RealmEngine
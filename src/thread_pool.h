@@ -0,0 +1,90 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace RealmEngine
+{
+    class ThreadPool
+    {
+    public:
+        ThreadPool()           = default;
+        ~ThreadPool() noexcept = default;
+
+        ThreadPool(const ThreadPool& that)            = delete;
+        ThreadPool(ThreadPool&& that)                 = delete;
+        ThreadPool& operator=(const ThreadPool& that) = delete;
+        ThreadPool& operator=(ThreadPool&& that)      = delete;
+
+        // thread_count == 0 picks hardware_concurrency - 1 (the caller thread also works in parallelFor).
+        void initialize(size_t thread_count = 0);
+        void disposal();
+
+        size_t getThreadCount() const { return m_workers.size(); }
+
+        template<typename F>
+        auto submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+        {
+            using Result = std::invoke_result_t<std::decay_t<F>>;
+
+            auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+            auto future   = packaged->get_future();
+
+            if (m_workers.empty())
+            {
+                (*packaged)();
+                return future;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_tasks.emplace_back([packaged]() { (*packaged)(); });
+            }
+            m_condition.notify_one();
+            return future;
+        }
+
+        /**
+         * Splits [begin, end) into chunks of at most grain elements and runs body(chunk_begin, chunk_end) on them.
+         * The calling thread takes chunks too and only waits for chunks already claimed by workers, so nested
+         * calls from inside pool tasks can't deadlock. The first exception thrown by body is rethrown here.
+         */
+        void parallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& body);
+
+        /**
+         * Waits for future while running queued tasks on the calling thread, like parallelFor, so a pool task
+         * waiting on a task still queued behind it can't tie up every worker.
+         */
+        template<typename Future>
+        void wait(const Future& future)
+        {
+            while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                // nothing queued: the task is running elsewhere, check back shortly in case more work comes in
+                if (!runPendingTask())
+                    future.wait_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        // Runs the oldest queued task on the calling thread. Returns false if there was none.
+        bool runPendingTask();
+
+    private:
+        void workerLoop();
+
+        std::vector<std::thread>          m_workers;
+        std::deque<std::function<void()>> m_tasks;
+        std::mutex                        m_mutex;
+        std::condition_variable           m_condition;
+        bool                              m_stopping {false};
+    };
+} // namespace RealmEngine
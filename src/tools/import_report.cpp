@@ -0,0 +1,288 @@
+#include "import_report.h"
+#include <stb/stb_image.h>
+#include "global_context.h"
+#include "json.hpp"
+#include "logger.h"
+#include "resource/datatype/model/material.h"
+#include "resource/datatype/model/model.h"
+#include "thread_pool.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <system_error>
+
+namespace RealmEngine
+{
+    namespace
+    {
+        constexpr const char* REPORT_FLAG = "--import-report";
+
+        void printUsage()
+        {
+            std::printf("Usage: RealmEngine %s <directory> [--json <file>] [--assimp] [--assimp-welding] "
+                        "[--weld-epsilon <size>] [--no-bvh] [--no-textures]\n"
+                        "  --json <file>          also write the report as JSON\n"
+                        "  --assimp               import glTF through Assimp instead of the native importer\n"
+                        "  --assimp-welding       weld vertices in Assimp (JoinIdenticalVertices)\n"
+                        "  --weld-epsilon <size>  grid size VertexWelder snaps attributes to, 0 for exact matches\n"
+                        "  --no-bvh               skip building the per mesh ray query BVHs\n"
+                        "  --no-textures          skip decoding the textures the models reference\n",
+                        REPORT_FLAG);
+        }
+
+        double toMegabytes(size_t bytes) { return static_cast<double>(bytes) / (1024.0 * 1024.0); }
+
+        // the stages of all reports merged by name, in the order they first show up
+        std::vector<ImportStats::Stage> mergeStages(const std::vector<ImportStats>& reports)
+        {
+            std::vector<ImportStats::Stage> merged;
+            for (const ImportStats& report : reports)
+            {
+                for (const ImportStats::Stage& stage : report.stages)
+                {
+                    auto it = std::find_if(merged.begin(), merged.end(), [&](const ImportStats::Stage& total) {
+                        return total.name == stage.name;
+                    });
+                    if (it == merged.end())
+                        it = merged.insert(merged.end(), ImportStats::Stage {stage.name});
+
+                    it->milliseconds += stage.milliseconds;
+                    it->peak_memory = std::max(it->peak_memory, stage.peak_memory);
+                    it->runs += stage.runs;
+                }
+            }
+            return merged;
+        }
+    } // namespace
+
+    bool ImportReport::isRequested(int argc, char** argv)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], REPORT_FLAG) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    bool ImportReport::parseArguments(int argc, char** argv, Settings& settings)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string argument = argv[i];
+            if (argument == REPORT_FLAG && i + 1 < argc)
+                settings.directory = argv[++i];
+            else if (argument == "--json" && i + 1 < argc)
+                settings.json_path = argv[++i];
+            else if (argument == "--assimp")
+                settings.options.native_gltf = false;
+            else if (argument == "--assimp-welding")
+                settings.options.vertex_welding = ModelImporter::VertexWelding::Assimp;
+            else if (argument == "--weld-epsilon" && i + 1 < argc)
+                settings.options.weld_epsilon = std::max(0.0f, std::strtof(argv[++i], nullptr));
+            else if (argument == "--no-bvh")
+                settings.options.build_bvh = false;
+            else if (argument == "--no-textures")
+                settings.decode_textures = false;
+            else
+                return false;
+        }
+        return !settings.directory.empty();
+    }
+
+    std::vector<std::filesystem::path> ImportReport::findModels(const std::filesystem::path& directory)
+    {
+        std::vector<std::filesystem::path> models;
+        std::error_code                    error;
+        for (auto it = std::filesystem::recursive_directory_iterator(directory, error);
+             !error && it != std::filesystem::recursive_directory_iterator();
+             it.increment(error))
+        {
+            if (!it->is_regular_file(error))
+                continue;
+
+            std::string extension = it->path().extension().string();
+            std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) {
+                return static_cast<char>(std::tolower(c));
+            });
+            // same formats the hot reloader watches
+            if (extension == ".gltf" || extension == ".glb" || extension == ".obj" || extension == ".fbx" ||
+                extension == ".dae" || extension == ".3ds" || extension == ".blend" || extension == ".ply")
+                models.push_back(it->path());
+        }
+
+        // a stable order, so reports of two runs line up
+        std::sort(models.begin(), models.end());
+        return models;
+    }
+
+    void ImportReport::decodeTextures(const Model& model, ImportStats& stats)
+    {
+        std::set<std::string> paths;
+        for (size_t i = 0; i < model.getMaterialCount(); ++i)
+        {
+            const Material& material = model.getMaterial(i);
+            for (const auto* texture : {&material.getBaseColorTexture(),
+                                        &material.getMetallicRoughnessTexture(),
+                                        &material.getNormalTexture(),
+                                        &material.getOcclusionTexture(),
+                                        &material.getEmissiveTexture()})
+            {
+                if (texture->has_value())
+                    paths.insert((*texture)->path);
+            }
+        }
+
+        // the stage is appended to the import's own, its time counts towards the total
+        ImportProfiler profiler(&stats);
+        for (const std::string& path : paths)
+        {
+            ImportProfiler::Scope scope(&profiler, "texture_decode");
+
+            // 4 channels, like the compressing TextureLoader path
+            int      width = 0, height = 0, channels = 0;
+            stbi_uc* pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+            if (!pixels)
+                warn("Failed to decode texture: " + path);
+            stbi_image_free(pixels);
+        }
+
+        if (const ImportStats::Stage* stage = stats.findStage("texture_decode"))
+        {
+            debug("Decoded " + std::to_string(stage->runs) + " texture(s) in " +
+                  std::to_string(stage->milliseconds) + " ms");
+            stats.total_milliseconds += stage->milliseconds;
+            stats.peak_memory = std::max(stats.peak_memory, stage->peak_memory);
+        }
+    }
+
+    int ImportReport::run(int argc, char** argv)
+    {
+        Settings settings;
+        if (!parseArguments(argc, argv, settings))
+        {
+            printUsage();
+            return 2;
+        }
+
+        // just what ModelImporter needs: logging and the thread pool
+        g_context.m_logger = std::make_shared<Logger>();
+        g_context.m_logger->initialize();
+        g_context.m_thread_pool = std::make_shared<ThreadPool>();
+        g_context.m_thread_pool->initialize();
+
+        const std::vector<std::filesystem::path> models = findModels(settings.directory);
+        if (models.empty())
+            warn("No model files found in: " + settings.directory.string());
+
+        std::vector<ImportStats> reports;
+        reports.reserve(models.size());
+        size_t failed = 0;
+        for (const std::filesystem::path& path : models)
+        {
+            ImportStats stats;
+            {
+                // the model is released before the next import, so its memory doesn't carry over
+                std::unique_ptr<Model> model = ModelImporter::loadModel(path.string(), settings.options, &stats);
+                if (!model)
+                    ++failed;
+                else if (settings.decode_textures)
+                    decodeTextures(*model, stats);
+            }
+            reports.push_back(std::move(stats));
+        }
+
+        printReport(settings, reports);
+        const bool written = settings.json_path.empty() || writeJson(settings, reports);
+
+        g_context.m_thread_pool->disposal();
+        g_context.m_thread_pool.reset();
+        g_context.m_logger->disposal();
+        g_context.m_logger.reset();
+
+        return failed == 0 && written ? 0 : 1;
+    }
+
+    void ImportReport::printReport(const Settings& settings, const std::vector<ImportStats>& reports)
+    {
+        double total_ms = 0.0;
+        std::printf(
+            "\n%-48s %-8s %7s %10s %10s %9s\n", "Model", "Importer", "Meshes", "Vertices", "Total ms", "Peak MB");
+        for (const ImportStats& report : reports)
+        {
+            std::string name = std::filesystem::path(report.source).lexically_relative(settings.directory).string();
+            if (name.size() > 48)
+                name = "..." + name.substr(name.size() - 45);
+            std::printf("%-48s %-8s %7zu %10zu %10.2f %9.1f%s\n",
+                        name.c_str(),
+                        report.importer.c_str(),
+                        report.meshes,
+                        report.vertices,
+                        report.total_milliseconds,
+                        toMegabytes(report.peak_memory),
+                        report.succeeded ? "" : "  FAILED");
+            total_ms += report.total_milliseconds;
+        }
+
+        // per mesh stages run on every worker at once, so their shares can add up to more than 100%
+        std::printf("\n%-24s %10s %7s %9s %7s\n", "Stage", "Total ms", "Share", "Peak MB", "Runs");
+        for (const ImportStats::Stage& stage : mergeStages(reports))
+        {
+            std::printf("%-24s %10.2f %6.1f%% %9.1f %7u\n",
+                        stage.name.c_str(),
+                        stage.milliseconds,
+                        total_ms > 0.0 ? stage.milliseconds / total_ms * 100.0 : 0.0,
+                        toMegabytes(stage.peak_memory),
+                        stage.runs);
+        }
+        std::printf("\n%zu model(s), %.2f ms in total\n", reports.size(), total_ms);
+    }
+
+    bool ImportReport::writeJson(const Settings& settings, const std::vector<ImportStats>& reports)
+    {
+        nlohmann::json json;
+        json["directory"]       = settings.directory.generic_string();
+        json["native_gltf"]     = settings.options.native_gltf;
+        json["engine_welding"]  = settings.options.vertex_welding == ModelImporter::VertexWelding::Engine;
+        json["weld_epsilon"]    = settings.options.weld_epsilon;
+        json["build_bvh"]       = settings.options.build_bvh;
+        json["decode_textures"] = settings.decode_textures;
+
+        double          total_ms    = 0.0;
+        nlohmann::json& json_models = json["models"];
+        json_models                 = nlohmann::json::array();
+        for (const ImportStats& report : reports)
+        {
+            json_models.push_back(report.toJson());
+            total_ms += report.total_milliseconds;
+        }
+        json["total_ms"] = total_ms;
+
+        nlohmann::json& json_stages = json["stages"];
+        json_stages                 = nlohmann::json::array();
+        for (const ImportStats::Stage& stage : mergeStages(reports))
+        {
+            json_stages.push_back({{"name", stage.name},
+                                   {"ms", stage.milliseconds},
+                                   {"peak_memory_bytes", stage.peak_memory},
+                                   {"runs", stage.runs}});
+        }
+
+        std::ofstream file(settings.json_path);
+        file << json.dump(2) << '\n';
+        if (!file.good())
+        {
+            err("Failed to write the import report to: " + settings.json_path);
+            return false;
+        }
+        info("Import report written to: " + settings.json_path);
+        return true;
+    }
+} // namespace RealmEngine
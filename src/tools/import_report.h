@@ -0,0 +1,45 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "resource/importer/import_stats.h"
+#include "resource/importer/model_importer.h"
+
+namespace RealmEngine
+{
+    /**
+     * Command line mode that imports every model under a directory with ImportStats enabled and reports where
+     * the time went, per model and per stage over all of them:
+     *
+     *     RealmEngine --import-report <directory> [--json <file>] [--assimp] [--assimp-welding]
+     *                 [--weld-epsilon <size>] [--no-bvh] [--no-textures]
+     *
+     * Models are imported one after another, so the memory figures of each are its own. Texture decoding isn't
+     * part of ModelImporter (the renderer's TextureLoader does it), so the report decodes the textures each model
+     * references itself, with stb_image like the loader, as a texture_decode stage.
+     */
+    class ImportReport
+    {
+    public:
+        struct Settings
+        {
+            std::filesystem::path      directory;
+            std::string                json_path;
+            ModelImporter::LoadOptions options;
+            bool                       decode_textures {true};
+        };
+
+        static bool isRequested(int argc, char** argv);
+        // Runs without a window or renderer and returns the process exit code.
+        static int  run(int argc, char** argv);
+
+    private:
+        static std::vector<std::filesystem::path> findModels(const std::filesystem::path& directory);
+
+        static bool parseArguments(int argc, char** argv, Settings& settings);
+        static void decodeTextures(const Model& model, ImportStats& stats);
+        static void printReport(const Settings& settings, const std::vector<ImportStats>& reports);
+        static bool writeJson(const Settings& settings, const std::vector<ImportStats>& reports);
+    };
+} // namespace RealmEngine
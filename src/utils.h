@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <cstdio>
 #include <string>
 #include "global_context.h"
 #include "logger.h"
@@ -58,4 +60,17 @@ namespace RealmEngine
         g_context.m_logger->log(Logger::LogLevel::fatal, "[" + std::string(__FUNCTION__) + "]" + str);
     }
 
+    // Formatting helpers
+
+    // "124 KB", rounded up so small allocations don't show as 0
+    inline std::string formatKilobytes(uint64_t bytes) { return std::to_string((bytes + 1023) >> 10) + " KB"; }
+
+    // "12.3 MB", for sizes in log lines and reports
+    inline std::string formatMegabytes(uint64_t bytes)
+    {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.1f MB", static_cast<double>(bytes) / (1024.0 * 1024.0));
+        return text;
+    }
+
 } // namespace RealmEngine
\ No newline at end of file